@@ -4680,6 +4680,10 @@ static const char liblte_rrc_sps_interval_dl_text[LIBLTE_RRC_SPS_INTERVAL_DL_N_I
                                                                                               "sf64",  "sf80", "sf128", "sf160",
                                                                                              "sf320", "sf640", "SPARE", "SPARE",
                                                                                              "SPARE", "SPARE", "SPARE", "SPARE"};
+static const uint16 liblte_rrc_sps_interval_dl_num[LIBLTE_RRC_SPS_INTERVAL_DL_N_ITEMS] = { 10,  20,  32,  40,
+                                                                                           64,  80, 128, 160,
+                                                                                          320, 640,   0,   0,
+                                                                                            0,   0,   0,   0};
 typedef enum{
     LIBLTE_RRC_SPS_INTERVAL_UL_SF10 = 0,
     LIBLTE_RRC_SPS_INTERVAL_UL_SF20,
@@ -4703,6 +4707,10 @@ static const char liblte_rrc_sps_interval_ul_text[LIBLTE_RRC_SPS_INTERVAL_UL_N_I
                                                                                               "sf64",  "sf80", "sf128", "sf160",
                                                                                              "sf320", "sf640", "SPARE", "SPARE",
                                                                                              "SPARE", "SPARE", "SPARE", "SPARE"};
+static const uint16 liblte_rrc_sps_interval_ul_num[LIBLTE_RRC_SPS_INTERVAL_UL_N_ITEMS] = { 10,  20,  32,  40,
+                                                                                           64,  80, 128, 160,
+                                                                                          320, 640,   0,   0,
+                                                                                            0,   0,   0,   0};
 typedef enum{
     LIBLTE_RRC_IMPLICIT_RELEASE_AFTER_E2 = 0,
     LIBLTE_RRC_IMPLICIT_RELEASE_AFTER_E3,
@@ -4711,6 +4719,7 @@ typedef enum{
     LIBLTE_RRC_IMPLICIT_RELEASE_AFTER_N_ITEMS,
 }LIBLTE_RRC_IMPLICIT_RELEASE_AFTER_ENUM;
 static const char liblte_rrc_implicit_release_after_text[LIBLTE_RRC_IMPLICIT_RELEASE_AFTER_N_ITEMS][20] = {"e2", "e3", "e4", "e8"};
+static const uint8 liblte_rrc_implicit_release_after_num[LIBLTE_RRC_IMPLICIT_RELEASE_AFTER_N_ITEMS] = {2, 3, 4, 8};
 typedef enum{
     LIBLTE_RRC_TWO_INTERVALS_CONFIG_TRUE = 0,
     LIBLTE_RRC_TWO_INTERVALS_CONFIG_N_ITEMS,
@@ -69,6 +69,7 @@ public:
 class usim_interface_rrc
 {
 public:
+  virtual void get_imsi_vec(uint8_t* imsi_, uint32_t n) = 0;
   virtual void generate_as_keys(uint32_t count_ul,
                                 uint8_t *k_rrc_enc,
                                 uint8_t *k_rrc_int,
@@ -109,6 +110,9 @@ class rrc_interface_mac
 public:
   virtual void release_pucch_srs() = 0;
   virtual void ra_problem() = 0; 
+  
+  /* Result of the acquisition of a SI message scheduled with mac_interface_rrc::si_acquire() */
+  virtual void si_acquired(uint32_t si_id, bool success) = 0;
 };
 
 // RRC interface for PHY
@@ -210,7 +214,8 @@ class rlc_interface_mac : public srslte::read_pdu_interface
 {
 public:
   /* MAC calls RLC to get buffer state for a logical channel.
-   * This function should return quickly. */
+   * This function should return quickly. It reads a snapshot that RLC updates after every 
+   * queue change and on expiry of its timers, without locking the RLC entity. */
   virtual uint32_t get_buffer_state(uint32_t lcid) = 0;
   virtual uint32_t get_total_buffer_state(uint32_t lcid) = 0; 
 
@@ -224,6 +229,14 @@ public:
   /* MAC calls RLC to push an RLC PDU. This function is called from an independent MAC thread.
    * PDU gets placed into the buffer and higher layer thread gets notified. */
   virtual void write_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes) = 0;
+  
+  typedef struct {
+    uint8_t  *payload; 
+    uint32_t  nof_bytes; 
+  } pdu_iov_t; 
+  
+  /* Same as write_pdu() for a burst of RLC PDUs of the same logical channel, in reception order */
+  virtual void write_pdus(uint32_t lcid, pdu_iov_t *pdus, uint32_t nof_pdus) = 0;
   virtual void write_pdu_bcch_bch(uint8_t *payload, uint32_t nof_bytes) = 0;
   virtual void write_pdu_bcch_dlsch(uint8_t *payload, uint32_t nof_bytes) = 0;
   virtual void write_pdu_pcch(uint8_t *payload, uint32_t nof_bytes) = 0;
@@ -60,6 +60,8 @@ public:
     uint16_t    rnti; 
     bool        is_from_rar;
     bool        is_sps_release;
+    bool        is_sps_configured; // Configured SPS assignment or grant, not received on PDCCH
+    uint32_t    sps_n_pucch_idx;   // n1PUCCH-AN-Persistent selected by the TPC field of a DL SPS activation
     bool        has_cqi_request;
     srslte_rnti_type_t rnti_type; 
     srslte_phy_grant_t phy_grant; 
@@ -103,12 +105,20 @@ public:
   /* Indicate reception of DL grant. */ 
   virtual void new_grant_dl(mac_grant_t grant, tb_action_dl_t *action) = 0;
   
+  /* Configured SPS assignment (DL) or grant (UL) occurring in this TTI, if any (Section 5.10). Called when 
+   * no grant was found on PDCCH. The grant is then delivered with new_grant_dl() or new_grant_ul() */
+  virtual bool get_sps_grant_dl(uint32_t tti, mac_grant_t *grant) = 0;
+  virtual bool get_sps_grant_ul(uint32_t tti, mac_grant_t *grant) = 0;
+  
   /* Indicate successfull decoding of PDSCH TB. */
   virtual void tb_decoded(bool ack, srslte_rnti_type_t rnti_type, uint32_t harq_pid) = 0;
   
   /* Indicate successfull decoding of BCH TB through PBCH */
   virtual void bch_decoded_ok(uint8_t *payload, uint32_t len) = 0;  
   
+  /* Indicates the cell the PHY is synchronized to. Called before the MIB is delivered */
+  virtual void set_cell(srslte_cell_t cell) = 0;  
+  
   /* Indicate successfull decoding of PCH TB through PDSCH */
   virtual void pch_decoded_ok(uint32_t len) = 0;  
   
@@ -117,6 +127,10 @@ public:
    */
   virtual void tti_clock(uint32_t tti) = 0;
   
+  /* Blocks until the MAC has run its procedures for every TTI clocked so far. For PHYs that clock 
+   * TTIs faster than real time, such as the MAC trace replay */
+  virtual void wait_tti_processed() = 0;
+  
 };
 
 
@@ -146,6 +160,14 @@ public:
   virtual void    bcch_start_rx() = 0; 
   virtual void    bcch_stop_rx() = 0; 
   virtual void    bcch_start_rx(int si_window_start, int si_window_length) = 0;
+  
+  /* SI acquisition (36.331 5.2.3). The MAC arms BCCH reception for every window of the SI message 
+   * on its TTI clock and reports the result with rrc_interface_mac::si_acquired(). The window 
+   * starts at subframe offset of the radio frames where SFN mod period = 0, offset may exceed 10. 
+   * Windows are skipped while random access is in progress and, once connected, the C-RNTI search 
+   * is resumed after each window */
+  virtual void    si_acquire(uint32_t si_id, uint32_t period, uint32_t offset, uint32_t win_len, uint32_t max_windows) = 0;
+  virtual void    si_acquire_stop() = 0;
 
   /* Instructs the MAC to start receiving PCCH */
   virtual void    pcch_start_rx() = 0; 
@@ -160,6 +182,7 @@ public:
   virtual void set_config_main(LIBLTE_RRC_MAC_MAIN_CONFIG_STRUCT *main_cfg) = 0;
   virtual void set_config_rach(LIBLTE_RRC_RACH_CONFIG_COMMON_STRUCT *rach_cfg, uint32_t prach_config_index) = 0;
   virtual void set_config_sr(LIBLTE_RRC_SCHEDULING_REQUEST_CONFIG_STRUCT *sr_cfg) = 0;
+  virtual void set_config_sps(LIBLTE_RRC_SPS_CONFIG_STRUCT *sps_cfg) = 0;
   virtual void get_config(mac_cfg_t *mac_cfg) = 0;
   
   virtual void get_rntis(ue_rnti_t *rntis) = 0;
@@ -170,6 +193,16 @@ public:
   virtual void reset() = 0;
 };
 
+
+/* Interface RLC -> MAC */
+class mac_interface_rlc
+{
+public:
+  /* RLC notifies the MAC that the buffer state of a logical channel increased. 
+   * Called from any thread, must not block */
+  virtual void notify_ul_data(uint32_t lcid) = 0; 
+};
+
 }
 
 
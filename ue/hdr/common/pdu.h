@@ -45,6 +45,10 @@ public:
   
   pdu(uint32_t max_subheaders_) : subheaders(max_subheaders_) {
     max_subheaders = max_subheaders_; 
+    for (int i=0;i<max_subheaders;i++) {
+      subheaders[i].parent = this; 
+      subheaders[i].init();
+    }
     nof_subheaders = 0; 
     cur_idx        = -1; 
     pdu_len        = 0; 
@@ -82,14 +86,16 @@ public:
     return nof_subheaders;
   }
   
+  /* Adds a subheader in its initial state. The subheader table grows when full, so the number of 
+   * subheaders is only bounded by the PDU size. get() pointers are not valid after this call */
   bool new_subh() {
-    if (nof_subheaders < max_subheaders - 1) {
-      nof_subheaders++;
-      next();
-      return true; 
-    } else {
-      return false; 
+    if (nof_subheaders >= max_subheaders - 1) {
+      grow();
     }
+    nof_subheaders++;
+    next();
+    subheaders[cur_idx].init();
+    return true; 
   }
 
   bool next() {
@@ -130,17 +136,34 @@ public:
     total_sdu_len += sdu_sz; 
   }
 
-  // Section 6.1.2
-  void parse_packet(uint8_t *ptr) {
-    uint8_t *init_ptr = ptr; 
+  // Section 6.1.2. Returns false and leaves no subheaders if the headers or payloads do not fit in the PDU
+  bool parse_packet(uint8_t *ptr) {
+    uint8_t *end_ptr = ptr + pdu_len; 
+    bool has_next = true; 
     nof_subheaders = 0; 
-    while(subheaders[nof_subheaders].read_subheader(&ptr)) {
+    while(has_next) {
+      if (ptr >= end_ptr) {
+        nof_subheaders = 0; 
+        return false; 
+      }
+      if (nof_subheaders >= max_subheaders) {
+        grow();
+      }
+      if (subheaders[nof_subheaders].peek_header_size(ptr, end_ptr - ptr) > (uint32_t) (end_ptr - ptr)) {
+        nof_subheaders = 0; 
+        return false; 
+      }
+      has_next = subheaders[nof_subheaders].read_subheader(&ptr);
       nof_subheaders++;
     }
-    nof_subheaders++;
     for (int i=0;i<nof_subheaders;i++) {
       subheaders[i].read_payload(&ptr);
     }
+    if (ptr > end_ptr) {
+      nof_subheaders = 0; 
+      return false; 
+    }
+    return true; 
   }
 
 protected:  
@@ -158,38 +181,36 @@ protected:
   
 private: 
   
-  /* Prepares the PDU for parsing or writing by setting the number of subheaders to 0 and the pdu length */
+  /* Prepares the PDU for parsing or writing by setting the number of subheaders to 0 and the pdu length. 
+   * Subheaders are reset when new_subh() hands them out or when parsing overwrites them */
   void init_(uint8_t *buffer_tx_ptr, uint32_t pdu_len_bytes, bool is_ulsch) {
     nof_subheaders = 0; 
     pdu_len        = pdu_len_bytes; 
     rem_len        = pdu_len; 
     pdu_is_ul      = is_ulsch; 
     buffer_tx      = buffer_tx_ptr; 
-    sdu_offset_start = max_subheaders*2 + 13; // Assuming worst-case 2 bytes per sdu subheader + all possible CE
+    sdu_offset_start = pdu_len_bytes; // Subheaders and CE never take more than the PDU 
     total_sdu_len  = 0; 
     last_sdu_idx   = -1;
     reset();
-    for (int i=0;i<max_subheaders;i++) {
+  }
+  
+  void grow() {
+    subheaders.resize(2*max_subheaders);
+    for (int i=max_subheaders;i<2*max_subheaders;i++) {
       subheaders[i].parent = this; 
       subheaders[i].init();
     }
+    max_subheaders *= 2; 
   }
 };
 
+/* Subheaders are stored by value and called through their concrete type, they have no virtual methods */
 template<class SubH>
 class subh
 {
 public: 
-      
-  virtual bool read_subheader(uint8_t** ptr)                        = 0;
-  virtual void read_payload(uint8_t **ptr)                          = 0;    
-  virtual void write_subheader(uint8_t** ptr, bool is_last)         = 0;
-  virtual void write_payload(uint8_t **ptr)                         = 0;
-  virtual void fprint(FILE *stream)                                 = 0;
-
   pdu<SubH>* parent; 
-private: 
-  virtual void init() = 0;
 };
 
 
@@ -216,11 +237,16 @@ public:
   const static int MAC_CE_CONTRES_LEN = 6; 
 
   // Reading functions
-  bool     is_sdu();
-  cetype   ce_type();
+  bool     is_sdu() {
+    return lcid < PHR_REPORT;
+  }
+  cetype   ce_type() {
+    return is_sdu()?SDU:(cetype) lcid;
+  }
   uint32_t size_plus_header();
   void     set_payload_size(uint32_t size);
   
+  uint32_t peek_header_size(uint8_t *ptr, uint32_t nof_bytes);
   bool     read_subheader(uint8_t** ptr);
   void     read_payload(uint8_t **ptr);
   uint32_t get_sdu_lcid();
@@ -235,7 +261,20 @@ public:
   int      get_bsr(uint32_t buff_size[4]);
   
   // Writing functions
-  void     write_subheader(uint8_t** ptr, bool is_last);
+  void     write_subheader(uint8_t** ptr, bool is_last) {
+    // Section 6.2.1. R/R/E/LCID, then F/L for SDUs that are not the last subheader 
+    uint8_t *p = *ptr; 
+    *p++ = (uint8_t) (is_last?0:(1<<5)) | ((uint8_t) lcid & 0x1f);
+    if (is_sdu() && !is_last) {
+      if (nof_bytes >= 128) {
+        *p++ = (uint8_t) 1<<7 | ((nof_bytes & 0x7f00) >> 8);
+        *p++ = (uint8_t) (nof_bytes & 0xff);
+      } else {
+        *p++ = (uint8_t) (nof_bytes & 0x7f); 
+      }
+    }
+    *ptr = p; 
+  }
   void     write_payload(uint8_t **ptr);
   int      set_sdu(uint32_t lcid, uint32_t nof_bytes, uint8_t *payload);
   int      set_sdu(uint32_t lcid, uint32_t requested_bytes, read_pdu_interface *sdu_itf);
@@ -267,9 +306,14 @@ class sch_pdu : public pdu<sch_subh>
 {
 public:
   
-  sch_pdu(uint32_t max_subh) : pdu(max_subh) {}
+  sch_pdu(uint32_t max_subh) : pdu(max_subh) {
+    nof_ce         = 0; 
+    ce_payload_len = 0; 
+    sdu_header_len = 0; 
+  }
 
-  void      parse_packet(uint8_t *ptr);
+  void      init_tx(uint8_t *payload, uint32_t pdu_len_bytes, bool is_ulsch = false);
+  bool      parse_packet(uint8_t *ptr);
   uint8_t*  write_packet();
   uint8_t*  write_packet(srslte::log *log_h);
   bool      has_space_ce(uint32_t nbytes);  
@@ -282,6 +326,12 @@ public:
   bool      update_space_ce(uint32_t nbytes);  
   bool      update_space_sdu(uint32_t nbytes);  
   void      fprint(FILE *stream);
+  
+private: 
+  // Header and CE size, accumulated as subheaders are added 
+  uint32_t  nof_ce; 
+  uint32_t  ce_payload_len; 
+  uint32_t  sdu_header_len; // As if every SDU subheader carried the length field 
 };
 
 class rar_subh : public subh<rar_subh>
@@ -291,6 +341,9 @@ public:
   static const uint32_t RAR_GRANT_LEN = 20; 
   
   // Reading functions
+  uint32_t peek_header_size(uint8_t *ptr, uint32_t nof_bytes) {
+    return 1; 
+  }
   bool     read_subheader(uint8_t** ptr);
   void     read_payload(uint8_t** ptr);
   uint32_t get_rapid();
@@ -44,6 +44,13 @@ public:
   {
     public: 
       virtual void process_pdu(uint8_t *buff, uint32_t len) = 0;
+      
+      /* Processes a batch of PDUs in queue order. Defaults to one process_pdu() call per PDU */
+      virtual void process_pdus(uint8_t **buff, uint32_t *len, uint32_t nof_pdus) {
+        for (uint32_t i=0;i<nof_pdus;i++) {
+          process_pdu(buff[i], len[i]);
+        }
+      }
   };
 
   pdu_queue();
@@ -53,6 +60,8 @@ public:
   uint8_t* request_buffer(uint32_t pid, uint32_t len);
   
   void     push_pdu(uint32_t pid, uint32_t nof_bytes);
+  
+  const static int MAX_BATCH_PDUS  = 32; // PDUs handed to the callback at once
     
 private:
   const static int NOF_HARQ_PID    = 8; 
@@ -59,6 +59,13 @@ typedef struct {
   bool sfo_correct_disable; 
   std::string sss_algorithm; 
   float estimator_fil_w;   
+  std::string iq_capture_mode; 
+  std::string iq_capture_filename; 
+  int iq_capture_nof_sf; 
+  bool cell_search_parallel; 
+  std::string cell_search_earfcn; 
+  std::string cell_cache_filename; 
+  bool pdcch_early_stop; 
 } phy_args_t; 
   
 /* Interface MAC -> PHY */
@@ -92,6 +99,12 @@ public:
   virtual void pdcch_ul_search_reset() = 0;
   virtual void pdcch_dl_search_reset() = 0;
   
+  /* SPS C-RNTI, looked for in the same PDCCH candidates as the C-RNTI. 0 disables it */
+  virtual void set_sps_rnti(uint16_t rnti) = 0;
+  
+  /* Pregenerates the UL signals and scrambling sequences of the C-RNTI */
+  virtual void set_crnti(uint16_t rnti) = 0;
+  
   virtual uint32_t get_current_tti() = 0;
   
   virtual float get_phr() = 0; 
@@ -118,6 +131,7 @@ public:
   typedef struct {
     LIBLTE_RRC_PHYSICAL_CONFIG_DEDICATED_STRUCT dedicated;
     phy_cfg_common_t                            common; 
+    LIBLTE_RRC_SPS_CONFIG_DL_STRUCT             sps_dl; 
     bool                                        enable_64qam; 
   } phy_cfg_t; 
 
@@ -127,10 +141,18 @@ public:
   virtual void set_config_dedicated(LIBLTE_RRC_PHYSICAL_CONFIG_DEDICATED_STRUCT *dedicated) = 0;
   virtual void set_config_common(phy_cfg_common_t *common) = 0; 
   virtual void set_config_tdd(LIBLTE_RRC_TDD_CONFIG_STRUCT *tdd) = 0; 
+  virtual void set_config_sps_dl(LIBLTE_RRC_SPS_CONFIG_DL_STRUCT *sps_dl) = 0; 
   virtual void set_config_64qam_en(bool enable) = 0;
   
+  /* Restricts the P-RNTI search to the paging occasion: subframe po_sf of the frames 
+   * where SFN mod T = pf_offset (36.304 Section 7). T=0 monitors every subframe */
+  virtual void set_paging_occasion(uint32_t T, uint32_t pf_offset, uint32_t po_sf) = 0;
+  
   /* Is the PHY downlink synchronized? */
   virtual bool status_is_sync() = 0;
+  
+  /* Notifies a radio link failure to the IQ capture, if enabled in trigger mode */
+  virtual void iq_capture_trigger() = 0;
 
   /* Configure UL using parameters written with set_param() */
   virtual void configure_ul_params(bool pregen_disabled = false) = 0;
@@ -102,6 +102,14 @@ public:
   {
     return running;
   }
+  // Milliseconds left until expiry, 0 once expired, -1 if not running
+  int32_t msec_to_expire()
+  {
+    if(!running)
+      return -1;
+    int32_t msec = (stop_time - boost::posix_time::microsec_clock::local_time()).total_milliseconds();
+    return msec > 0 ? msec : 0;
+  }
 
 private:
   boost::posix_time::ptime  stop_time;
@@ -56,6 +56,7 @@ public:
   bool     get_uecrid_successful();
   
   void     process_pdu(uint8_t *pdu, uint32_t nof_bytes);
+  void     process_pdus(uint8_t **pdu, uint32_t *nof_bytes, uint32_t nof_pdus);
   
 private:
   const static int NOF_HARQ_PID    = 8; 
@@ -63,6 +64,22 @@ private:
   const static int NOF_BUFFER_PDUS = 64; // Number of PDU buffers per HARQ pid
   uint8_t bcch_buffer[1024]; // BCCH PID has a dedicated buffer
   
+  // SDUs of a batch of PDUs, delivered to RLC grouped by LCID. A full batch is delivered 
+  // before adding more SDUs. Every SDU subheader but the last takes at least 2 bytes (R/R/E/LCID 
+  // and F/L), so a PDU carries at most MAX_PDU_LEN/2+1 SDUs and a batch always holds a whole PDU 
+  const static uint32_t MAX_SDU_LCID   = 32; 
+  const static uint32_t MAX_BATCH_SDUS = MAX_PDU_LEN/2+1; 
+  typedef struct {
+    uint32_t lcid; 
+    uint8_t *payload; 
+    uint32_t nof_bytes; 
+  } batch_sdu_t; 
+  batch_sdu_t                    batch_sdus[MAX_BATCH_SDUS]; 
+  rlc_interface_mac::pdu_iov_t   batch_iov[MAX_BATCH_SDUS]; 
+  uint32_t                       nof_batch_sdus; 
+  uint32_t                       nof_batch_lcid_sdus[MAX_SDU_LCID]; 
+  void                           deliver_batch();
+  
   bool (*uecrid_callback) (void*, uint64_t);
   void *uecrid_callback_arg; 
   
@@ -59,6 +59,14 @@ public:
   
   void reset();
   void start_pcap(srslte::mac_pcap* pcap);
+  
+  /* Semi-persistent scheduling (Section 5.10.1) */
+  void set_sps_config(LIBLTE_RRC_SPS_CONFIG_DL_STRUCT *sps_cfg);
+  bool sps_enabled();
+  bool get_sps_grant(uint32_t tti, mac_interface_phy::mac_grant_t *grant);
+  
+  /* Sizes the soft buffers for the cell bandwidth and the largest TB of the UE category */
+  bool set_nof_prb(uint32_t nof_prb);
   int  get_current_tbs(uint32_t harq_pid);
 
   void set_si_window_start(int si_window_start);
@@ -72,6 +80,7 @@ private:
   public:
     dl_harq_process();
     bool init(uint32_t pid, dl_harq_entity *parent);
+    bool resize(uint32_t nof_prb);
     void reset();
     bool is_sps(); 
     void new_grant_dl(mac_interface_phy::mac_grant_t grant, mac_interface_phy::tb_action_dl_t *action);
@@ -95,11 +104,13 @@ private:
     
     mac_interface_phy::mac_grant_t cur_grant;    
     srslte_softbuffer_rx_t         softbuffer; 
+    uint32_t                       softbuffer_nof_prb; 
     
   };
   static bool      generate_ack_callback(void *arg);
-
-  uint32_t         get_harq_sps_pid(uint32_t tti);
+  
+  // Soft buffers are allocated for the smallest bandwidth until the cell is known 
+  const static uint32_t INIT_NOF_PRB = 6; 
   
   dl_sps           dl_sps_assig;
   
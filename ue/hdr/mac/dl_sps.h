@@ -27,26 +27,44 @@
 #ifndef DL_SPS_H
 #define DL_SPS_H
 
+#include <pthread.h>
 #include "common/log.h"
-#include "phy/phy.h"
-#include "common/timers.h"
+#include "common/mac_interface.h"
 
 /* Downlink Semi-Persistent schedulign (Section 5.10.1) */
 
 
 namespace srsue {
   
+/* Configured downlink assignment. A PDCCH for the SPS C-RNTI with NDI=0 (re)initializes it and it then 
+ * recurs every semiPersistSchedIntervalDL subframes from the activation TTI until it is released. 
+ * Accessed from the PHY workers and from the RRC, all methods are thread-safe */
 class dl_sps
 {
 public:
 
-  void            clear() {}
-  void            reset() {}
-  bool            get_pending_grant(uint32_t tti, mac_interface_phy::mac_grant_t *grant) {
-    return false; 
-  }
+  dl_sps();
+  
+  /* RRC configuration, NULL or setup_present=false disables SPS and clears the configured assignment */
+  void            set_config(LIBLTE_RRC_SPS_CONFIG_DL_STRUCT *cfg);
+  bool            is_enabled();
+  
+  void            clear();
+  void            reset(uint32_t tti, mac_interface_phy::mac_grant_t *grant);
+  /* Configured assignment in this TTI, if any, with the HARQ process of get_harq_pid() */
+  bool            get_pending_grant(uint32_t tti, mac_interface_phy::mac_grant_t *grant);
+  uint32_t        get_harq_pid(uint32_t tti);
+  
 private:  
   
+  pthread_mutex_t mutex; 
+  bool            enabled; 
+  uint32_t        interval; 
+  uint32_t        nof_procs; 
+  
+  bool            is_configured; 
+  uint32_t        start_tti; 
+  mac_interface_phy::mac_grant_t cur_grant; 
 };
 
 } // namespace srsue
@@ -27,6 +27,7 @@
 #ifndef MAC_H
 #define MAC_H
 
+#include <semaphore.h>
 #include "common/log.h"
 #include "phy/phy.h"
 #include "mac/dl_harq.h"
@@ -37,6 +38,7 @@
 #include "mac/proc_sr.h"
 #include "mac/proc_bsr.h"
 #include "mac/proc_phr.h"
+#include "mac/proc_si.h"
 #include "mac/mux.h"
 #include "mac/demux.h"
 #include "common/mac_pcap.h"
@@ -49,6 +51,7 @@ namespace srsue {
 class mac
     :public mac_interface_phy
     ,public mac_interface_rrc
+    ,public mac_interface_rlc
     ,public srslte::mac_interface_timers
     ,public thread
     ,public srslte::timer_callback
@@ -66,21 +69,30 @@ public:
   void new_grant_ul_ack(mac_grant_t grant, bool ack, tb_action_ul_t *action);
   void harq_recv(uint32_t tti, bool ack, tb_action_ul_t *action);
   void new_grant_dl(mac_grant_t grant, tb_action_dl_t *action);
+  bool get_sps_grant_dl(uint32_t tti, mac_grant_t *grant);
+  bool get_sps_grant_ul(uint32_t tti, mac_grant_t *grant);
   void tb_decoded(bool ack, srslte_rnti_type_t rnti_type, uint32_t harq_pid);
   void bch_decoded_ok(uint8_t *payload, uint32_t len);
+  void set_cell(srslte_cell_t cell);
   void pch_decoded_ok(uint32_t len);    
   void tti_clock(uint32_t tti);
+  void wait_tti_processed();
 
   
   /******** Interface from RLC (RLC -> MAC) ****************/ 
   void bcch_start_rx(); 
   void bcch_stop_rx(); 
   void bcch_start_rx(int si_window_start, int si_window_length);
+  void si_acquire(uint32_t si_id, uint32_t period, uint32_t offset, uint32_t win_len, uint32_t max_windows);
+  void si_acquire_stop();
   void pcch_start_rx(); 
   void pcch_stop_rx(); 
   void setup_lcid(uint32_t lcid, uint32_t lcg, uint32_t priority, int PBR_x_tti, uint32_t BSD);
   void reconfiguration(); 
   void reset(); 
+  
+  /* Buffer state event from RLC */
+  void notify_ul_data(uint32_t lcid);
 
   /******** set/get MAC configuration  ****************/ 
   void set_config(mac_cfg_t *mac_cfg);
@@ -88,6 +100,7 @@ public:
   void set_config_main(LIBLTE_RRC_MAC_MAIN_CONFIG_STRUCT *main_cfg);
   void set_config_rach(LIBLTE_RRC_RACH_CONFIG_COMMON_STRUCT *rach_cfg, uint32_t prach_config_index);
   void set_config_sr(LIBLTE_RRC_SCHEDULING_REQUEST_CONFIG_STRUCT *sr_cfg);
+  void set_config_sps(LIBLTE_RRC_SPS_CONFIG_STRUCT *sps_cfg);
   void set_contention_id(uint64_t uecri);
   
   void get_rntis(ue_rnti_t *rntis);
@@ -122,6 +135,13 @@ private:
   // Interaction with PHY 
   srslte::tti_sync_cv   ttisync; 
   phy_interface_mac    *phy_h; 
+  
+  // TTIs clocked by the PHY and run by the MAC thread since it synchronized, for wait_tti_processed() 
+  pthread_mutex_t       tti_mutex; 
+  pthread_cond_t        tti_cond; 
+  bool                  tti_synced; 
+  uint32_t              nof_clocked_ttis; 
+  uint32_t              nof_processed_ttis; 
   rlc_interface_mac    *rlc_h; 
   rrc_interface_mac    *rrc_h; 
   srslte::log          *log_h;
@@ -152,6 +172,9 @@ private:
   bsr_proc      bsr_procedure; 
   phr_proc      phr_procedure; 
   
+  /* MAC Downlink-related Procedures */
+  si_proc       si_procedure; 
+  
   /* Buffers for PCH reception (not included in DL HARQ) */
   const static uint32_t  pch_payload_buffer_sz = 8*1024;
   srslte_softbuffer_rx_t pch_softbuffer;
@@ -199,9 +222,8 @@ private:
   private:
     void run_thread();
     bool running; 
-    bool have_data; 
-    pthread_mutex_t mutex;
-    pthread_cond_t  cvar;
+    volatile bool have_data; 
+    sem_t  sem;
     demux* demux_unit;
   };
   pdu_process pdu_process_thread;
@@ -51,7 +51,8 @@ public:
   bool     is_pending_any_sdu();
   bool     is_pending_sdu(uint32_t lcid); 
   
-  uint8_t* pdu_get(uint8_t *payload, uint32_t pdu_sz, uint32_t tx_tti, uint32_t pid);
+  /* Builds a MAC PDU. If nof_sdus is not NULL it returns the number of MAC SDUs in the PDU */
+  uint8_t* pdu_get(uint8_t *payload, uint32_t pdu_sz, uint32_t tx_tti, uint32_t pid, uint32_t *nof_sdus = NULL);
   uint8_t* msg3_get(uint8_t* payload, uint32_t pdu_sz);
   
   void     msg3_flush();
@@ -69,7 +70,7 @@ private:
   // There is a known bug in the code and NOF_UL_LCH must match the maximum priority (16) + 1
   const static int NOF_UL_LCH = 17; 
   const static int MIN_RLC_SDU_LEN = 0; 
-  const static int MAX_NOF_SUBHEADERS = 20; 
+  const static int INIT_NOF_SUBHEADERS = 20; // Grows with the number of SDUs that fit in the grant
   const static int MAX_HARQ_PROC = 8; 
   
   int64_t       Bj[NOF_UL_LCH];
@@ -91,8 +92,8 @@ private:
   phr_proc          *phr_procedure;
   uint16_t           pending_crnti_ce;
   
-  /* Msg3 Buffer */
-  static const uint32_t MSG3_BUFF_SZ = 128; 
+  /* Msg3 Buffer. The PDU is assembled with the headers placed before the SDUs, which needs twice the PDU size */
+  static const uint32_t MSG3_BUFF_SZ = 1024; 
   srslte::qbuff         msg3_buff;
   
   /* PDU Buffer */
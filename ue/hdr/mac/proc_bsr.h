@@ -28,6 +28,7 @@
 #define PROCBSR_H
 
 #include <stdint.h>
+#include <pthread.h>
 
 #include "common/log.h"
 #include "common/mac_interface.h"
@@ -50,6 +51,10 @@ public:
   void timer_expired(uint32_t timer_id);
   uint32_t get_buffer_state();
   
+  /* Called by RLC (any thread) when the buffer of a logical channel grows. Triggers a Regular BSR right away. 
+   * Returns true if the SR must be started because no UL grant is pending */
+  bool new_data(uint32_t lcid, uint32_t tti); 
+  
   typedef enum {
     LONG_BSR, 
     SHORT_BSR, 
@@ -79,8 +84,8 @@ private:
   bool              initiated;
   const static int MAX_LCID = 6; 
   int        lcg[MAX_LCID];
-  uint32_t   last_pending_data[MAX_LCID];
   int        priorities[MAX_LCID]; 
+  pthread_mutex_t mutex;       // Trigger state is shared by the MAC, PHY worker (mux) and RLC threads
   uint32_t   find_max_priority_lcid(); 
   typedef enum {NONE, REGULAR, PADDING, PERIODIC} triggered_bsr_type_t;
   triggered_bsr_type_t triggered_bsr_type; 
@@ -88,9 +93,9 @@ private:
   bool sr_is_sent;
   uint32_t last_print;
   uint32_t next_tx_tti;
-  void update_pending_data(); 
-  bool check_highest_channel(); 
-  bool check_single_channel(); 
+  bool check_highest_channel(uint32_t lcid_mask); 
+  bool check_single_channel(uint32_t lcid_mask); 
+  bool check_sr(uint32_t tti); 
   bool generate_bsr(bsr_t *bsr, uint32_t nof_padding_bytes); 
   char* bsr_type_tostring(triggered_bsr_type_t type); 
   char* bsr_format_tostring(bsr_format_t format);
@@ -0,0 +1,103 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef PROCSI_H
+#define PROCSI_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "common/log.h"
+#include "common/interfaces.h"
+#include "common/mac_interface.h"
+
+/* System Information acquisition scheduling as defined in 5.2.3 of 36.331 */
+
+
+namespace srsue {
+
+class si_proc
+{
+public:
+  si_proc();
+  void init(mac_interface_rrc *mac, rrc_interface_mac *rrc, srslte::log *log_h);
+  /* Windows are only armed while dl_search_free, i.e. the PDCCH DL search is not used by random 
+   * access. An armed window is given up, without counting it, if that is no longer the case */
+  void step(uint32_t tti, bool dl_search_free);  
+  void reset();
+  
+  /* Schedules the reception of SI message si_id, transmitted in windows of win_len subframes 
+   * starting at subframe offset of every period radio frames. Gives up after max_windows 
+   * windows (0 means never). */
+  void acquire(uint32_t si_id, uint32_t period, uint32_t offset, uint32_t win_len, uint32_t max_windows);
+  void stop();
+  
+  /* Called with the result of every SI-RNTI transport block */
+  void tb_decoded(bool ack);
+  
+  const static uint32_t MAX_SI = 33; // SIB1 + maxSI-Message
+  
+private:
+  
+  const static uint32_t SCHED_LEAD_TTI = 2;  // Windows are armed at least this number of TTIs in advance
+  const static uint32_t SCHED_MAX_TTI  = 10; // and at most this number, to leave the DL search free meanwhile
+  
+  typedef struct {
+    bool     pending; 
+    uint32_t period; 
+    uint32_t offset; 
+    uint32_t win_len; 
+    uint32_t max_windows; 
+    uint32_t nof_windows; 
+  } si_window_t; 
+  
+  uint32_t next_window_start(uint32_t tti, si_window_t *w);
+  void     arm_next(uint32_t tti); 
+  
+  si_window_t windows[MAX_SI]; 
+  bool        armed; 
+  uint32_t    armed_id; 
+  uint32_t    armed_end; 
+  
+  // Results are reported to RRC after releasing the mutex 
+  typedef struct {
+    uint32_t si_id; 
+    bool     success; 
+  } si_result_t; 
+  si_result_t results[MAX_SI]; 
+  uint32_t    nof_results; 
+  void        report_results(si_result_t *r, uint32_t n);
+  
+  pthread_mutex_t    mutex; 
+  mac_interface_rrc *mac; 
+  rrc_interface_mac *rrc;
+  srslte::log       *log_h;
+  bool               initiated;
+};
+
+} // namespace srsue
+
+#endif // PROCSI_H
@@ -28,6 +28,7 @@
 #define PROCSR_H
 
 #include <stdint.h>
+#include <pthread.h>
 
 #include "phy/phy.h"
 
@@ -43,6 +44,8 @@ public:
   void init(phy_interface_mac *phy_h, rrc_interface_mac *rrc, srslte::log *log_h, mac_interface_rrc::mac_cfg_t *mac_cfg);
   void step(uint32_t tti);  
   void reset();
+  
+  /* Called by the MAC thread or by RLC (any thread) on new data. The first SR is signalled to the PHY right away */
   void start();
   bool need_random_access(); 
   
@@ -60,6 +63,7 @@ private:
   
   bool          initiated;
   bool          do_ra;
+  pthread_mutex_t mutex; 
 };
 
 } // namespace srsue
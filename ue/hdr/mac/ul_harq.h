@@ -65,6 +65,11 @@ public:
   void reset_ndi();
 
   void start_pcap(srslte::mac_pcap* pcap);
+  
+  /* Semi-persistent scheduling (Section 5.10.2) */
+  void set_sps_config(LIBLTE_RRC_SPS_CONFIG_UL_STRUCT *sps_cfg);
+  bool sps_enabled();
+  bool get_sps_grant(uint32_t tti, mac_interface_phy::mac_grant_t *grant);
 
   
   /***************** PHY->MAC interface for UL processes **************************/
@@ -27,26 +27,47 @@
 #ifndef ULSPS_H
 #define ULSPS_H
 
+#include <pthread.h>
 #include "common/log.h"
-#include "phy/phy.h"
-#include "common/timers.h"
+#include "common/mac_interface.h"
 
 /* Uplink Semi-Persistent schedulign (Section 5.10.2) */
 
 
 namespace srsue {
   
-typedef _Complex float cf_t; 
-
+/* Configured uplink grant. Initialized by a PDCCH for the SPS C-RNTI with NDI=0, it recurs every 
+ * semiPersistSchedIntervalUL subframes from the activation TTI until it is released explicitly or 
+ * after implicitReleaseAfter consecutive new MAC PDUs without MAC SDUs. All methods are thread-safe */
 class ul_sps
 {
 public:
 
-  void           clear() {}
-  void           reset(uint32_t tti) {}
-  bool           get_pending_grant(uint32_t tti, mac_interface_phy::mac_grant_t *grant) { return false; }
+  ul_sps();
+  
+  /* RRC configuration, NULL or setup_present=false disables SPS and clears the configured grant */
+  void           set_config(LIBLTE_RRC_SPS_CONFIG_UL_STRUCT *cfg);
+  bool           is_enabled();
+  
+  void           clear();
+  void           reset(uint32_t tti, mac_interface_phy::mac_grant_t *grant);
+  bool           get_pending_grant(uint32_t tti, mac_interface_phy::mac_grant_t *grant);
+  
+  /* Called for every new MAC PDU built for the configured grant. Returns true if the grant was 
+   * implicitly released */
+  bool           new_pdu(uint32_t nof_sdus);
+  
 private:  
   
+  pthread_mutex_t mutex; 
+  bool           enabled; 
+  uint32_t       interval; 
+  uint32_t       implicit_release_after; 
+  
+  bool           is_configured; 
+  uint32_t       start_tti; 
+  uint32_t       nof_empty_pdus; 
+  mac_interface_phy::mac_grant_t cur_grant; 
 };
 
 } // namespace srsue
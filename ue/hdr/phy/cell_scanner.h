@@ -0,0 +1,100 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef UEPHYCELLSCANNER_H
+#define UEPHYCELLSCANNER_H
+
+#include <stdint.h>
+#include "srslte/srslte.h"
+#include "common/log.h"
+#include "common/thread_pool.h"
+
+namespace srsue {
+
+/* Searches PSS/SSS in a block of samples captured at 1.92 MHz. Each of the three N_id_2 
+ * hypotheses is correlated over the whole block by its own worker of a fixed pool, created 
+ * once in init(). 
+ */
+class cell_scanner
+{
+public:
+  
+  typedef struct {
+    bool        found; 
+    uint32_t    cell_id; 
+    srslte_cp_t cp; 
+    float       peak;         // Average PSS peak-to-side-lobe ratio 
+    float       rsrp_db;      // PSS-based received power estimate (dB relative to full scale)
+    float       cfo;          // Hz 
+    uint32_t    nof_detected; // Number of half-frames where PSS and SSS were found
+  } result_t; 
+  
+  const static uint32_t HALF_FRAME_LEN = 9600;  // 5 ms at 1.92 MHz
+  const static uint32_t FFT_SIZE       = 128; 
+  
+  cell_scanner();
+  ~cell_scanner();
+  bool init(uint32_t nof_half_frames, srslte::log *log_h, uint32_t prio);
+  void free();
+  
+  /* Buffer where the caller writes get_buffer_len() samples before calling scan() */
+  cf_t*    get_buffer();
+  uint32_t get_buffer_len();
+  
+  /* Searches the 3 N_id_2 in parallel (or only force_N_id_2 if 0..2). Returns the index of the 
+   * N_id_2 with the largest peak among those detected in at least min_detected half-frames, 
+   * or -1 if no cell was found. All results are written in results[3] */
+  int scan(uint32_t min_detected, result_t results[3], int force_N_id_2 = -1);
+  
+private:
+  
+  class searcher : public srslte::thread_pool::worker
+  {
+  public:
+    bool init(uint32_t N_id_2);
+    void free();
+    void set_search(cf_t *buffer, uint32_t nof_half_frames, bool enabled);
+    result_t result; 
+  private:
+    void work_imp();
+    srslte_sync_t sync; 
+    uint32_t      N_id_2; 
+    cf_t         *buffer; 
+    uint32_t      nof_half_frames; 
+    bool          enabled; 
+  };
+  
+  srslte::log        *log_h; 
+  srslte::thread_pool pool; 
+  searcher            searchers[3]; 
+  cf_t        *buffer; 
+  uint32_t     nof_half_frames; 
+  bool         initiated; 
+};
+
+} // namespace srsue
+
+#endif // UEPHYCELLSCANNER_H
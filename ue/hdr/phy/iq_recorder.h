@@ -0,0 +1,145 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef UEPHYIQRECORDER_H
+#define UEPHYIQRECORDER_H
+
+#include <stdint.h>
+#include <string>
+#include "srslte/srslte.h"
+#include "common/log.h"
+#include "common/threads.h"
+
+namespace srsue {
+
+/* Background recorder of the subframes handed to the PHY workers. 
+ * 
+ * push() is called by phch_recv for every synchronized subframe and only copies the 
+ * samples into a preallocated ring, it never blocks or takes a lock. A low priority 
+ * thread writes the ring to a memory-mapped file made of fixed-size, page-aligned records: 
+ * an iq_record_hdr_t followed by nof_samples complex float samples. 
+ * 
+ * Modes: 
+ *  - window:     keeps the last nof_sf subframes and writes them when the recorder is stopped
+ *  - trigger:    writes the window around each trigger (PDSCH CRC error, sync loss, RLF), 
+ *                half of it before and half after the event
+ *  - continuous: writes every subframe. Subframes are dropped if the file can not keep up 
+ */
+class iq_recorder : public thread
+{
+public:
+  
+  typedef enum {
+    MODE_NONE = 0, 
+    MODE_WINDOW, 
+    MODE_TRIGGER, 
+    MODE_CONTINUOUS
+  } mode_t; 
+  
+  typedef struct {
+    uint32_t magic; 
+    uint32_t tti; 
+    uint32_t nof_samples; 
+    uint32_t trigger;     // Non-zero if a trigger occurred in this subframe
+    uint64_t seq;         // Subframe sequence number. Gaps indicate dropped subframes
+  } iq_record_hdr_t; 
+  
+  const static uint32_t MAGIC = 0x49514331; // "IQC1"
+  
+  iq_recorder();
+  ~iq_recorder();
+  
+  static mode_t mode_from_string(std::string mode);
+  
+  bool init(std::string filename, mode_t mode, uint32_t nof_sf, uint32_t max_sf_len, srslte::log *log_h);
+  void stop();
+  bool is_enabled();
+  
+  /* Called from the synchronization thread only */
+  void push(uint32_t tti, cf_t *buffer, uint32_t nof_samples);
+  
+  /* Can be called from any thread */
+  void trigger(const char *reason);
+  
+private:
+  
+  const static int      WRITER_THREAD_PRIO = -1; // Normal (non real-time) priority
+  const static uint32_t CHUNK_RECORDS      = 64; 
+  
+  // States of trigger_pending. The window is written while CLAIMED and published as PENDING
+  const static uint32_t TRIGGER_IDLE       = 0; 
+  const static uint32_t TRIGGER_CLAIMED    = 1; 
+  const static uint32_t TRIGGER_PENDING    = 2; 
+  
+  typedef struct {
+    iq_record_hdr_t hdr; 
+    cf_t           *samples; 
+  } slot_t; 
+  
+  void run_thread();
+  void dump_window(uint64_t end);
+  bool write_slot(uint64_t idx, bool check_overwrite);
+  bool grow_file();
+  void close_file();
+  
+  srslte::log *log_h; 
+  mode_t       mode; 
+  bool         enabled; 
+  bool         running; 
+  std::string  filename; 
+  
+  slot_t      *slots; 
+  cf_t        *ring_buffer; 
+  uint32_t     nof_sf; 
+  uint32_t     max_sf_len; 
+  
+  // Written by push() only 
+  volatile uint64_t wr_idx; 
+  volatile uint32_t nof_dropped; 
+  
+  // Written by the writer thread only 
+  volatile uint64_t rd_idx; 
+  
+  // Set by trigger(), cleared by the writer thread
+  volatile uint32_t trigger_pending; 
+  volatile uint64_t trigger_end; 
+  volatile uint64_t trigger_seq; 
+  uint64_t          last_dump_end; 
+  uint32_t          nof_triggers; 
+  
+  // Output file 
+  int          fd; 
+  uint32_t     record_len; 
+  uint8_t     *chunk; 
+  uint64_t     chunk_offset; 
+  uint32_t     chunk_pos; 
+  uint64_t     file_len; 
+  uint64_t     nof_written; 
+};
+
+} // namespace srsue
+
+#endif // UEPHYIQRECORDER_H
@@ -0,0 +1,160 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef UEMACREPLAY_H
+#define UEMACREPLAY_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <string>
+#include "srslte/srslte.h"
+#include "common/log.h"
+#include "common/threads.h"
+#include "common/mac_interface.h"
+#include "common/phy_interface.h"
+#include "common/interfaces.h"
+#include "phy/mac_trace.h"
+
+namespace srsue {
+
+/* Replaces the PHY and the radio by a mac_trace file recorded with mac_recorder.
+ *
+ * The MAC and RRC are given the player as their PHY. Once the MAC starts synchronization,
+ * a thread calls the MAC and RRC in the recorded order: DL payloads are copied into the
+ * buffers the MAC hands out with each grant and values the MAC polls (PRACH and SR TTI,
+ * PHR, pathloss) are returned as recorded. TTIs are paced at 1 ms in real-time mode, or
+ * delivered as fast as the records can be read otherwise. In both modes the player waits for
+ * the MAC thread to run each TTI before going on with the next record.
+ *
+ * UL MAC PDUs generated during the replay are compared with the recorded ones, and calls
+ * whose outcome differs from the recording are counted as divergences.
+ */
+class mac_replay
+    : public phy_interface_mac
+    , public phy_interface_rrc
+    , public thread
+{
+public:
+
+  mac_replay();
+  ~mac_replay();
+
+  bool init(std::string filename, bool realtime, mac_interface_phy *mac, rrc_interface_phy *rrc, srslte::log *log_h);
+  void stop();
+  bool is_finished();
+
+  /* PHY interface for MAC */
+  void configure_prach_params();
+  void sync_start();
+  void sync_stop();
+  void prach_send(uint32_t preamble_idx, int allowed_subframe, float target_power_dbm);
+  int  prach_tx_tti();
+  void sr_send();
+  int  sr_last_tx_tti();
+  void set_timeadv_rar(uint32_t ta_cmd);
+  void set_timeadv(uint32_t ta_cmd);
+  void set_rar_grant(uint32_t tti, uint8_t grant_payload[SRSLTE_RAR_GRANT_LEN]);
+  void pdcch_ul_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start = -1, int tti_end = -1);
+  void pdcch_dl_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start = -1, int tti_end = -1);
+  void pdcch_ul_search_reset();
+  void pdcch_dl_search_reset();
+  void set_sps_rnti(uint16_t rnti);
+  void set_crnti(uint16_t rnti);
+  uint32_t get_current_tti();
+  float get_phr();
+  float get_pathloss_db();
+
+  /* PHY interface for RRC. The configuration is only stored */
+  void get_current_cell(srslte_cell_t *cell);
+  void get_config(phy_cfg_t *phy_cfg);
+  void set_config(phy_cfg_t *phy_cfg);
+  void set_config_dedicated(LIBLTE_RRC_PHYSICAL_CONFIG_DEDICATED_STRUCT *dedicated);
+  void set_config_common(phy_cfg_common_t *common);
+  void set_config_tdd(LIBLTE_RRC_TDD_CONFIG_STRUCT *tdd);
+  void set_config_sps_dl(LIBLTE_RRC_SPS_CONFIG_DL_STRUCT *sps_dl);
+  void set_config_64qam_en(bool enable);
+  void set_paging_occasion(uint32_t T, uint32_t pf_offset, uint32_t po_sf);
+  bool status_is_sync();
+  void iq_capture_trigger();
+  void configure_ul_params(bool pregen_disabled = false);
+  void reset();
+  void resync_sfn();
+
+private:
+
+  const static uint32_t MAX_RECORD_LEN = 0x10000;
+
+  void run_thread();
+  bool read_record();
+  void play_record();
+  void play_grant_ul();
+  void wait_tti();
+  void print_stats();
+
+  mac_interface_phy *mac;
+  rrc_interface_phy *rrc;
+  srslte::log       *log_h;
+
+  std::string        filename;
+  FILE              *f;
+  bool               realtime;
+  bool               started;
+  bool               running;
+  bool               finished;
+
+  mac_trace::record_hdr_t hdr;
+  uint8_t                 body[MAX_RECORD_LEN];
+
+  // Actions returned by the MAC for the DL grants, waiting for their TB
+  mac_interface_phy::tb_action_dl_t dl_action[mac_trace::MAX_RNTI_TYPES][mac_trace::MAX_PIDS];
+  mac_interface_phy::tb_action_dl_t pch_action;
+  uint32_t                          dl_len[mac_trace::MAX_RNTI_TYPES][mac_trace::MAX_PIDS];
+  uint32_t                          pch_len;
+
+  // PHY state seen by the MAC and RRC
+  volatile uint32_t  cur_tti;
+  volatile int32_t   prach_tti;
+  volatile int32_t   sr_tti;
+  volatile float     phr;
+  volatile float     pathloss;
+  srslte_cell_t      cell;
+  bool               cell_is_set;
+  phy_cfg_t          config;
+
+  // Statistics
+  struct timeval     start_time;
+  uint64_t           nof_records;
+  uint64_t           nof_ttis;
+  uint64_t           nof_dl_bytes;
+  uint64_t           nof_ul_bytes;
+  uint32_t           nof_ul_mismatch;
+  uint32_t           nof_diverged;
+};
+
+} // namespace srsue
+
+#endif // UEMACREPLAY_H
@@ -0,0 +1,250 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef UEMACTRACE_H
+#define UEMACTRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include "srslte/srslte.h"
+#include "common/log.h"
+#include "common/threads.h"
+#include "common/mac_interface.h"
+#include "common/phy_interface.h"
+#include "common/interfaces.h"
+
+namespace srsue {
+
+/* Binary trace of the PHY-MAC interface.
+ *
+ * The file starts with a file_hdr_t followed by one record per call: a record_hdr_t
+ * and len bytes of body. Integers are in host byte order. Grants are stored without the
+ * PHY grant, which the MAC only copies back to the PHY in the action.
+ *
+ * Bodies:
+ *  - NEW_GRANT_DL, SPS_GRANT_DL, SPS_GRANT_UL: grant_t
+ *  - NEW_GRANT_UL, NEW_GRANT_UL_ACK: grant_t and the new MAC PDU, if any
+ *  - HARQ_RECV:   none, only retransmissions follow a PHICH without grant
+ *  - TB_DECODED:  tb_decoded_t and the TB payload if it was decoded
+ *  - PCH_DECODED, BCH_DECODED: the payload
+ *  - SET_CELL:    srslte_cell_t
+ *  - PRACH_TX_TTI, SR_TX_TTI: int32_t, PHR, PATHLOSS: float. Written when the value
+ *    returned to the MAC changes
+ */
+class mac_trace
+{
+public:
+
+  const static uint32_t MAGIC   = 0x4d414331; // "MAC1"
+  const static uint32_t VERSION = 1;
+
+  typedef enum {
+    TTI_CLOCK = 1,
+    NEW_GRANT_DL,
+    TB_DECODED,
+    PCH_DECODED,
+    BCH_DECODED,
+    NEW_GRANT_UL,
+    NEW_GRANT_UL_ACK,
+    HARQ_RECV,
+    SPS_GRANT_DL,
+    SPS_GRANT_UL,
+    SET_CELL,
+    IN_SYNC,
+    OUT_OF_SYNC,
+    PRACH_TX_TTI,
+    SR_TX_TTI,
+    PHR,
+    PATHLOSS,
+    NOF_TYPES
+  } type_t;
+
+  const static uint8_t FLAG_ACK   = 0x1; // HARQ ACK or CRC ok
+  const static uint8_t FLAG_VALID = 0x2; // A SPS grant occurs in this TTI
+
+  typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t start_us;     // Wall clock time of the first record
+  } file_hdr_t;
+
+  typedef struct {
+    uint8_t  type;
+    uint8_t  flags;
+    uint16_t len;          // Bytes of body after the header
+    uint32_t tti;          // TTI of the grant, or current TTI
+  } record_hdr_t;
+
+  const static uint8_t GRANT_NDI          = 0x01;
+  const static uint8_t GRANT_LAST_NDI     = 0x02;
+  const static uint8_t GRANT_FROM_RAR     = 0x04;
+  const static uint8_t GRANT_SPS_RELEASE  = 0x08;
+  const static uint8_t GRANT_SPS_CONFIG   = 0x10;
+  const static uint8_t GRANT_CQI_REQUEST  = 0x20;
+
+  typedef struct {
+    uint32_t last_tti;
+    uint32_t n_bytes;
+    uint16_t rnti;
+    uint8_t  rnti_type;
+    uint8_t  pid;
+    int8_t   rv;
+    uint8_t  flags;
+    uint8_t  sps_n_pucch_idx;
+    uint8_t  reserved;
+  } grant_t;
+
+  typedef struct {
+    uint8_t  rnti_type;
+    uint8_t  pid;
+    uint16_t reserved;
+  } tb_decoded_t;
+
+  /* Grants are stored in the TTI field of the record header */
+  static void pack_grant(mac_interface_phy::mac_grant_t *grant, grant_t *g);
+  static void unpack_grant(grant_t *g, uint32_t tti, mac_interface_phy::mac_grant_t *grant);
+
+  static const char *type_to_string(uint8_t type);
+  
+  /* Length of the fixed part of the body of a record type */
+  static uint32_t min_body_len(uint8_t type);
+
+  const static uint32_t MAX_RNTI_TYPES = 8;
+  const static uint32_t MAX_PIDS       = 16;
+};
+
+/* Records the calls between PHY and MAC to a mac_trace file.
+ *
+ * Sits between both layers: the PHY is given the recorder as its MAC and RRC, the MAC is
+ * given the recorder as its PHY, and every call is forwarded. Records are appended to a
+ * memory buffer under a mutex by the calling thread, in the order the calls return, and a
+ * low priority thread writes the buffer to the file. Records are dropped, and the trace
+ * becomes unusable for replay, if the writer can not keep up with MAX_BUFFERED_BYTES.
+ */
+class mac_recorder
+    : public mac_interface_phy
+    , public rrc_interface_phy
+    , public phy_interface_mac
+    , public thread
+{
+public:
+
+  mac_recorder();
+  ~mac_recorder();
+
+  bool init(std::string filename, mac_interface_phy *mac, rrc_interface_phy *rrc, phy_interface_mac *phy, srslte::log *log_h);
+  void stop();
+
+  /* MAC interface for PHY */
+  void new_grant_ul(mac_grant_t grant, tb_action_ul_t *action);
+  void new_grant_ul_ack(mac_grant_t grant, bool ack, tb_action_ul_t *action);
+  void harq_recv(uint32_t tti, bool ack, tb_action_ul_t *action);
+  void new_grant_dl(mac_grant_t grant, tb_action_dl_t *action);
+  bool get_sps_grant_dl(uint32_t tti, mac_grant_t *grant);
+  bool get_sps_grant_ul(uint32_t tti, mac_grant_t *grant);
+  void tb_decoded(bool ack, srslte_rnti_type_t rnti_type, uint32_t harq_pid);
+  void bch_decoded_ok(uint8_t *payload, uint32_t len);
+  void set_cell(srslte_cell_t cell);
+  void pch_decoded_ok(uint32_t len);
+  void tti_clock(uint32_t tti);
+  void wait_tti_processed();
+
+  /* RRC interface for PHY */
+  void in_sync();
+  void out_of_sync();
+
+  /* PHY interface for MAC */
+  void configure_prach_params();
+  void sync_start();
+  void sync_stop();
+  void prach_send(uint32_t preamble_idx, int allowed_subframe, float target_power_dbm);
+  int  prach_tx_tti();
+  void sr_send();
+  int  sr_last_tx_tti();
+  void set_timeadv_rar(uint32_t ta_cmd);
+  void set_timeadv(uint32_t ta_cmd);
+  void set_rar_grant(uint32_t tti, uint8_t grant_payload[SRSLTE_RAR_GRANT_LEN]);
+  void pdcch_ul_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start = -1, int tti_end = -1);
+  void pdcch_dl_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start = -1, int tti_end = -1);
+  void pdcch_ul_search_reset();
+  void pdcch_dl_search_reset();
+  void set_sps_rnti(uint16_t rnti);
+  void set_crnti(uint16_t rnti);
+  uint32_t get_current_tti();
+  float get_phr();
+  float get_pathloss_db();
+
+private:
+
+  const static uint32_t MAX_BUFFERED_BYTES = 16*1024*1024;
+  const static uint32_t WRITE_PERIOD_US    = 10000;
+
+  void run_thread();
+  void write_buffer();
+  void record(uint8_t type, uint8_t flags, uint32_t tti,
+              void *body, uint32_t body_len, uint8_t *payload = NULL, uint32_t payload_len = 0);
+  void record_ul(uint8_t type, uint8_t flags, mac_grant_t *grant, tb_action_ul_t *action, uint32_t tti);
+  void record_value(uint8_t type, void *value, void *last, uint32_t len);
+
+  mac_interface_phy *mac;
+  rrc_interface_phy *rrc;
+  phy_interface_mac *phy;
+  srslte::log       *log_h;
+
+  bool               enabled;
+  bool               running;
+  std::string        filename;
+  FILE              *f;
+
+  pthread_mutex_t      mutex;
+  std::vector<uint8_t> buffer;      // Filled by the callers
+  std::vector<uint8_t> wr_buffer;   // Written by the writer thread
+  uint32_t             cur_tti;
+  uint64_t             nof_records;
+  uint64_t             nof_bytes;
+  uint32_t             nof_dropped;
+
+  // Payload buffers of the DL grants, filled by the PHY before tb_decoded()
+  typedef struct {
+    uint8_t *ptr;
+    uint32_t len;
+  } dl_buffer_t;
+  dl_buffer_t dl_buffer[mac_trace::MAX_RNTI_TYPES][mac_trace::MAX_PIDS];
+  uint8_t    *pch_payload;
+
+  // Last values returned by the PHY
+  int32_t  last_prach_tti;
+  int32_t  last_sr_tti;
+  float    last_phr;
+  float    last_pathloss;
+};
+
+} // namespace srsue
+
+#endif // UEMACTRACE_H
@@ -0,0 +1,92 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef UEPDCCHSS_H
+#define UEPDCCHSS_H
+
+#include <string.h>
+#include "srslte/srslte.h"
+
+namespace srsue {
+
+/* PDCCH search space of a C-RNTI (36.213 Section 9.1.1). The UE-specific candidates for the 
+ * 10 subframes and the 3 CFI values are computed once when the C-RNTI is set. Blind decoding 
+ * tries first the candidates with the aggregation level of the last DCI found and can look 
+ * for the DL and the UL DCI in a single pass over the candidates. The SPS C-RNTI shares the 
+ * candidates of the C-RNTI, it is checked against the same decoded CRC at no extra cost. 
+ */
+class pdcch_ss_table
+{
+public:
+  
+  typedef struct {
+    bool                  dl_found; 
+    bool                  ul_found; 
+    srslte_dci_msg_t      dl_msg; 
+    srslte_dci_msg_t      ul_msg; 
+    srslte_dci_location_t dl_loc; 
+    srslte_dci_location_t ul_loc; 
+    bool                  dl_sps; // DCI scrambled with the SPS C-RNTI 
+    bool                  ul_sps; 
+  } result_t; 
+  
+  pdcch_ss_table();
+  
+  bool     set_rnti(srslte_regs_t *regs, uint16_t rnti);
+  void     reset();
+  bool     is_set(uint16_t rnti);
+  
+  /* Blind search of the DCIs requested by find_dl and find_ul. Returns true if all of them were found. 
+   * A non-zero sps_rnti is accepted as well as the C-RNTI */
+  bool     search(srslte_pdcch_t *pdcch, uint32_t cfi, uint32_t sf_idx, uint32_t first_L, 
+                  bool find_dl, bool find_ul, result_t *result, uint16_t sps_rnti = 0);
+  
+  const static uint32_t MAX_CANDIDATES_UE     = 16; // 6 + 6 + 2 + 2 
+  const static uint32_t MAX_CANDIDATES_COMMON = 6;  // 4 + 2
+  
+private:
+  
+  typedef struct {
+    srslte_dci_location_t loc[MAX_CANDIDATES_UE]; 
+    uint32_t              nof_loc; 
+  } candidates_t; 
+  
+  bool is_rnti(uint16_t crc_rem);
+  bool decode(srslte_pdcch_t *pdcch, srslte_dci_location_t *loc, bool is_ue_ss, 
+              bool find_dl, bool find_ul, result_t *result);
+  bool search_space(srslte_pdcch_t *pdcch, candidates_t *ss, bool is_ue_ss, uint32_t first_L, 
+                    bool find_dl, bool find_ul, result_t *result);
+  
+  uint16_t     rnti; 
+  uint16_t     cur_sps_rnti; 
+  bool         is_init; 
+  candidates_t ue_ss[3][SRSLTE_NSUBFRAMES_X_FRAME]; 
+  candidates_t common_ss[3]; 
+};
+
+} // namespace srsue
+
+#endif // UEPDCCHSS_H
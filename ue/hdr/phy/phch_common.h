@@ -36,6 +36,9 @@
 #include "radio/radio.h"
 #include "common/log.h"
 #include "phy/phy_metrics.h"
+#include "phy/ul_rs_table.h"
+#include "phy/phy_config.h"
+#include "phy/iq_recorder.h"
 
 //#define CONTINUOUS_TX
 
@@ -46,12 +49,13 @@ namespace srsue {
   class phch_common {
   public:
     
-    /* Common variables used by all phy workers */
+    /* Common variables used by all phy workers. Workers read config through get_config() */
     phy_interface_rrc::phy_cfg_t *config; 
     phy_args_t                   *args; 
     srslte::log       *log_h;
     mac_interface_phy *mac;
     srslte_ue_ul_t     ue_ul; 
+    iq_recorder        iq_rec; 
     
     /* Power control variables */
     float pathloss;
@@ -82,6 +86,18 @@ namespace srsue {
     uint16_t           get_dl_rnti(uint32_t tti);
     srslte_rnti_type_t get_dl_rnti_type();
     
+    /* SPS C-RNTI, searched in the C-RNTI candidates. 0 if not configured */
+    void               set_sps_rnti(uint16_t rnti_value);
+    uint16_t           get_sps_rnti();
+    
+    /* P-RNTI is only searched in SFN mod T = pf_offset, subframe po_sf. T=0 disables paging DRX */
+    void               set_paging_occasion(uint32_t T, uint32_t pf_offset, uint32_t po_sf);
+    
+    /* Aggregation level of the last DCI found for the C-RNTI, tried first in the next search. It is 
+     * only a hint shared by all workers, so it is read and written atomically without ordering */
+    void               set_pdcch_last_L(uint32_t L);
+    uint32_t           get_pdcch_last_L();
+    
     void set_rar_grant(uint32_t tti, uint8_t grant_payload[SRSLTE_RAR_GRANT_LEN]);
     bool get_pending_rar(uint32_t tti, srslte_dci_rar_grant_t *rar_grant = NULL);
     
@@ -110,6 +126,20 @@ namespace srsue {
 
     void reset_ul();
     
+    /* Shared UL reference signal table. If the configuration changed, a new table is generated 
+     * in full and then replaces the current one */
+    void            set_ul_rs_cfg(srslte_cell_t cell, 
+                                  srslte_refsignal_dmrs_pusch_cfg_t *dmrs_cfg, 
+                                  srslte_pucch_cfg_t *pucch_cfg, 
+                                  srslte_refsignal_srs_cfg_t *srs_cfg);
+    ul_rs_table_ptr get_ul_rs_table();
+    
+    /* Publishes a new configuration snapshot built from config and args. The UL reference 
+     * signals are not pregenerated for snapshots published with pregen_disabled */
+    void            publish_config();
+    void            publish_config(bool pregen_disabled);
+    phy_config_ptr  get_config();
+    
   private: 
     
     std::vector<pthread_mutex_t>    tx_mutex; 
@@ -125,6 +155,12 @@ namespace srsue {
     srslte_rnti_type_t ul_rnti_type, dl_rnti_type; 
     int                ul_rnti_start, ul_rnti_end, dl_rnti_start, dl_rnti_end; 
     
+    uint16_t           sps_rnti; 
+    
+    uint32_t           paging_T, paging_pf_offset, paging_po_sf; 
+    
+    uint32_t           pdcch_last_L; 
+    
     float              time_adv_sec; 
     
     srslte_dci_rar_grant_t rar_grant; 
@@ -145,6 +181,14 @@ namespace srsue {
     uint32_t        max_mutex;
 
     srslte_cell_t   cell;
+    
+    ul_rs_table_ptr ul_rs; 
+    pthread_mutex_t ul_rs_mutex; 
+    
+    phy_config_ptr  cur_config; 
+    uint32_t        config_version; 
+    bool            config_pregen_disabled; 
+    pthread_mutex_t config_mutex; 
 
     dl_metrics_t    dl_metrics;
     uint32_t        dl_metrics_count;
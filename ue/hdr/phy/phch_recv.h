@@ -35,6 +35,7 @@
 #include "phy/prach.h"
 #include "phy/phch_worker.h"
 #include "phy/phch_common.h"
+#include "phy/cell_scanner.h"
 #include "common/interfaces.h"
 
 namespace srsue {
@@ -108,7 +109,30 @@ private:
   const static uint32_t SYNC_SFN_TIMEOUT = 5000;
   float ul_dl_factor;
   
+  // Parallel cell search over one capture per EARFCN 
+  const static uint32_t SCAN_NOF_HALF_FRAMES = 2*SRSLTE_DEFAULT_NOF_VALID_PSS_FRAMES; 
+  cell_scanner          scanner; 
+  bool                  parallel_search; 
+  std::vector<float>    scan_freq;   // DL frequency of each valid EARFCN to scan
+  
+  // Warm start from the last serving cell 
+  typedef struct {
+    uint32_t      magic; 
+    float         dl_freq; 
+    float         ul_freq; 
+    srslte_cell_t cell; 
+    float         cfo; 
+    float         gain; 
+  } cell_cache_t; 
+  const static uint32_t CELL_CACHE_MAGIC    = 0x43454c31; // "CEL1"
+  const static uint32_t WARM_START_TIMEOUT  = 1000; 
+  bool                  warm_start; 
+  bool                  warm_start_tried; 
+  
   bool          cell_search(int force_N_id_2 = -1);
+  bool          cell_scan(int force_N_id_2);
+  bool          cell_cache_load();
+  void          cell_cache_save();
   bool          init_cell();
   void          free_cell();
 };
@@ -33,6 +33,7 @@
 #include "common/phy_interface.h"
 #include "common/trace.h"
 #include "phy/phch_common.h"
+#include "phy/pdcch_ss_table.h"
 
 #define LOG_EXECTIME
 
@@ -55,7 +56,6 @@ public:
   void  set_cfo(float cfo);
   void  set_sample_offset(float sample_offset); 
   
-  void  set_ul_params(bool pregen_disabled = false);
   void  set_crnti(uint16_t rnti);
   void  enable_pregen_signals(bool enabled);
   
@@ -72,11 +72,14 @@ private:
 
   
   /* Internal methods */
+  void set_config(phy_config_ptr c);
   bool extract_fft_and_pdcch_llr(); 
   
   /* ... for DL */
   bool decode_pdcch_ul(mac_interface_phy::mac_grant_t *grant);
   bool decode_pdcch_dl(mac_interface_phy::mac_grant_t *grant);
+  bool decode_pdcch_dl_sps(srslte_dci_msg_t *dci_msg, mac_interface_phy::mac_grant_t *grant);
+  bool check_pdcch_ul_sps(srslte_dci_msg_t *dci_msg, bool *is_release);
   bool decode_phich(bool *ack); 
   bool decode_pdsch(srslte_ra_dl_grant_t *grant, uint8_t *payload, srslte_softbuffer_rx_t* softbuffer, int rv, uint16_t rnti, uint32_t pid);
 
@@ -105,6 +108,7 @@ private:
   
   /* Common objects */  
   phch_common    *phy;
+  phy_config_ptr  cfg; 
   srslte_cell_t  cell; 
   bool           cell_initiated; 
   cf_t          *signal_buffer; 
@@ -112,12 +116,20 @@ private:
   uint32_t       tx_tti;
   bool           pregen_enabled;
   uint32_t       last_dl_pdcch_ncce;
+  bool           sps_ack_pending;  // HARQ-ACK of a configured SPS assignment, sent in sps_n_pucch
+  uint32_t       sps_n_pucch; 
   bool           rnti_is_set; 
   
   /* Objects for DL */
   srslte_ue_dl_t ue_dl; 
   uint32_t       cfi; 
   uint16_t       dl_rnti;
+  uint16_t       crnti; 
+  
+  /* PDCCH search space of the C-RNTI */
+  pdcch_ss_table           pdcch_ss; 
+  pdcch_ss_table::result_t pdcch_res; 
+  bool                     pdcch_ul_searched; 
   
   /* Objects for UL */
   srslte_ue_ul_t     ue_ul; 
@@ -108,6 +108,7 @@ public:
   void    pdcch_dl_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start = -1, int tti_end = -1);
   void    pdcch_ul_search_reset();
   void    pdcch_dl_search_reset();
+  void    set_sps_rnti(uint16_t rnti);
 
   /* Get/Set PHY parameters interface from RRC */  
   void get_config(phy_cfg_t *phy_cfg); 
@@ -115,7 +116,10 @@ public:
   void set_config_dedicated(LIBLTE_RRC_PHYSICAL_CONFIG_DEDICATED_STRUCT *dedicated);
   void set_config_common(phy_cfg_common_t *common); 
   void set_config_tdd(LIBLTE_RRC_TDD_CONFIG_STRUCT *tdd); 
+  void set_config_sps_dl(LIBLTE_RRC_SPS_CONFIG_DL_STRUCT *sps_dl); 
   void set_config_64qam_en(bool enable);
+  void set_paging_occasion(uint32_t T, uint32_t pf_offset, uint32_t po_sf);
+  void iq_capture_trigger();
 
 
   float   get_phr();
@@ -0,0 +1,91 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef UEPHYCONFIG_H
+#define UEPHYCONFIG_H
+
+#include <string.h>
+#include <boost/shared_ptr.hpp>
+#include "srslte/srslte.h"
+#include "common/phy_interface.h"
+
+namespace srsue {
+
+/* Immutable snapshot of the PHY configuration shared by all PHY workers. 
+ * The RRC configuration and the PHY arguments are resolved once into the enums, 
+ * estimator filter and UL parameters used by the workers. A reconfiguration publishes 
+ * a new snapshot and each worker switches to it at the start of its next TTI. 
+ */
+class phy_config
+{
+public:
+  
+  typedef enum {
+    EQUALIZER_MMSE = 0, 
+    EQUALIZER_ZF
+  } equalizer_mode_t; 
+  
+  phy_config(uint32_t version, phy_interface_rrc::phy_cfg_t *config, phy_args_t *args, bool pregen_disabled);
+  
+  uint32_t                          version; 
+  bool                              pregen_disabled; // UL signals are generated per subframe, not from the shared table
+  phy_interface_rrc::phy_cfg_t      config; 
+  
+  /* DL channel estimation and equalization. filter_len < 0 keeps the srsLTE default filter */
+  srslte_chest_dl_noise_alg_t       noise_alg; 
+  equalizer_mode_t                  equalizer; 
+  int                               filter_len; 
+  float                             filter[3]; 
+  
+  /* UL parameters */
+  srslte_refsignal_dmrs_pusch_cfg_t dmrs_cfg; 
+  srslte_pusch_hopping_cfg_t        pusch_hopping; 
+  srslte_uci_cfg_t                  uci_cfg; 
+  srslte_pucch_cfg_t                pucch_cfg; 
+  srslte_pucch_sched_t              pucch_sched; 
+  srslte_refsignal_srs_cfg_t        srs_cfg; 
+  srslte_ue_ul_powerctrl_t          power_ctrl; 
+  srslte_cqi_periodic_cfg_t         period_cqi; 
+  uint32_t                          I_sr; 
+  
+  /* n1PUCCH-AN-Persistent, the HARQ-ACK resources of PDSCH without PDCCH. The TPC field of the 
+   * SPS activation selects one of them (36.213 Table 9.2-2) */
+  uint32_t                          sps_n_pucch_1[4]; 
+  uint32_t                          nof_sps_n_pucch_1; 
+  
+  static srslte_chest_dl_noise_alg_t noise_alg_from_string(std::string alg); 
+  static equalizer_mode_t            equalizer_from_string(std::string mode); 
+  
+private:
+  void set_dl_params(phy_args_t *args); 
+  void set_ul_params(); 
+};
+
+typedef boost::shared_ptr<const phy_config> phy_config_ptr; 
+
+} // namespace srsue
+
+#endif // UEPHYCONFIG_H
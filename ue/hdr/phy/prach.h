@@ -49,7 +49,12 @@ namespace srsue {
       signal_buffer     = NULL; 
       transmitted_tti   = 0; 
       target_power_dbm  = 0; 
+      preamble_buffer   = NULL; 
+      cache_cnt         = 0; 
+      bzero(cache, sizeof(cache));
+      bzero(&cur_cfg, sizeof(prach_cfg_t));
     }
+    ~prach();
     void           init(LIBLTE_RRC_PRACH_CONFIG_SIB_STRUCT *config, phy_args_t *args, srslte::log *log_h);
     bool           init_cell(srslte_cell_t cell);
     void           free_cell();
@@ -71,7 +76,6 @@ namespace srsue {
     int            allowed_subframe; 
     bool           initiated;   
     uint32_t       len; 
-    cf_t          *buffer[64]; 
     srslte_prach_t prach_obj; 
     int            transmitted_tti;
     srslte_cell_t  cell;
@@ -79,6 +83,34 @@ namespace srsue {
     srslte_cfo_t   cfo_h; 
     float target_power_dbm;
     
+    /* Preambles are generated on demand and kept in a small LRU cache, so that a 
+     * reselection back to a known cell or a contention-free preamble reuses the waveform */
+    typedef struct {
+      uint32_t root_seq; 
+      uint32_t config_idx; 
+      uint32_t zero_corr_zone; 
+      uint32_t freq_offset; 
+      bool     high_speed; 
+      uint32_t nof_prb; 
+    } prach_cfg_t; 
+    
+    typedef struct {
+      bool        valid; 
+      prach_cfg_t cfg; 
+      uint32_t    preamble; 
+      uint32_t    len; 
+      uint32_t    last_used; 
+      cf_t       *buffer; 
+    } preamble_cache_t; 
+    
+    static const uint32_t CACHE_SIZE = 8; 
+    preamble_cache_t cache[CACHE_SIZE];
+    uint32_t         cache_cnt; 
+    prach_cfg_t      cur_cfg; 
+    cf_t            *preamble_buffer; 
+    
+    void           get_cfg(prach_cfg_t *cfg);
+    cf_t*          get_preamble(uint32_t preamble_idx);
   };
 
 } // namespace srsue
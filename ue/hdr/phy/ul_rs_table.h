@@ -0,0 +1,86 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef UEULRSTABLE_H
+#define UEULRSTABLE_H
+
+#include <string.h>
+#include <boost/shared_ptr.hpp>
+#include "srslte/srslte.h"
+
+namespace srsue {
+
+/* Read-only table of UL reference signals (PUSCH DMRS and SRS) shared by all PHY workers. 
+ * All the sequences of the cell and UL RS configuration are generated in init(), after that 
+ * the table is immutable and workers read it without locking. A reconfiguration creates a new 
+ * table and the old one is freed when the last worker using it drops its reference. 
+ */
+class ul_rs_table
+{
+public:
+  ul_rs_table();
+  ~ul_rs_table();
+  
+  bool  init(srslte_cell_t cell, 
+             srslte_refsignal_dmrs_pusch_cfg_t *dmrs_cfg, 
+             srslte_pucch_cfg_t *pucch_cfg, 
+             srslte_refsignal_srs_cfg_t *srs_cfg);
+  bool  is_cfg(srslte_cell_t cell, 
+               srslte_refsignal_dmrs_pusch_cfg_t *dmrs_cfg, 
+               srslte_pucch_cfg_t *pucch_cfg, 
+               srslte_refsignal_srs_cfg_t *srs_cfg);
+  
+  cf_t* get_dmrs(uint32_t n_prb, uint32_t ncs, uint32_t sf_idx);
+  cf_t* get_srs(uint32_t sf_idx);
+  
+  /* Points the pregenerated signal tables of ue_ul to this table for the given grant. 
+   * The pointer arrays of ue_ul must have been allocated with alloc_ue_ul() */
+  bool  set_ue_ul(srslte_ue_ul_t *ue_ul, uint32_t n_prb, uint32_t ncs, uint32_t sf_idx);
+  
+  /* Allocate and free the per-worker pointer arrays of ue_ul that set_ue_ul() fills in */
+  static bool alloc_ue_ul(srslte_ue_ul_t *ue_ul);
+  static void free_ue_ul(srslte_ue_ul_t *ue_ul);
+  
+private:
+  bool  gen_dmrs();
+  bool  gen_srs();
+  
+  bool                              initiated; 
+  srslte_cell_t                     cell; 
+  srslte_refsignal_dmrs_pusch_cfg_t dmrs_cfg; 
+  srslte_pucch_cfg_t                pucch_cfg; 
+  srslte_refsignal_srs_cfg_t        srs_cfg; 
+  srslte_refsignal_ul_t             signals; 
+  
+  cf_t                             *dmrs[SRSLTE_NOF_CSHIFT][SRSLTE_NSUBFRAMES_X_FRAME][SRSLTE_MAX_PRB+1];
+  cf_t                             *srs[SRSLTE_NSUBFRAMES_X_FRAME];
+};
+
+typedef boost::shared_ptr<ul_rs_table> ul_rs_table_ptr; 
+
+} // namespace srsue
+
+#endif // UEULRSTABLE_H
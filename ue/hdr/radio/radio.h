@@ -29,6 +29,7 @@
 #include "srslte/srslte.h"
 #include "srslte/rf/rf.h"
 #include "common/trace.h"
+#include "radio/radio_file.h"
 
 #ifndef RADIO_H
 #define RADIO_H
@@ -55,7 +56,7 @@ namespace srslte {
       radio() : tr_local_time(1024*10), tr_usrp_time(1024*10), tr_tx_time(1024*10), tr_is_eob(1024*10) {
         bzero(&rf_device, sizeof(srslte_rf_t));
         bzero(&end_of_burst_time, sizeof(srslte_timestamp_t));
-        bzero(zeros, burst_preamble_max_samples*sizeof(cf_t));
+        bzero(zeros, burst_preamble_zeros_len*sizeof(cf_t));
         
         sf_len                  = 0;
         burst_preamble_sec      = 0; 
@@ -74,6 +75,7 @@ namespace srslte {
         tti                     = 0; 
         agc_enabled             = false; 
         offset                  = 0; 
+        is_file                 = false; 
         
       };
       
@@ -127,20 +129,27 @@ namespace srslte {
 
       void register_error_handler(srslte_rf_error_handler_t h);
       
+      /* Writes all received samples to a file that can be replayed with the "file" device */
+      bool start_record(const char *filename);
+      
     private:
       
       void save_trace(uint32_t is_eob, srslte_timestamp_t *usrp_time);
       
       srslte_rf_t rf_device; 
       
+      // File-backed device, used instead of rf_device when the device name is "file"
+      radio_file file; 
+      bool       is_file; 
       
       const static uint32_t burst_preamble_max_samples = 30720000;  // 30.72 MHz is maximum frequency
+      const static uint32_t burst_preamble_zeros_len   = 4096;      // Burst preamble is sent in chunks of this size
       double burst_preamble_sec;// Start of burst preamble time (off->on RF transition time)      
       srslte_timestamp_t end_of_burst_time; 
       bool is_start_of_burst; 
       uint32_t burst_preamble_samples; 
       double burst_preamble_time_rounded; // preamble time rounded to sample time
-      cf_t zeros[burst_preamble_max_samples]; 
+      cf_t zeros[burst_preamble_zeros_len]; 
       double cur_tx_srate;
 
       double   tx_adv_sec; // Transmission time advance to compensate for antenna->timestamp delay
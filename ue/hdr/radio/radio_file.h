@@ -0,0 +1,101 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "srslte/srslte.h"
+
+#ifndef RADIO_FILE_H
+#define RADIO_FILE_H
+
+namespace srslte {
+  
+/* File-backed RF frontend used by srslte::radio when the device name is "file". 
+ * 
+ * Samples are raw interleaved complex float (the format written by srslte_filesink 
+ * and by start_record()). The receive file is memory-mapped and streamed sequentially, 
+ * timestamps are derived from the number of samples read and the current RX sampling rate. 
+ * Transmitted samples are appended to the TX file or discarded if none is given. 
+ * 
+ * Device arguments are a comma-separated list of: 
+ *   rx_file=<path>   capture to replay (mandatory)
+ *   tx_file=<path>   file where transmitted samples are written (optional)
+ *   paced            deliver samples at the sampling rate instead of as fast as possible
+ *   loop             restart from the beginning of the capture at end of file 
+ */
+  class radio_file
+  {
+    public: 
+      radio_file();
+      ~radio_file();
+      
+      bool init(char *args);
+      void stop();
+      bool is_init();
+      
+      bool rx(void *buffer, uint32_t nof_samples, srslte_timestamp_t *rxd_time);
+      bool tx(void *buffer, uint32_t nof_samples, srslte_timestamp_t tx_time);
+      void get_time(srslte_timestamp_t *now);
+      
+      void set_rx_srate(double srate);
+      void set_tx_srate(double srate);
+      
+      /* Writes every received buffer to filename. Can be used with any RF device */
+      bool start_record(const char *filename);
+      void record(void *buffer, uint32_t nof_samples);
+      
+      const static uint32_t max_path_len = 256; 
+      
+    private: 
+      
+      void pace();
+      
+      bool      initiated; 
+      
+      char      rx_filename[max_path_len];
+      char      tx_filename[max_path_len];
+      int       rx_fd; 
+      cf_t     *rx_map; 
+      size_t    rx_map_len; 
+      uint64_t  rx_nof_samples; 
+      uint64_t  rx_pos; 
+      srslte_timestamp_t rx_time; // Time of the next sample to be delivered
+      
+      FILE     *tx_file; 
+      FILE     *rec_file; 
+      
+      double    rx_srate; 
+      double    tx_srate; 
+      bool      paced; 
+      bool      loop; 
+      bool      pace_started; 
+      struct timespec pace_start; 
+  };
+}
+
+#endif
@@ -39,6 +39,8 @@
 
 #include "radio/radio.h"
 #include "phy/phy.h"
+#include "phy/mac_trace.h"
+#include "phy/mac_replay.h"
 #include "mac/mac.h"
 #include "upper/rlc.h"
 #include "upper/pdcp.h"
@@ -69,6 +71,7 @@ typedef struct {
   std::string   device_args; 
   std::string   time_adv_nsamples; 
   std::string   burst_preamble; 
+  std::string   record_filename; 
 }rf_args_t;
 
 typedef struct {
@@ -80,6 +83,9 @@ typedef struct {
   bool          enable;
   std::string   phy_filename;
   std::string   radio_filename;
+  std::string   mac_record_filename;
+  std::string   mac_replay_filename;
+  bool          mac_replay_realtime;
 }trace_args_t;
 
 typedef struct {
@@ -150,6 +156,9 @@ public:
 
   void pregenerate_signals(bool enable);
   
+  // True once a MAC trace replay has reached the end of the file
+  bool replay_finished();
+  
   // Testing
   void test_con_restablishment(); 
   
@@ -161,6 +170,8 @@ private:
 
   srslte::radio radio;
   srsue::phy        phy;
+  srsue::mac_recorder mac_recorder;
+  srsue::mac_replay  mac_replay;
   srsue::mac        mac;
   srslte::mac_pcap   mac_pcap;
   srsue::rlc        rlc;
@@ -185,11 +196,13 @@ private:
 
   all_args_t       *args;
   bool              started;
+  bool              replaying;
   rf_metrics_t     rf_metrics;
 
   srslte::LOG_LEVEL_ENUM level(std::string l);
   
   bool check_srslte_version();
+  bool init_radio_phy(mac_interface_phy *mac_phy, rrc_interface_phy *rrc_phy);
 };
 
 } // namespace srsue
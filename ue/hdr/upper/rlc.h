@@ -34,6 +34,7 @@
 #include "common/msg_queue.h"
 #include "upper/rlc_entity.h"
 #include "upper/rlc_metrics.h"
+#include <boost/thread/mutex.hpp>
 
 namespace srsue {
 
@@ -47,6 +48,7 @@ class rlc
     :public rlc_interface_mac
     ,public rlc_interface_pdcp
     ,public rlc_interface_rrc
+    ,public srslte::timer_callback
 {
 public:
   rlc();
@@ -54,7 +56,8 @@ public:
             rrc_interface_rlc  *rrc_,
             ue_interface       *ue_,
             srslte::log        *rlc_log_, 
-            srslte::mac_interface_timers *mac_timers_);
+            srslte::mac_interface_timers *mac_timers_,
+            mac_interface_rlc  *mac_);
   void stop();
 
   void get_metrics(rlc_metrics_t &m);
@@ -67,6 +70,7 @@ public:
   uint32_t get_total_buffer_state(uint32_t lcid);
   int      read_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes);
   void     write_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes);
+  void     write_pdus(uint32_t lcid, pdu_iov_t *pdus, uint32_t nof_pdus);
   void     write_pdu_bcch_bch(uint8_t *payload, uint32_t nof_bytes);
   void     write_pdu_bcch_dlsch(uint8_t *payload, uint32_t nof_bytes);
   void     write_pdu_pcch(uint8_t *payload, uint32_t nof_bytes);
@@ -76,6 +80,9 @@ public:
   void add_bearer(uint32_t lcid);
   void add_bearer(uint32_t lcid, LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg);
 
+  // Timer callback
+  void timer_expired(uint32_t timer_id);
+
 private:
   void reset_metrics(); 
   
@@ -84,9 +91,21 @@ private:
   pdcp_interface_rlc *pdcp;
   rrc_interface_rlc  *rrc;
   srslte::mac_interface_timers *mac_timers; 
+  mac_interface_rlc  *mac;
   ue_interface       *ue;
   rlc_entity          rlc_array[SRSUE_N_RADIO_BEARERS];
 
+  // Buffer state seen by MAC. Writers update it with the entity state after every queue change
+  // and notify MAC when it grows. Stored with release and loaded with acquire semantics
+  uint32_t            buffer_state[SRSUE_N_RADIO_BEARERS];
+  boost::mutex        buffer_state_mutex[SRSUE_N_RADIO_BEARERS];
+  void                update_buffer_state(uint32_t lcid);
+
+  // AM timers change the buffer state without a call into the RLC. Each AM bearer has a MAC
+  // timer that wakes up update_buffer_state() when the next of them expires
+  uint32_t            buffer_state_timer_id[SRSUE_N_RADIO_BEARERS];
+  bool                has_buffer_state_timer[SRSUE_N_RADIO_BEARERS];
+
   long                ul_tput_bytes[SRSUE_N_RADIO_BEARERS];
   long                dl_tput_bytes[SRSUE_N_RADIO_BEARERS];
   bpt::ptime          metrics_time;
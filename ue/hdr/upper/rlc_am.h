@@ -35,9 +35,6 @@
 #include "common/timeout.h"
 #include "upper/rlc_common.h"
 #include <boost/thread/mutex.hpp>
-#include <map>
-#include <deque>
-#include <list>
 
 using srslte::byte_buffer_t; 
 
@@ -45,13 +42,35 @@ namespace srsue {
 
 
 
+#define RLC_AM_MAX_RX_INTERVALS  16
+#define RLC_AM_MAX_RX_STATUS     4
+
 struct rlc_amd_rx_pdu_t{
   rlc_amd_pdu_header_t  header;
   byte_buffer_t         *buf;
 };
 
+struct rlc_amd_so_interval_t{
+  uint32_t  so_start;
+  uint32_t  so_end;
+};
+
+// PDU being received in segments. Each segment is written at its SO in buf and the received
+// SO ranges are kept sorted and merged. Until the PDU is complete, header.li holds the SDU
+// boundaries as offsets from the start of the PDU
 struct rlc_amd_rx_pdu_segments_t{
-  std::list<rlc_amd_rx_pdu_t> segments;
+  rlc_amd_pdu_header_t   header;
+  byte_buffer_t         *buf;
+  uint32_t               len;           // PDU length, known once the last segment is received
+  uint32_t               nof_intervals;
+  rlc_amd_so_interval_t  intervals[RLC_AM_MAX_RX_INTERVALS];
+};
+
+struct rlc_amd_retx_t{
+  uint32_t  sn;
+  bool      is_segment;
+  uint32_t  so_start;
+  uint32_t  so_end;
 };
 
 struct rlc_amd_tx_pdu_t{
@@ -59,13 +78,76 @@ struct rlc_amd_tx_pdu_t{
   byte_buffer_t        *buf;
   uint32_t              retx_count;
   bool                  is_acked;
+
+  // Pending retx. PDUs in the retx queue are linked by SN through their tx window slots
+  bool                  in_retx_queue;
+  rlc_amd_retx_t        retx;
+  uint16_t              retx_prev;
+  uint16_t              retx_next;
 };
 
-struct rlc_amd_retx_t{
-  uint32_t  sn;
-  bool      is_segment;
-  uint32_t  so_start;
-  uint32_t  so_end;
+/****************************************************************************
+ * Fixed size window of PDUs, indexed by SN modulo the window size.
+ * Slots are allocated once in init() and a bitmap keeps which SNs are in
+ * the window, so PDUs are added and removed without allocations.
+ ***************************************************************************/
+template<class T>
+class rlc_am_window
+{
+public:
+  rlc_am_window() : slots(NULL) { clear(); }
+  ~rlc_am_window() { delete [] slots; }
+
+  void init()
+  {
+    if(!slots)
+      slots = new T[RLC_AM_WINDOW_SIZE];
+  }
+  void clear()
+  {
+    memset(used, 0, sizeof(used));
+    count = 0;
+  }
+
+  bool has(uint32_t sn)
+  {
+    uint32_t i = sn%RLC_AM_WINDOW_SIZE;
+    return ((used[i/32] >> (i%32)) & 1) && sns[i] == sn;
+  }
+  T& operator[](uint32_t sn)
+  {
+    return slots[sn%RLC_AM_WINDOW_SIZE];
+  }
+  T& add(uint32_t sn)
+  {
+    uint32_t i = sn%RLC_AM_WINDOW_SIZE;
+    if(!((used[i/32] >> (i%32)) & 1))
+      count++;
+    used[i/32] |= (1u << (i%32));
+    sns[i]      = sn;
+    return slots[i];
+  }
+  void remove(uint32_t sn)
+  {
+    if(has(sn)) {
+      uint32_t i = sn%RLC_AM_WINDOW_SIZE;
+      used[i/32] &= ~(1u << (i%32));
+      count--;
+    }
+  }
+  uint32_t size()
+  {
+    return count;
+  }
+
+private:
+  rlc_am_window(const rlc_am_window&);
+  rlc_am_window& operator=(const rlc_am_window&);
+
+  T        *slots;
+  uint16_t  sns[RLC_AM_WINDOW_SIZE];
+  uint32_t  used[RLC_AM_WINDOW_SIZE/32];
+  uint32_t  count;
 };
 
 
@@ -94,6 +176,8 @@ public:
   uint32_t get_total_buffer_state(); 
   int      read_pdu(uint8_t *payload, uint32_t nof_bytes);
   void     write_pdu(uint8_t *payload, uint32_t nof_bytes);
+  void     write_pdus(rlc_interface_mac::pdu_iov_t *pdus, uint32_t nof_pdus);
+  int32_t  msec_to_timer_expiry();
 
 private:
 
@@ -111,20 +195,39 @@ private:
   rlc_amd_tx_pdu_t tx_pdu_segments;
 
   // Tx and Rx windows
-  std::map<uint32_t, rlc_amd_tx_pdu_t>          tx_window;
-  std::deque<rlc_amd_retx_t>                    retx_queue;
-  std::map<uint32_t, rlc_amd_rx_pdu_t>          rx_window;
-  std::map<uint32_t, rlc_amd_rx_pdu_segments_t> rx_segments;
+  rlc_am_window<rlc_amd_tx_pdu_t>           tx_window;
+  rlc_am_window<rlc_amd_rx_pdu_t>           rx_window;
+  rlc_am_window<rlc_amd_rx_pdu_segments_t>  rx_segments;
+
+  // Retx queue, linked through the tx_window slots
+  static const uint16_t retx_none = 0xFFFF;
+  uint16_t            retx_head;
+  uint16_t            retx_tail;
 
   // RX SDU buffers
   byte_buffer_t *rx_sdu;
 
-  // Mutexes
-  boost::mutex        mutex;
+  // Headers of the PDU being built or parsed, reused so their LI storage is allocated only
+  // once. tx_header is used with the tx_mutex locked, rx_header with the rx_mutex locked
+  rlc_amd_pdu_header_t tx_header;
+  rlc_amd_pdu_header_t rx_header;
+
+  // Mutexes. TX and RX state are locked separately, never both at once. The status
+  // handoff has its own mutex, taken last and held only to copy the handoff
+  boost::mutex        tx_mutex;
+  boost::mutex        rx_mutex;
+  boost::mutex        status_mutex;
 
   bool                poll_received;
   bool                do_status;
-  rlc_status_pdu_t    status;
+  bool                rx_pending;  // Data PDUs written to rx_window since the last reassembly
+  uint32_t            status_nack_bits; // Size of the NACKs for SNs in [vr_r, vr_ms)
+
+  // Status handoff. The RX side publishes the size of its pending status report and the
+  // TX side picks up the status PDUs received from the peer when it next builds a PDU
+  uint32_t            status_len;
+  byte_buffer_t      *rx_status[RLC_AM_MAX_RX_STATUS];
+  uint32_t            nof_rx_status;
 
   /****************************************************************************
    * Configurable parameters
@@ -167,39 +270,57 @@ private:
    * Timers
    * Ref: 3GPP TS 36.322 v10.0.0 Section 7
    ***************************************************************************/
-  timeout poll_retx_timeout;
-  timeout reordering_timeout;
-  timeout status_prohibit_timeout;
+  timeout poll_retx_timeout;        // TX side
+  timeout reordering_timeout;       // RX side
+  timeout status_prohibit_timeout;  // Status handoff
 
   static const int reordering_timeout_id = 1;
 
   // Timer checks
   bool status_prohibited();
   bool poll_retx();
+  void check_poll_retx();
   void check_reordering_timeout();
 
   // Helpers
   bool poll_required();
 
-  int  prepare_status();
+  uint32_t nack_bits(uint32_t sn);
+  uint32_t nack_bits(uint32_t sn_start, uint32_t sn_end);
+  int  status_length();
+  void update_status_handoff();
+  uint32_t status_due();
+  int  read_status_pdu(uint8_t *payload, uint32_t nof_bytes);
+  void queue_rx_status(uint8_t *payload, uint32_t nof_bytes);
+  void handle_rx_status();
   int  build_status_pdu(uint8_t *payload, uint32_t nof_bytes);
   int  build_retx_pdu(uint8_t *payload, uint32_t nof_bytes);
   int  build_segment(uint8_t *payload, uint32_t nof_bytes, rlc_amd_retx_t retx);
   int  build_data_pdu(uint8_t *payload, uint32_t nof_bytes);
+  int  build_pdu(uint8_t *payload, uint32_t nof_bytes);
 
-  void handle_data_pdu(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_header_t header);
-  void handle_data_pdu_segment(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_header_t header);
+  void handle_pdu(uint8_t *payload, uint32_t nof_bytes);
+  void handle_data_pdu(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_header_t &header);
+  void handle_data_pdu_segment(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_header_t &header);
+  void add_rx_pdu(byte_buffer_t *buf, rlc_amd_pdu_header_t &header);
   void handle_control_pdu(uint8_t *payload, uint32_t nof_bytes);
 
   void reassemble_rx_sdus();
+  void update_rx_window();
 
   bool inside_tx_window(uint16_t sn);
   bool inside_rx_window(uint16_t sn);
   void debug_state();
 
-  bool add_segment_and_check(rlc_amd_rx_pdu_segments_t *pdu, rlc_amd_rx_pdu_t *segment);
+  bool add_segment_and_check(rlc_amd_rx_pdu_segments_t *pdu, uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_header_t *header);
+  uint32_t build_segment_header(rlc_amd_tx_pdu_t *pdu, uint32_t so_start, uint32_t so_end, uint32_t nof_bytes, rlc_amd_pdu_header_t *header);
   int  required_buffer_size(rlc_amd_retx_t retx);
-  bool retx_queue_has_sn(uint32_t sn);
+
+  bool            retx_empty();
+  rlc_amd_retx_t& retx_front();
+  void            retx_push_back(rlc_amd_retx_t retx);
+  void            retx_pop_front();
+  void            retx_remove(uint32_t sn);
 };
 
 /****************************************************************************
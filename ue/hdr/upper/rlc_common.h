@@ -27,6 +27,8 @@
 #ifndef RLC_COMMON_H
 #define RLC_COMMON_H
 
+#include <vector>
+
 namespace srsue {
 
 /****************************************************************************
@@ -36,6 +38,15 @@ namespace srsue {
 
 #define RLC_AM_WINDOW_SIZE  512
 
+// Copies of SDU and PDU bytes done by the entities. Benchmarks build the entities with
+// RLC_COUNT_COPIES to add the copied bytes to rlc_copied_bytes, which they define
+#ifdef RLC_COUNT_COPIES
+extern uint64_t rlc_copied_bytes;
+#define rlc_memcpy(dst, src, n) (rlc_copied_bytes += (n), memcpy((dst), (src), (n)))
+#else
+#define rlc_memcpy(dst, src, n) memcpy((dst), (src), (n))
+#endif
+
 typedef enum{
   RLC_MODE_TM = 0,
   RLC_MODE_UM,
@@ -83,7 +94,9 @@ typedef struct{
   uint16_t          li[RLC_AM_WINDOW_SIZE]; // Array of length indicators
 }rlc_umd_pdu_header_t;
 
-// AMD PDU Header
+// AMD PDU Header. The LIs are kept out of the struct, in storage that only grows: the headers
+// stored in the AM windows hold as many LIs as their PDUs carried and reusing a header does not
+// allocate once it has held that many
 struct rlc_amd_pdu_header_t{
   rlc_dc_field_t dc;                      // Data or control
   uint8_t        rf;                      // Resegmentation flag
@@ -92,8 +105,8 @@ struct rlc_amd_pdu_header_t{
   uint16_t       sn;                      // Sequence number
   uint8_t        lsf;                     // Last segment flag
   uint16_t       so;                      // Segment offset
-  uint32_t       N_li;                    // Number of length indicators
-  uint16_t       li[RLC_AM_WINDOW_SIZE];  // Array of length indicators
+  uint32_t              N_li;             // Number of length indicators
+  std::vector<uint16_t> li;               // Length indicators, the first N_li are valid
 
   rlc_amd_pdu_header_t(){
     dc = RLC_DC_FIELD_CONTROL_PDU;
@@ -104,8 +117,6 @@ struct rlc_amd_pdu_header_t{
     lsf = 0; 
     so = 0; 
     N_li=0;
-    for(int i=0;i<RLC_AM_WINDOW_SIZE;i++)
-      li[i] = 0;
   }
   rlc_amd_pdu_header_t(const rlc_amd_pdu_header_t& h)
   {
@@ -126,9 +137,17 @@ struct rlc_amd_pdu_header_t{
     lsf  = h.lsf;
     so   = h.so;
     N_li = h.N_li;
-    for(int i=0;i<h.N_li;i++)
+    if(li.size() < N_li)
+      li.resize(N_li);
+    for(uint32_t i=0;i<N_li;i++)
       li[i] = h.li[i];
   }
+  void add_li(uint16_t len)
+  {
+    if(li.size() <= N_li)
+      li.resize(N_li+1);
+    li[N_li++] = len;
+  }
 };
 
 // NACK helper
@@ -177,6 +196,17 @@ public:
   virtual uint32_t get_total_buffer_state() = 0;
   virtual int      read_pdu(uint8_t *payload, uint32_t nof_bytes) = 0;
   virtual void     write_pdu(uint8_t *payload, uint32_t nof_bytes) = 0;
+
+  // Milliseconds until a timer that changes the buffer state expires, or -1 if none is running
+  virtual int32_t msec_to_timer_expiry() { return -1; }
+
+  // Burst version of write_pdu(). Entities override it to process the burst at once
+  virtual void write_pdus(rlc_interface_mac::pdu_iov_t *pdus, uint32_t nof_pdus)
+  {
+    for(uint32_t i=0;i<nof_pdus;i++) {
+      write_pdu(pdus[i].payload, pdus[i].nof_bytes);
+    }
+  }
 };
 
 } // namespace srsue
@@ -69,6 +69,8 @@ public:
   uint32_t get_total_buffer_state();
   int      read_pdu(uint8_t *payload, uint32_t nof_bytes);
   void     write_pdu(uint8_t *payload, uint32_t nof_bytes);
+  void     write_pdus(rlc_interface_mac::pdu_iov_t *pdus, uint32_t nof_pdus);
+  int32_t  msec_to_timer_expiry();
 
 private:
   rlc_tm tm;
@@ -71,6 +71,7 @@ public:
   uint32_t get_total_buffer_state();
   int      read_pdu(uint8_t *payload, uint32_t nof_bytes);
   void     write_pdu(uint8_t *payload, uint32_t nof_bytes);
+  void     write_pdus(rlc_interface_mac::pdu_iov_t *pdus, uint32_t nof_pdus);
 
   // Timeout callback interface
   void timer_expired(uint32_t timeout_id);
@@ -99,9 +100,11 @@ private:
   // RX SDU buffers
   srslte::byte_buffer_t      *rx_sdu;
   uint32_t            vr_ur_in_rx_sdu;
+  bool                rx_pending;  // PDUs written to rx_window since the last reassembly
 
-  // Mutexes
-  boost::mutex        mutex;
+  // Mutexes. TX and RX state are locked separately, never both at once
+  boost::mutex        tx_mutex;
+  boost::mutex        rx_mutex;
 
   /****************************************************************************
    * Configurable parameters
@@ -136,6 +139,7 @@ private:
   int  build_data_pdu(uint8_t *payload, uint32_t nof_bytes);
   void handle_data_pdu(uint8_t *payload, uint32_t nof_bytes);
   void reassemble_rx_sdus();
+  void update_rx_window();
   bool inside_reordering_window(uint16_t sn);
   void debug_state();
 };
@@ -83,6 +83,9 @@ public:
   rrc_state_t get_state();
   
   void enable_capabilities();
+  
+  /* Caches SIB2 in filename and reuses it while systemInfoValueTag in SIB1 does not change */
+  void set_si_cache(std::string filename);
 
   // Timeout callback interface
   void timer_expired(uint32_t timeout_id);
@@ -126,7 +129,26 @@ private:
   LIBLTE_RRC_DL_CCCH_MSG_STRUCT                         dl_ccch_msg;
   LIBLTE_RRC_DL_DCCH_MSG_STRUCT                         dl_dcch_msg;
 
-  pthread_t             sib_search_thread;
+  // SI acquisition state. Bit n of si_pending is set while SI message n is scheduled 
+  const static uint32_t SIB1_MAX_WINDOWS = 150; 
+  const static uint32_t SI_MAX_WINDOWS   = 4; 
+  const static uint64_t SIB2_SI_MASK     = 2;  // SIB2 is in the first SI message
+  boost::mutex          si_mutex; 
+  uint64_t              si_pending; 
+  bool                  sib2_received; 
+  
+  // SI cache for warm start 
+  typedef struct {
+    uint32_t magic; 
+    uint32_t cell_id; 
+    uint32_t value_tag; 
+    uint32_t sib2_len; 
+    uint8_t  sib2_pdu[512]; 
+  } si_cache_t; 
+  const static uint32_t SI_CACHE_MAGIC = 0x53494331; // "SIC1"
+  std::string           si_cache_file; 
+  si_cache_t            si_cache; 
+  bool                  si_cache_valid; 
 
   // RRC constants and timers 
   srslte::mac_interface_timers *mac_timers;
@@ -147,6 +169,7 @@ private:
   // MAC interface
   void release_pucch_srs();
   void ra_problem(); 
+  void si_acquired(uint32_t si_id, bool success);
 
   // GW interface
   bool rrc_connected();
@@ -180,10 +203,13 @@ private:
   // Helpers
   void          rrc_connection_release();
   void          radio_link_failure(); 
-  static void*  start_sib_thread(void *rrc_);
-  void          sib_search();
-  uint32_t      sib_start_tti(uint32_t tti, uint32_t period, uint32_t x);
+  void          sib1_acquire();
+  void          sib2_complete();
   void          apply_sib2_configs();
+  void          handle_sib2(LIBLTE_RRC_SYS_INFO_BLOCK_TYPE_2_STRUCT *sib2_);
+  bool          si_cache_load();
+  void          si_cache_save(uint8_t *sib2_pdu, uint32_t len);
+  void          apply_paging_drx();
   void          handle_con_setup(LIBLTE_RRC_CONNECTION_SETUP_STRUCT *setup);
   void          handle_con_reest(LIBLTE_RRC_CONNECTION_REESTABLISHMENT_STRUCT *setup);
   void          handle_rrc_con_reconfig(uint32_t lcid, LIBLTE_RRC_CONNECTION_RECONFIGURATION_STRUCT *reconfig, byte_buffer_t *pdu);
@@ -193,6 +219,7 @@ private:
   void          apply_rr_config_dedicated(LIBLTE_RRC_RR_CONFIG_DEDICATED_STRUCT *cnfg);
   void          apply_phy_config_dedicated(LIBLTE_RRC_PHYSICAL_CONFIG_DEDICATED_STRUCT *phy_cnfg, bool apply_defaults); 
   void          apply_mac_config_dedicated(LIBLTE_RRC_MAC_MAIN_CONFIG_STRUCT *mac_cfg, bool apply_defaults); 
+  void          apply_sps_config(LIBLTE_RRC_SPS_CONFIG_STRUCT *sps_cnfg);
   
   // Helpers for setting default values 
   void          set_phy_default_pucch_srs();
@@ -91,24 +91,34 @@ void sch_subh::fprint(FILE* stream)
   }
 }
 
-void sch_pdu::parse_packet(uint8_t *ptr)
+bool sch_pdu::parse_packet(uint8_t *ptr)
 {
 
-  pdu::parse_packet(ptr);
+  if (!pdu::parse_packet(ptr)) {
+    return false; 
+  }
 
   // Correct size for last SDU 
-  if (nof_subheaders > 0) {
-    uint32_t read_len = 0; 
-    for (int i=0;i<nof_subheaders-1;i++) {
-      read_len += subheaders[i].size_plus_header();
-    }
+  uint32_t read_len = 0; 
+  for (int i=0;i<nof_subheaders-1;i++) {
+    read_len += subheaders[i].size_plus_header();
+  }
 
-    if (pdu_len-read_len-1 >= 0) {
-      subheaders[nof_subheaders-1].set_payload_size(pdu_len-read_len-1);
-    } else {
-      fprintf(stderr,"Reading MAC PDU: negative payload for last subheader\n");
-    }
+  if (read_len + 1 <= pdu_len) {
+    subheaders[nof_subheaders-1].set_payload_size(pdu_len-read_len-1);
+  } else {
+    nof_subheaders = 0; 
+    return false; 
   }
+  return true; 
+}
+
+void sch_pdu::init_tx(uint8_t *payload, uint32_t pdu_len_bytes, bool is_ulsch)
+{
+  pdu::init_tx(payload, pdu_len_bytes, is_ulsch);
+  nof_ce         = 0; 
+  ce_payload_len = 0; 
+  sdu_header_len = 0; 
 }
 
 uint8_t* sch_pdu::write_packet() {
@@ -151,22 +161,19 @@ uint8_t* sch_pdu::write_packet(srslte::log *log_h)
     rem_len = 0;  
   }
   
-  /* Determine the header size and CE payload size */
-  uint32_t header_sz     = 0; 
-  uint32_t ce_payload_sz = 0; 
-  for (int i=0;i<nof_subheaders;i++) {
-    header_sz += subheaders[i].get_header_size(!multibyte_padding && i==last_sdu_idx);
-    if (!subheaders[i].is_sdu()) {
-      ce_payload_sz += subheaders[i].get_payload_size();
-    }
+  /* Header size and CE payload size are accumulated as subheaders are added */
+  uint32_t header_sz     = nof_ce + sdu_header_len; 
+  uint32_t ce_payload_sz = ce_payload_len; 
+  if (!multibyte_padding && !ce_only) {
+    header_sz -= sch_pdu::size_header_sdu(subheaders[last_sdu_idx].get_payload_size())-1; 
   }
   if (multibyte_padding) {
     header_sz += 1; 
   } else if (onetwo_padding) {
     header_sz += onetwo_padding;
   }
-  if (ce_payload_sz + header_sz >= sdu_offset_start) {
-    fprintf(stderr, "Writting PDU: header sz + ce_payload_sz >= sdu_offset_start (%d>=%d). pdu_len=%d, total_sdu_len=%d\n", 
+  if (ce_payload_sz + header_sz > sdu_offset_start) {
+    fprintf(stderr, "Writting PDU: header sz + ce_payload_sz > sdu_offset_start (%d>%d). pdu_len=%d, total_sdu_len=%d\n", 
             header_sz + ce_payload_sz, sdu_offset_start, pdu_len, total_sdu_len);
     return NULL; 
   }
@@ -282,7 +289,9 @@ bool sch_pdu::has_space_ce(uint32_t nbytes)
 bool sch_pdu::update_space_ce(uint32_t nbytes)
 {
   if (has_space_ce(nbytes)) {
-    rem_len      -= nbytes + 1; 
+    rem_len        -= nbytes + 1; 
+    nof_ce++; 
+    ce_payload_len += nbytes; 
     return true; 
   } else {
     return false; 
@@ -303,6 +312,7 @@ bool sch_pdu::update_space_sdu(uint32_t nbytes)
     } else {
       rem_len      -= (nbytes+1 + (size_header_sdu(subheaders[last_sdu_idx].get_payload_size())-1));
     }
+    sdu_header_len += size_header_sdu(nbytes); 
     last_sdu_idx = cur_idx;
     return true;
   } else {
@@ -328,15 +338,6 @@ void sch_subh::init()
   payload         = NULL;
 }
 
-sch_subh::cetype sch_subh::ce_type()
-{
-  if (lcid >= PHR_REPORT) {
-    return (cetype) lcid;
-  } else {
-    return SDU;
-  }
-}
-
 void sch_subh::set_payload_size(uint32_t size) {
   nof_bytes = size; 
 }
@@ -380,10 +381,6 @@ uint32_t sch_subh::sizeof_ce(uint32_t lcid, bool is_ul)
   }
   return 0;
 }
-bool sch_subh::is_sdu()
-{
-  return ce_type() == SDU;
-}
 uint16_t sch_subh::get_c_rnti()
 {
   if (payload) {
@@ -607,28 +604,6 @@ int sch_subh::set_sdu(uint32_t lcid_, uint32_t nof_bytes_, uint8_t *payload)
 }
 
 
-// Section 6.2.1
-void sch_subh::write_subheader(uint8_t** ptr, bool is_last)
-{
-  *(*ptr)   = (uint8_t) (is_last?0:(1<<5)) | ((uint8_t) lcid & 0x1f);
-  *ptr += 1;
-  if (is_sdu()) {
-    // MAC SDU: R/R/E/LCID/F/L subheader
-    // 2nd and 3rd octet
-    if (!is_last) {
-      if (nof_bytes >= 128) {
-        *(*ptr) = (uint8_t) 1<<7 | ((nof_bytes & 0x7f00) >> 8);
-        *ptr += 1;
-        *(*ptr) = (uint8_t) (nof_bytes & 0xff);
-        *ptr += 1;
-      } else {
-       *(*ptr) = (uint8_t) (nof_bytes & 0x7f); 
-       *ptr += 1;
-     }      
-    }
-  } 
-}
-
 void sch_subh::write_payload(uint8_t** ptr)
 {
   if (is_sdu()) {
@@ -640,6 +615,21 @@ void sch_subh::write_payload(uint8_t** ptr)
   *ptr += nof_bytes;
 }
 
+/* Size of the subheader at ptr, reading at most the nof_bytes (at least 1) left in the PDU. 
+ * An SDU subheader with the F/L field takes 2 or 3 bytes depending on the F bit */
+uint32_t sch_subh::peek_header_size(uint8_t *ptr, uint32_t nof_bytes)
+{
+  bool    e_bit  = (ptr[0] & 0x20)?true:false;
+  uint8_t lcid_  = ptr[0] & 0x1f;
+  if (lcid_ < PHR_REPORT && e_bit) {
+    if (nof_bytes < 2) {
+      return 2; 
+    }
+    return (ptr[1] & 0x80)?3:2; 
+  }
+  return 1; 
+}
+
 bool sch_subh::read_subheader(uint8_t** ptr)
 {
   // Skip R
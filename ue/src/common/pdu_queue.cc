@@ -30,6 +30,8 @@
 #define Info(fmt, ...)    log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
 #define Debug(fmt, ...)   log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
 
+#include <strings.h>
+
 #include "common/pdu_queue.h"
 
 
@@ -110,24 +112,45 @@ bool pdu_queue::process_pdus()
     return false; 
   }
 
-  bool have_data = false; 
-  for (int i=0;i<NOF_HARQ_PID;i++) {
-    uint8_t *buff = NULL;
-    uint32_t len  = 0; 
-    uint32_t cnt  = 0; 
-    do {
-      buff = (uint8_t*) pdu_q[i].pop(&len);
-      if (buff) {
-        if (callback) {
-          callback->process_pdu(buff, len);
+  bool     have_data = false; 
+  uint8_t *buff[MAX_BATCH_PDUS]; 
+  uint32_t len[MAX_BATCH_PDUS]; 
+  uint32_t cnt[NOF_HARQ_PID]; 
+  uint32_t nof_pdus; 
+  bzero(cnt, sizeof(cnt));
+  
+  do {
+    // Collect the pending PDUs of all PIDs without releasing their buffers 
+    uint32_t nof_pid[NOF_HARQ_PID]; 
+    nof_pdus = 0; 
+    for (int i=0;i<NOF_HARQ_PID;i++) {
+      nof_pid[i] = 0; 
+      while (nof_pdus < MAX_BATCH_PDUS) {
+        buff[nof_pdus] = (uint8_t*) pdu_q[i].pop(&len[nof_pdus], nof_pid[i]);
+        if (!buff[nof_pdus]) {
+          break; 
+        }
+        nof_pid[i]++;
+        nof_pdus++;
+      }
+    }
+    if (nof_pdus > 0) {
+      if (callback) {
+        callback->process_pdus(buff, len, nof_pdus);
+      }
+      for (int i=0;i<NOF_HARQ_PID;i++) {
+        for (uint32_t j=0;j<nof_pid[i];j++) {
+          pdu_q[i].release();
         }
-        pdu_q[i].release();
-        cnt++;
-        have_data = true;
+        cnt[i] += nof_pid[i]; 
       }
-    } while(buff);
-    if (cnt > 20) {
-      log_h->console("Warning dispatched %d packets for PID=%d\n", cnt, i);
+      have_data = true; 
+    }
+  } while (nof_pdus == MAX_BATCH_PDUS);
+  
+  for (int i=0;i<NOF_HARQ_PID;i++) {
+    if (cnt[i] > 20) {
+      log_h->console("Warning dispatched %d packets for PID=%d\n", cnt[i], i);
     }
   }
   return have_data; 
@@ -38,6 +38,8 @@ namespace srsue {
     
 demux::demux() : mac_msg(20), pending_mac_msg(20)
 {
+  nof_batch_sdus = 0; 
+  bzero(nof_batch_lcid_sdus, sizeof(nof_batch_lcid_sdus));
 }
 
 void demux::init(phy_interface_mac* phy_h_, rlc_interface_mac *rlc_, srslte::log* log_h_, srslte::timers* timers_db_)
@@ -86,7 +88,9 @@ void demux::push_pdu_temp_crnti(uint32_t pid, uint8_t *buff, uint32_t nof_bytes)
     if (nof_bytes > 0) {
       // Unpack DLSCH MAC PDU 
       pending_mac_msg.init_rx(nof_bytes);
-      pending_mac_msg.parse_packet(buff);
+      if (!pending_mac_msg.parse_packet(buff)) {
+        Warning("Discarding malformed MAC PDU with Temporal C-RNTI (%d bytes)\n", nof_bytes);
+      }
       
       // Look for Contention Resolution UE ID 
       is_uecrid_successful = false; 
@@ -140,13 +144,80 @@ void demux::process_pdu(uint8_t *mac_pdu, uint32_t nof_bytes)
 {
   // Unpack DLSCH MAC PDU 
   mac_msg.init_rx(nof_bytes);
-  mac_msg.parse_packet(mac_pdu);
+  if (!mac_msg.parse_packet(mac_pdu)) {
+    Warning("Discarding malformed MAC PDU (%d bytes)\n", nof_bytes);
+    return; 
+  }
 
   process_sch_pdu(&mac_msg);
   //srslte_vec_fprint_byte(stdout, mac_pdu, nof_bytes);
   Debug("MAC PDU processed\n");
 }
 
+/* Parses the subheaders of all PDUs and processes their MAC CE in PDU order. Then delivers 
+ * the SDUs with one RLC call per logical channel, keeping the reception order within it. 
+ */
+void demux::process_pdus(uint8_t **mac_pdu, uint32_t *nof_bytes, uint32_t nof_pdus)
+{
+  nof_batch_sdus = 0; 
+  bzero(nof_batch_lcid_sdus, sizeof(nof_batch_lcid_sdus));
+  
+  for (uint32_t i=0;i<nof_pdus;i++) {
+    mac_msg.init_rx(nof_bytes[i]);
+    if (!mac_msg.parse_packet(mac_pdu[i])) {
+      Warning("Discarding malformed MAC PDU (%d bytes)\n", nof_bytes[i]);
+      continue; 
+    }
+    while(mac_msg.next()) {
+      srslte::sch_subh *subh = mac_msg.get(); 
+      if (subh->is_sdu()) {
+        uint32_t lcid = subh->get_sdu_lcid(); 
+        if (lcid < MAX_SDU_LCID) {
+          if (nof_batch_sdus == MAX_BATCH_SDUS) {
+            deliver_batch();
+          }
+          batch_sdus[nof_batch_sdus].lcid      = lcid; 
+          batch_sdus[nof_batch_sdus].payload   = subh->get_sdu_ptr(); 
+          batch_sdus[nof_batch_sdus].nof_bytes = subh->get_payload_size(); 
+          nof_batch_lcid_sdus[lcid]++;
+          nof_batch_sdus++;
+        } else {
+          rlc->write_pdu(lcid, subh->get_sdu_ptr(), subh->get_payload_size());
+        }
+      } else {
+        // Process MAC Control Element
+        if (!process_ce(subh)) {
+          Warning("Received Subheader with invalid or unkonwn LCID\n");
+        }
+      }
+    }
+  }
+  
+  deliver_batch();
+  Debug("%d MAC PDUs processed\n", nof_pdus);
+}
+
+/* Delivers the SDUs collected so far with one RLC call per logical channel and empties the batch */
+void demux::deliver_batch()
+{
+  for (uint32_t lcid=0;lcid<MAX_SDU_LCID;lcid++) {
+    if (nof_batch_lcid_sdus[lcid] > 0) {
+      uint32_t n = 0; 
+      for (uint32_t j=0;j<nof_batch_sdus && n<nof_batch_lcid_sdus[lcid];j++) {
+        if (batch_sdus[j].lcid == lcid) {
+          batch_iov[n].payload   = batch_sdus[j].payload; 
+          batch_iov[n].nof_bytes = batch_sdus[j].nof_bytes; 
+          n++;
+        }
+      }
+      Debug("Delivering %d PDUs for lcid=%d\n", n, lcid);
+      rlc->write_pdus(lcid, batch_iov, n);
+    }
+  }
+  nof_batch_sdus = 0; 
+  bzero(nof_batch_lcid_sdus, sizeof(nof_batch_lcid_sdus));
+}
+
 void demux::process_sch_pdu(srslte::sch_pdu *pdu_msg)
 {  
   while(pdu_msg->next()) {
@@ -69,6 +69,26 @@ void dl_harq_entity::start_pcap(srslte::mac_pcap* pcap_)
   pcap = pcap_; 
 }
 
+/* Maximum number of DL-SCH TB bits received within a TTI, 36.306 Table 4.1-1 */
+static const uint32_t ue_category_max_tbs[5] = {10296, 51024, 75376, 75376, 149776}; 
+
+bool dl_harq_entity::set_nof_prb(uint32_t nof_prb)
+{
+  // Largest PRB allocation whose TB at the highest MCS fits in the UE category 
+  uint32_t max_tbs = ue_category_max_tbs[(SRSUE_UE_CATEGORY-1)%5]; 
+  uint32_t n_prb   = SRSLTE_MIN(nof_prb, SRSLTE_MAX_PRB); 
+  while (n_prb > INIT_NOF_PRB && (uint32_t) srslte_ra_tbs_from_idx(26, n_prb) > max_tbs) {
+    n_prb--; 
+  }
+  Info("Sizing DL HARQ soft buffers for %d PRB (cell %d PRB, UE category %d)\n", n_prb, nof_prb, SRSUE_UE_CATEGORY);
+  for (uint32_t i=0;i<NOF_HARQ_PROC+1;i++) {
+    if (!proc[i].resize(n_prb)) {
+      return false; 
+    }
+  }
+  return true; 
+}
+
 void dl_harq_entity::reset()
 {
   for (uint32_t i=0;i<NOF_HARQ_PROC+1;i++) {
@@ -77,8 +97,19 @@ void dl_harq_entity::reset()
   dl_sps_assig.clear();
 }
 
-uint32_t dl_harq_entity::get_harq_sps_pid(uint32_t tti) {
-  return 0;
+void dl_harq_entity::set_sps_config(LIBLTE_RRC_SPS_CONFIG_DL_STRUCT *sps_cfg)
+{
+  dl_sps_assig.set_config(sps_cfg);
+}
+
+bool dl_harq_entity::sps_enabled()
+{
+  return dl_sps_assig.is_enabled();
+}
+
+bool dl_harq_entity::get_sps_grant(uint32_t tti, mac_interface_phy::mac_grant_t *grant)
+{
+  return dl_sps_assig.get_pending_grant(tti, grant);
 }
 
 void dl_harq_entity::new_grant_dl(mac_interface_phy::mac_grant_t grant, mac_interface_phy::tb_action_dl_t* action)
@@ -102,24 +133,34 @@ void dl_harq_entity::new_grant_dl(mac_interface_phy::mac_grant_t grant, mac_inte
       Info("Set NDI=1 for C-RNTI DL grant\n");
     }
     proc[harq_pid].new_grant_dl(grant, action);
+  } else if (grant.is_sps_configured) {
+    /* Configured assignment: the HARQ process was derived from the TTI by dl_sps and NDI is considered toggled */
+    uint32_t harq_pid = grant.pid%NOF_HARQ_PROC; 
+    grant.ndi = false; 
+    proc[harq_pid].new_grant_dl(grant, action);
   } else {
-    /* This is for SPS scheduling */
-    uint32_t harq_pid = get_harq_sps_pid(grant.tti)%NOF_HARQ_PROC; 
+    /* PDCCH for the SPS C-RNTI */
     if (grant.ndi) {
+      // Retransmission of a configured assignment, NDI is considered not toggled 
       grant.ndi = false; 
-      proc[harq_pid].new_grant_dl(grant, action);
+      proc[grant.pid%NOF_HARQ_PROC].new_grant_dl(grant, action);
     } else {
-      if (grant.is_sps_release) {
+      bzero(action, sizeof(mac_interface_phy::tb_action_dl_t));
+      if (!dl_sps_assig.is_enabled()) {
+        Warning("SPS: DL activation/release received but SPS is not configured\n");
+      } else if (grant.is_sps_release) {
+        Info("SPS: DL assignment released\n");
         dl_sps_assig.clear();
+        // The release PDCCH is acknowledged on PUCCH (36.213 Section 10.1)
         if (timers_db->get(mac::TIME_ALIGNMENT)->is_running()) {
-          //phy_h->send_sps_ack();
-          Warning("PHY Send SPS ACK not implemented\n");
+          action->default_ack  = true; 
+          action->generate_ack = true; 
         }
       } else {
-        Error("SPS not implemented\n");
-        //dl_sps_assig.reset(grant.tti, grant);
-        //grant.ndi = true;
-        //procs[harq_pid].save_grant();
+        Info("SPS: DL assignment activated at tti=%d, tbs=%d\n", grant.tti, grant.n_bytes);
+        // The first configured assignment occurs in this subframe. The PHY gets it with get_sps_grant(), 
+        // so that the HARQ process derived from the TTI is the one the PHY reports in tb_decoded()
+        dl_sps_assig.reset(grant.tti, &grant);
       }
     }
   }
@@ -164,6 +205,7 @@ float dl_harq_entity::get_average_retx()
           
 dl_harq_entity::dl_harq_process::dl_harq_process() {
   is_initiated = false; 
+  softbuffer_nof_prb = 0; 
   ack = false; 
   bzero(&cur_grant, sizeof(mac_interface_phy::mac_grant_t));
 }  
@@ -178,11 +220,12 @@ void dl_harq_entity::dl_harq_process::reset() {
 }
 
 bool dl_harq_entity::dl_harq_process::init(uint32_t pid_, dl_harq_entity *parent) {
-  if (srslte_softbuffer_rx_init(&softbuffer, 110)) {
+  if (srslte_softbuffer_rx_init(&softbuffer, INIT_NOF_PRB)) {
     Error("Error initiating soft buffer\n");
     return false; 
   } else {
     pid = pid_;
+    softbuffer_nof_prb = INIT_NOF_PRB; 
     is_initiated = true; 
     harq_entity = parent; 
     log_h = harq_entity->log_h; 
@@ -190,22 +233,42 @@ bool dl_harq_entity::dl_harq_process::init(uint32_t pid_, dl_harq_entity *parent
   }     
 }
 
+bool dl_harq_entity::dl_harq_process::resize(uint32_t nof_prb) {
+  if (!is_initiated) {
+    return false; 
+  }
+  if (nof_prb == softbuffer_nof_prb) {
+    srslte_softbuffer_rx_reset(&softbuffer);
+    return true; 
+  }
+  srslte_softbuffer_rx_free(&softbuffer);
+  if (srslte_softbuffer_rx_init(&softbuffer, nof_prb)) {
+    Error("Error initiating soft buffer\n");
+    is_initiated = false; 
+    return false; 
+  }
+  softbuffer_nof_prb = nof_prb; 
+  return true; 
+}
+
 bool dl_harq_entity::dl_harq_process::is_sps()
 {
-  return false; 
+  return cur_grant.rnti_type == SRSLTE_RNTI_SPS; 
 }                                                            
 
 bool dl_harq_entity::dl_harq_process::calc_is_new_transmission(mac_interface_phy::mac_grant_t grant) {
   
   bool is_new_tb = true; 
   if (srslte_tti_interval(grant.tti, cur_grant.tti) <= 8 && grant.n_bytes == cur_grant.n_bytes ||
-      pid == HARQ_BCCH_PID) 
+      pid == HARQ_BCCH_PID                                                                   ||
+      (grant.rnti_type == SRSLTE_RNTI_SPS && !grant.is_sps_configured))  // SPS retx from PDCCH
   {
     is_new_tb = false; 
   }
   
   if ((grant.ndi != cur_grant.ndi && !is_new_tb) || // NDI toggled for same TB
       is_new_tb                                  || // is new TB
+      grant.is_sps_configured                    || // Configured SPS assignment, NDI considered toggled
       (pid == HARQ_BCCH_PID && grant.rv == 0))      // Broadcast PID and 1st TX (RV=0)
   {
     is_new_transmission = true; 
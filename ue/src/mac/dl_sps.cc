@@ -0,0 +1,110 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <strings.h>
+
+#include "mac/dl_sps.h"
+
+namespace srsue {
+
+dl_sps::dl_sps()
+{
+  pthread_mutex_init(&mutex, NULL);
+  enabled       = false; 
+  interval      = 0; 
+  nof_procs     = 1; 
+  is_configured = false; 
+  start_tti     = 0; 
+  bzero(&cur_grant, sizeof(mac_interface_phy::mac_grant_t));
+}
+
+void dl_sps::set_config(LIBLTE_RRC_SPS_CONFIG_DL_STRUCT *cfg)
+{
+  pthread_mutex_lock(&mutex);
+  is_configured = false; 
+  if (cfg && cfg->setup_present && liblte_rrc_sps_interval_dl_num[cfg->sps_interval_dl%LIBLTE_RRC_SPS_INTERVAL_DL_N_ITEMS] > 0) {
+    enabled   = true; 
+    interval  = liblte_rrc_sps_interval_dl_num[cfg->sps_interval_dl%LIBLTE_RRC_SPS_INTERVAL_DL_N_ITEMS]; 
+    nof_procs = SRSLTE_MAX(1, cfg->N_sps_processes); 
+  } else {
+    enabled   = false; 
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+bool dl_sps::is_enabled()
+{
+  return enabled; 
+}
+
+void dl_sps::clear()
+{
+  pthread_mutex_lock(&mutex);
+  is_configured = false; 
+  pthread_mutex_unlock(&mutex);
+}
+
+/* Stores the assignment of the activation PDCCH, the Nth assignment occurs in the subframe 
+ * (10*SFN + subframe) = [(10*SFN_start + subframe_start) + N*interval] mod 10240 */
+void dl_sps::reset(uint32_t tti, mac_interface_phy::mac_grant_t *grant)
+{
+  pthread_mutex_lock(&mutex);
+  if (enabled) {
+    memcpy(&cur_grant, grant, sizeof(mac_interface_phy::mac_grant_t));
+    start_tti     = tti%10240; 
+    is_configured = true; 
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+bool dl_sps::get_pending_grant(uint32_t tti, mac_interface_phy::mac_grant_t *grant)
+{
+  bool ret = false; 
+  pthread_mutex_lock(&mutex);
+  if (enabled && is_configured && srslte_tti_interval(tti%10240, start_tti)%interval == 0) {
+    memcpy(grant, &cur_grant, sizeof(mac_interface_phy::mac_grant_t));
+    grant->tti               = tti; 
+    grant->pid               = get_harq_pid(tti); 
+    grant->rv                = 0; 
+    grant->is_sps_release    = false; 
+    grant->is_sps_configured = true; 
+    ret = true; 
+  }
+  pthread_mutex_unlock(&mutex);
+  return ret; 
+}
+
+/* HARQ Process ID = [floor(CURRENT_TTI/semiPersistSchedIntervalDL)] modulo numberOfConfSPS-Processes */
+uint32_t dl_sps::get_harq_pid(uint32_t tti)
+{
+  if (!interval) {
+    return 0; 
+  }
+  return ((tti%10240)/interval)%nof_procs; 
+}
+
+} // namespace srsue
@@ -48,6 +48,11 @@ mac::mac() : ttisync(10240),
   started = false;  
   pcap    = NULL;   
   signals_pregenerated = false; 
+  tti_synced         = false; 
+  nof_clocked_ttis   = 0; 
+  nof_processed_ttis = 0; 
+  pthread_mutex_init(&tti_mutex, NULL);
+  pthread_cond_init(&tti_cond, NULL);
 }
   
 bool mac::init(phy_interface_mac *phy, rlc_interface_mac *rlc, rrc_interface_mac *rrc, srslte::log *log_h_)
@@ -72,6 +77,7 @@ bool mac::init(phy_interface_mac *phy, rlc_interface_mac *rlc, rrc_interface_mac
   sr_procedure.init (phy_h, rrc,   log_h,          &config);
   ul_harq.init      (              log_h, &uernti, &config, &timers_db, &mux_unit);
   dl_harq.init      (              log_h,          &config, &timers_db, &demux_unit);
+  si_procedure.init (this,  rrc,   log_h);
 
   reset();
   
@@ -84,7 +90,10 @@ bool mac::init(phy_interface_mac *phy, rlc_interface_mac *rlc, rrc_interface_mac
 
 void mac::stop()
 {
+  pthread_mutex_lock(&tti_mutex);
   started = false;   
+  pthread_cond_broadcast(&tti_cond);
+  pthread_mutex_unlock(&tti_mutex);
   ttisync.increase();
   upper_timers_thread.stop();
   pdu_process_thread.stop();
@@ -124,10 +133,14 @@ void mac::reset()
   sr_procedure.reset();
   bsr_procedure.reset();
   phr_procedure.reset();
+  si_procedure.reset();
   
   dl_harq.reset();
+  dl_harq.set_sps_config(NULL);
+  ul_harq.set_sps_config(NULL);
   phy_h->pdcch_dl_search_reset();
   phy_h->pdcch_ul_search_reset();
+  phy_h->set_sps_rnti(0);
   
   signals_pregenerated = false; 
   is_first_ul_grant = true;   
@@ -144,7 +157,13 @@ void mac::run_thread() {
     usleep(50000);
   }
   Debug("Setting ttysync to %d\n", phy_h->get_current_tti());
+  // TTIs clocked before this point are not run 
+  pthread_mutex_lock(&tti_mutex);
   ttisync.set_producer_cntr(phy_h->get_current_tti());
+  nof_processed_ttis = nof_clocked_ttis; 
+  tti_synced = true; 
+  pthread_cond_broadcast(&tti_cond);
+  pthread_mutex_unlock(&tti_mutex);
      
   while(started) {
 
@@ -156,6 +175,7 @@ void mac::run_thread() {
       log_h->step(tti);
         
       // Step all procedures 
+      si_procedure.step(tti, !ra_procedure.in_progress());
       bsr_procedure.step(tti);
       phr_procedure.step(tti);
       
@@ -185,12 +205,17 @@ void mac::run_thread() {
         
         // Pregenerate UL signals and C-RNTI scrambling sequences
         Debug("Pre-computing C-RNTI scrambling sequences for C-RNTI=0x%x\n", uernti.crnti);
-        ((phy*) phy_h)->set_crnti(uernti.crnti);
+        phy_h->set_crnti(uernti.crnti);
         signals_pregenerated = true; 
       }
       
       timers_db.step_all();          
     }
+    
+    pthread_mutex_lock(&tti_mutex);
+    nof_processed_ttis++; 
+    pthread_cond_broadcast(&tti_cond);
+    pthread_mutex_unlock(&tti_mutex);
   }  
 }
 
@@ -210,9 +235,28 @@ void mac::bcch_start_rx(int si_window_start, int si_window_length)
   Info("SCHED: Searching for DL grant for SI-RNTI window_st=%d, window_len=%d\n", si_window_start, si_window_length);  
 }
 
+void mac::si_acquire(uint32_t si_id, uint32_t period, uint32_t offset, uint32_t win_len, uint32_t max_windows)
+{
+  si_procedure.acquire(si_id, period, offset, win_len, max_windows);
+}
+
+void mac::si_acquire_stop()
+{
+  si_procedure.stop();
+}
+
 void mac::bcch_stop_rx()
 {
-  phy_h->pdcch_dl_search_reset();
+  if (ra_procedure.in_progress()) {
+    // The DL search belongs to random access 
+    return; 
+  }
+  if (signals_pregenerated) {
+    // SI windows interrupt the C-RNTI search while connected, resume it
+    phy_h->pdcch_dl_search(SRSLTE_RNTI_USER, uernti.crnti);
+  } else {
+    phy_h->pdcch_dl_search_reset();
+  }
 }
 
 void mac::pcch_start_rx()
@@ -229,10 +273,23 @@ void mac::pcch_stop_rx()
 
 void mac::tti_clock(uint32_t tti)
 {
+  pthread_mutex_lock(&tti_mutex);
+  nof_clocked_ttis++; 
   ttisync.increase();
+  pthread_mutex_unlock(&tti_mutex);
   upper_timers_thread.tti_clock();
 }
 
+/* Before the MAC thread synchronizes with the PHY clocked TTIs are dropped, there is nothing to wait for */
+void mac::wait_tti_processed()
+{
+  pthread_mutex_lock(&tti_mutex);
+  while(started && tti_synced && nof_processed_ttis != nof_clocked_ttis) {
+    pthread_cond_wait(&tti_cond, &tti_mutex);
+  }
+  pthread_mutex_unlock(&tti_mutex);
+}
+
 void mac::bch_decoded_ok(uint8_t* payload, uint32_t len)
 {
   // Send MIB to RLC 
@@ -243,6 +300,14 @@ void mac::bch_decoded_ok(uint8_t* payload, uint32_t len)
   }
 }
 
+void mac::set_cell(srslte_cell_t cell)
+{
+  // Size the DL soft buffers for the new bandwidth 
+  if (!dl_harq.set_nof_prb(cell.nof_prb)) {
+    Error("Resizing DL HARQ soft buffers for %d PRB\n", cell.nof_prb);
+  }
+}
+
 void mac::pch_decoded_ok(uint32_t len)
 {
   // Send PCH payload to RLC 
@@ -261,6 +326,9 @@ void mac::tb_decoded(bool ack, srslte_rnti_type_t rnti_type, uint32_t harq_pid)
     }
   } else {
     dl_harq.tb_decoded(ack, rnti_type, harq_pid);
+    if (rnti_type == SRSLTE_RNTI_SI) {
+      si_procedure.tb_decoded(ack);
+    }
     if (ack) {
       pdu_process_thread.notify();
       metrics.rx_brate += dl_harq.get_current_tbs(harq_pid);
@@ -298,6 +366,16 @@ void mac::new_grant_dl(mac_interface_phy::mac_grant_t grant, mac_interface_phy::
   }
 }
 
+bool mac::get_sps_grant_dl(uint32_t tti, mac_interface_phy::mac_grant_t* grant)
+{
+  return dl_harq.get_sps_grant(tti, grant);
+}
+
+bool mac::get_sps_grant_ul(uint32_t tti, mac_interface_phy::mac_grant_t* grant)
+{
+  return ul_harq.get_sps_grant(tti, grant);
+}
+
 uint32_t mac::get_current_tti()
 {
   return phy_h->get_current_tti();
@@ -416,6 +494,25 @@ void mac::set_config_sr(LIBLTE_RRC_SCHEDULING_REQUEST_CONFIG_STRUCT* sr_cfg)
   memcpy(&config.sr, sr_cfg, sizeof(LIBLTE_RRC_SCHEDULING_REQUEST_CONFIG_STRUCT));
 }
 
+/* Semi-persistent scheduling (Section 5.10). A DL or UL configuration without setup releases it */
+void mac::set_config_sps(LIBLTE_RRC_SPS_CONFIG_STRUCT* sps_cfg)
+{
+  if (sps_cfg->sps_c_rnti_present) {
+    uernti.sps_rnti = sps_cfg->sps_c_rnti; 
+  }
+  if (sps_cfg->sps_cnfg_dl_present) {
+    dl_harq.set_sps_config(&sps_cfg->sps_cnfg_dl);
+  }
+  if (sps_cfg->sps_cnfg_ul_present) {
+    ul_harq.set_sps_config(&sps_cfg->sps_cnfg_ul);
+  }
+  // The SPS C-RNTI is only monitored while SPS is set up in any direction 
+  bool enabled = dl_harq.sps_enabled() || ul_harq.sps_enabled(); 
+  phy_h->set_sps_rnti(enabled?uernti.sps_rnti:0);
+  Info("Set SPS config: SPS C-RNTI=0x%x, DL %s, UL %s\n", uernti.sps_rnti, 
+       dl_harq.sps_enabled()?"enabled":"disabled", ul_harq.sps_enabled()?"enabled":"disabled");
+}
+
 void mac::setup_lcid(uint32_t lcid, uint32_t lcg, uint32_t priority, int PBR_x_tti, uint32_t BSD)
 {
   Info("Logical Channel Setup: LCID=%d, LCG=%d, priority=%d, PBR=%d, BSd=%d\n", 
@@ -425,6 +522,16 @@ void mac::setup_lcid(uint32_t lcid, uint32_t lcg, uint32_t priority, int PBR_x_t
   bsr_procedure.set_priority(lcid, priority);
 }
 
+/* Called by RLC (any thread). Without a UL grant the SR is signalled to the PHY from here 
+ * rather than in the next MAC TTI */
+void mac::notify_ul_data(uint32_t lcid)
+{
+  if (bsr_procedure.new_data(lcid, phy_h->get_current_tti())) {
+    Debug("Starting SR procedure by BSR request on new data\n");
+    sr_procedure.start();
+  }
+}
+
 uint32_t mac::get_unique_id()
 {
   return upper_timers_thread.get_unique_id();
@@ -504,42 +611,36 @@ void mac::upper_timers::tti_clock()
 mac::pdu_process::pdu_process(demux *demux_unit_)
 {
   demux_unit = demux_unit_;
-  pthread_mutex_init(&mutex, NULL);
-  pthread_cond_init(&cvar, NULL);
+  sem_init(&sem, 0, 0);
   have_data = false; 
   start(MAC_PDU_THREAD_PRIO);  
 }
 
 void mac::pdu_process::stop()
 {
-  pthread_mutex_lock(&mutex);
   running = false; 
-  pthread_cond_signal(&cvar);
-  pthread_mutex_unlock(&mutex);
+  sem_post(&sem);
   
   wait_thread_finish();
 }
 
+/* Called by the PHY workers. Only the first call after the thread wakes up posts the semaphore */
 void mac::pdu_process::notify()
 {
-  pthread_mutex_lock(&mutex);
-  have_data = true; 
-  pthread_cond_signal(&cvar);
-  pthread_mutex_unlock(&mutex);
+  if (__sync_bool_compare_and_swap(&have_data, false, true)) {
+    sem_post(&sem);
+  }
 }
 
 void mac::pdu_process::run_thread()
 {
   running = true; 
   while(running) {
-    have_data = demux_unit->process_pdus();
-    if (!have_data) {
-      pthread_mutex_lock(&mutex);
-      while(!have_data && running) {
-        pthread_cond_wait(&cvar, &mutex);
-      }
-      pthread_mutex_unlock(&mutex);
-    }
+    sem_wait(&sem);
+    // Clear the flag before draining so that PDUs pushed from now on post again 
+    have_data = false; 
+    __sync_synchronize();
+    while(demux_unit->process_pdus());
   }
 }
 
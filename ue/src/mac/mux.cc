@@ -35,7 +35,7 @@
 
 namespace srsue {
 
-mux::mux() : pdu_msg(MAX_NOF_SUBHEADERS)
+mux::mux() : pdu_msg(INIT_NOF_SUBHEADERS)
 {
   msg3_buff.init(1, MSG3_BUFF_SZ);
 
@@ -138,7 +138,7 @@ void mux::pusch_retx(uint32_t tx_tti, uint32_t pid)
 }
 
 // Multiplexing and logical channel priorization as defined in Section 5.4.3
-uint8_t* mux::pdu_get(uint8_t *payload, uint32_t pdu_sz, uint32_t tx_tti, uint32_t pid)
+uint8_t* mux::pdu_get(uint8_t *payload, uint32_t pdu_sz, uint32_t tx_tti, uint32_t pid, uint32_t *nof_sdus)
 {
   
   pthread_mutex_lock(&mutex);
@@ -224,6 +224,16 @@ uint8_t* mux::pdu_get(uint8_t *payload, uint32_t pdu_sz, uint32_t tx_tti, uint32
 
   /* Generate MAC PDU and save to buffer */
   uint8_t *ret = pdu_msg.write_packet(log_h);   
+  
+  if (nof_sdus) {
+    *nof_sdus = 0; 
+    pdu_msg.reset();
+    while(pdu_msg.next()) {
+      if (pdu_msg.get()->is_sdu()) {
+        (*nof_sdus)++;
+      }
+    }
+  }
 
   pid_has_bsr[pid%MAX_HARQ_PROC] = bsr_is_inserted; 
   if (bsr_is_inserted) {
@@ -294,6 +304,10 @@ bool mux::msg3_is_transmitted()
 
 bool mux::pdu_move_to_msg3(uint32_t pdu_sz)
 {
+  if (2*pdu_sz > MSG3_BUFF_SZ) {
+    Error("Msg3 of %d bytes does not fit in the Msg3 buffer\n", pdu_sz);
+    return false; 
+  }
   uint8_t *msg3_start = (uint8_t*) msg3_buff.request();
   if (msg3_start) {
     uint8_t *msg3_pdu = pdu_get(msg3_start, pdu_sz, 0, 0); 
@@ -42,7 +42,7 @@ bsr_proc::bsr_proc()
   last_print = 0; 
   next_tx_tti = 0; 
   triggered_bsr_type=NONE; 
-  
+  pthread_mutex_init(&mutex, NULL);
 }
 
 void bsr_proc::init(rlc_interface_mac *rlc_, srslte::log* log_h_, mac_interface_rrc::mac_cfg_t *mac_cfg_, srslte::timers *timers_db_)
@@ -62,21 +62,23 @@ void bsr_proc::reset()
   timers_db->get(mac::BSR_TIMER_RETX)->stop();
   timers_db->get(mac::BSR_TIMER_RETX)->reset();
   
+  pthread_mutex_lock(&mutex);
   reset_sr = false; 
   sr_is_sent = false; 
   triggered_bsr_type = NONE; 
   for (int i=0;i<MAX_LCID;i++)  {
     lcg[i]        = -1; 
     priorities[i] = -1; 
-    last_pending_data[i] = 0; 
   }        
   lcg[0] = 0; 
   priorities[0] = 99;   
   next_tx_tti = 0; 
+  pthread_mutex_unlock(&mutex);
 }
 
 /* Process Periodic BSR */
 void bsr_proc::timer_expired(uint32_t timer_id) {
+  pthread_mutex_lock(&mutex);
   switch(timer_id) {
     case mac::BSR_TIMER_PERIODIC:
       if (triggered_bsr_type == NONE) {
@@ -95,10 +97,32 @@ void bsr_proc::timer_expired(uint32_t timer_id) {
       }
       break;      
   }
+  pthread_mutex_unlock(&mutex);
+}
+
+/* Regular BSR triggers (Sec 5.4.5) are evaluated right away in the RLC thread, so that a 
+ * grant multiplexed before the next step() already carries the BSR. Without a pending grant 
+ * the caller starts the SR from this thread too */
+bool bsr_proc::new_data(uint32_t lcid, uint32_t tti)
+{
+  if (!initiated || lcid >= MAX_LCID) {
+    return false; 
+  }
+  pthread_mutex_lock(&mutex);
+  uint32_t lcid_mask = 1<<lcid; 
+  // Check condition 1 in Sec 5.4.5   
+  if (triggered_bsr_type == NONE) {
+    check_single_channel(lcid_mask);
+  }
+  // Higher priority channel is reported regardless of a BSR being already triggered
+  check_highest_channel(lcid_mask);
+  bool ret = check_sr(tti); 
+  pthread_mutex_unlock(&mutex);
+  return ret; 
 }
 
 // Checks if data is available for a a channel with higher priority than others 
-bool bsr_proc::check_highest_channel() {
+bool bsr_proc::check_highest_channel(uint32_t lcid_mask) {
   int pending_data_lcid = -1; 
   
   for (int i=0;i<MAX_LCID && pending_data_lcid == -1;i++) {
@@ -117,8 +141,7 @@ bool bsr_proc::check_highest_channel() {
   }
   if (pending_data_lcid >= 0) {
     // If there is new data available for this logical channel 
-    uint32_t nbytes = rlc->get_buffer_state(pending_data_lcid);
-    if (nbytes > last_pending_data[pending_data_lcid]) 
+    if (lcid_mask & (1<<pending_data_lcid)) 
     {
       if (triggered_bsr_type != REGULAR) {        
         Info("BSR:   Triggered REGULAR BSR for Max Priority LCID=%d\n", pending_data_lcid);
@@ -132,16 +155,18 @@ bool bsr_proc::check_highest_channel() {
 
 uint32_t bsr_proc::get_buffer_state() {
   uint32_t buffer = 0; 
+  pthread_mutex_lock(&mutex);
   for (int i=0;i<MAX_LCID;i++) {
     if (lcg[i] >= 0) {
       buffer += rlc->get_buffer_state(i);
     }
   }
+  pthread_mutex_unlock(&mutex);
   return buffer; 
 }
     
 // Checks if only one logical channel has data avaiable for Tx
-bool bsr_proc::check_single_channel() {    
+bool bsr_proc::check_single_channel(uint32_t lcid_mask) {    
   uint32_t pending_data_lcid = 0; 
   uint32_t nof_nonzero_lcid = 0; 
   
@@ -154,9 +179,8 @@ bool bsr_proc::check_single_channel() {
     }
   }
   if (nof_nonzero_lcid == 1) {
-    uint32_t nbytes = rlc->get_buffer_state(pending_data_lcid);
     // If there is new data available for this logical channel 
-    if (nbytes > last_pending_data[pending_data_lcid]) {
+    if (lcid_mask & (1<<pending_data_lcid)) {
       triggered_bsr_type = REGULAR; 
       Info("BSR:   Triggered REGULAR BSR for single LCID=%d\n", pending_data_lcid);
       return true; 
@@ -165,12 +189,6 @@ bool bsr_proc::check_single_channel() {
   return false;
 }
 
-void bsr_proc::update_pending_data() {
-  for (int i=0;i<MAX_LCID;i++) {
-    last_pending_data[i] = rlc->get_buffer_state(i); 
-  }
-}
-
 bool bsr_proc::generate_bsr(bsr_t *bsr, uint32_t nof_padding_bytes) {
   bool ret = false; 
   uint32_t nof_lcg=0;
@@ -236,21 +254,13 @@ void bsr_proc::step(uint32_t tti)
     Info("BSR:   Configured timer reTX %d ms\n", retx);
   }
 
-  // Check condition 1 in Sec 5.4.5   
-  if (triggered_bsr_type == NONE) {
-    check_single_channel();
-  }
-  // Higher priority channel is reported regardless of a BSR being already triggered
-  check_highest_channel();
-  
-  update_pending_data();
-  
+  // Regular BSR is triggered by new_data(), no polling here
   
   if ((tti - last_print)%10240 > QUEUE_STATUS_PERIOD_MS) {
     char str[128];
     bzero(str, 128);
     for (int i=0;i<MAX_LCID;i++) {
-      sprintf(str, "%s%d (%d), ", str, rlc->get_buffer_state(i), last_pending_data[i]);
+      sprintf(str, "%s%d, ", str, rlc->get_buffer_state(i));
     }
     Info("BSR:   QUEUE status: %s\n", str);
     last_print = tti; 
@@ -286,6 +296,7 @@ bool bsr_proc::need_to_send_bsr_on_ul_grant(uint32_t grant_size, bsr_t *bsr)
 {
   bool ret = false; 
 
+  pthread_mutex_lock(&mutex);
   uint32_t bsr_sz = 0; 
   if (triggered_bsr_type == PERIODIC || triggered_bsr_type == REGULAR) {
     /* Check if grant + MAC SDU headers is enough to accomodate all pending data */
@@ -320,6 +331,7 @@ bool bsr_proc::need_to_send_bsr_on_ul_grant(uint32_t grant_size, bsr_t *bsr)
     timers_db->get(mac::BSR_TIMER_RETX)->reset();
     timers_db->get(mac::BSR_TIMER_RETX)->run();
   }
+  pthread_mutex_unlock(&mutex);
   return ret;   
 }
 
@@ -327,6 +339,7 @@ bool bsr_proc::generate_padding_bsr(uint32_t nof_padding_bytes, bsr_t *bsr)
 {
   bool ret = false; 
 
+  pthread_mutex_lock(&mutex);
   if (triggered_bsr_type != NONE || nof_padding_bytes >= 2) {
 
     if (triggered_bsr_type == NONE) {
@@ -343,26 +356,39 @@ bool bsr_proc::generate_padding_bsr(uint32_t nof_padding_bytes, bsr_t *bsr)
     }    
     
   }
+  pthread_mutex_unlock(&mutex);
   return ret; 
 }
 
 void bsr_proc::set_tx_tti(uint32_t tti) {
   Debug("BSR:   Set next_tx_tti=%d\n", tti);
+  pthread_mutex_lock(&mutex);
   next_tx_tti = tti;  
+  pthread_mutex_unlock(&mutex);
 }
 
 bool bsr_proc::need_to_reset_sr() {
+  bool ret = false; 
+  pthread_mutex_lock(&mutex);
   if (reset_sr) {
     reset_sr = false; 
     sr_is_sent = false; 
     Debug("BSR:   SR reset. sr_is_sent and reset_rs false\n");
-    return true; 
-  } else {
-    return false; 
+    ret = true; 
   }
+  pthread_mutex_unlock(&mutex);
+  return ret; 
 }
 
 bool bsr_proc::need_to_send_sr(uint32_t tti) {
+  pthread_mutex_lock(&mutex);
+  bool ret = check_sr(tti); 
+  pthread_mutex_unlock(&mutex);
+  return ret; 
+}
+
+// A Regular BSR needs a SR unless one is already sent or a UL grant is due (mutex locked)
+bool bsr_proc::check_sr(uint32_t tti) {
   if (!sr_is_sent && triggered_bsr_type == REGULAR) {
     if (srslte_tti_interval(tti,next_tx_tti)>0 && srslte_tti_interval(tti,next_tx_tti) < 10240-4) {
       reset_sr = false; 
@@ -379,13 +405,17 @@ bool bsr_proc::need_to_send_sr(uint32_t tti) {
 void bsr_proc::setup_lcg(uint32_t lcid, uint32_t new_lcg)
 {
   if (lcid < MAX_LCID && new_lcg < 4) {
+    pthread_mutex_lock(&mutex);
     lcg[lcid] = new_lcg; 
+    pthread_mutex_unlock(&mutex);
   }      
 }
 
 void bsr_proc::set_priority(uint32_t lcid, uint32_t priority) {
   if (lcid < MAX_LCID) {
+    pthread_mutex_lock(&mutex);
     priorities[lcid] = priority;     
+    pthread_mutex_unlock(&mutex);
   }
 }
 
@@ -299,7 +299,9 @@ void ra_proc::tb_decoded_ok() {
   rDebug("RAR decoded successfully TBS=%d\n", rar_grant_nbytes);
   
   rar_pdu_msg.init_rx(rar_grant_nbytes);
-  rar_pdu_msg.parse_packet(rar_pdu_buffer);
+  if (!rar_pdu_msg.parse_packet(rar_pdu_buffer)) {
+    rError("Discarding malformed RAR PDU TBS=%d\n", rar_grant_nbytes);
+  }
   // Set Backoff parameter
   if (rar_pdu_msg.has_backoff()) {
     backoff_param_ms = backoff_table[rar_pdu_msg.get_backoff()%16];
@@ -0,0 +1,214 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#define Error(fmt, ...)   log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+#include <string.h>
+
+#include "mac/proc_si.h"
+
+
+namespace srsue {
+
+/* Signed distance from tti b to tti a, in the range [-5120, 5120) */
+static int tti_diff(uint32_t a, uint32_t b) 
+{
+  return (int) ((a + 10240 - b + 5120)%10240) - 5120; 
+}
+
+si_proc::si_proc() {
+  initiated = false; 
+  pthread_mutex_init(&mutex, NULL);
+}
+  
+void si_proc::init(mac_interface_rrc *mac_, rrc_interface_mac *rrc_, srslte::log* log_h_)
+{
+  mac       = mac_; 
+  rrc       = rrc_; 
+  log_h     = log_h_;
+  reset();
+  initiated = true; 
+}
+
+void si_proc::reset()
+{
+  pthread_mutex_lock(&mutex);
+  bzero(windows, sizeof(si_window_t)*MAX_SI);
+  armed       = false; 
+  armed_id    = 0; 
+  armed_end   = 0; 
+  nof_results = 0; 
+  pthread_mutex_unlock(&mutex);
+}
+
+void si_proc::acquire(uint32_t si_id, uint32_t period, uint32_t offset, uint32_t win_len, uint32_t max_windows)
+{
+  if (si_id >= MAX_SI || !period || !win_len) {
+    Error("Invalid SI message %d, period=%d, win_len=%d\n", si_id, period, win_len);
+    return; 
+  }
+  pthread_mutex_lock(&mutex);
+  windows[si_id].pending     = true; 
+  windows[si_id].period      = period; 
+  windows[si_id].offset      = offset; 
+  windows[si_id].win_len     = win_len; 
+  windows[si_id].max_windows = max_windows; 
+  windows[si_id].nof_windows = 0; 
+  Info("SI:    Scheduled SI message %d, period=%d frames, offset=%d, win_len=%d\n", si_id, period, offset, win_len);
+  pthread_mutex_unlock(&mutex);
+}
+
+void si_proc::stop()
+{
+  pthread_mutex_lock(&mutex);
+  for (uint32_t i=0;i<MAX_SI;i++) {
+    windows[i].pending = false; 
+  }
+  if (armed) {
+    mac->bcch_stop_rx();
+    armed = false; 
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+/* First window start at or after tti + SCHED_LEAD_TTI. The period divides 10240 */
+uint32_t si_proc::next_window_start(uint32_t tti, si_window_t *w)
+{
+  uint32_t T   = w->period*10; 
+  uint32_t min = tti + SCHED_LEAD_TTI + T; // Add one period to avoid negative values
+  uint32_t k   = (min - w->offset + T - 1)/T; 
+  return ((k-1)*T + w->offset)%10240; 
+}
+
+/* Arms BCCH reception for the earliest window among the pending SI messages, if it starts soon */
+void si_proc::arm_next(uint32_t tti)
+{
+  int      best_diff  = 0; 
+  uint32_t best_id    = 0; 
+  uint32_t best_start = 0; 
+  bool     found      = false; 
+  for (uint32_t i=0;i<MAX_SI;i++) {
+    if (windows[i].pending) {
+      uint32_t start = next_window_start(tti, &windows[i]);
+      int      diff  = tti_diff(start, tti);
+      if (!found || diff < best_diff) {
+        found      = true; 
+        best_diff  = diff; 
+        best_id    = i; 
+        best_start = start; 
+      }
+    }
+  }
+  if (found && best_diff <= (int) SCHED_MAX_TTI) {
+    armed     = true; 
+    armed_id  = best_id; 
+    armed_end = (best_start + windows[best_id].win_len)%10240; 
+    mac->bcch_start_rx(best_start, windows[best_id].win_len);
+    Debug("SI:    Armed window for SI message %d, start=%d, len=%d\n", best_id, best_start, windows[best_id].win_len);
+  }
+}
+
+void si_proc::step(uint32_t tti, bool dl_search_free)
+{
+  if (!initiated) {
+    return; 
+  }
+  si_result_t r[MAX_SI]; 
+  uint32_t    n = 0; 
+  bool        window_end = false; 
+  
+  pthread_mutex_lock(&mutex);
+  if (armed && !dl_search_free) {
+    // The search has been taken over, try again in a later window 
+    armed = false; 
+    Debug("SI:    Window for SI message %d interrupted\n", armed_id);
+  } else if (armed && tti_diff(tti, armed_end) >= 0) {
+    // Window ended without receiving the SI message 
+    si_window_t *w = &windows[armed_id]; 
+    armed      = false; 
+    window_end = true; 
+    if (w->pending) {
+      w->nof_windows++;
+      if (w->max_windows && w->nof_windows >= w->max_windows) {
+        w->pending = false; 
+        results[nof_results].si_id   = armed_id; 
+        results[nof_results].success = false; 
+        nof_results++;
+        Info("SI:    SI message %d not received after %d windows\n", armed_id, w->nof_windows);
+      }
+    }
+  }
+  if (!armed && dl_search_free) {
+    arm_next(tti);
+  }
+  // Give the DL search back if no other window follows 
+  if (window_end && !armed) {
+    mac->bcch_stop_rx();
+  }
+  n = nof_results; 
+  memcpy(r, results, sizeof(si_result_t)*n);
+  nof_results = 0; 
+  pthread_mutex_unlock(&mutex);
+  
+  report_results(r, n);
+}
+
+void si_proc::tb_decoded(bool ack)
+{
+  if (!initiated || !ack) {
+    return; 
+  }
+  si_result_t r; 
+  bool        report = false; 
+  
+  pthread_mutex_lock(&mutex);
+  if (armed && windows[armed_id].pending) {
+    windows[armed_id].pending = false; 
+    armed = false; 
+    mac->bcch_stop_rx();
+    r.si_id   = armed_id; 
+    r.success = true; 
+    report    = true; 
+    Info("SI:    Received SI message %d\n", armed_id);
+  }
+  pthread_mutex_unlock(&mutex);
+  
+  if (report) {
+    report_results(&r, 1);
+  }
+}
+
+void si_proc::report_results(si_result_t *r, uint32_t n)
+{
+  for (uint32_t i=0;i<n;i++) {
+    rrc->si_acquired(r[i].si_id, r[i].success);
+  }
+}
+
+} // namespace srsue
@@ -36,6 +36,8 @@ namespace srsue {
 
 sr_proc::sr_proc() {
   initiated = false; 
+  is_pending_sr = false; 
+  pthread_mutex_init(&mutex, NULL);
 }
   
 void sr_proc::init(phy_interface_mac* phy_h_, rrc_interface_mac *rrc_, srslte::log* log_h_, mac_interface_rrc::mac_cfg_t *mac_cfg_)
@@ -50,7 +52,9 @@ void sr_proc::init(phy_interface_mac* phy_h_, rrc_interface_mac *rrc_, srslte::l
   
 void sr_proc::reset()
 {
+  pthread_mutex_lock(&mutex);
   is_pending_sr = false;
+  pthread_mutex_unlock(&mutex);
 }
 
 bool sr_proc::need_tx(uint32_t tti) 
@@ -73,7 +77,9 @@ bool sr_proc::need_tx(uint32_t tti)
 
 void sr_proc::step(uint32_t tti)
 {
+  bool release = false; 
   if (initiated) {
+    pthread_mutex_lock(&mutex);
     if (is_pending_sr) {
       if (mac_cfg->sr.setup_present) {
         if (sr_counter < dsr_transmax) {
@@ -87,7 +93,7 @@ void sr_proc::step(uint32_t tti)
             Info("SR:    Releasing PUCCH/SRS resources, sr_counter=%d, dsr_transmax=%d\n", 
                  sr_counter, dsr_transmax);
             log_h->console("Scheduling request failed: releasing RRC connection...\n");
-            rrc->release_pucch_srs();
+            release = true; 
             do_ra = true; 
             is_pending_sr = false; 
           }
@@ -95,33 +101,47 @@ void sr_proc::step(uint32_t tti)
       } else {
         Info("SR:    PUCCH not configured. Starting RA procedure\n");
         do_ra = true; 
-        reset();
+        is_pending_sr = false; 
       }
     }
+    pthread_mutex_unlock(&mutex);
+  }
+  // RRC reconfigures the PHY, not done with the lock held
+  if (release) {
+    rrc->release_pucch_srs();
   }
 }
 
 bool sr_proc::need_random_access() {
+  bool ret = false; 
   if (initiated) {
+    pthread_mutex_lock(&mutex);
     if (do_ra) {
       do_ra = false; 
-      return true; 
-    } else {
-      return false; 
+      ret = true; 
     }
+    pthread_mutex_unlock(&mutex);
   }
-  return false;
+  return ret;
 }
 
 void sr_proc::start()
 {
   if (initiated) {
+    pthread_mutex_lock(&mutex);
     if (!is_pending_sr) {
       sr_counter = 0;
       is_pending_sr = true; 
     }
     dsr_transmax = liblte_rrc_dsr_trans_max_num[mac_cfg->sr.dsr_trans_max];
     Debug("SR:    Starting Procedure. dsrTransMax=%d\n", dsr_transmax);
+    // First SR goes to the PHY now rather than in the next step()
+    if (mac_cfg->sr.setup_present && sr_counter == 0 && sr_counter < dsr_transmax) {
+      sr_counter++;
+      Info("SR:    Signalling PHY sr_counter=%d\n", sr_counter);
+      phy_h->sr_send();
+    }
+    pthread_mutex_unlock(&mutex);
   }
 }
 
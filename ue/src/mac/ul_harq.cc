@@ -74,6 +74,21 @@ void ul_harq_entity::reset() {
   }
   ul_sps_assig.clear();
 }
+void ul_harq_entity::set_sps_config(LIBLTE_RRC_SPS_CONFIG_UL_STRUCT *sps_cfg)
+{
+  ul_sps_assig.set_config(sps_cfg);
+}
+
+bool ul_harq_entity::sps_enabled()
+{
+  return ul_sps_assig.is_enabled();
+}
+
+bool ul_harq_entity::get_sps_grant(uint32_t tti, mac_interface_phy::mac_grant_t *grant)
+{
+  return ul_sps_assig.get_pending_grant(tti, grant);
+}
+
 void ul_harq_entity::reset_ndi() {
   for (uint32_t i=0;i<NOF_HARQ_PROC;i++) {
     proc[i].reset_ndi();
@@ -118,11 +133,24 @@ void ul_harq_entity::new_grant_ul(mac_interface_phy::mac_grant_t grant, mac_inte
     }
     run_tti(grant.tti, &grant, action);
   } else if (grant.rnti_type == SRSLTE_RNTI_SPS) {
-    if (grant.ndi) {
-      grant.ndi = proc[pidof(grant.tti)].get_ndi();
+    if (grant.is_sps_configured) {
+      // Configured grant, NDI is considered toggled 
       run_tti(grant.tti, &grant, action);
+    } else if (grant.ndi) {
+      // Retransmission for the SPS C-RNTI, NDI is considered not toggled 
+      grant.ndi = proc[pidof(grant.tti+4)].get_ndi();
+      run_tti(grant.tti, &grant, action);
+    } else if (!ul_sps_assig.is_enabled()) {
+      Warning("SPS: UL activation/release received but SPS is not configured\n");
+    } else if (grant.is_sps_release) {
+      Info("SPS: UL grant released\n");
+      ul_sps_assig.clear();
     } else {
-      Info("Not implemented\n");
+      Info("SPS: UL grant activated at tti=%d, tbs=%d\n", grant.tti, grant.n_bytes);
+      ul_sps_assig.reset(grant.tti, &grant);
+      // The activation PDCCH carries the first configured grant 
+      grant.is_sps_configured = true; 
+      run_tti(grant.tti, &grant, action);
     }
   }
 }
@@ -229,7 +257,8 @@ void ul_harq_entity::ul_harq_process::run_tti(uint32_t tti_tx, mac_interface_phy
   // Receive and route HARQ feedbacks
   if (grant) {
     if ((!grant->rnti_type == SRSLTE_RNTI_TEMP && grant->ndi != get_ndi()) || 
-        (grant->rnti_type == SRSLTE_RNTI_USER && !has_grant())             ||
+        (grant->rnti_type == SRSLTE_RNTI_USER && (!has_grant() || is_sps()))   ||
+         grant->is_sps_configured                                          ||
          grant->is_from_rar) 
     {          
       // New transmission
@@ -247,9 +276,13 @@ void ul_harq_entity::ul_harq_process::run_tti(uint32_t tti_tx, mac_interface_phy
       // Normal UL grant
       } else {
         // Request a MAC PDU from the Multiplexing & Assemble Unit
-        pdu_ptr = harq_entity->mux_unit->pdu_get(payload_buffer, grant->n_bytes, tti_tx, pid);
+        uint32_t nof_sdus = 0; 
+        pdu_ptr = harq_entity->mux_unit->pdu_get(payload_buffer, grant->n_bytes, tti_tx, pid, &nof_sdus);
         if (pdu_ptr) {            
           generate_new_tx(tti_tx, false, grant, action);          
+          if (grant->is_sps_configured && harq_entity->ul_sps_assig.new_pdu(nof_sdus)) {
+            Info("SPS: UL grant implicitly released, consecutive PDUs without MAC SDU\n");
+          }
         } else {
           Warning("Uplink grant but no MAC PDU in Multiplex Unit buffer\n");
         }
@@ -362,7 +395,7 @@ void ul_harq_entity::ul_harq_process::generate_tx(uint32_t tti_tx, mac_interface
 
 bool ul_harq_entity::ul_harq_process::is_sps()
 {
-  return false; 
+  return has_grant() && cur_grant.rnti_type == SRSLTE_RNTI_SPS; 
 }
 
 uint32_t ul_harq_entity::ul_harq_process::last_tx_tti()
@@ -0,0 +1,117 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <strings.h>
+
+#include "mac/ul_sps.h"
+
+namespace srsue {
+
+ul_sps::ul_sps()
+{
+  pthread_mutex_init(&mutex, NULL);
+  enabled                = false; 
+  interval               = 0; 
+  implicit_release_after = 0; 
+  is_configured          = false; 
+  start_tti              = 0; 
+  nof_empty_pdus         = 0; 
+  bzero(&cur_grant, sizeof(mac_interface_phy::mac_grant_t));
+}
+
+void ul_sps::set_config(LIBLTE_RRC_SPS_CONFIG_UL_STRUCT *cfg)
+{
+  pthread_mutex_lock(&mutex);
+  is_configured = false; 
+  if (cfg && cfg->setup_present && liblte_rrc_sps_interval_ul_num[cfg->sps_interval_ul%LIBLTE_RRC_SPS_INTERVAL_UL_N_ITEMS] > 0) {
+    enabled                = true; 
+    interval               = liblte_rrc_sps_interval_ul_num[cfg->sps_interval_ul%LIBLTE_RRC_SPS_INTERVAL_UL_N_ITEMS]; 
+    implicit_release_after = liblte_rrc_implicit_release_after_num[cfg->implicit_release_after%LIBLTE_RRC_IMPLICIT_RELEASE_AFTER_N_ITEMS];
+  } else {
+    enabled                = false; 
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+bool ul_sps::is_enabled()
+{
+  return enabled; 
+}
+
+void ul_sps::clear()
+{
+  pthread_mutex_lock(&mutex);
+  is_configured = false; 
+  pthread_mutex_unlock(&mutex);
+}
+
+/* Stores the grant of the activation PDCCH. Grants are indexed by the TTI of the PDCCH, 4 subframes 
+ * before the PUSCH, which keeps the recurrence of Section 5.10.2 */
+void ul_sps::reset(uint32_t tti, mac_interface_phy::mac_grant_t *grant)
+{
+  pthread_mutex_lock(&mutex);
+  if (enabled) {
+    memcpy(&cur_grant, grant, sizeof(mac_interface_phy::mac_grant_t));
+    start_tti      = tti%10240; 
+    nof_empty_pdus = 0; 
+    is_configured  = true; 
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+bool ul_sps::get_pending_grant(uint32_t tti, mac_interface_phy::mac_grant_t *grant)
+{
+  bool ret = false; 
+  pthread_mutex_lock(&mutex);
+  if (enabled && is_configured && srslte_tti_interval(tti%10240, start_tti)%interval == 0) {
+    memcpy(grant, &cur_grant, sizeof(mac_interface_phy::mac_grant_t));
+    grant->tti               = tti; 
+    grant->rv                = 0; 
+    grant->is_sps_release    = false; 
+    grant->is_sps_configured = true; 
+    ret = true; 
+  }
+  pthread_mutex_unlock(&mutex);
+  return ret; 
+}
+
+bool ul_sps::new_pdu(uint32_t nof_sdus)
+{
+  bool released = false; 
+  pthread_mutex_lock(&mutex);
+  if (is_configured) {
+    nof_empty_pdus = nof_sdus?0:nof_empty_pdus+1; 
+    if (nof_empty_pdus >= implicit_release_after) {
+      is_configured = false; 
+      released      = true; 
+    }
+  }
+  pthread_mutex_unlock(&mutex);
+  return released; 
+}
+
+} // namespace srsue
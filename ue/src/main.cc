@@ -70,6 +70,7 @@ void parse_args(all_args_t *args, int argc, char* argv[]) {
         ("rf.device_args",       bpo::value<string>(&args->rf.device_args)->default_value("auto"),    "Front-end device arguments")
         ("rf.time_adv_nsamples", bpo::value<string>(&args->rf.time_adv_nsamples)->default_value("auto"),    "Transmission time advance")
         ("rf.burst_preamble_us", bpo::value<string>(&args->rf.burst_preamble)->default_value("auto"), "Transmission time advance")
+        ("rf.record_filename",   bpo::value<string>(&args->rf.record_filename)->default_value(""), "Record received samples to this file (replay with device_name=file)")
 
         ("pcap.enable",       bpo::value<bool>(&args->pcap.enable)->default_value(false),           "Enable MAC packet captures for wireshark")
         ("pcap.filename",     bpo::value<string>(&args->pcap.filename)->default_value("ue.pcap"),   "MAC layer capture filename")
@@ -77,6 +78,9 @@ void parse_args(all_args_t *args, int argc, char* argv[]) {
         ("trace.enable",      bpo::value<bool>(&args->trace.enable)->default_value(false),                  "Enable PHY and radio timing traces")
         ("trace.phy_filename",bpo::value<string>(&args->trace.phy_filename)->default_value("ue.phy_trace"), "PHY timing traces filename")
         ("trace.radio_filename",bpo::value<string>(&args->trace.radio_filename)->default_value("ue.radio_trace"), "Radio timing traces filename")
+        ("trace.mac_record_filename",bpo::value<string>(&args->trace.mac_record_filename)->default_value(""), "Record the PHY-MAC interface calls to this file")
+        ("trace.mac_replay_filename",bpo::value<string>(&args->trace.mac_replay_filename)->default_value(""), "Replay a PHY-MAC interface recording instead of running the radio and the PHY")
+        ("trace.mac_replay_realtime",bpo::value<bool>(&args->trace.mac_replay_realtime)->default_value(true),  "Replay at one TTI per ms, or as fast as possible if false")
 
         ("gui.enable",        bpo::value<bool>(&args->gui.enable)->default_value(false),                  "Enable GUI plots")
         
@@ -181,6 +185,34 @@ void parse_args(all_args_t *args, int argc, char* argv[]) {
             bpo::value<float>(&args->expert.phy.estimator_fil_w)->default_value(0.1), 
             "Chooses the coefficients for the 3-tap channel estimator centered filter.")
         
+        ("expert.iq_capture_mode",    
+            bpo::value<string>(&args->expert.phy.iq_capture_mode)->default_value("none"), 
+            "Background IQ capture of received subframes: none, window, trigger or continuous")
+        
+        ("expert.iq_capture_filename",    
+            bpo::value<string>(&args->expert.phy.iq_capture_filename)->default_value("/tmp/ue_iq.bin"), 
+            "IQ capture filename")
+        
+        ("expert.iq_capture_nof_sf",    
+            bpo::value<int>(&args->expert.phy.iq_capture_nof_sf)->default_value(40), 
+            "Number of subframes kept in the IQ capture ring")
+        
+        ("expert.cell_search_parallel",    
+            bpo::value<bool>(&args->expert.phy.cell_search_parallel)->default_value(false), 
+            "Searches the 3 PSS sequences in parallel over a single capture")
+        
+        ("expert.cell_search_earfcn",    
+            bpo::value<string>(&args->expert.phy.cell_search_earfcn)->default_value(""), 
+            "Comma-separated list of DL EARFCN to scan. Camps on the strongest cell found")
+        
+        ("expert.cell_cache_filename",    
+            bpo::value<string>(&args->expert.phy.cell_cache_filename)->default_value(""), 
+            "Prefix of the files caching the last serving cell and its SIB2 for warm start")
+        
+        ("expert.pdcch_early_stop",    
+            bpo::value<bool>(&args->expert.phy.pdcch_early_stop)->default_value(false), 
+            "Looks for the DL and UL DCI of the C-RNTI in a single pass over the PDCCH candidates")
+        
         
         ("rf_calibration.tx_corr_dc_gain",  bpo::value<float>(&args->rf_cal.tx_corr_dc_gain)->default_value(0.0),  "TX DC offset gain correction")
         ("rf_calibration.tx_corr_dc_phase", bpo::value<float>(&args->rf_cal.tx_corr_dc_phase)->default_value(0.0), "TX DC offset phase correction")
@@ -353,6 +385,9 @@ int main(int argc, char *argv[])
         plot_started = true; 
       }
     }
+    if (ue->replay_finished()) {
+      running = false; 
+    }
     sleep(1);
   }
   pthread_cancel(input);
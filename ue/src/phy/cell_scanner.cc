@@ -0,0 +1,192 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "phy/cell_scanner.h"
+
+#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+namespace srsue {
+
+cell_scanner::cell_scanner() : pool(3)
+{
+  log_h           = NULL; 
+  buffer          = NULL; 
+  nof_half_frames = 0; 
+  initiated       = false; 
+}
+
+cell_scanner::~cell_scanner()
+{
+  free();
+}
+
+bool cell_scanner::init(uint32_t nof_half_frames_, srslte::log* log_h_, uint32_t prio)
+{
+  log_h           = log_h_; 
+  nof_half_frames = nof_half_frames_; 
+  
+  buffer = (cf_t*) srslte_vec_malloc(sizeof(cf_t)*get_buffer_len());
+  if (!buffer) {
+    Error("Allocating cell scanner buffer\n");
+    return false; 
+  }
+  for (uint32_t i=0;i<3;i++) {
+    if (!searchers[i].init(i)) {
+      Error("Initiating PSS searcher for N_id_2=%d\n", i);
+      for (uint32_t j=0;j<i;j++) {
+        searchers[j].free();
+      }
+      return false; 
+    }
+  }
+  for (uint32_t i=0;i<3;i++) {
+    pool.init_worker(i, &searchers[i], prio);
+  }
+  initiated = true; 
+  return true; 
+}
+
+void cell_scanner::free()
+{
+  if (initiated) {
+    pool.stop();
+    for (uint32_t i=0;i<3;i++) {
+      searchers[i].free();
+    }
+    initiated = false; 
+  }
+  if (buffer) {
+    ::free(buffer);
+    buffer = NULL; 
+  }
+}
+
+cf_t* cell_scanner::get_buffer()
+{
+  return buffer; 
+}
+
+uint32_t cell_scanner::get_buffer_len()
+{
+  // One extra half-frame so that the last one can be searched with a full window
+  return (nof_half_frames+1)*HALF_FRAME_LEN; 
+}
+
+int cell_scanner::scan(uint32_t min_detected, result_t results[3], int force_N_id_2)
+{
+  // All workers are started every time so that waiting for 3 idle workers waits for all
+  for (uint32_t i=0;i<3;i++) {
+    searchers[i].set_search(buffer, nof_half_frames, force_N_id_2 < 0 || force_N_id_2 == (int) i);
+    pool.start_worker(i);
+  }
+  for (uint32_t i=0;i<3;i++) {
+    pool.wait_worker();
+  }
+  int max_idx = -1; 
+  for (uint32_t i=0;i<3;i++) {
+    memcpy(&results[i], &searchers[i].result, sizeof(result_t));
+    results[i].found = results[i].nof_detected >= min_detected; 
+    if (results[i].found && (max_idx < 0 || results[i].peak > results[max_idx].peak)) {
+      max_idx = i; 
+    }
+    Info("SCAN:  N_id_2=%d, detected=%d/%d, cell_id=%d, peak=%.1f, rsrp=%.1f dB, cfo=%.1f Hz\n", 
+         i, results[i].nof_detected, nof_half_frames, results[i].cell_id, 
+         results[i].peak, results[i].rsrp_db, results[i].cfo);
+  }
+  return max_idx; 
+}
+
+bool cell_scanner::searcher::init(uint32_t N_id_2_)
+{
+  N_id_2 = N_id_2_; 
+  if (srslte_sync_init(&sync, HALF_FRAME_LEN, HALF_FRAME_LEN, FFT_SIZE)) {
+    return false; 
+  }
+  srslte_sync_set_N_id_2(&sync, N_id_2);
+  srslte_sync_sss_en(&sync, true);
+  srslte_sync_cp_en(&sync, true);
+  srslte_sync_set_threshold(&sync, 2.0);
+  return true; 
+}
+
+void cell_scanner::searcher::free()
+{
+  srslte_sync_free(&sync);
+}
+
+void cell_scanner::searcher::set_search(cf_t *buffer_, uint32_t nof_half_frames_, bool enabled_)
+{
+  buffer          = buffer_; 
+  nof_half_frames = nof_half_frames_; 
+  enabled         = enabled_; 
+  bzero(&result, sizeof(result_t));
+}
+
+void cell_scanner::searcher::work_imp()
+{
+  if (!enabled) {
+    return; 
+  }
+  float    peak_acc = 0; 
+  float    pwr_acc  = 0; 
+  float    cfo_acc  = 0; 
+  uint32_t cp_ext   = 0; 
+  uint32_t cnt      = 0; 
+  
+  srslte_sync_reset(&sync);
+  for (uint32_t n=0;n<nof_half_frames;n++) {
+    uint32_t peak_pos = 0; 
+    cf_t *input = &buffer[n*HALF_FRAME_LEN]; 
+    if (srslte_sync_find(&sync, input, 0, &peak_pos) == SRSLTE_SYNC_FOUND && srslte_sync_sss_detected(&sync)) {
+      // Energy of the PSS symbol, which ends at the correlation peak
+      if (peak_pos >= FFT_SIZE) {
+        pwr_acc += crealf(srslte_vec_dot_prod_conj_ccc(&input[peak_pos-FFT_SIZE], &input[peak_pos-FFT_SIZE], FFT_SIZE))/FFT_SIZE; 
+      }
+      peak_acc += srslte_sync_get_last_peak_value(&sync);
+      cfo_acc  += 15000*srslte_sync_get_cfo(&sync);
+      if (SRSLTE_CP_ISEXT(srslte_sync_get_cp(&sync))) {
+        cp_ext++;
+      }
+      result.cell_id = srslte_sync_get_cell_id(&sync);
+      cnt++;
+    }
+  }
+  result.nof_detected = cnt; 
+  if (cnt > 0) {
+    result.peak    = peak_acc/cnt; 
+    result.cfo     = cfo_acc/cnt; 
+    result.rsrp_db = 10*log10f(pwr_acc/cnt + 1e-12);
+    result.cp      = cp_ext > cnt/2 ? SRSLTE_CP_EXT : SRSLTE_CP_NORM; 
+  }
+}
+
+} // namespace srsue
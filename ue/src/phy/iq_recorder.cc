@@ -0,0 +1,342 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "phy/iq_recorder.h"
+
+#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+namespace srsue {
+
+iq_recorder::iq_recorder()
+{
+  log_h           = NULL; 
+  mode            = MODE_NONE; 
+  enabled         = false; 
+  running         = false; 
+  slots           = NULL; 
+  ring_buffer     = NULL; 
+  nof_sf          = 0; 
+  max_sf_len      = 0; 
+  wr_idx          = 0; 
+  rd_idx          = 0; 
+  nof_dropped     = 0; 
+  trigger_pending = TRIGGER_IDLE; 
+  trigger_end     = 0; 
+  trigger_seq     = 0; 
+  last_dump_end   = 0; 
+  nof_triggers    = 0; 
+  fd              = -1; 
+  record_len      = 0; 
+  chunk           = NULL; 
+  chunk_offset    = 0; 
+  chunk_pos       = 0; 
+  file_len        = 0; 
+  nof_written     = 0; 
+}
+
+iq_recorder::~iq_recorder()
+{
+  stop();
+  if (slots) {
+    munlock(slots, nof_sf*sizeof(slot_t));
+    free(slots);
+  }
+  if (ring_buffer) {
+    munlock(ring_buffer, (size_t) nof_sf*max_sf_len*sizeof(cf_t));
+    free(ring_buffer);
+  }
+}
+
+iq_recorder::mode_t iq_recorder::mode_from_string(std::string mode)
+{
+  if (!mode.compare("window")) {
+    return MODE_WINDOW; 
+  } else if (!mode.compare("trigger")) {
+    return MODE_TRIGGER; 
+  } else if (!mode.compare("continuous")) {
+    return MODE_CONTINUOUS; 
+  } 
+  return MODE_NONE; 
+}
+
+bool iq_recorder::init(std::string filename_, mode_t mode_, uint32_t nof_sf_, uint32_t max_sf_len_, srslte::log *log_h_)
+{
+  log_h      = log_h_; 
+  filename   = filename_; 
+  mode       = mode_; 
+  nof_sf     = nof_sf_; 
+  max_sf_len = max_sf_len_; 
+  
+  if (mode == MODE_NONE) {
+    return true; 
+  }
+  if (nof_sf < 4) {
+    log_h->console("Error IQ capture requires at least 4 subframes\n");
+    return false; 
+  }
+  
+  slots       = (slot_t*) malloc(nof_sf*sizeof(slot_t));
+  ring_buffer = (cf_t*) malloc((size_t) nof_sf*max_sf_len*sizeof(cf_t));
+  if (!slots || !ring_buffer) {
+    log_h->console("Error allocating IQ capture buffer of %d subframes\n", nof_sf);
+    return false; 
+  }
+  // Write every page of the ring and lock it in memory so push() never page-faults 
+  // on the synchronization thread
+  memset(slots, 0, nof_sf*sizeof(slot_t));
+  memset(ring_buffer, 0, (size_t) nof_sf*max_sf_len*sizeof(cf_t));
+  if (mlock(slots, nof_sf*sizeof(slot_t)) || mlock(ring_buffer, (size_t) nof_sf*max_sf_len*sizeof(cf_t))) {
+    Warning("Could not lock IQ capture buffer in memory: %s\n", strerror(errno));
+  }
+  for (uint32_t i=0;i<nof_sf;i++) {
+    slots[i].samples = &ring_buffer[(size_t) i*max_sf_len]; 
+  }
+  
+  long page_size = sysconf(_SC_PAGESIZE);
+  record_len = sizeof(iq_record_hdr_t) + max_sf_len*sizeof(cf_t); 
+  record_len = page_size*((record_len + page_size - 1)/page_size);
+  
+  fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    log_h->console("Error opening IQ capture file %s: %s\n", filename.c_str(), strerror(errno));
+    return false; 
+  }
+  file_len     = 0; 
+  chunk        = NULL; 
+  chunk_offset = 0; 
+  chunk_pos    = 0; 
+  nof_written  = 0; 
+  
+  wr_idx          = 0; 
+  rd_idx          = 0; 
+  trigger_pending = TRIGGER_IDLE; 
+  last_dump_end   = 0; 
+  
+  enabled = true; 
+  running = true; 
+  start(WRITER_THREAD_PRIO);
+  
+  log_h->console("Capturing IQ samples to %s, %d subframes ring, %s mode\n", filename.c_str(), nof_sf, 
+                 mode==MODE_WINDOW?"window":(mode==MODE_TRIGGER?"trigger":"continuous"));
+  return true; 
+}
+
+bool iq_recorder::is_enabled()
+{
+  return enabled; 
+}
+
+void iq_recorder::stop()
+{
+  if (!enabled) {
+    return; 
+  }
+  running = false; 
+  wait_thread_finish();
+  
+  // The synchronization thread is stopped, flush whatever is left
+  if (mode == MODE_WINDOW) {
+    dump_window(wr_idx);
+  } else if (mode == MODE_CONTINUOUS) {
+    while (rd_idx < wr_idx) {
+      write_slot(rd_idx, false);
+      rd_idx = rd_idx + 1; 
+    }
+  }
+  close_file();
+  enabled = false; 
+  
+  log_h->console("IQ capture: %lu subframes written to %s, %d triggers, %d dropped\n", 
+                 (unsigned long) nof_written, filename.c_str(), nof_triggers, nof_dropped);
+}
+
+/* Copies one subframe into the ring. Lock-free, single producer */
+void iq_recorder::push(uint32_t tti, cf_t *buffer, uint32_t nof_samples)
+{
+  if (!enabled) {
+    return; 
+  }
+  uint64_t w = wr_idx; 
+  
+  // In continuous mode unread slots can not be overwritten 
+  if (mode == MODE_CONTINUOUS && w - rd_idx >= nof_sf) {
+    nof_dropped++;
+    return; 
+  }
+  
+  slot_t *s = &slots[w%nof_sf]; 
+  s->hdr.magic       = MAGIC; 
+  s->hdr.tti         = tti; 
+  s->hdr.nof_samples = SRSLTE_MIN(nof_samples, max_sf_len); 
+  s->hdr.trigger     = 0; 
+  s->hdr.seq         = w; 
+  memcpy(s->samples, buffer, s->hdr.nof_samples*sizeof(cf_t));
+  
+  // Publish the slot after its content 
+  __sync_synchronize();
+  wr_idx = w + 1; 
+}
+
+void iq_recorder::trigger(const char *reason)
+{
+  if (!enabled || mode != MODE_TRIGGER) {
+    return; 
+  }
+  uint64_t w = wr_idx; 
+  // Ignore triggers until the previous window has been written 
+  if (w < last_dump_end) {
+    return; 
+  }
+  // Claim the trigger, fill the window and only then publish it to the writer thread
+  if (__sync_bool_compare_and_swap(&trigger_pending, TRIGGER_IDLE, TRIGGER_CLAIMED)) {
+    uint64_t seq = w > 0 ? w - 1 : 0; 
+    trigger_seq = seq; 
+    trigger_end = w + nof_sf/2; 
+    __sync_synchronize();
+    trigger_pending = TRIGGER_PENDING; 
+    Info("IQ capture triggered by %s at sf=%lu\n", reason, (unsigned long) seq);
+  }
+}
+
+void iq_recorder::run_thread()
+{
+  while (running) {
+    switch (mode) {
+      case MODE_CONTINUOUS:
+        while (rd_idx < wr_idx) {
+          write_slot(rd_idx, false);
+          __sync_synchronize();
+          rd_idx = rd_idx + 1; 
+        }
+        break;
+      case MODE_TRIGGER:
+        if (trigger_pending == TRIGGER_PENDING) {
+          __sync_synchronize();
+          if (wr_idx >= trigger_end) {
+            dump_window(trigger_end);
+            last_dump_end = trigger_end + nof_sf/2; 
+            nof_triggers++;
+            __sync_synchronize();
+            trigger_pending = TRIGGER_IDLE; 
+          }
+        }
+        break;
+      default:
+        break;
+    }
+    usleep(1000);
+  }
+}
+
+/* Writes the window of subframes ending at sequence number end. The oldest two slots are 
+ * skipped to leave room for the producer while the window is being copied */
+void iq_recorder::dump_window(uint64_t end)
+{
+  uint64_t len   = SRSLTE_MIN(end, (uint64_t) nof_sf - 2); 
+  uint64_t start = end - len; 
+  for (uint64_t idx=start;idx<end;idx++) {
+    write_slot(idx, true);
+  }
+}
+
+bool iq_recorder::write_slot(uint64_t idx, bool check_overwrite)
+{
+  if (chunk_pos == CHUNK_RECORDS || !chunk) {
+    if (!grow_file()) {
+      return false; 
+    }
+  }
+  slot_t  *s   = &slots[idx%nof_sf];
+  uint8_t *dst = &chunk[(size_t) chunk_pos*record_len]; 
+  
+  iq_record_hdr_t hdr; 
+  memcpy(&hdr, &s->hdr, sizeof(iq_record_hdr_t));
+  memcpy(&dst[sizeof(iq_record_hdr_t)], s->samples, hdr.nof_samples*sizeof(cf_t));
+  
+  // Discard the record if the producer has reused the slot meanwhile 
+  __sync_synchronize();
+  if (hdr.seq != idx || (check_overwrite && wr_idx - idx >= nof_sf)) {
+    return false; 
+  }
+  hdr.trigger = (mode == MODE_TRIGGER && idx == trigger_seq) ? 1 : 0; 
+  memcpy(dst, &hdr, sizeof(iq_record_hdr_t));
+  chunk_pos++;
+  nof_written++;
+  return true; 
+}
+
+/* Maps the next chunk of records at the end of the file */
+bool iq_recorder::grow_file()
+{
+  size_t chunk_len = (size_t) CHUNK_RECORDS*record_len; 
+  if (chunk) {
+    munmap(chunk, chunk_len);
+    chunk_offset += chunk_len; 
+    chunk = NULL; 
+  }
+  file_len = chunk_offset + chunk_len; 
+  if (ftruncate(fd, file_len)) {
+    Error("Error resizing IQ capture file: %s\n", strerror(errno));
+    return false; 
+  }
+  void *ptr = mmap(NULL, chunk_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, chunk_offset);
+  if (ptr == MAP_FAILED) {
+    Error("Error mapping IQ capture file: %s\n", strerror(errno));
+    return false; 
+  }
+  chunk     = (uint8_t*) ptr; 
+  chunk_pos = 0; 
+  return true; 
+}
+
+void iq_recorder::close_file()
+{
+  if (chunk) {
+    munmap(chunk, (size_t) CHUNK_RECORDS*record_len);
+    chunk = NULL; 
+  }
+  if (fd >= 0) {
+    // Remove the unused part of the last chunk 
+    if (ftruncate(fd, chunk_offset + (uint64_t) chunk_pos*record_len)) {
+      perror("ftruncate");
+    }
+    close(fd);
+    fd = -1; 
+  }
+}
+
+} // namespace srsue
@@ -0,0 +1,480 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+
+#include "phy/mac_replay.h"
+
+#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+namespace srsue {
+
+mac_replay::mac_replay()
+{
+  mac             = NULL;
+  rrc             = NULL;
+  log_h           = NULL;
+  f               = NULL;
+  realtime        = true;
+  started         = false;
+  running         = false;
+  finished        = false;
+  cur_tti         = 0;
+  prach_tti       = -1;
+  sr_tti          = -1;
+  phr             = 0;
+  pathloss        = 0;
+  cell_is_set     = false;
+  nof_records     = 0;
+  nof_ttis        = 0;
+  nof_dl_bytes    = 0;
+  nof_ul_bytes    = 0;
+  nof_ul_mismatch = 0;
+  nof_diverged    = 0;
+  bzero(&hdr, sizeof(mac_trace::record_hdr_t));
+  bzero(dl_action, sizeof(dl_action));
+  bzero(&pch_action, sizeof(mac_interface_phy::tb_action_dl_t));
+  bzero(dl_len, sizeof(dl_len));
+  pch_len         = 0;
+  bzero(&cell, sizeof(srslte_cell_t));
+  bzero(&config, sizeof(phy_cfg_t));
+  bzero(&start_time, sizeof(struct timeval));
+}
+
+mac_replay::~mac_replay()
+{
+  stop();
+}
+
+bool mac_replay::init(std::string filename_, bool realtime_, mac_interface_phy *mac_, rrc_interface_phy *rrc_,
+                      srslte::log *log_h_)
+{
+  mac      = mac_;
+  rrc      = rrc_;
+  log_h    = log_h_;
+  filename = filename_;
+  realtime = realtime_;
+
+  f = fopen(filename.c_str(), "r");
+  if (!f) {
+    log_h->console("Error opening MAC trace file %s: %s\n", filename.c_str(), strerror(errno));
+    return false;
+  }
+  mac_trace::file_hdr_t file_hdr;
+  if (fread(&file_hdr, sizeof(mac_trace::file_hdr_t), 1, f) != 1 ||
+      file_hdr.magic   != mac_trace::MAGIC ||
+      file_hdr.version != mac_trace::VERSION)
+  {
+    log_h->console("Error %s is not a MAC trace file\n", filename.c_str());
+    fclose(f);
+    f = NULL;
+    return false;
+  }
+  log_h->console("Replaying PHY-MAC interface from %s%s\n", filename.c_str(), realtime?"":" as fast as possible");
+  return true;
+}
+
+void mac_replay::stop()
+{
+  if (started) {
+    running = false;
+    wait_thread_finish();
+    started = false;
+  }
+  if (f) {
+    fclose(f);
+    f = NULL;
+  }
+}
+
+bool mac_replay::is_finished()
+{
+  return finished;
+}
+
+void mac_replay::run_thread()
+{
+  gettimeofday(&start_time, NULL);
+  while (running && read_record()) {
+    play_record();
+    nof_records++;
+  }
+  print_stats();
+  finished = true;
+}
+
+bool mac_replay::read_record()
+{
+  if (fread(&hdr, sizeof(mac_trace::record_hdr_t), 1, f) != 1) {
+    return false;
+  }
+  if (hdr.len > 0 && fread(body, 1, hdr.len, f) != hdr.len) {
+    Error("Truncated record %s in MAC trace\n", mac_trace::type_to_string(hdr.type));
+    return false;
+  }
+  if (hdr.len < mac_trace::min_body_len(hdr.type)) {
+    Error("Invalid record %s in MAC trace, len=%d\n", mac_trace::type_to_string(hdr.type), hdr.len);
+    return false;
+  }
+  return true;
+}
+
+void mac_replay::play_record()
+{
+  mac_interface_phy::mac_grant_t grant;
+  mac_interface_phy::tb_action_ul_t ul_action;
+  mac_trace::tb_decoded_t *tb;
+  mac_interface_phy::tb_action_dl_t *action;
+  uint32_t payload_len;
+  bool ack = (hdr.flags & mac_trace::FLAG_ACK) != 0;
+
+  switch (hdr.type) {
+    case mac_trace::TTI_CLOCK:
+      wait_tti();
+      cur_tti = hdr.tti;
+      nof_ttis++;
+      mac->tti_clock(hdr.tti);
+      // Let the MAC thread run this TTI before the next record, otherwise it races with cur_tti 
+      // and the replay is not repeatable 
+      mac->wait_tti_processed();
+      break;
+    case mac_trace::NEW_GRANT_DL:
+      mac_trace::unpack_grant((mac_trace::grant_t*) body, hdr.tti, &grant);
+      if (grant.rnti_type == SRSLTE_RNTI_PCH) {
+        action  = &pch_action;
+        pch_len = grant.n_bytes;
+      } else if (grant.rnti_type < mac_trace::MAX_RNTI_TYPES && grant.pid < mac_trace::MAX_PIDS) {
+        action = &dl_action[grant.rnti_type][grant.pid];
+        dl_len[grant.rnti_type][grant.pid] = grant.n_bytes;
+      } else {
+        Error("Invalid DL grant in MAC trace\n");
+        break;
+      }
+      bzero(action, sizeof(mac_interface_phy::tb_action_dl_t));
+      mac->new_grant_dl(grant, action);
+      break;
+    case mac_trace::TB_DECODED:
+      tb = (mac_trace::tb_decoded_t*) body;
+      if (tb->rnti_type >= mac_trace::MAX_RNTI_TYPES || tb->pid >= mac_trace::MAX_PIDS) {
+        Error("Invalid TB in MAC trace\n");
+        break;
+      }
+      action      = &dl_action[tb->rnti_type][tb->pid];
+      payload_len = hdr.len - sizeof(mac_trace::tb_decoded_t);
+      if (payload_len > 0) {
+        if (action->decode_enabled && action->payload_ptr && payload_len <= dl_len[tb->rnti_type][tb->pid]) {
+          memcpy(action->payload_ptr, &body[sizeof(mac_trace::tb_decoded_t)], payload_len);
+          nof_dl_bytes += payload_len;
+        } else {
+          Warning("TB pid=%d received but the MAC did not request its decoding\n", tb->pid);
+          nof_diverged++;
+        }
+      }
+      mac->tb_decoded(ack, (srslte_rnti_type_t) tb->rnti_type, tb->pid);
+      // The PHY asks the MAC whether to ACK right after tb_decoded()
+      if (action->generate_ack_callback && action->decode_enabled) {
+        action->generate_ack_callback(action->generate_ack_callback_arg);
+      }
+      bzero(action, sizeof(mac_interface_phy::tb_action_dl_t));
+      break;
+    case mac_trace::PCH_DECODED:
+      if (pch_action.decode_enabled && pch_action.payload_ptr && hdr.len <= pch_len) {
+        memcpy(pch_action.payload_ptr, body, hdr.len);
+        nof_dl_bytes += hdr.len;
+        mac->pch_decoded_ok(hdr.len);
+      } else {
+        nof_diverged++;
+      }
+      bzero(&pch_action, sizeof(mac_interface_phy::tb_action_dl_t));
+      break;
+    case mac_trace::BCH_DECODED:
+      mac->bch_decoded_ok(body, hdr.len);
+      break;
+    case mac_trace::NEW_GRANT_UL:
+    case mac_trace::NEW_GRANT_UL_ACK:
+      play_grant_ul();
+      break;
+    case mac_trace::HARQ_RECV:
+      bzero(&ul_action, sizeof(mac_interface_phy::tb_action_ul_t));
+      mac->harq_recv(hdr.tti, ack, &ul_action);
+      break;
+    case mac_trace::SPS_GRANT_DL:
+      if (mac->get_sps_grant_dl(hdr.tti, &grant) != ((hdr.flags & mac_trace::FLAG_VALID) != 0)) {
+        nof_diverged++;
+      }
+      break;
+    case mac_trace::SPS_GRANT_UL:
+      if (mac->get_sps_grant_ul(hdr.tti, &grant) != ((hdr.flags & mac_trace::FLAG_VALID) != 0)) {
+        nof_diverged++;
+      }
+      break;
+    case mac_trace::SET_CELL:
+      memcpy(&cell, body, sizeof(srslte_cell_t));
+      cell_is_set = true;
+      mac->set_cell(cell);
+      break;
+    case mac_trace::IN_SYNC:
+      rrc->in_sync();
+      break;
+    case mac_trace::OUT_OF_SYNC:
+      rrc->out_of_sync();
+      break;
+    case mac_trace::PRACH_TX_TTI:
+      memcpy((void*) &prach_tti, body, sizeof(int32_t));
+      break;
+    case mac_trace::SR_TX_TTI:
+      memcpy((void*) &sr_tti, body, sizeof(int32_t));
+      break;
+    case mac_trace::PHR:
+      memcpy((void*) &phr, body, sizeof(float));
+      break;
+    case mac_trace::PATHLOSS:
+      memcpy((void*) &pathloss, body, sizeof(float));
+      break;
+    default:
+      Warning("Unknown record type %d in MAC trace\n", hdr.type);
+      break;
+  }
+}
+
+/* Compares the MAC PDU built by the MAC with the recorded one */
+void mac_replay::play_grant_ul()
+{
+  mac_interface_phy::mac_grant_t    grant;
+  mac_interface_phy::tb_action_ul_t action;
+  bzero(&action, sizeof(mac_interface_phy::tb_action_ul_t));
+
+  mac_trace::unpack_grant((mac_trace::grant_t*) body, hdr.tti, &grant);
+  if (hdr.type == mac_trace::NEW_GRANT_UL_ACK) {
+    mac->new_grant_ul_ack(grant, (hdr.flags & mac_trace::FLAG_ACK) != 0, &action);
+  } else {
+    mac->new_grant_ul(grant, &action);
+  }
+
+  uint8_t *rec_pdu = &body[sizeof(mac_trace::grant_t)];
+  uint32_t rec_len = hdr.len - sizeof(mac_trace::grant_t);
+  bool     new_pdu = action.tx_enabled && action.current_tx_nb == 0 && action.payload_ptr;
+  if (new_pdu) {
+    nof_ul_bytes += grant.n_bytes;
+  }
+  if (new_pdu != (rec_len > 0) || (new_pdu && (rec_len != grant.n_bytes || memcmp(rec_pdu, action.payload_ptr, rec_len)))) {
+    Info("UL MAC PDU at tti=%d differs from the recorded one\n", hdr.tti);
+    nof_ul_mismatch++;
+  }
+}
+
+/* In real-time mode each TTI starts 1 ms after the previous, from the first one */
+void mac_replay::wait_tti()
+{
+  if (!realtime) {
+    return;
+  }
+  struct timeval now, elapsed;
+  gettimeofday(&now, NULL);
+  timersub(&now, &start_time, &elapsed);
+  int64_t wait_us = (int64_t) nof_ttis*1000 - ((int64_t) elapsed.tv_sec*1000000 + elapsed.tv_usec);
+  if (wait_us > 0) {
+    usleep(wait_us);
+  }
+}
+
+void mac_replay::print_stats()
+{
+  struct timeval now, elapsed;
+  gettimeofday(&now, NULL);
+  timersub(&now, &start_time, &elapsed);
+  float secs = elapsed.tv_sec + (float) elapsed.tv_usec/1e6;
+  log_h->console("MAC replay: %lu records, %lu TTIs in %.2f s (%.0f TTI/s), DL %lu bytes, UL %lu bytes, "
+                 "%d UL PDU mismatches, %d divergences\n",
+                 (unsigned long) nof_records, (unsigned long) nof_ttis, secs, secs>0?nof_ttis/secs:0,
+                 (unsigned long) nof_dl_bytes, (unsigned long) nof_ul_bytes, nof_ul_mismatch, nof_diverged);
+}
+
+/* PHY interface for MAC */
+
+void mac_replay::configure_prach_params()
+{
+}
+
+/* The MAC starts synchronization once it is ready to receive */
+void mac_replay::sync_start()
+{
+  if (!started && f) {
+    started = true;
+    running = true;
+    start();
+  }
+}
+
+void mac_replay::sync_stop()
+{
+}
+
+void mac_replay::prach_send(uint32_t preamble_idx, int allowed_subframe, float target_power_dbm)
+{
+  Debug("PRACH preamble %d\n", preamble_idx);
+  prach_tti = -1;
+}
+
+int mac_replay::prach_tx_tti()
+{
+  return prach_tti;
+}
+
+void mac_replay::sr_send()
+{
+}
+
+int mac_replay::sr_last_tx_tti()
+{
+  return sr_tti;
+}
+
+void mac_replay::set_timeadv_rar(uint32_t ta_cmd)
+{
+}
+
+void mac_replay::set_timeadv(uint32_t ta_cmd)
+{
+}
+
+void mac_replay::set_rar_grant(uint32_t tti, uint8_t grant_payload[SRSLTE_RAR_GRANT_LEN])
+{
+}
+
+void mac_replay::pdcch_ul_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start, int tti_end)
+{
+}
+
+void mac_replay::pdcch_dl_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start, int tti_end)
+{
+}
+
+void mac_replay::pdcch_ul_search_reset()
+{
+}
+
+void mac_replay::pdcch_dl_search_reset()
+{
+}
+
+void mac_replay::set_sps_rnti(uint16_t rnti)
+{
+}
+
+void mac_replay::set_crnti(uint16_t rnti)
+{
+}
+
+uint32_t mac_replay::get_current_tti()
+{
+  return cur_tti;
+}
+
+float mac_replay::get_phr()
+{
+  return phr;
+}
+
+float mac_replay::get_pathloss_db()
+{
+  return pathloss;
+}
+
+/* PHY interface for RRC */
+
+void mac_replay::get_current_cell(srslte_cell_t *cell_)
+{
+  memcpy(cell_, &cell, sizeof(srslte_cell_t));
+}
+
+void mac_replay::get_config(phy_cfg_t *phy_cfg)
+{
+  memcpy(phy_cfg, &config, sizeof(phy_cfg_t));
+}
+
+void mac_replay::set_config(phy_cfg_t *phy_cfg)
+{
+  memcpy(&config, phy_cfg, sizeof(phy_cfg_t));
+}
+
+void mac_replay::set_config_dedicated(LIBLTE_RRC_PHYSICAL_CONFIG_DEDICATED_STRUCT *dedicated)
+{
+  memcpy(&config.dedicated, dedicated, sizeof(LIBLTE_RRC_PHYSICAL_CONFIG_DEDICATED_STRUCT));
+}
+
+void mac_replay::set_config_common(phy_cfg_common_t *common)
+{
+  memcpy(&config.common, common, sizeof(phy_cfg_common_t));
+}
+
+void mac_replay::set_config_tdd(LIBLTE_RRC_TDD_CONFIG_STRUCT *tdd)
+{
+  memcpy(&config.common.tdd_cnfg, tdd, sizeof(LIBLTE_RRC_TDD_CONFIG_STRUCT));
+}
+
+void mac_replay::set_config_sps_dl(LIBLTE_RRC_SPS_CONFIG_DL_STRUCT *sps_dl)
+{
+  memcpy(&config.sps_dl, sps_dl, sizeof(LIBLTE_RRC_SPS_CONFIG_DL_STRUCT));
+}
+
+void mac_replay::set_config_64qam_en(bool enable)
+{
+  config.enable_64qam = enable;
+}
+
+void mac_replay::set_paging_occasion(uint32_t T, uint32_t pf_offset, uint32_t po_sf)
+{
+}
+
+bool mac_replay::status_is_sync()
+{
+  return cell_is_set && !finished;
+}
+
+void mac_replay::iq_capture_trigger()
+{
+}
+
+void mac_replay::configure_ul_params(bool pregen_disabled)
+{
+}
+
+void mac_replay::reset()
+{
+}
+
+void mac_replay::resync_sfn()
+{
+}
+
+} // namespace srsue
@@ -0,0 +1,504 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <sys/time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+
+#include "phy/mac_trace.h"
+
+#define Error(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->error_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Warning(fmt, ...) if (SRSLTE_DEBUG_ENABLED) log_h->warning_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Info(fmt, ...)    if (SRSLTE_DEBUG_ENABLED) log_h->info_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define Debug(fmt, ...)   if (SRSLTE_DEBUG_ENABLED) log_h->debug_line(__FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+namespace srsue {
+
+/*******************************************************************************
+  Trace format
+*******************************************************************************/
+
+void mac_trace::pack_grant(mac_interface_phy::mac_grant_t *grant, grant_t *g)
+{
+  bzero(g, sizeof(grant_t));
+  g->last_tti  = grant->last_tti;
+  g->n_bytes   = grant->n_bytes;
+  g->rnti      = grant->rnti;
+  g->rnti_type = (uint8_t) grant->rnti_type;
+  g->pid       = (uint8_t) grant->pid;
+  g->rv        = (int8_t) grant->rv;
+  g->sps_n_pucch_idx = (uint8_t) grant->sps_n_pucch_idx;
+  g->flags     = (grant->ndi               ? GRANT_NDI         : 0) |
+                 (grant->last_ndi          ? GRANT_LAST_NDI    : 0) |
+                 (grant->is_from_rar       ? GRANT_FROM_RAR    : 0) |
+                 (grant->is_sps_release    ? GRANT_SPS_RELEASE : 0) |
+                 (grant->is_sps_configured ? GRANT_SPS_CONFIG  : 0) |
+                 (grant->has_cqi_request   ? GRANT_CQI_REQUEST : 0);
+}
+
+void mac_trace::unpack_grant(grant_t *g, uint32_t tti, mac_interface_phy::mac_grant_t *grant)
+{
+  bzero(grant, sizeof(mac_interface_phy::mac_grant_t));
+  grant->tti               = tti;
+  grant->last_tti          = g->last_tti;
+  grant->n_bytes           = g->n_bytes;
+  grant->rnti              = g->rnti;
+  grant->rnti_type         = (srslte_rnti_type_t) g->rnti_type;
+  grant->pid               = g->pid;
+  grant->rv                = g->rv;
+  grant->sps_n_pucch_idx   = g->sps_n_pucch_idx;
+  grant->ndi               = (g->flags & GRANT_NDI)         != 0;
+  grant->last_ndi          = (g->flags & GRANT_LAST_NDI)    != 0;
+  grant->is_from_rar       = (g->flags & GRANT_FROM_RAR)    != 0;
+  grant->is_sps_release    = (g->flags & GRANT_SPS_RELEASE) != 0;
+  grant->is_sps_configured = (g->flags & GRANT_SPS_CONFIG)  != 0;
+  grant->has_cqi_request   = (g->flags & GRANT_CQI_REQUEST) != 0;
+}
+
+const char* mac_trace::type_to_string(uint8_t type)
+{
+  static const char *names[NOF_TYPES] = {"unknown", "tti_clock", "new_grant_dl", "tb_decoded", "pch_decoded",
+                                         "bch_decoded", "new_grant_ul", "new_grant_ul_ack", "harq_recv",
+                                         "sps_grant_dl", "sps_grant_ul", "set_cell", "in_sync", "out_of_sync",
+                                         "prach_tx_tti", "sr_tx_tti", "phr", "pathloss"};
+  return type < NOF_TYPES ? names[type] : names[0];
+}
+
+uint32_t mac_trace::min_body_len(uint8_t type)
+{
+  switch (type) {
+    case NEW_GRANT_DL:
+    case NEW_GRANT_UL:
+    case NEW_GRANT_UL_ACK:
+      return sizeof(grant_t);
+    case TB_DECODED:
+      return sizeof(tb_decoded_t);
+    case SET_CELL:
+      return sizeof(srslte_cell_t);
+    case PRACH_TX_TTI:
+    case SR_TX_TTI:
+      return sizeof(int32_t);
+    case PHR:
+    case PATHLOSS:
+      return sizeof(float);
+    default:
+      return 0;
+  }
+}
+
+/*******************************************************************************
+  Recorder
+*******************************************************************************/
+
+mac_recorder::mac_recorder()
+{
+  mac         = NULL;
+  rrc         = NULL;
+  phy         = NULL;
+  log_h       = NULL;
+  enabled     = false;
+  running     = false;
+  f           = NULL;
+  cur_tti     = 0;
+  nof_records = 0;
+  nof_bytes   = 0;
+  nof_dropped = 0;
+  pch_payload = NULL;
+  bzero(dl_buffer, sizeof(dl_buffer));
+  last_prach_tti = -1;
+  last_sr_tti    = -1;
+  last_phr       = 0;
+  last_pathloss  = 0;
+  pthread_mutex_init(&mutex, NULL);
+}
+
+mac_recorder::~mac_recorder()
+{
+  stop();
+  pthread_mutex_destroy(&mutex);
+}
+
+bool mac_recorder::init(std::string filename_, mac_interface_phy *mac_, rrc_interface_phy *rrc_,
+                        phy_interface_mac *phy_, srslte::log *log_h_)
+{
+  mac      = mac_;
+  rrc      = rrc_;
+  phy      = phy_;
+  log_h    = log_h_;
+  filename = filename_;
+
+  f = fopen(filename.c_str(), "w");
+  if (!f) {
+    log_h->console("Error opening MAC trace file %s: %s\n", filename.c_str(), strerror(errno));
+    return false;
+  }
+
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  mac_trace::file_hdr_t hdr;
+  hdr.magic    = mac_trace::MAGIC;
+  hdr.version  = mac_trace::VERSION;
+  hdr.start_us = (uint64_t) now.tv_sec*1000000 + now.tv_usec;
+  if (fwrite(&hdr, sizeof(mac_trace::file_hdr_t), 1, f) != 1) {
+    log_h->console("Error writing MAC trace file %s\n", filename.c_str());
+    fclose(f);
+    f = NULL;
+    return false;
+  }
+
+  buffer.reserve(MAX_BUFFERED_BYTES);
+  wr_buffer.reserve(MAX_BUFFERED_BYTES);
+
+  enabled = true;
+  running = true;
+  start();
+
+  log_h->console("Recording PHY-MAC interface to %s\n", filename.c_str());
+  return true;
+}
+
+void mac_recorder::stop()
+{
+  if (!enabled) {
+    return;
+  }
+  running = false;
+  wait_thread_finish();
+  write_buffer();
+  fclose(f);
+  f = NULL;
+  enabled = false;
+
+  log_h->console("MAC trace: %lu records, %lu bytes written to %s, %d dropped\n",
+                 (unsigned long) nof_records, (unsigned long) nof_bytes, filename.c_str(), nof_dropped);
+}
+
+void mac_recorder::run_thread()
+{
+  while (running) {
+    write_buffer();
+    usleep(WRITE_PERIOD_US);
+  }
+}
+
+/* Swaps the buffers and writes the filled one without holding the lock */
+void mac_recorder::write_buffer()
+{
+  pthread_mutex_lock(&mutex);
+  buffer.swap(wr_buffer);
+  pthread_mutex_unlock(&mutex);
+
+  if (wr_buffer.size() > 0) {
+    if (fwrite(&wr_buffer[0], 1, wr_buffer.size(), f) != wr_buffer.size()) {
+      Error("Error writing MAC trace file: %s\n", strerror(errno));
+    }
+    nof_bytes += wr_buffer.size();
+    wr_buffer.clear();
+  }
+}
+
+void mac_recorder::record(uint8_t type, uint8_t flags, uint32_t tti,
+                          void *body, uint32_t body_len, uint8_t *payload, uint32_t payload_len)
+{
+  if (!enabled) {
+    return;
+  }
+  if (!payload) {
+    payload_len = 0;
+  }
+  mac_trace::record_hdr_t hdr;
+  hdr.type  = type;
+  hdr.flags = flags;
+  hdr.len   = (uint16_t) (body_len + payload_len);
+  hdr.tti   = tti;
+
+  uint32_t len = sizeof(mac_trace::record_hdr_t) + body_len + payload_len;
+
+  pthread_mutex_lock(&mutex);
+  if (body_len + payload_len > 0xffff || buffer.size() + len > MAX_BUFFERED_BYTES) {
+    nof_dropped++;
+  } else {
+    uint8_t *ptr = (uint8_t*) &hdr;
+    buffer.insert(buffer.end(), ptr, ptr + sizeof(mac_trace::record_hdr_t));
+    if (body_len) {
+      ptr = (uint8_t*) body;
+      buffer.insert(buffer.end(), ptr, ptr + body_len);
+    }
+    if (payload_len) {
+      buffer.insert(buffer.end(), payload, payload + payload_len);
+    }
+    nof_records++;
+  }
+  pthread_mutex_unlock(&mutex);
+}
+
+/* UL grants carry the MAC PDU when the MAC generated a new one */
+void mac_recorder::record_ul(uint8_t type, uint8_t flags, mac_grant_t *grant, tb_action_ul_t *action, uint32_t tti)
+{
+  uint8_t *pdu = NULL;
+  uint32_t len = 0;
+  if (action->tx_enabled && action->current_tx_nb == 0 && action->payload_ptr) {
+    pdu = action->payload_ptr;
+    len = grant ? grant->n_bytes : 0;
+  }
+  if (grant) {
+    mac_trace::grant_t g;
+    mac_trace::pack_grant(grant, &g);
+    record(type, flags, tti, &g, sizeof(mac_trace::grant_t), pdu, len);
+  } else {
+    record(type, flags, tti, NULL, 0);
+  }
+}
+
+/* Values polled by the MAC are only recorded when they change */
+void mac_recorder::record_value(uint8_t type, void *value, void *last, uint32_t len)
+{
+  if (memcmp(value, last, len)) {
+    memcpy(last, value, len);
+    record(type, 0, cur_tti, value, len);
+  }
+}
+
+/* MAC interface for PHY */
+
+void mac_recorder::new_grant_ul(mac_grant_t grant, tb_action_ul_t *action)
+{
+  mac->new_grant_ul(grant, action);
+  record_ul(mac_trace::NEW_GRANT_UL, 0, &grant, action, grant.tti);
+}
+
+void mac_recorder::new_grant_ul_ack(mac_grant_t grant, bool ack, tb_action_ul_t *action)
+{
+  mac->new_grant_ul_ack(grant, ack, action);
+  record_ul(mac_trace::NEW_GRANT_UL_ACK, ack ? mac_trace::FLAG_ACK : 0, &grant, action, grant.tti);
+}
+
+void mac_recorder::harq_recv(uint32_t tti, bool ack, tb_action_ul_t *action)
+{
+  mac->harq_recv(tti, ack, action);
+  record_ul(mac_trace::HARQ_RECV, ack ? mac_trace::FLAG_ACK : 0, NULL, action, tti);
+}
+
+void mac_recorder::new_grant_dl(mac_grant_t grant, tb_action_dl_t *action)
+{
+  mac->new_grant_dl(grant, action);
+
+  if (grant.rnti_type == SRSLTE_RNTI_PCH) {
+    pch_payload = action->payload_ptr;
+  } else if (grant.rnti_type < mac_trace::MAX_RNTI_TYPES && grant.pid < mac_trace::MAX_PIDS) {
+    dl_buffer[grant.rnti_type][grant.pid].ptr = action->decode_enabled ? action->payload_ptr : NULL;
+    dl_buffer[grant.rnti_type][grant.pid].len = grant.n_bytes;
+  }
+  mac_trace::grant_t g;
+  mac_trace::pack_grant(&grant, &g);
+  record(mac_trace::NEW_GRANT_DL, 0, grant.tti, &g, sizeof(mac_trace::grant_t));
+}
+
+bool mac_recorder::get_sps_grant_dl(uint32_t tti, mac_grant_t *grant)
+{
+  bool ret = mac->get_sps_grant_dl(tti, grant);
+  record(mac_trace::SPS_GRANT_DL, ret ? mac_trace::FLAG_VALID : 0, tti, NULL, 0);
+  return ret;
+}
+
+bool mac_recorder::get_sps_grant_ul(uint32_t tti, mac_grant_t *grant)
+{
+  bool ret = mac->get_sps_grant_ul(tti, grant);
+  record(mac_trace::SPS_GRANT_UL, ret ? mac_trace::FLAG_VALID : 0, tti, NULL, 0);
+  return ret;
+}
+
+/* The payload is recorded before the MAC consumes it */
+void mac_recorder::tb_decoded(bool ack, srslte_rnti_type_t rnti_type, uint32_t harq_pid)
+{
+  mac_trace::tb_decoded_t tb;
+  bzero(&tb, sizeof(mac_trace::tb_decoded_t));
+  tb.rnti_type = (uint8_t) rnti_type;
+  tb.pid       = (uint8_t) harq_pid;
+
+  uint8_t *payload = NULL;
+  uint32_t len     = 0;
+  if (ack && rnti_type < mac_trace::MAX_RNTI_TYPES && harq_pid < mac_trace::MAX_PIDS) {
+    payload = dl_buffer[rnti_type][harq_pid].ptr;
+    len     = dl_buffer[rnti_type][harq_pid].len;
+  }
+  record(mac_trace::TB_DECODED, ack ? mac_trace::FLAG_ACK : 0, cur_tti,
+         &tb, sizeof(mac_trace::tb_decoded_t), payload, len);
+  mac->tb_decoded(ack, rnti_type, harq_pid);
+}
+
+void mac_recorder::bch_decoded_ok(uint8_t *payload, uint32_t len)
+{
+  record(mac_trace::BCH_DECODED, 0, cur_tti, NULL, 0, payload, len);
+  mac->bch_decoded_ok(payload, len);
+}
+
+void mac_recorder::set_cell(srslte_cell_t cell)
+{
+  record(mac_trace::SET_CELL, 0, cur_tti, &cell, sizeof(srslte_cell_t));
+  mac->set_cell(cell);
+}
+
+void mac_recorder::pch_decoded_ok(uint32_t len)
+{
+  record(mac_trace::PCH_DECODED, 0, cur_tti, NULL, 0, pch_payload, len);
+  mac->pch_decoded_ok(len);
+}
+
+void mac_recorder::tti_clock(uint32_t tti)
+{
+  cur_tti = tti;
+  record(mac_trace::TTI_CLOCK, 0, tti, NULL, 0);
+  mac->tti_clock(tti);
+}
+
+void mac_recorder::wait_tti_processed()
+{
+  mac->wait_tti_processed();
+}
+
+/* RRC interface for PHY */
+
+void mac_recorder::in_sync()
+{
+  record(mac_trace::IN_SYNC, 0, cur_tti, NULL, 0);
+  rrc->in_sync();
+}
+
+void mac_recorder::out_of_sync()
+{
+  record(mac_trace::OUT_OF_SYNC, 0, cur_tti, NULL, 0);
+  rrc->out_of_sync();
+}
+
+/* PHY interface for MAC */
+
+void mac_recorder::configure_prach_params()
+{
+  phy->configure_prach_params();
+}
+
+void mac_recorder::sync_start()
+{
+  phy->sync_start();
+}
+
+void mac_recorder::sync_stop()
+{
+  phy->sync_stop();
+}
+
+void mac_recorder::prach_send(uint32_t preamble_idx, int allowed_subframe, float target_power_dbm)
+{
+  phy->prach_send(preamble_idx, allowed_subframe, target_power_dbm);
+}
+
+int mac_recorder::prach_tx_tti()
+{
+  int32_t ret = phy->prach_tx_tti();
+  record_value(mac_trace::PRACH_TX_TTI, &ret, &last_prach_tti, sizeof(int32_t));
+  return ret;
+}
+
+void mac_recorder::sr_send()
+{
+  phy->sr_send();
+}
+
+int mac_recorder::sr_last_tx_tti()
+{
+  int32_t ret = phy->sr_last_tx_tti();
+  record_value(mac_trace::SR_TX_TTI, &ret, &last_sr_tti, sizeof(int32_t));
+  return ret;
+}
+
+void mac_recorder::set_timeadv_rar(uint32_t ta_cmd)
+{
+  phy->set_timeadv_rar(ta_cmd);
+}
+
+void mac_recorder::set_timeadv(uint32_t ta_cmd)
+{
+  phy->set_timeadv(ta_cmd);
+}
+
+void mac_recorder::set_rar_grant(uint32_t tti, uint8_t grant_payload[SRSLTE_RAR_GRANT_LEN])
+{
+  phy->set_rar_grant(tti, grant_payload);
+}
+
+void mac_recorder::pdcch_ul_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start, int tti_end)
+{
+  phy->pdcch_ul_search(rnti_type, rnti, tti_start, tti_end);
+}
+
+void mac_recorder::pdcch_dl_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start, int tti_end)
+{
+  phy->pdcch_dl_search(rnti_type, rnti, tti_start, tti_end);
+}
+
+void mac_recorder::pdcch_ul_search_reset()
+{
+  phy->pdcch_ul_search_reset();
+}
+
+void mac_recorder::pdcch_dl_search_reset()
+{
+  phy->pdcch_dl_search_reset();
+}
+
+void mac_recorder::set_sps_rnti(uint16_t rnti)
+{
+  phy->set_sps_rnti(rnti);
+}
+
+void mac_recorder::set_crnti(uint16_t rnti)
+{
+  phy->set_crnti(rnti);
+}
+
+uint32_t mac_recorder::get_current_tti()
+{
+  return phy->get_current_tti();
+}
+
+float mac_recorder::get_phr()
+{
+  float ret = phy->get_phr();
+  record_value(mac_trace::PHR, &ret, &last_phr, sizeof(float));
+  return ret;
+}
+
+float mac_recorder::get_pathloss_db()
+{
+  float ret = phy->get_pathloss_db();
+  record_value(mac_trace::PATHLOSS, &ret, &last_pathloss, sizeof(float));
+  return ret;
+}
+
+} // namespace srsue
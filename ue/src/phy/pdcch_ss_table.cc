@@ -0,0 +1,146 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <strings.h>
+
+#include "phy/pdcch_ss_table.h"
+
+namespace srsue {
+
+pdcch_ss_table::pdcch_ss_table()
+{
+  reset();
+}
+
+void pdcch_ss_table::reset()
+{
+  rnti    = 0; 
+  cur_sps_rnti = 0; 
+  is_init = false; 
+  bzero(ue_ss,     sizeof(ue_ss));
+  bzero(common_ss, sizeof(common_ss));
+}
+
+bool pdcch_ss_table::is_set(uint16_t rnti_)
+{
+  return is_init && rnti == rnti_; 
+}
+
+bool pdcch_ss_table::set_rnti(srslte_regs_t *regs, uint16_t rnti_)
+{
+  reset();
+  for (uint32_t cfi=0;cfi<3;cfi++) {
+    int nof_cce = srslte_regs_pdcch_ncce(regs, cfi+1);
+    if (nof_cce < 0) {
+      return false; 
+    }
+    for (uint32_t sf_idx=0;sf_idx<SRSLTE_NSUBFRAMES_X_FRAME;sf_idx++) {
+      ue_ss[cfi][sf_idx].nof_loc = srslte_pdcch_ue_locations_ncce(nof_cce, ue_ss[cfi][sf_idx].loc, 
+                                                                   MAX_CANDIDATES_UE, sf_idx, rnti_);
+    }
+    common_ss[cfi].nof_loc = srslte_pdcch_common_locations_ncce(nof_cce, common_ss[cfi].loc, MAX_CANDIDATES_COMMON);
+  }
+  rnti    = rnti_; 
+  is_init = true; 
+  return true; 
+}
+
+bool pdcch_ss_table::is_rnti(uint16_t crc_rem)
+{
+  return crc_rem == rnti || (cur_sps_rnti && crc_rem == cur_sps_rnti);
+}
+
+/* Decodes one candidate with Format 0/1A and, in the UE-specific search space, Format 1 */
+bool pdcch_ss_table::decode(srslte_pdcch_t *pdcch, srslte_dci_location_t *loc, bool is_ue_ss, 
+                            bool find_dl, bool find_ul, result_t *result)
+{
+  srslte_dci_msg_t msg; 
+  uint16_t         crc_rem = 0; 
+  
+  if (srslte_pdcch_decode_msg(pdcch, &msg, loc, SRSLTE_DCI_FORMAT1A, &crc_rem) == SRSLTE_SUCCESS && is_rnti(crc_rem)) {
+    // Format 0 and 1A have the same size and are told apart by the first bit
+    if (msg.data[0] && find_dl && !result->dl_found) {
+      msg.format = SRSLTE_DCI_FORMAT1A; 
+      memcpy(&result->dl_msg, &msg, sizeof(srslte_dci_msg_t));
+      result->dl_loc   = *loc; 
+      result->dl_found = true; 
+      result->dl_sps   = crc_rem != rnti; 
+      return true; 
+    } else if (!msg.data[0] && find_ul && !result->ul_found) {
+      msg.format = SRSLTE_DCI_FORMAT0; 
+      memcpy(&result->ul_msg, &msg, sizeof(srslte_dci_msg_t));
+      result->ul_loc   = *loc; 
+      result->ul_found = true; 
+      result->ul_sps   = crc_rem != rnti; 
+      return true; 
+    }
+  }
+  if (is_ue_ss && find_dl && !result->dl_found) {
+    if (srslte_pdcch_decode_msg(pdcch, &msg, loc, SRSLTE_DCI_FORMAT1, &crc_rem) == SRSLTE_SUCCESS && is_rnti(crc_rem)) {
+      msg.format = SRSLTE_DCI_FORMAT1; 
+      memcpy(&result->dl_msg, &msg, sizeof(srslte_dci_msg_t));
+      result->dl_loc   = *loc; 
+      result->dl_found = true; 
+      result->dl_sps   = crc_rem != rnti; 
+      return true; 
+    }
+  }
+  return false; 
+}
+
+/* Two passes over the candidates: first those with aggregation level first_L, then the rest */
+bool pdcch_ss_table::search_space(srslte_pdcch_t *pdcch, candidates_t *ss, bool is_ue_ss, uint32_t first_L, 
+                                  bool find_dl, bool find_ul, result_t *result)
+{
+  for (uint32_t pass=0;pass<2;pass++) {
+    for (uint32_t i=0;i<ss->nof_loc;i++) {
+      if ((ss->loc[i].L == first_L) == (pass == 0)) {
+        decode(pdcch, &ss->loc[i], is_ue_ss, find_dl, find_ul, result);
+        if ((!find_dl || result->dl_found) && (!find_ul || result->ul_found)) {
+          return true; 
+        }
+      }
+    }
+  }
+  return false; 
+}
+
+bool pdcch_ss_table::search(srslte_pdcch_t *pdcch, uint32_t cfi, uint32_t sf_idx, uint32_t first_L, 
+                            bool find_dl, bool find_ul, result_t *result, uint16_t sps_rnti)
+{
+  bzero(result, sizeof(result_t));
+  cur_sps_rnti = sps_rnti; 
+  if (!is_init || cfi < 1 || cfi > 3 || sf_idx >= SRSLTE_NSUBFRAMES_X_FRAME) {
+    return false; 
+  }
+  if (search_space(pdcch, &ue_ss[cfi-1][sf_idx], true, first_L, find_dl, find_ul, result)) {
+    return true; 
+  }
+  return search_space(pdcch, &common_ss[cfi-1], false, first_L, find_dl, find_ul, result);
+}
+
+} // namespace srsue
@@ -59,9 +59,18 @@ phch_common::phch_common(uint32_t max_mutex_) : tx_mutex(max_mutex_)
   p0_preamble = 0; 
   cur_radio_power = 0; 
   rx_gain_offset = 0; 
+  pdcch_last_L = 0; 
   sr_last_tx_tti = -1;
   cur_pusch_power = 0;
+  sps_rnti = 0; 
+  paging_T = 0; 
+  paging_pf_offset = 0; 
+  paging_po_sf = 0; 
   bzero(zeros, 50000*sizeof(cf_t));
+  pthread_mutex_init(&ul_rs_mutex, NULL);
+  pthread_mutex_init(&config_mutex, NULL);
+  config_version = 0; 
+  config_pregen_disabled = false; 
 
   bzero(&dl_metrics, sizeof(dl_metrics_t));
   dl_metrics_read = true;
@@ -87,6 +96,8 @@ void phch_common::init(phy_interface_rrc::phy_cfg_t *_config, phy_args_t *_args,
   for (int i=0;i<nof_mutex;i++) {
     pthread_mutex_init(&tx_mutex[i], NULL);
   }
+  
+  publish_config();
 }
 
 void phch_common::set_nof_mutex(uint32_t nof_mutex_) {
@@ -117,6 +128,13 @@ bool phch_common::dl_rnti_active(uint32_t tti) {
           ret = false; 
         }
       }
+    } else if (dl_rnti_type == SRSLTE_RNTI_PCH) {
+      // In idle mode only the paging occasion is monitored, all other subframes skip FFT and PDCCH
+      if (paging_T > 0) {
+        if ((tti/10)%paging_T != paging_pf_offset || (tti%10) != paging_po_sf) {
+          ret = false; 
+        }
+      }
     }
     return ret; 
   } else {
@@ -189,6 +207,30 @@ void phch_common::set_dl_rnti(srslte_rnti_type_t type, uint16_t rnti_value, int
   Debug("Set DL rnti: start=%d, end=%d, value=0x%x\n", tti_start, tti_end, rnti_value);  
 }
 
+void phch_common::set_sps_rnti(uint16_t rnti_value) {
+  sps_rnti = rnti_value; 
+  Debug("Set SPS C-RNTI: value=0x%x\n", rnti_value);
+}
+
+uint16_t phch_common::get_sps_rnti() {
+  return sps_rnti; 
+}
+
+void phch_common::set_pdcch_last_L(uint32_t L) {
+  __atomic_store_n(&pdcch_last_L, L, __ATOMIC_RELAXED);
+}
+
+uint32_t phch_common::get_pdcch_last_L() {
+  return __atomic_load_n(&pdcch_last_L, __ATOMIC_RELAXED);
+}
+
+void phch_common::set_paging_occasion(uint32_t T, uint32_t pf_offset, uint32_t po_sf) {
+  paging_T         = T; 
+  paging_pf_offset = T>0?pf_offset%T:0; 
+  paging_po_sf     = po_sf%10; 
+  Debug("Set paging occasion: T=%d, pf_offset=%d, po_sf=%d\n", T, pf_offset, po_sf);
+}
+
 void phch_common::reset_pending_ack(uint32_t tti) {
   pending_ack[tti%10].enabled = false; 
 }
@@ -255,6 +297,52 @@ void phch_common::worker_end(uint32_t tti, bool tx_enable,
 }    
 
 
+void phch_common::set_ul_rs_cfg(srslte_cell_t c, 
+                                srslte_refsignal_dmrs_pusch_cfg_t *dmrs_cfg, 
+                                srslte_pucch_cfg_t *pucch_cfg, 
+                                srslte_refsignal_srs_cfg_t *srs_cfg) 
+{
+  pthread_mutex_lock(&ul_rs_mutex);
+  ul_rs_table_ptr cur = boost::atomic_load(&ul_rs);
+  if (!cur || !cur->is_cfg(c, dmrs_cfg, pucch_cfg, srs_cfg)) {
+    ul_rs_table_ptr t(new ul_rs_table());
+    if (t->init(c, dmrs_cfg, pucch_cfg, srs_cfg)) {
+      // Workers still holding the previous table release it at the end of their subframe
+      boost::atomic_store(&ul_rs, t);
+      Debug("New UL reference signal table for nof_prb=%d\n", c.nof_prb);
+    } else {
+      Error("Initiating UL reference signal table\n");
+      boost::atomic_store(&ul_rs, ul_rs_table_ptr());
+    }
+  }
+  pthread_mutex_unlock(&ul_rs_mutex);
+}
+
+ul_rs_table_ptr phch_common::get_ul_rs_table() {
+  return boost::atomic_load(&ul_rs);
+}
+
+void phch_common::publish_config()
+{
+  publish_config(config_pregen_disabled);
+}
+
+void phch_common::publish_config(bool pregen_disabled)
+{
+  pthread_mutex_lock(&config_mutex);
+  config_version++;
+  config_pregen_disabled = pregen_disabled; 
+  // Workers still using the previous snapshot release it at the end of their subframe
+  phy_config_ptr c(new phy_config(config_version, config, args, pregen_disabled));
+  boost::atomic_store(&cur_config, c);
+  Debug("Published PHY configuration version %d\n", config_version);
+  pthread_mutex_unlock(&config_mutex);
+}
+
+phy_config_ptr phch_common::get_config() {
+  return boost::atomic_load(&cur_config);
+}
+
 void phch_common::set_cell(const srslte_cell_t &c) {
   cell = c;
 }
@@ -25,6 +25,8 @@
  */
 
 #include <unistd.h>
+#include <stdlib.h>
+#include <math.h>
 #include "srslte/srslte.h"
 #include "common/log.h"
 #include "phy/phch_worker.h"
@@ -63,6 +65,41 @@ void phch_recv::init(srslte::radio* _radio_handler, mac_interface_phy *_mac, rrc
   
   nof_tx_mutex = MUTEX_X_WORKER*workers_pool->get_nof_workers();
   worker_com->set_nof_mutex(nof_tx_mutex);
+  
+  // Parse list of EARFCN to scan. Entries that are not a number or not in a known band are ignored
+  scan_freq.clear();
+  std::string earfcn_list = worker_com->args->cell_search_earfcn; 
+  size_t pos = 0; 
+  while (pos < earfcn_list.length()) {
+    size_t end = earfcn_list.find(',', pos);
+    if (end == std::string::npos) {
+      end = earfcn_list.length();
+    }
+    if (end > pos) {
+      std::string item = earfcn_list.substr(pos, end-pos);
+      char *endptr = NULL; 
+      long earfcn = strtol(item.c_str(), &endptr, 10);
+      float freq = -1; 
+      if (endptr != item.c_str() && *endptr == '\0' && earfcn >= 0) {
+        freq = srslte_band_fd((uint32_t) earfcn);
+      }
+      if (freq < 0) {
+        log_h->console("Invalid EARFCN %s in cell search list, ignoring it\n", item.c_str());
+      } else {
+        scan_freq.push_back(freq);
+      }
+    }
+    pos = end + 1; 
+  }
+  parallel_search = worker_com->args->cell_search_parallel || scan_freq.size() > 0; 
+  warm_start      = false; 
+  warm_start_tried = false; 
+  if (parallel_search) {
+    if (!scanner.init(SCAN_NOF_HALF_FRAMES, log_h, prio)) {
+      Error("Initiating cell scanner. Using sequential cell search\n");
+      parallel_search = false; 
+    }
+  }
     
   start(prio);
 }
@@ -179,55 +216,61 @@ bool phch_recv::cell_search(int force_N_id_2)
   
   srslte_ue_cellsearch_result_t found_cells[3];
   srslte_ue_cellsearch_t        cs; 
+  int ret = SRSLTE_ERROR; 
 
   bzero(found_cells, 3*sizeof(srslte_ue_cellsearch_result_t));
 
   log_h->console("Searching for cell...\n");
-  if (srslte_ue_cellsearch_init(&cs, SRSLTE_DEFAULT_MAX_FRAMES_PSS, radio_recv_wrapper_cs, radio_h)) {
-    Error("Initiating UE cell search\n");
-    return false; 
-  }
+  if (parallel_search) {
+    if (!cell_scan(force_N_id_2)) {
+      return false; 
+    }
+  } else {
+    if (srslte_ue_cellsearch_init(&cs, SRSLTE_DEFAULT_MAX_FRAMES_PSS, radio_recv_wrapper_cs, radio_h)) {
+      Error("Initiating UE cell search\n");
+      return false; 
+    }
   
-  srslte_ue_cellsearch_set_nof_valid_frames(&cs, SRSLTE_DEFAULT_NOF_VALID_PSS_FRAMES);
+    srslte_ue_cellsearch_set_nof_valid_frames(&cs, SRSLTE_DEFAULT_NOF_VALID_PSS_FRAMES);
   
-  // Set options defined in expert section 
-  set_ue_sync_opts(&cs.ue_sync); 
+    // Set options defined in expert section 
+    set_ue_sync_opts(&cs.ue_sync); 
   
-  if (do_agc) {
-    srslte_ue_sync_start_agc(&cs.ue_sync, callback_set_rx_gain, last_gain);
-  }
+    if (do_agc) {
+      srslte_ue_sync_start_agc(&cs.ue_sync, callback_set_rx_gain, last_gain);
+    }
   
-  radio_h->set_rx_srate(1.92e6);
-  radio_h->start_rx();
+    radio_h->set_rx_srate(1.92e6);
+    radio_h->start_rx();
   
-  /* Find a cell in the given N_id_2 or go through the 3 of them to find the strongest */
-  uint32_t max_peak_cell = 0;
-  int ret = SRSLTE_ERROR; 
+    /* Find a cell in the given N_id_2 or go through the 3 of them to find the strongest */
+    uint32_t max_peak_cell = 0;
   
-  if (force_N_id_2 >= 0 && force_N_id_2 < 3) {
-    ret = srslte_ue_cellsearch_scan_N_id_2(&cs, force_N_id_2, &found_cells[force_N_id_2]);
-    max_peak_cell = force_N_id_2;
-  } else {
-    ret = srslte_ue_cellsearch_scan(&cs, found_cells, &max_peak_cell); 
-  }
+    if (force_N_id_2 >= 0 && force_N_id_2 < 3) {
+      ret = srslte_ue_cellsearch_scan_N_id_2(&cs, force_N_id_2, &found_cells[force_N_id_2]);
+      max_peak_cell = force_N_id_2;
+    } else {
+      ret = srslte_ue_cellsearch_scan(&cs, found_cells, &max_peak_cell); 
+    }
 
-  last_gain = srslte_agc_get_gain(&cs.ue_sync.agc);
+    last_gain = srslte_agc_get_gain(&cs.ue_sync.agc);
 
-  radio_h->stop_rx();
-  srslte_ue_cellsearch_free(&cs);
+    radio_h->stop_rx();
+    srslte_ue_cellsearch_free(&cs);
   
-  if (ret < 0) {
-    Error("Error decoding MIB: Error searching PSS\n");
-    return false;
-  } else if (ret == 0) {
-    Error("Error decoding MIB: Could not find any PSS in this frequency\n");
-    return false;
-  }
+    if (ret < 0) {
+      Error("Error decoding MIB: Error searching PSS\n");
+      return false;
+    } else if (ret == 0) {
+      Error("Error decoding MIB: Could not find any PSS in this frequency\n");
+      return false;
+    }
     
-  // Save result 
-  cell.id   = found_cells[max_peak_cell].cell_id;
-  cell.cp   = found_cells[max_peak_cell].cp; 
-  cellsearch_cfo = found_cells[max_peak_cell].cfo;
+    // Save result 
+    cell.id   = found_cells[max_peak_cell].cell_id;
+    cell.cp   = found_cells[max_peak_cell].cp; 
+    cellsearch_cfo = found_cells[max_peak_cell].cfo;
+  }
   
   log_h->console("Found CELL ID: %d CP: %s, CFO: %.1f KHz.\nTrying to decode MIB...\n", 
                  cell.id, srslte_cp_string(cell.cp), cellsearch_cfo/1000);
@@ -268,6 +311,7 @@ bool phch_recv::cell_search(int force_N_id_2)
     cellsearch_cfo = srslte_ue_sync_get_cfo(&ue_mib_sync.ue_sync);
     
     srslte_bit_pack_vector(bch_payload, bch_payload_bits, SRSLTE_BCH_PAYLOAD_LEN);
+    mac->set_cell(cell);
     mac->bch_decoded_ok(bch_payload_bits, SRSLTE_BCH_PAYLOAD_LEN/8);
     return true;     
   } else {
@@ -277,6 +321,152 @@ bool phch_recv::cell_search(int force_N_id_2)
 }
 
 
+/* Captures one block per EARFCN and searches the 3 N_id_2 in parallel. If several EARFCN 
+ * are given, the cell with the highest received power is selected and the radio tuned to it */
+bool phch_recv::cell_scan(int force_N_id_2)
+{
+  cell_scanner::result_t results[3];
+  
+  float dl_freq    = radio_h->get_rx_freq();
+  float duplex     = radio_h->get_tx_freq() - dl_freq; 
+  float best_freq  = dl_freq; 
+  float best_rsrp  = 0; 
+  bool  found      = false; 
+  
+  std::vector<float> freqs = scan_freq; 
+  if (freqs.size() == 0) {
+    freqs.push_back(dl_freq);
+  }
+  
+  radio_h->set_rx_srate(1.92e6);
+  if (do_agc) {
+    radio_h->set_rx_gain_th(last_gain);
+  }
+  
+  for (uint32_t f=0;f<freqs.size();f++) {
+    if (scan_freq.size() > 0) {
+      radio_h->set_rx_freq(freqs[f]);
+    }
+    
+    // Capture a single block for all hypotheses 
+    cf_t    *buffer = scanner.get_buffer();
+    uint32_t len    = scanner.get_buffer_len();
+    uint32_t n      = 0; 
+    radio_h->start_rx();
+    while (n < len) {
+      uint32_t nsamples = SRSLTE_MIN(len - n, cell_scanner::HALF_FRAME_LEN); 
+      if (!radio_h->rx_now(&buffer[n], nsamples, NULL)) {
+        break; 
+      }
+      n += nsamples; 
+    }
+    radio_h->stop_rx();
+    if (n < len) {
+      Error("Error receiving samples for cell search\n");
+      continue; 
+    }
+    
+    int idx = scanner.scan(SCAN_NOF_HALF_FRAMES/2, results, force_N_id_2);
+    if (idx < 0) {
+      log_h->console("Scan %.1f MHz: no cell found\n", freqs[f]/1e6);
+      continue; 
+    }
+    log_h->console("Scan %.1f MHz: CELL ID %d, peak %.1f, RSRP %.1f dB\n", 
+                   freqs[f]/1e6, results[idx].cell_id, results[idx].peak, results[idx].rsrp_db);
+    
+    if (!found || results[idx].rsrp_db > best_rsrp) {
+      found          = true; 
+      best_rsrp      = results[idx].rsrp_db; 
+      best_freq      = freqs[f]; 
+      cell.id        = results[idx].cell_id; 
+      cell.cp        = results[idx].cp; 
+      cellsearch_cfo = results[idx].cfo; 
+    }
+  }
+  
+  if (scan_freq.size() > 0) {
+    radio_h->set_rx_freq(best_freq);
+    radio_h->set_tx_freq(best_freq + duplex);
+    if (found) {
+      log_h->console("Selected DL=%.1f MHz, UL=%.1f MHz\n", best_freq/1e6, (best_freq + duplex)/1e6);
+    }
+  }
+  if (!found) {
+    Error("Error decoding MIB: Could not find any PSS\n");
+  }
+  return found; 
+}
+
+
+/* Loads the last serving cell. It is only used if it was found in the configured frequency 
+ * or in one of the EARFCN to scan */
+bool phch_recv::cell_cache_load()
+{
+  if (!worker_com->args->cell_cache_filename.length()) {
+    return false; 
+  }
+  std::string filename = worker_com->args->cell_cache_filename + ".cell"; 
+  FILE *f = fopen(filename.c_str(), "r");
+  if (!f) {
+    return false; 
+  }
+  cell_cache_t c; 
+  bool valid = fread(&c, sizeof(cell_cache_t), 1, f) == 1 && c.magic == CELL_CACHE_MAGIC; 
+  fclose(f);
+  if (!valid) {
+    Warning("Invalid cell cache file %s\n", filename.c_str());
+    return false; 
+  }
+  
+  bool freq_ok = c.dl_freq == radio_h->get_rx_freq(); 
+  for (uint32_t i=0;i<scan_freq.size();i++) {
+    if (scan_freq[i] == c.dl_freq) {
+      freq_ok = true; 
+    }
+  }
+  if (!freq_ok) {
+    Info("Cached cell at %.1f MHz not in the configured frequencies\n", c.dl_freq/1e6);
+    return false; 
+  }
+  
+  radio_h->set_rx_freq(c.dl_freq);
+  radio_h->set_tx_freq(c.ul_freq);
+  memcpy(&cell, &c.cell, sizeof(srslte_cell_t));
+  cellsearch_cfo = c.cfo; 
+  last_gain      = c.gain; 
+  if (!do_agc) {
+    last_gain = radio_h->get_rx_gain();
+  }
+  log_h->console("Using cached cell ID: %d, PRB: %d, CFO: %.1f KHz at %.1f MHz\n", 
+                 cell.id, cell.nof_prb, cellsearch_cfo/1000, c.dl_freq/1e6);
+  return true; 
+}
+
+void phch_recv::cell_cache_save()
+{
+  if (!worker_com->args->cell_cache_filename.length()) {
+    return; 
+  }
+  cell_cache_t c; 
+  bzero(&c, sizeof(cell_cache_t));
+  c.magic   = CELL_CACHE_MAGIC; 
+  c.dl_freq = radio_h->get_rx_freq();
+  c.ul_freq = radio_h->get_tx_freq();
+  c.cfo     = srslte_ue_sync_get_cfo(&ue_sync);
+  c.gain    = do_agc?srslte_agc_get_gain(&ue_sync.agc):radio_h->get_rx_gain();
+  memcpy(&c.cell, &cell, sizeof(srslte_cell_t));
+  
+  std::string filename = worker_com->args->cell_cache_filename + ".cell"; 
+  FILE *f = fopen(filename.c_str(), "w");
+  if (!f || fwrite(&c, sizeof(cell_cache_t), 1, f) != 1) {
+    Warning("Error writing cell cache file %s\n", filename.c_str());
+  }
+  if (f) {
+    fclose(f);
+  }
+}
+
+
 int phch_recv::sync_sfn(void) {
   
   cf_t *sf_buffer = NULL; 
@@ -300,7 +490,27 @@ int phch_recv::sync_sfn(void) {
         return -1; 
       } else if (n == SRSLTE_UE_MIB_FOUND) {  
         uint32_t sfn; 
+        uint32_t cached_nof_prb = cell.nof_prb; 
         srslte_pbch_mib_unpack(bch_payload, &cell, &sfn);
+        
+        if (warm_start) {
+          // The cached cell was not confirmed by a MIB yet 
+          if (cell.nof_prb != cached_nof_prb) {
+            log_h->console("Cached cell has changed bandwidth. Searching...\n");
+            warm_start = false; 
+            free_cell();
+            radio_h->stop_rx();
+            radio_is_streaming = false; 
+            phy_state = CELL_SEARCH; 
+            return 0; 
+          }
+          uint8_t bch_payload_bits[SRSLTE_BCH_PAYLOAD_LEN/8];
+          worker_com->set_cell(cell);
+          srslte_bit_pack_vector(bch_payload, bch_payload_bits, SRSLTE_BCH_PAYLOAD_LEN);
+          mac->set_cell(cell);
+          mac->bch_decoded_ok(bch_payload_bits, SRSLTE_BCH_PAYLOAD_LEN/8);
+          warm_start = false; 
+        }
 
         sfn = (sfn + sfn_offset)%1024;         
         tti = sfn*10;
@@ -330,7 +540,10 @@ void phch_recv::run_thread()
   while(running) {
     switch(phy_state) {
       case CELL_SEARCH:
-        if (cell_search()) {
+        // The cached cell is only tried once after sync_start()
+        warm_start = !warm_start_tried && cell_cache_load();
+        warm_start_tried = true; 
+        if (warm_start || cell_search()) {
           log_h->console("Initializating cell configuration...\n");
           init_cell();
           float srate = (float) srslte_sampling_freq_hz(cell.nof_prb); 
@@ -371,11 +584,22 @@ void phch_recv::run_thread()
           case 1:
             srslte_ue_sync_set_agc_period(&ue_sync, 20);
             phy_state = SYNC_DONE;  
+            cell_cache_save();
             break;        
           case 0:
             break;        
         } 
         sync_sfn_cnt++;
+        if (warm_start && phy_state == SYNCING && sync_sfn_cnt >= WARM_START_TIMEOUT) {
+          log_h->console("Could not synchronize to cached cell. Searching...\n");
+          warm_start = false; 
+          sync_sfn_cnt = 0; 
+          free_cell();
+          radio_h->stop_rx();
+          radio_is_streaming = false; 
+          phy_state = CELL_SEARCH; 
+          break; 
+        }
         if (sync_sfn_cnt >= SYNC_SFN_TIMEOUT) {
           sync_sfn_cnt = 0; 
           radio_h->stop_rx();
@@ -430,6 +654,7 @@ void phch_recv::run_thread()
               worker_com->p0_preamble = prach_buffer->get_p0_preamble();
               worker_com->cur_radio_power = SRSLTE_MIN(SRSLTE_PC_MAX, worker_com->pathloss + worker_com->p0_preamble);
             }            
+            worker_com->iq_rec.push(tti, buffer, SRSLTE_SF_LEN_PRB(cell.nof_prb));
             workers_pool->start_worker(worker);             
             // Notify RRC in-sync every 1 frame
             if ((tti%10) == 0) {
@@ -441,6 +666,7 @@ void phch_recv::run_thread()
             log_h->error("Sync error. Sending out-of-sync to RRC\n");
             // Notify RRC of out-of-sync frame
             rrc->out_of_sync();
+            worker_com->iq_rec.trigger("sync error");
             worker->release();
             worker_com->reset_ul();            
             phy_state = SYNCING;
@@ -477,6 +703,7 @@ void phch_recv::get_current_cell(srslte_cell_t* cell_)
 void phch_recv::sync_start()
 {
   radio_h->set_master_clock_rate(30.72e6);        
+  warm_start_tried = false; 
   phy_state = CELL_SEARCH;
 }
 
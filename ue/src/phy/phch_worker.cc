@@ -78,8 +78,13 @@ void phch_worker::reset()
   bzero(&srs_cfg, sizeof(srslte_refsignal_srs_cfg_t));
   bzero(&period_cqi, sizeof(srslte_cqi_periodic_cfg_t));
   I_sr = 0; 
+  cfg.reset();
+  pdcch_ss.reset();
+  pdcch_ul_searched = false; 
   rnti_is_set     = false; 
   rar_cqi_request = false; 
+  sps_ack_pending = false; 
+  sps_n_pucch     = 0; 
   cfi = 0;
 }
 
@@ -110,6 +115,19 @@ bool phch_worker::init_cell(srslte_cell_t cell_)
   }
   srslte_ue_ul_set_normalization(&ue_ul, true);
   srslte_ue_ul_set_cfo_enable(&ue_ul, true);
+  
+  // Pointer arrays into the shared UL signal table, filled for each grant 
+  if (!ul_rs_table::alloc_ue_ul(&ue_ul)) {
+    Error("Allocating UL signal pointers\n");
+    return false; 
+  }
+  
+  // Apply the current configuration to the new DL/UL objects in the next TTI 
+  cfg.reset();
+  
+  if (rnti_is_set && !pdcch_ss.set_rnti(&ue_dl.regs, crnti)) {
+    Error("Computing PDCCH search space for RNTI=0x%x\n", crnti);
+  }
     
   cell_initiated = true; 
   
@@ -123,6 +141,7 @@ void phch_worker::free_cell()
       free(signal_buffer);
     }
     srslte_ue_dl_free(&ue_dl);
+    ul_rs_table::free_ue_ul(&ue_ul);
     srslte_ue_ul_free(&ue_ul);
   }
 }
@@ -155,7 +174,11 @@ void phch_worker::set_crnti(uint16_t rnti)
 {
   srslte_ue_dl_set_rnti(&ue_dl, rnti);
   srslte_ue_ul_set_rnti(&ue_ul, rnti);
+  crnti       = rnti; 
   rnti_is_set = true; 
+  if (cell_initiated && !pdcch_ss.set_rnti(&ue_dl.regs, rnti)) {
+    Error("Computing PDCCH search space for RNTI=0x%x\n", rnti);
+  }
 }
 
 void phch_worker::work_imp()
@@ -166,6 +189,12 @@ void phch_worker::work_imp()
   
   Debug("TTI %d running\n", tti);
 
+  /* Switch to the latest configuration snapshot */
+  phy_config_ptr c = phy->get_config();
+  if (c != cfg) {
+    set_config(c);
+  }
+
 #ifdef LOG_EXECTIME
   gettimeofday(&logtime_start[1], NULL);
 #endif
@@ -177,6 +206,8 @@ void phch_worker::work_imp()
   bool dl_grant_available = false; 
   bool ul_grant_available = false; 
   bool dl_ack = false;
+  
+  pdcch_ul_searched = false; 
 
   mac_interface_phy::mac_grant_t    dl_mac_grant;
   mac_interface_phy::tb_action_dl_t dl_action; 
@@ -194,6 +225,32 @@ void phch_worker::work_imp()
     
     /* PDCCH DL + PDSCH */
     dl_grant_available = decode_pdcch_dl(&dl_mac_grant); 
+    
+    /* SPS activation. The MAC stores the assignment and its first occurrence, in this subframe, is received 
+     * below as a configured assignment with the HARQ process derived from the TTI. Its HARQ-ACK still goes 
+     * in the PUCCH resource of the PDCCH */
+    bool sps_activation = dl_grant_available && dl_mac_grant.rnti_type == SRSLTE_RNTI_SPS && 
+                          !dl_mac_grant.ndi && !dl_mac_grant.is_sps_release; 
+    if (sps_activation) {
+      phy->mac->new_grant_dl(dl_mac_grant, &dl_action);
+      dl_grant_available = false; 
+    }
+    
+    /* Configured SPS assignment, PDSCH without PDCCH. HARQ-ACK goes in the n1PUCCH-AN-Persistent resource 
+     * selected by the TPC field of the activation (36.213 Table 9.2-2) */
+    bool sps_no_pucch = false; 
+    if (!dl_grant_available && phy->get_sps_rnti()) {
+      dl_grant_available = phy->mac->get_sps_grant_dl(tti, &dl_mac_grant);
+      if (dl_grant_available && !sps_activation) {
+        if (dl_mac_grant.sps_n_pucch_idx < cfg->nof_sps_n_pucch_1) {
+          sps_ack_pending = true; 
+          sps_n_pucch     = cfg->sps_n_pucch_1[dl_mac_grant.sps_n_pucch_idx];
+        } else {
+          sps_no_pucch = true; 
+          Warning("SPS: No n1PUCCH-AN-Persistent resource for index %d, HARQ-ACK not sent\n", dl_mac_grant.sps_n_pucch_idx);
+        }
+      }
+    }
     if(dl_grant_available) {
       /* Send grant to MAC and get action for this TB */
       phy->mac->new_grant_dl(dl_mac_grant, &dl_action);
@@ -211,7 +268,7 @@ void phch_worker::work_imp()
         Debug("Calling generate ACK callback returned=%d\n", dl_ack);
       }
       Debug("dl_ack=%d, generate_ack=%d\n", dl_ack, dl_action.generate_ack);
-      if (dl_action.generate_ack) {
+      if (dl_action.generate_ack && !sps_no_pucch) {
         set_uci_ack(dl_ack);
       }
     }
@@ -228,6 +285,9 @@ void phch_worker::work_imp()
 
   /* Check if we have UL grant. ul_phy_grant will be overwritten by new grant */
   ul_grant_available = decode_pdcch_ul(&ul_mac_grant);
+  if (!ul_grant_available && phy->get_sps_rnti()) {
+    ul_grant_available = phy->mac->get_sps_grant_ul(tti, &ul_mac_grant);
+  }
 
   /* Generate CQI reports if required, note that in case both aperiodic
       and periodic ones present, only aperiodic is sent (36.213 section 7.2) */
@@ -299,22 +359,6 @@ bool phch_worker::extract_fft_and_pdcch_llr() {
   /* Without a grant, we might need to do fft processing if need to decode PHICH */
   if (phy->get_pending_ack(tti) || decode_pdcch) {
     
-    // Setup estimator filter 
-    float w_coeff = phy->args->estimator_fil_w; 
-    if (w_coeff > 0.0) {
-      srslte_chest_dl_set_smooth_filter3_coeff(&ue_dl.chest, w_coeff); 
-    } else if (w_coeff == 0.0) {
-      srslte_chest_dl_set_smooth_filter(&ue_dl.chest, NULL, 0); 
-    }
-    
-    if (!phy->args->snr_estim_alg.compare("refs")) {
-      srslte_chest_dl_set_noise_alg(&ue_dl.chest, SRSLTE_NOISE_ALG_REFS);
-    } else if (!phy->args->snr_estim_alg.compare("empty")) {
-      srslte_chest_dl_set_noise_alg(&ue_dl.chest, SRSLTE_NOISE_ALG_EMPTY);
-    } else {
-      srslte_chest_dl_set_noise_alg(&ue_dl.chest, SRSLTE_NOISE_ALG_PSS);      
-    }
-  
     if (srslte_ue_dl_decode_fft_estimate(&ue_dl, signal_buffer, tti%10, &cfi) < 0) {
       Error("Getting PDCCH FFT estimate\n");
       return false; 
@@ -327,7 +371,7 @@ bool phch_worker::extract_fft_and_pdcch_llr() {
     
     float noise_estimate = phy->avg_noise;
     
-    if (!phy->args->equalizer_mode.compare("zf")) {
+    if (cfg->equalizer == phy_config::EQUALIZER_ZF) {
       noise_estimate = 0; 
     }
 
@@ -364,7 +408,21 @@ bool phch_worker::decode_pdcch_dl(srsue::mac_interface_phy::mac_grant_t* grant)
     
     Debug("Looking for RNTI=0x%x\n", dl_rnti);
     
-    if (srslte_ue_dl_find_dl_dci_type(&ue_dl, cfi, tti%10, dl_rnti, type, &dci_msg) != 1) {
+    if (type == SRSLTE_RNTI_USER && pdcch_ss.is_set(dl_rnti)) {
+      /* Look also for the UL DCI in the same pass if enabled */
+      bool find_ul = phy->args->pdcch_early_stop && phy->get_ul_rnti(tti) == dl_rnti; 
+      pdcch_ss.search(&ue_dl.pdcch, cfi, tti%10, phy->get_pdcch_last_L(), true, find_ul, &pdcch_res, phy->get_sps_rnti());
+      pdcch_ul_searched = find_ul; 
+      if (!pdcch_res.dl_found) {
+        return false; 
+      }
+      memcpy(&dci_msg, &pdcch_res.dl_msg, sizeof(srslte_dci_msg_t));
+      ue_dl.last_location = pdcch_res.dl_loc; 
+      phy->set_pdcch_last_L(pdcch_res.dl_loc.L); 
+      if (pdcch_res.dl_sps) {
+        return decode_pdcch_dl_sps(&dci_msg, grant);
+      }
+    } else if (srslte_ue_dl_find_dl_dci_type(&ue_dl, cfi, tti%10, dl_rnti, type, &dci_msg) != 1) {
       return false; 
     }
     
@@ -382,6 +440,9 @@ bool phch_worker::decode_pdcch_dl(srsue::mac_interface_phy::mac_grant_t* grant)
     grant->rnti = dl_rnti; 
     grant->rnti_type = type; 
     grant->last_tti = 0;
+    grant->is_sps_release    = false; 
+    grant->is_sps_configured = false; 
+    grant->sps_n_pucch_idx   = 0; 
     
     last_dl_pdcch_ncce = srslte_ue_dl_get_ncce(&ue_dl);
 
@@ -399,6 +460,112 @@ bool phch_worker::decode_pdcch_dl(srsue::mac_interface_phy::mac_grant_t* grant)
   }
 }
 
+/* Resource block assignment of a DCI format 0 or 1A set to all ones, as required by a SPS release. The field 
+ * follows the format flag and the hopping or localized/distributed flag (36.212 5.3.3.1.1 and 5.3.3.1.3) */
+static bool dci_rb_assignment_all_ones(srslte_dci_msg_t *dci_msg, uint32_t nof_prb)
+{
+  uint32_t nof_bits = 0; 
+  while ((1u<<nof_bits) < nof_prb*(nof_prb+1)/2) {
+    nof_bits++;
+  }
+  if (2+nof_bits > dci_msg->nof_bits) {
+    return false; 
+  }
+  for (uint32_t i=2;i<2+nof_bits;i++) {
+    if (!dci_msg->data[i]) {
+      return false; 
+    }
+  }
+  return true; 
+}
+
+/* UL DCI scrambled with the SPS C-RNTI. With NDI=0 it is only a valid activation or release if the fields 
+ * in 36.213 Table 9.2-1/9.2-1A are set as specified, otherwise it is ignored */
+bool phch_worker::check_pdcch_ul_sps(srslte_dci_msg_t *dci_msg, bool *is_release)
+{
+  srslte_ra_ul_dci_t dci_unpacked;
+  
+  *is_release = false; 
+  if (srslte_dci_msg_unpack_pusch(dci_msg, &dci_unpacked, cell.nof_prb)) {
+    Error("Unpacking SPS UL DCI\n");
+    return false; 
+  }
+  if (!dci_unpacked.ndi) {
+    if (dci_unpacked.tpc_pusch != 0 || dci_unpacked.n_dmrs != 0) {
+      Info("PDCCH: Invalid SPS UL activation/release, tpc=%d, n_dmrs=%d\n", dci_unpacked.tpc_pusch, dci_unpacked.n_dmrs);
+      return false; 
+    }
+    if (dci_unpacked.mcs_idx == 31) {
+      if (!dci_rb_assignment_all_ones(dci_msg, cell.nof_prb)) {
+        Info("PDCCH: Invalid SPS UL release, resource block assignment not all ones\n");
+        return false; 
+      }
+      *is_release = true; 
+    } else if (dci_unpacked.mcs_idx >= 16) {
+      Info("PDCCH: Invalid SPS UL activation, mcs=%d\n", dci_unpacked.mcs_idx);
+      return false; 
+    }
+  }
+  return true; 
+}
+
+/* DL DCI scrambled with the SPS C-RNTI. With NDI=0 it activates or releases the configured assignment and 
+ * is only valid if the fields in 36.213 Table 9.2-1/9.2-1A are set as specified, otherwise it is ignored */
+bool phch_worker::decode_pdcch_dl_sps(srslte_dci_msg_t *dci_msg, mac_interface_phy::mac_grant_t *grant)
+{
+  srslte_ra_dl_dci_t dci_unpacked;
+  
+  if (srslte_dci_msg_unpack_pdsch(dci_msg, &dci_unpacked, cell.nof_prb, cell.nof_ports, true)) {
+    Error("Unpacking SPS DL DCI\n");
+    return false; 
+  }
+  
+  bool is_release = false; 
+  if (!dci_unpacked.ndi) {
+    if (dci_unpacked.harq_process != 0 || dci_unpacked.rv_idx != 0) {
+      Info("PDCCH: Invalid SPS DL activation/release, pid=%d, rv=%d\n", dci_unpacked.harq_process, dci_unpacked.rv_idx);
+      return false; 
+    }
+    if (dci_msg->format == SRSLTE_DCI_FORMAT1A && dci_unpacked.mcs_idx == 31) {
+      if (!dci_rb_assignment_all_ones(dci_msg, cell.nof_prb)) {
+        Info("PDCCH: Invalid SPS DL release, resource block assignment not all ones\n");
+        return false; 
+      }
+      is_release = true; 
+    } else if (dci_unpacked.mcs_idx >= 16) {
+      Info("PDCCH: Invalid SPS DL activation, mcs=%d\n", dci_unpacked.mcs_idx);
+      return false; 
+    }
+  }
+  
+  if (!is_release) {
+    if (srslte_dci_msg_to_dl_grant(dci_msg, phy->get_sps_rnti(), cell.nof_prb, cell.nof_ports, &dci_unpacked, &grant->phy_grant.dl)) {
+      Error("Converting SPS DCI message to DL grant\n");
+      return false;   
+    }
+    grant->n_bytes = grant->phy_grant.dl.mcs.tbs/8;
+  } else {
+    grant->n_bytes = 0; 
+  }
+  
+  grant->ndi       = dci_unpacked.ndi;
+  grant->pid       = dci_unpacked.harq_process;
+  grant->tti       = tti; 
+  grant->rv        = dci_unpacked.rv_idx;
+  grant->rnti      = phy->get_sps_rnti(); 
+  grant->rnti_type = SRSLTE_RNTI_SPS; 
+  grant->last_tti  = 0;
+  grant->is_sps_release    = is_release; 
+  grant->is_sps_configured = false; 
+  grant->sps_n_pucch_idx   = (!dci_unpacked.ndi && !is_release)?dci_unpacked.tpc_pucch:0; 
+  
+  last_dl_pdcch_ncce = srslte_ue_dl_get_ncce(&ue_dl);
+  
+  Info("PDCCH: DL DCI %s for SPS C-RNTI, %s, cce_index=%2d, L=%d\n", srslte_dci_format_string(dci_msg->format), 
+       is_release?"release":(dci_unpacked.ndi?"retx":"activation"), last_dl_pdcch_ncce, (1<<ue_dl.last_location.L));
+  return true; 
+}
+
 bool phch_worker::decode_pdsch(srslte_ra_dl_grant_t *grant, uint8_t *payload, 
                                srslte_softbuffer_rx_t* softbuffer, int rv, uint16_t rnti, uint32_t harq_pid)
 {
@@ -414,7 +581,7 @@ bool phch_worker::decode_pdsch(srslte_ra_dl_grant_t *grant, uint8_t *payload,
         
         float noise_estimate = srslte_chest_dl_get_noise_estimate(&ue_dl.chest);
         
-        if (!phy->args->equalizer_mode.compare("zf")) {
+        if (cfg->equalizer == phy_config::EQUALIZER_ZF) {
           noise_estimate = 0; 
         }
         
@@ -444,6 +611,10 @@ bool phch_worker::decode_pdsch(srslte_ra_dl_grant_t *grant, uint8_t *payload,
               10*log10(srslte_chest_dl_get_snr(&ue_dl.chest)), 
               srslte_pdsch_last_noi(&ue_dl.pdsch),
               timestr);
+        
+        if (!ack) {
+          phy->iq_rec.trigger("PDSCH CRC error");
+        }
 
         //printf("tti=%d, cfo=%f\n", tti, cfo*15000);
         //srslte_vec_save_file("pdsch", signal_buffer, sizeof(cf_t)*SRSLTE_SF_LEN_PRB(cell.nof_prb));
@@ -497,6 +668,9 @@ bool phch_worker::decode_pdcch_ul(mac_interface_phy::mac_grant_t* grant)
   srslte_rnti_type_t type = phy->get_ul_rnti_type();
   
   bool ret = false; 
+  bool is_sps = false; 
+  grant->is_sps_release    = false; 
+  grant->is_sps_configured = false; 
   if (phy->get_pending_rar(tti, &rar_grant)) {
 
     if (srslte_dci_rar_to_ul_grant(&rar_grant, cell.nof_prb, pusch_hopping.hopping_offset, 
@@ -513,10 +687,44 @@ bool phch_worker::decode_pdcch_ul(mac_interface_phy::mac_grant_t* grant)
   } else {
     ul_rnti = phy->get_ul_rnti(tti);
     if (ul_rnti) {
-      if (srslte_ue_dl_find_ul_dci(&ue_dl, cfi, tti%10, ul_rnti, &dci_msg) != 1) {
+      if (type == SRSLTE_RNTI_USER && pdcch_ss.is_set(ul_rnti)) {
+        /* Skip the search if it was already done together with the DL search */
+        if (!pdcch_ul_searched) {
+          pdcch_ss.search(&ue_dl.pdcch, cfi, tti%10, phy->get_pdcch_last_L(), false, true, &pdcch_res, phy->get_sps_rnti());
+        }
+        if (!pdcch_res.ul_found) {
+          return false; 
+        }
+        memcpy(&dci_msg, &pdcch_res.ul_msg, sizeof(srslte_dci_msg_t));
+        ue_dl.last_location_ul = pdcch_res.ul_loc; 
+        phy->set_pdcch_last_L(pdcch_res.ul_loc.L); 
+        is_sps                 = pdcch_res.ul_sps; 
+      } else if (srslte_ue_dl_find_ul_dci(&ue_dl, cfi, tti%10, ul_rnti, &dci_msg) != 1) {
         return false; 
       }
       
+      if (is_sps) {
+        if (!check_pdcch_ul_sps(&dci_msg, &grant->is_sps_release)) {
+          return false; 
+        }
+        ul_rnti = phy->get_sps_rnti(); 
+        type    = SRSLTE_RNTI_SPS; 
+        if (grant->is_sps_release) {
+          // The resource allocation of a release is not a valid grant 
+          grant->ndi       = false; 
+          grant->pid       = 0; 
+          grant->n_bytes   = 0; 
+          grant->tti       = tti; 
+          grant->rnti      = ul_rnti; 
+          grant->rv        = 0; 
+          grant->rnti_type = type; 
+          grant->is_from_rar     = false; 
+          grant->has_cqi_request = false; 
+          Info("PDCCH: UL DCI Format0 for SPS C-RNTI, release\n");
+          return true; 
+        }
+      }
+      
       if (srslte_dci_msg_to_ul_grant(&dci_msg, cell.nof_prb, pusch_hopping.hopping_offset, 
         &dci_unpacked, &grant->phy_grant.ul, tti)) 
       {
@@ -544,7 +752,7 @@ bool phch_worker::decode_pdcch_ul(mac_interface_phy::mac_grant_t* grant)
   }
   
   /* Limit UL modulation if not supported by the UE or disabled by higher layers */
-  if (!phy->config->enable_64qam) {
+  if (!cfg->config.enable_64qam) {
     if (grant->phy_grant.ul.mcs.mod == SRSLTE_MOD_64QAM) {
       grant->phy_grant.ul.mcs.mod = SRSLTE_MOD_16QAM;
       grant->phy_grant.ul.Qm      = 4;
@@ -577,6 +785,7 @@ bool phch_worker::decode_pdcch_ul(mac_interface_phy::mac_grant_t* grant)
 void phch_worker::reset_uci()
 {
   bzero(&uci_data, sizeof(srslte_uci_data_t));
+  sps_ack_pending = false; 
 }
 
 void phch_worker::set_uci_ack(bool ack)
@@ -635,8 +844,8 @@ void phch_worker::set_uci_periodic_cqi()
 
 void phch_worker::set_uci_aperiodic_cqi()
 {
-  if (phy->config->dedicated.cqi_report_cnfg.report_mode_aperiodic_present) {
-    switch(phy->config->dedicated.cqi_report_cnfg.report_mode_aperiodic) {
+  if (cfg->config.dedicated.cqi_report_cnfg.report_mode_aperiodic_present) {
+    switch(cfg->config.dedicated.cqi_report_cnfg.report_mode_aperiodic) {
       case LIBLTE_RRC_CQI_REPORT_MODE_APERIODIC_RM30:
         /* only Higher Layer-configured subband feedback support right now, according to TS36.213 section 7.2.1
           - A UE shall report a wideband CQI value which is calculated assuming transmission on set S subbands
@@ -662,7 +871,7 @@ void phch_worker::set_uci_aperiodic_cqi()
         break;
       default:
         Warning("Received CQI request but mode %s is not supported\n", 
-                liblte_rrc_cqi_report_mode_aperiodic_text[phy->config->dedicated.cqi_report_cnfg.report_mode_aperiodic]);
+                liblte_rrc_cqi_report_mode_aperiodic_text[cfg->config.dedicated.cqi_report_cnfg.report_mode_aperiodic]);
         break;
     }
   } else {
@@ -696,6 +905,15 @@ void phch_worker::encode_pusch(srslte_ra_ul_grant_t *grant, uint8_t *payload, ui
     Error("Configuring UL grant\n");
   }
   
+  /* Keep a reference to the shared table until the signal is encoded */
+  ul_rs_table_ptr ul_rs; 
+  if (pregen_enabled && !cfg->pregen_disabled) {
+    ul_rs = phy->get_ul_rs_table();
+    if (ul_rs && !ul_rs->set_ue_ul(&ue_ul, grant->L_prb, grant->ncs_dmrs, (tti+4)%10)) {
+      ul_rs.reset();
+    }
+  }
+  
   if (srslte_ue_ul_pusch_encode_rnti_softbuffer(&ue_ul, 
                                                 payload, uci_data, 
                                                 softbuffer,
@@ -704,6 +922,7 @@ void phch_worker::encode_pusch(srslte_ra_ul_grant_t *grant, uint8_t *payload, ui
   {
     Error("Encoding PUSCH\n");
   }
+  ue_ul.signals_pregenerated = false; 
     
   float p0_preamble = 0; 
   if (is_from_rar) {
@@ -752,9 +971,17 @@ void phch_worker::encode_pucch()
     gettimeofday(&t[1], NULL);
 #endif
 
-    if (srslte_ue_ul_pucch_encode(&ue_ul, uci_data, last_dl_pdcch_ncce, (tti+4)%10240, signal_buffer)) {
+    /* The encoder computes n_pucch = n_cce + N_pucch_1. The HARQ-ACK of a configured SPS assignment uses 
+     * the n1PUCCH-AN-Persistent resource instead, so it is passed as is with N_pucch_1 = 0 */
+    uint32_t n_pucch = last_dl_pdcch_ncce + pucch_sched.N_pucch_1; 
+    if (sps_ack_pending && uci_data.uci_ack_len > 0) {
+      n_pucch = sps_n_pucch; 
+    }
+    ue_ul.pucch_sched.N_pucch_1 = 0; 
+    if (srslte_ue_ul_pucch_encode(&ue_ul, uci_data, n_pucch, (tti+4)%10240, signal_buffer)) {
       Error("Encoding PUCCH\n");
     }
+    ue_ul.pucch_sched.N_pucch_1 = pucch_sched.N_pucch_1; 
 
 #ifdef LOG_EXECTIME
   gettimeofday(&logtime_start[2], NULL);
@@ -767,9 +994,9 @@ void phch_worker::encode_pucch()
   float tx_power = srslte_ue_ul_pucch_power(&ue_ul, phy->pathloss, ue_ul.last_pucch_format, uci_data.uci_cqi_len, uci_data.uci_ack_len);
   float gain = set_power(tx_power);  
   
-  Info("PUCCH: power=%.2f dBm, tti_tx=%d, n_cce=%3d, ack=%s, sr=%s, cfo=%.1f Hz%s\n", 
+  Info("PUCCH: power=%.2f dBm, tti_tx=%d, n_pucch=%3d, ack=%s, sr=%s, cfo=%.1f Hz%s\n", 
          tx_power, (tti+4)%10240, 
-         last_dl_pdcch_ncce, uci_data.uci_ack_len>0?(uci_data.uci_ack?"1":"0"):"no",uci_data.scheduling_request?"yes":"no", 
+         n_pucch, uci_data.uci_ack_len>0?(uci_data.uci_ack?"1":"0"):"no",uci_data.scheduling_request?"yes":"no", 
          cfo*15000, timestr);        
   }   
   
@@ -783,10 +1010,21 @@ void phch_worker::encode_srs()
   char timestr[64];
   timestr[0]='\0';
   
+  ul_rs_table_ptr ul_rs; 
+  if (pregen_enabled && !cfg->pregen_disabled) {
+    ul_rs = phy->get_ul_rs_table();
+    cf_t *r_srs = ul_rs?ul_rs->get_srs((tti+4)%10):NULL; 
+    if (r_srs) {
+      ue_ul.pregen_srs.r[(tti+4)%10] = r_srs; 
+      ue_ul.signals_pregenerated = true; 
+    }
+  }
+  
   if (srslte_ue_ul_srs_encode(&ue_ul, (tti+4)%10240, signal_buffer)) 
   {
     Error("Encoding SRS\n");
   }
+  ue_ul.signals_pregenerated = false; 
 
 #ifdef LOG_EXECTIME
   gettimeofday(&logtime_start[2], NULL);
@@ -805,114 +1043,41 @@ void phch_worker::encode_srs()
 void phch_worker::enable_pregen_signals(bool enabled)
 {
   pregen_enabled = enabled; 
-  if (enabled) {
-    Info("Pre-generating UL signals worker=%d\n", get_id());
-    srslte_ue_ul_pregen_signals(&ue_ul);
-    Info("Done pre-generating signals worker=%d\n", get_id());
+  if (enabled && cell_initiated && cfg && !cfg->pregen_disabled) {
+    Info("Using shared UL signal table worker=%d\n", get_id());
+    phy->set_ul_rs_cfg(cell, &dmrs_cfg, &pucch_cfg, &srs_cfg);
   }
 }
 
-void phch_worker::set_ul_params(bool pregen_disabled)
+/* Applies a configuration snapshot. Called at the start of the TTI, before any DL/UL processing */
+void phch_worker::set_config(phy_config_ptr c)
 {
-  phy_interface_rrc::phy_cfg_common_t         *common    = &phy->config->common;
-  LIBLTE_RRC_PHYSICAL_CONFIG_DEDICATED_STRUCT *dedicated = &phy->config->dedicated;
+  cfg = c; 
   
-  Info("Setting new params worker_id=%d, pregen_disabled=%d\n", get_id(), pregen_disabled);
+  Info("Setting new params worker_id=%d, version=%d\n", get_id(), cfg->version);
   
-  /* PUSCH DMRS signal configuration */
-  bzero(&dmrs_cfg, sizeof(srslte_refsignal_dmrs_pusch_cfg_t));    
-  dmrs_cfg.group_hopping_en    = common->pusch_cnfg.ul_rs.group_hopping_enabled;
-  dmrs_cfg.sequence_hopping_en = common->pusch_cnfg.ul_rs.sequence_hopping_enabled;
-  dmrs_cfg.cyclic_shift        = common->pusch_cnfg.ul_rs.cyclic_shift;
-  dmrs_cfg.delta_ss            = common->pusch_cnfg.ul_rs.group_assignment_pusch;
-  
-  /* PUSCH Hopping configuration */
-  bzero(&pusch_hopping, sizeof(srslte_pusch_hopping_cfg_t));
-  pusch_hopping.n_sb           = common->pusch_cnfg.n_sb;
-  pusch_hopping.hop_mode       = common->pusch_cnfg.hopping_mode == LIBLTE_RRC_HOPPING_MODE_INTRA_AND_INTER_SUBFRAME ? 
-                                  pusch_hopping.SRSLTE_PUSCH_HOP_MODE_INTRA_SF : 
-                                  pusch_hopping.SRSLTE_PUSCH_HOP_MODE_INTER_SF; 
-  pusch_hopping.hopping_offset = common->pusch_cnfg.pusch_hopping_offset;
-
-  /* PUSCH UCI configuration */
-  bzero(&uci_cfg, sizeof(srslte_uci_cfg_t));
-  uci_cfg.I_offset_ack         = dedicated->pusch_cnfg_ded.beta_offset_ack_idx;
-  uci_cfg.I_offset_cqi         = dedicated->pusch_cnfg_ded.beta_offset_cqi_idx;
-  uci_cfg.I_offset_ri          = dedicated->pusch_cnfg_ded.beta_offset_ri_idx;
-  
-  /* PUCCH configuration */  
-  bzero(&pucch_cfg, sizeof(srslte_pucch_cfg_t));
-  pucch_cfg.delta_pucch_shift  = liblte_rrc_delta_pucch_shift_num[common->pucch_cnfg.delta_pucch_shift%LIBLTE_RRC_DELTA_PUCCH_SHIFT_N_ITEMS];
-  pucch_cfg.N_cs               = common->pucch_cnfg.n_cs_an;
-  pucch_cfg.n_rb_2             = common->pucch_cnfg.n_rb_cqi;
-  pucch_cfg.srs_configured     = dedicated->srs_ul_cnfg_ded.setup_present;
-  if (pucch_cfg.srs_configured) {
-    pucch_cfg.srs_cs_subf_cfg    = liblte_rrc_srs_subfr_config_num[common->srs_ul_cnfg.subfr_cnfg%LIBLTE_RRC_SRS_SUBFR_CONFIG_N_ITEMS];
-    pucch_cfg.srs_simul_ack      = common->srs_ul_cnfg.ack_nack_simul_tx;
-  }
-  
-  /* PUCCH Scheduling configuration */
-  bzero(&pucch_sched, sizeof(srslte_pucch_sched_t));
-  pucch_sched.n_pucch_1[0]     = 0; // TODO: n_pucch_1 for SPS
-  pucch_sched.n_pucch_1[1]     = 0;
-  pucch_sched.n_pucch_1[2]     = 0;
-  pucch_sched.n_pucch_1[3]     = 0;
-  pucch_sched.N_pucch_1        = common->pucch_cnfg.n1_pucch_an;
-  pucch_sched.n_pucch_2        = dedicated->cqi_report_cnfg.report_periodic.pucch_resource_idx;
-  pucch_sched.n_pucch_sr       = dedicated->sched_request_cnfg.sr_pucch_resource_idx;
-
-  /* SRS Configuration */
-  bzero(&srs_cfg, sizeof(srslte_refsignal_srs_cfg_t));
-  srs_cfg.configured           = dedicated->srs_ul_cnfg_ded.setup_present;
-  if (pucch_cfg.srs_configured) {
-    srs_cfg.subframe_config      = liblte_rrc_srs_subfr_config_num[common->srs_ul_cnfg.subfr_cnfg%LIBLTE_RRC_SRS_SUBFR_CONFIG_N_ITEMS];
-    srs_cfg.bw_cfg               = liblte_rrc_srs_bw_config_num[common->srs_ul_cnfg.bw_cnfg%LIBLTE_RRC_SRS_BW_CONFIG_N_ITEMS];
-    srs_cfg.I_srs                = dedicated->srs_ul_cnfg_ded.srs_cnfg_idx;
-    srs_cfg.B                    = dedicated->srs_ul_cnfg_ded.srs_bandwidth;
-    srs_cfg.b_hop                = dedicated->srs_ul_cnfg_ded.srs_hopping_bandwidth;
-    srs_cfg.n_rrc                = dedicated->srs_ul_cnfg_ded.freq_domain_pos;
-    srs_cfg.k_tc                 = dedicated->srs_ul_cnfg_ded.tx_comb;
-    srs_cfg.n_srs                = dedicated->srs_ul_cnfg_ded.cyclic_shift;
+  /* DL channel estimator */
+  if (cfg->filter_len >= 0) {
+    srslte_chest_dl_set_smooth_filter(&ue_dl.chest, (float*) cfg->filter, cfg->filter_len); 
   }
+  srslte_chest_dl_set_noise_alg(&ue_dl.chest, cfg->noise_alg);
   
-  /* UL power control configuration */
-  bzero(&power_ctrl, sizeof(srslte_ue_ul_powerctrl_t));
-  power_ctrl.p0_nominal_pusch  = common->ul_pwr_ctrl.p0_nominal_pusch;
-  power_ctrl.alpha             = liblte_rrc_ul_power_control_alpha_num[common->ul_pwr_ctrl.alpha%LIBLTE_RRC_UL_POWER_CONTROL_ALPHA_N_ITEMS];
-  power_ctrl.p0_nominal_pucch  = common->ul_pwr_ctrl.p0_nominal_pucch;
-  power_ctrl.delta_f_pucch[0]  = liblte_rrc_delta_f_pucch_format_1_num[common->ul_pwr_ctrl.delta_flist_pucch.format_1%LIBLTE_RRC_DELTA_F_PUCCH_FORMAT_1_N_ITEMS];
-  power_ctrl.delta_f_pucch[1]  = liblte_rrc_delta_f_pucch_format_1b_num[common->ul_pwr_ctrl.delta_flist_pucch.format_1b%LIBLTE_RRC_DELTA_F_PUCCH_FORMAT_1B_N_ITEMS];
-  power_ctrl.delta_f_pucch[2]  = liblte_rrc_delta_f_pucch_format_2_num[common->ul_pwr_ctrl.delta_flist_pucch.format_2%LIBLTE_RRC_DELTA_F_PUCCH_FORMAT_2_N_ITEMS];
-  power_ctrl.delta_f_pucch[3]  = liblte_rrc_delta_f_pucch_format_2a_num[common->ul_pwr_ctrl.delta_flist_pucch.format_2a%LIBLTE_RRC_DELTA_F_PUCCH_FORMAT_2A_N_ITEMS];
-  power_ctrl.delta_f_pucch[4]  = liblte_rrc_delta_f_pucch_format_2b_num[common->ul_pwr_ctrl.delta_flist_pucch.format_2b%LIBLTE_RRC_DELTA_F_PUCCH_FORMAT_2B_N_ITEMS];
-  
-  power_ctrl.delta_preamble_msg3 = common->ul_pwr_ctrl.delta_preamble_msg3;
-  
-  power_ctrl.p0_ue_pusch       = dedicated->ul_pwr_ctrl_ded.p0_ue_pusch;
-  power_ctrl.delta_mcs_based   = dedicated->ul_pwr_ctrl_ded.delta_mcs_en==LIBLTE_RRC_DELTA_MCS_ENABLED_EN0;
-  power_ctrl.acc_enabled       = dedicated->ul_pwr_ctrl_ded.accumulation_en;
-  power_ctrl.p0_ue_pucch       = dedicated->ul_pwr_ctrl_ded.p0_ue_pucch;
-  power_ctrl.p_srs_offset      = dedicated->ul_pwr_ctrl_ded.p_srs_offset;
+  /* UL parameters */
+  memcpy(&dmrs_cfg,      &cfg->dmrs_cfg,      sizeof(srslte_refsignal_dmrs_pusch_cfg_t));
+  memcpy(&pusch_hopping, &cfg->pusch_hopping, sizeof(srslte_pusch_hopping_cfg_t));
+  memcpy(&uci_cfg,       &cfg->uci_cfg,       sizeof(srslte_uci_cfg_t));
+  memcpy(&pucch_cfg,     &cfg->pucch_cfg,     sizeof(srslte_pucch_cfg_t));
+  memcpy(&pucch_sched,   &cfg->pucch_sched,   sizeof(srslte_pucch_sched_t));
+  memcpy(&srs_cfg,       &cfg->srs_cfg,       sizeof(srslte_refsignal_srs_cfg_t));
+  memcpy(&power_ctrl,    &cfg->power_ctrl,    sizeof(srslte_ue_ul_powerctrl_t));
+  memcpy(&period_cqi,    &cfg->period_cqi,    sizeof(srslte_cqi_periodic_cfg_t));
+  I_sr = cfg->I_sr; 
   
   srslte_ue_ul_set_cfg(&ue_ul, &dmrs_cfg, &srs_cfg, &pucch_cfg, &pucch_sched, &uci_cfg, &pusch_hopping, &power_ctrl);
-
-  /* CQI configuration */
-  bzero(&period_cqi, sizeof(srslte_cqi_periodic_cfg_t));
-  period_cqi.configured        = dedicated->cqi_report_cnfg.report_periodic_setup_present;
-  period_cqi.pmi_idx           = dedicated->cqi_report_cnfg.report_periodic.pmi_cnfg_idx; 
-  period_cqi.simul_cqi_ack     = dedicated->cqi_report_cnfg.report_periodic.simult_ack_nack_and_cqi;
-  period_cqi.format_is_subband = dedicated->cqi_report_cnfg.report_periodic.format_ind_periodic ==
-                                 LIBLTE_RRC_CQI_FORMAT_INDICATOR_PERIODIC_SUBBAND_CQI;
-  period_cqi.subband_size      = dedicated->cqi_report_cnfg.report_periodic.format_ind_periodic_subband_k;
-  
-  /* SR configuration */
-  I_sr                         = dedicated->sched_request_cnfg.sr_cnfg_idx;
-  
   
-  if (pregen_enabled && !pregen_disabled) { 
-    Info("Pre-generating UL signals worker=%d\n", get_id());
-    srslte_ue_ul_pregen_signals(&ue_ul);
-    Info("Done pre-generating signals worker=%d\n", get_id());
+  /* The shared table is not updated for intermediate configurations published with pregen_disabled */
+  if (pregen_enabled && cell_initiated && !cfg->pregen_disabled) { 
+    phy->set_ul_rs_cfg(cell, &dmrs_cfg, &pucch_cfg, &srs_cfg);
   } 
 }
 
@@ -1019,7 +1184,7 @@ void phch_worker::update_measurements()
       }    
     }
     // Compute PL
-    float tx_crs_power = phy->config->common.pdsch_cnfg.rs_power;
+    float tx_crs_power = cfg->config.common.pdsch_cnfg.rs_power;
     phy->pathloss = tx_crs_power - phy->avg_rsrp_db;
 
     // Average noise 
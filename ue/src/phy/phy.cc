@@ -75,6 +75,13 @@ void phy::set_default_args(phy_args_t *args)
   args->sfo_correct_disable = false; 
   args->sss_algorithm       = "full"; 
   args->estimator_fil_w     = 0.1; 
+  args->iq_capture_mode     = "none"; 
+  args->iq_capture_filename = "/tmp/ue_iq.bin"; 
+  args->iq_capture_nof_sf   = 40; 
+  args->cell_search_parallel = false; 
+  args->cell_search_earfcn  = ""; 
+  args->cell_cache_filename = ""; 
+  args->pdcch_early_stop    = false; 
 }
 
 bool phy::check_args(phy_args_t *args) 
@@ -91,6 +98,11 @@ bool phy::check_args(phy_args_t *args)
     log_h->console("Error in PHY args: snr_ema_coeff must be 0<=w<=1\n");
     return false; 
   }
+  if (args->iq_capture_mode.compare("none") && 
+      iq_recorder::mode_from_string(args->iq_capture_mode) == iq_recorder::MODE_NONE) {
+    log_h->console("Error in PHY args: iq_capture_mode must be none, window, trigger or continuous\n");
+    return false; 
+  }
   return true; 
 }
 
@@ -125,6 +137,12 @@ bool phy::init(srslte::radio* radio_handler_, mac_interface_phy *mac, rrc_interf
   prach_buffer.init(&config.common.prach_cnfg, args, log_h);
   workers_common.init(&config, args, log_h, radio_handler, mac);
   
+  if (!workers_common.iq_rec.init(args->iq_capture_filename, 
+                                  iq_recorder::mode_from_string(args->iq_capture_mode), 
+                                  args->iq_capture_nof_sf, SRSLTE_SF_LEN_PRB(SRSLTE_MAX_PRB), log_h)) {
+    return false; 
+  }
+  
   // Warning this must be initialized after all workers have been added to the pool
   sf_recv.init(radio_handler, mac, rrc, &prach_buffer, &workers_pool, &workers_common, log_h, SF_RECV_THREAD_PRIO);
 
@@ -158,6 +176,12 @@ void phy::stop()
 {  
   sf_recv.stop();
   workers_pool.stop();
+  workers_common.iq_rec.stop();
+}
+
+void phy::iq_capture_trigger()
+{
+  workers_common.iq_rec.trigger("RLF");
 }
 
 void phy::get_metrics(phy_metrics_t &m) {
@@ -199,10 +223,8 @@ void phy::configure_prach_params()
 
 void phy::configure_ul_params(bool pregen_disabled)
 {
-  Info("PHY:   Configuring UL parameters\n");
-  for (int i=0;i<nof_workers;i++) {
-    workers[i].set_ul_params(pregen_disabled);
-  }
+  Info("PHY:   Configuring UL parameters, pregen_disabled=%d\n", pregen_disabled);
+  workers_common.publish_config(pregen_disabled);
 }
 
 float phy::get_phr()
@@ -236,6 +258,11 @@ void phy::pdcch_ul_search_reset()
   workers_common.set_ul_rnti(SRSLTE_RNTI_USER, 0);
 }
 
+void phy::set_sps_rnti(uint16_t rnti)
+{
+  workers_common.set_sps_rnti(rnti);
+}
+
 void phy::get_current_cell(srslte_cell_t *cell)
 {
   sf_recv.get_current_cell(cell);
@@ -339,26 +366,43 @@ void phy::get_config(phy_interface_rrc::phy_cfg_t* phy_cfg)
 void phy::set_config(phy_interface_rrc::phy_cfg_t* phy_cfg)
 {
   memcpy(&config, phy_cfg, sizeof(phy_cfg_t));
+  workers_common.publish_config();
 }
 
 void phy::set_config_64qam_en(bool enable)
 {
   config.enable_64qam = enable; 
+  workers_common.publish_config();
 }
 
 void phy::set_config_common(phy_interface_rrc::phy_cfg_common_t* common)
 {
   memcpy(&config.common, common, sizeof(phy_cfg_common_t));
+  workers_common.publish_config();
 }
 
 void phy::set_config_dedicated(LIBLTE_RRC_PHYSICAL_CONFIG_DEDICATED_STRUCT* dedicated)
 {
   memcpy(&config.dedicated, dedicated, sizeof(LIBLTE_RRC_PHYSICAL_CONFIG_DEDICATED_STRUCT));
+  workers_common.publish_config();
 }
 
 void phy::set_config_tdd(LIBLTE_RRC_TDD_CONFIG_STRUCT* tdd)
 {
   memcpy(&config.common.tdd_cnfg, tdd, sizeof(LIBLTE_RRC_TDD_CONFIG_STRUCT));
+  workers_common.publish_config();
+}
+
+void phy::set_config_sps_dl(LIBLTE_RRC_SPS_CONFIG_DL_STRUCT* sps_dl)
+{
+  memcpy(&config.sps_dl, sps_dl, sizeof(LIBLTE_RRC_SPS_CONFIG_DL_STRUCT));
+  workers_common.publish_config();
+}
+
+void phy::set_paging_occasion(uint32_t T, uint32_t pf_offset, uint32_t po_sf)
+{
+  workers_common.set_paging_occasion(T, pf_offset, po_sf);
+  Info("Paging occasion set to sf_idx=%d of frames with SFN mod %d = %d\n", po_sf, T, pf_offset);
 }
 
 }
@@ -0,0 +1,182 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <strings.h>
+
+#include "phy/phy_config.h"
+
+namespace srsue {
+
+phy_config::phy_config(uint32_t version_, phy_interface_rrc::phy_cfg_t *config_, phy_args_t *args, bool pregen_disabled_)
+{
+  version         = version_; 
+  pregen_disabled = pregen_disabled_; 
+  memcpy(&config, config_, sizeof(phy_interface_rrc::phy_cfg_t));
+  set_dl_params(args);
+  set_ul_params();
+}
+
+srslte_chest_dl_noise_alg_t phy_config::noise_alg_from_string(std::string alg)
+{
+  if (!alg.compare("refs")) {
+    return SRSLTE_NOISE_ALG_REFS; 
+  } else if (!alg.compare("empty")) {
+    return SRSLTE_NOISE_ALG_EMPTY; 
+  } else {
+    return SRSLTE_NOISE_ALG_PSS; 
+  }
+}
+
+phy_config::equalizer_mode_t phy_config::equalizer_from_string(std::string mode)
+{
+  if (!mode.compare("zf")) {
+    return EQUALIZER_ZF; 
+  } else {
+    return EQUALIZER_MMSE; 
+  }
+}
+
+void phy_config::set_dl_params(phy_args_t *args)
+{
+  noise_alg = noise_alg_from_string(args->snr_estim_alg);
+  equalizer = equalizer_from_string(args->equalizer_mode);
+  
+  /* Same coefficients as srslte_chest_dl_set_smooth_filter3_coeff() */
+  float w = args->estimator_fil_w; 
+  bzero(filter, sizeof(filter));
+  if (w > 0.0) {
+    filter_len = 3; 
+    filter[0]  = w; 
+    filter[1]  = 1-2*w; 
+    filter[2]  = w; 
+  } else if (w == 0.0) {
+    filter_len = 0; 
+  } else {
+    filter_len = -1; 
+  }
+}
+
+void phy_config::set_ul_params()
+{
+  phy_interface_rrc::phy_cfg_common_t         *common    = &config.common;
+  LIBLTE_RRC_PHYSICAL_CONFIG_DEDICATED_STRUCT *dedicated = &config.dedicated;
+  
+  /* PUSCH DMRS signal configuration */
+  bzero(&dmrs_cfg, sizeof(srslte_refsignal_dmrs_pusch_cfg_t));    
+  dmrs_cfg.group_hopping_en    = common->pusch_cnfg.ul_rs.group_hopping_enabled;
+  dmrs_cfg.sequence_hopping_en = common->pusch_cnfg.ul_rs.sequence_hopping_enabled;
+  dmrs_cfg.cyclic_shift        = common->pusch_cnfg.ul_rs.cyclic_shift;
+  dmrs_cfg.delta_ss            = common->pusch_cnfg.ul_rs.group_assignment_pusch;
+  
+  /* PUSCH Hopping configuration */
+  bzero(&pusch_hopping, sizeof(srslte_pusch_hopping_cfg_t));
+  pusch_hopping.n_sb           = common->pusch_cnfg.n_sb;
+  pusch_hopping.hop_mode       = common->pusch_cnfg.hopping_mode == LIBLTE_RRC_HOPPING_MODE_INTRA_AND_INTER_SUBFRAME ? 
+                                  pusch_hopping.SRSLTE_PUSCH_HOP_MODE_INTRA_SF : 
+                                  pusch_hopping.SRSLTE_PUSCH_HOP_MODE_INTER_SF; 
+  pusch_hopping.hopping_offset = common->pusch_cnfg.pusch_hopping_offset;
+
+  /* PUSCH UCI configuration */
+  bzero(&uci_cfg, sizeof(srslte_uci_cfg_t));
+  uci_cfg.I_offset_ack         = dedicated->pusch_cnfg_ded.beta_offset_ack_idx;
+  uci_cfg.I_offset_cqi         = dedicated->pusch_cnfg_ded.beta_offset_cqi_idx;
+  uci_cfg.I_offset_ri          = dedicated->pusch_cnfg_ded.beta_offset_ri_idx;
+  
+  /* PUCCH configuration */  
+  bzero(&pucch_cfg, sizeof(srslte_pucch_cfg_t));
+  pucch_cfg.delta_pucch_shift  = liblte_rrc_delta_pucch_shift_num[common->pucch_cnfg.delta_pucch_shift%LIBLTE_RRC_DELTA_PUCCH_SHIFT_N_ITEMS];
+  pucch_cfg.N_cs               = common->pucch_cnfg.n_cs_an;
+  pucch_cfg.n_rb_2             = common->pucch_cnfg.n_rb_cqi;
+  pucch_cfg.srs_configured     = dedicated->srs_ul_cnfg_ded.setup_present;
+  if (pucch_cfg.srs_configured) {
+    pucch_cfg.srs_cs_subf_cfg    = liblte_rrc_srs_subfr_config_num[common->srs_ul_cnfg.subfr_cnfg%LIBLTE_RRC_SRS_SUBFR_CONFIG_N_ITEMS];
+    pucch_cfg.srs_simul_ack      = common->srs_ul_cnfg.ack_nack_simul_tx;
+  }
+  
+  /* PUCCH Scheduling configuration */
+  bzero(&pucch_sched, sizeof(srslte_pucch_sched_t));
+  pucch_sched.N_pucch_1        = common->pucch_cnfg.n1_pucch_an;
+  pucch_sched.n_pucch_2        = dedicated->cqi_report_cnfg.report_periodic.pucch_resource_idx;
+  pucch_sched.n_pucch_sr       = dedicated->sched_request_cnfg.sr_pucch_resource_idx;
+  
+  /* HARQ-ACK resources of PDSCH without PDCCH */
+  bzero(sps_n_pucch_1, sizeof(sps_n_pucch_1));
+  nof_sps_n_pucch_1 = 0; 
+  if (config.sps_dl.setup_present) {
+    nof_sps_n_pucch_1 = SRSLTE_MIN(4, config.sps_dl.n1_pucch_an_persistent_list_size);
+    for (uint32_t i=0;i<nof_sps_n_pucch_1;i++) {
+      sps_n_pucch_1[i] = config.sps_dl.n1_pucch_an_persistent_list[i];
+    }
+  }
+
+  /* SRS Configuration */
+  bzero(&srs_cfg, sizeof(srslte_refsignal_srs_cfg_t));
+  srs_cfg.configured           = dedicated->srs_ul_cnfg_ded.setup_present;
+  if (pucch_cfg.srs_configured) {
+    srs_cfg.subframe_config      = liblte_rrc_srs_subfr_config_num[common->srs_ul_cnfg.subfr_cnfg%LIBLTE_RRC_SRS_SUBFR_CONFIG_N_ITEMS];
+    srs_cfg.bw_cfg               = liblte_rrc_srs_bw_config_num[common->srs_ul_cnfg.bw_cnfg%LIBLTE_RRC_SRS_BW_CONFIG_N_ITEMS];
+    srs_cfg.I_srs                = dedicated->srs_ul_cnfg_ded.srs_cnfg_idx;
+    srs_cfg.B                    = dedicated->srs_ul_cnfg_ded.srs_bandwidth;
+    srs_cfg.b_hop                = dedicated->srs_ul_cnfg_ded.srs_hopping_bandwidth;
+    srs_cfg.n_rrc                = dedicated->srs_ul_cnfg_ded.freq_domain_pos;
+    srs_cfg.k_tc                 = dedicated->srs_ul_cnfg_ded.tx_comb;
+    srs_cfg.n_srs                = dedicated->srs_ul_cnfg_ded.cyclic_shift;
+  }
+  
+  /* UL power control configuration */
+  bzero(&power_ctrl, sizeof(srslte_ue_ul_powerctrl_t));
+  power_ctrl.p0_nominal_pusch  = common->ul_pwr_ctrl.p0_nominal_pusch;
+  power_ctrl.alpha             = liblte_rrc_ul_power_control_alpha_num[common->ul_pwr_ctrl.alpha%LIBLTE_RRC_UL_POWER_CONTROL_ALPHA_N_ITEMS];
+  power_ctrl.p0_nominal_pucch  = common->ul_pwr_ctrl.p0_nominal_pucch;
+  power_ctrl.delta_f_pucch[0]  = liblte_rrc_delta_f_pucch_format_1_num[common->ul_pwr_ctrl.delta_flist_pucch.format_1%LIBLTE_RRC_DELTA_F_PUCCH_FORMAT_1_N_ITEMS];
+  power_ctrl.delta_f_pucch[1]  = liblte_rrc_delta_f_pucch_format_1b_num[common->ul_pwr_ctrl.delta_flist_pucch.format_1b%LIBLTE_RRC_DELTA_F_PUCCH_FORMAT_1B_N_ITEMS];
+  power_ctrl.delta_f_pucch[2]  = liblte_rrc_delta_f_pucch_format_2_num[common->ul_pwr_ctrl.delta_flist_pucch.format_2%LIBLTE_RRC_DELTA_F_PUCCH_FORMAT_2_N_ITEMS];
+  power_ctrl.delta_f_pucch[3]  = liblte_rrc_delta_f_pucch_format_2a_num[common->ul_pwr_ctrl.delta_flist_pucch.format_2a%LIBLTE_RRC_DELTA_F_PUCCH_FORMAT_2A_N_ITEMS];
+  power_ctrl.delta_f_pucch[4]  = liblte_rrc_delta_f_pucch_format_2b_num[common->ul_pwr_ctrl.delta_flist_pucch.format_2b%LIBLTE_RRC_DELTA_F_PUCCH_FORMAT_2B_N_ITEMS];
+  
+  power_ctrl.delta_preamble_msg3 = common->ul_pwr_ctrl.delta_preamble_msg3;
+  
+  power_ctrl.p0_ue_pusch       = dedicated->ul_pwr_ctrl_ded.p0_ue_pusch;
+  power_ctrl.delta_mcs_based   = dedicated->ul_pwr_ctrl_ded.delta_mcs_en==LIBLTE_RRC_DELTA_MCS_ENABLED_EN0;
+  power_ctrl.acc_enabled       = dedicated->ul_pwr_ctrl_ded.accumulation_en;
+  power_ctrl.p0_ue_pucch       = dedicated->ul_pwr_ctrl_ded.p0_ue_pucch;
+  power_ctrl.p_srs_offset      = dedicated->ul_pwr_ctrl_ded.p_srs_offset;
+  
+  /* CQI configuration */
+  bzero(&period_cqi, sizeof(srslte_cqi_periodic_cfg_t));
+  period_cqi.configured        = dedicated->cqi_report_cnfg.report_periodic_setup_present;
+  period_cqi.pmi_idx           = dedicated->cqi_report_cnfg.report_periodic.pmi_cnfg_idx; 
+  period_cqi.simul_cqi_ack     = dedicated->cqi_report_cnfg.report_periodic.simult_ack_nack_and_cqi;
+  period_cqi.format_is_subband = dedicated->cqi_report_cnfg.report_periodic.format_ind_periodic ==
+                                 LIBLTE_RRC_CQI_FORMAT_INDICATOR_PERIODIC_SUBBAND_CQI;
+  period_cqi.subband_size      = dedicated->cqi_report_cnfg.report_periodic.format_ind_periodic_subband_k;
+  
+  /* SR configuration */
+  I_sr                         = dedicated->sched_request_cnfg.sr_cnfg_idx;
+}
+
+} // namespace srsue
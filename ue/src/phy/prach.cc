@@ -42,14 +42,18 @@
 namespace srsue {
  
   
+prach::~prach()
+{
+  for (uint32_t i=0;i<CACHE_SIZE;i++) {
+    if (cache[i].buffer) {
+      free(cache[i].buffer);
+    }
+  }
+}
+  
 void prach::free_cell() 
 {
   if (initiated) {
-    for (int i=0;i<64;i++) {
-      if (buffer[i]) {
-        free(buffer[i]);    
-      }      
-    }
     if (signal_buffer) {
       free(signal_buffer);
     }
@@ -65,46 +69,48 @@ void prach::init(LIBLTE_RRC_PRACH_CONFIG_SIB_STRUCT *config_, phy_args_t *args_,
   args   = args_; 
 }
 
+void prach::get_cfg(prach_cfg_t *cfg)
+{
+  bzero(cfg, sizeof(prach_cfg_t));
+  cfg->root_seq       = config->root_sequence_index;
+  cfg->config_idx     = config->prach_cnfg_info.prach_config_index;
+  cfg->zero_corr_zone = config->prach_cnfg_info.zero_correlation_zone_config;
+  cfg->freq_offset    = config->prach_cnfg_info.prach_freq_offset;
+  cfg->high_speed     = config->prach_cnfg_info.high_speed_flag; 
+  cfg->nof_prb        = cell.nof_prb; 
+}
+
 bool prach::init_cell(srslte_cell_t cell_)
 {
-  // TODO: Check if other PRACH parameters changed
-  if (cell_.id != cell.id || !initiated) {
+  prach_cfg_t new_cfg; 
+  srslte_cell_t old_cell = cell; 
+  cell = cell_; 
+  get_cfg(&new_cfg);
+  
+  if (cell_.id != old_cell.id || memcmp(&new_cfg, &cur_cfg, sizeof(prach_cfg_t)) || !initiated) {
     if (initiated) {
       free_cell();
+      initiated = false; 
     }
-    cell = cell_; 
     preamble_idx = -1; 
-
-    uint32_t configIdx      = config->prach_cnfg_info.prach_config_index;
-    uint32_t rootSeq        = config->root_sequence_index;
-    uint32_t zeroCorrConfig = config->prach_cnfg_info.zero_correlation_zone_config;
-    uint32_t freq_offset    = config->prach_cnfg_info.prach_freq_offset;
-    bool     highSpeed      = config->prach_cnfg_info.high_speed_flag; 
+    preamble_buffer = NULL; 
     
-    if (6 + freq_offset > cell.nof_prb) {
-      log_h->console("Error no space for PRACH: frequency offset=%d, N_rb_ul=%d\n", freq_offset, cell.nof_prb);
-      log_h->error("Error no space for PRACH: frequency offset=%d, N_rb_ul=%d\n", freq_offset, cell.nof_prb);
+    if (6 + new_cfg.freq_offset > cell.nof_prb) {
+      log_h->console("Error no space for PRACH: frequency offset=%d, N_rb_ul=%d\n", new_cfg.freq_offset, cell.nof_prb);
+      log_h->error("Error no space for PRACH: frequency offset=%d, N_rb_ul=%d\n", new_cfg.freq_offset, cell.nof_prb);
       return false; 
     }
     
     if (srslte_prach_init(&prach_obj, srslte_symbol_sz(cell.nof_prb), 
-                          configIdx, rootSeq, highSpeed, zeroCorrConfig))
+                          new_cfg.config_idx, new_cfg.root_seq, new_cfg.high_speed, new_cfg.zero_corr_zone))
     {
       Error("Initiating PRACH library\n");
       return false; 
     }
+    memcpy(&cur_cfg, &new_cfg, sizeof(prach_cfg_t));
     
+    // Preambles are generated in prepare_to_send()
     len = prach_obj.N_seq + prach_obj.N_cp;
-    for (int i=0;i<64;i++) {
-      buffer[i] = (cf_t*) srslte_vec_malloc(len*sizeof(cf_t));
-      if(!buffer[i]) {
-        return false; 
-      }    
-      if(srslte_prach_gen(&prach_obj, i, freq_offset, buffer[i])) {
-        Error("Generating PRACH preamble %d\n", i);
-        return false;
-      }
-    }
     srslte_cfo_init(&cfo_h, len);
     srslte_cfo_set_tol(&cfo_h, 0);
     signal_buffer = (cf_t*) srslte_vec_malloc(len*sizeof(cf_t)); 
@@ -115,9 +121,57 @@ bool prach::init_cell(srslte_cell_t cell_)
   return initiated;  
 }
 
+cf_t* prach::get_preamble(uint32_t preamble)
+{
+  cache_cnt++;
+  
+  // Return the cached waveform if it was generated for the same configuration 
+  uint32_t lru = 0; 
+  for (uint32_t i=0;i<CACHE_SIZE;i++) {
+    if (cache[i].valid && cache[i].preamble == preamble && 
+        !memcmp(&cache[i].cfg, &cur_cfg, sizeof(prach_cfg_t))) 
+    {
+      cache[i].last_used = cache_cnt; 
+      return cache[i].buffer; 
+    }
+    if (!cache[i].valid || (cache[lru].valid && cache[i].last_used < cache[lru].last_used)) {
+      lru = i; 
+    }
+  }
+  
+  // Otherwise generate it replacing the least recently used entry
+  preamble_cache_t *e = &cache[lru]; 
+  e->valid = false; 
+  if (e->len != len || !e->buffer) {
+    if (e->buffer) {
+      free(e->buffer);
+    }
+    e->buffer = (cf_t*) srslte_vec_malloc(len*sizeof(cf_t));
+    if (!e->buffer) {
+      e->len = 0; 
+      return NULL; 
+    }
+    e->len = len; 
+  }
+  if (srslte_prach_gen(&prach_obj, preamble, cur_cfg.freq_offset, e->buffer)) {
+    Error("Generating PRACH preamble %d\n", preamble);
+    return NULL; 
+  }
+  memcpy(&e->cfg, &cur_cfg, sizeof(prach_cfg_t));
+  e->preamble  = preamble; 
+  e->last_used = cache_cnt; 
+  e->valid     = true; 
+  Debug("PRACH generated preamble %d in cache entry %d\n", preamble, lru);
+  return e->buffer; 
+}
+
 bool prach::prepare_to_send(uint32_t preamble_idx_, int allowed_subframe_, float target_power_dbm_)
 {
   if (initiated && preamble_idx_ < 64) {
+    preamble_buffer = get_preamble(preamble_idx_);
+    if (!preamble_buffer) {
+      return false; 
+    }
     preamble_idx = preamble_idx_;
     target_power_dbm = target_power_dbm_;
     allowed_subframe = allowed_subframe_; 
@@ -164,7 +218,7 @@ void prach::send(srslte::radio *radio_handler, float cfo, float pathloss, srslte
   float old_gain = radio_handler->get_tx_gain(); 
   
   // Correct CFO before transmission
-  srslte_cfo_correct(&cfo_h, buffer[preamble_idx], signal_buffer, cfo / srslte_symbol_sz(cell.nof_prb));            
+  srslte_cfo_correct(&cfo_h, preamble_buffer, signal_buffer, cfo / srslte_symbol_sz(cell.nof_prb));            
 
   // If power control is enabled, choose amplitude and power 
   if (args->ul_pwr_ctrl_en) {
@@ -0,0 +1,202 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <strings.h>
+
+#include "srslte/srslte.h"
+#include "phy/ul_rs_table.h"
+
+namespace srsue {
+
+ul_rs_table::ul_rs_table()
+{
+  initiated = false; 
+  bzero(&cell,      sizeof(srslte_cell_t));
+  bzero(&dmrs_cfg,  sizeof(srslte_refsignal_dmrs_pusch_cfg_t));
+  bzero(&pucch_cfg, sizeof(srslte_pucch_cfg_t));
+  bzero(&srs_cfg,   sizeof(srslte_refsignal_srs_cfg_t));
+  bzero(&signals,   sizeof(srslte_refsignal_ul_t));
+  bzero(dmrs,       sizeof(dmrs));
+  bzero(srs,        sizeof(srs));
+}
+
+ul_rs_table::~ul_rs_table()
+{
+  for (int cs=0;cs<SRSLTE_NOF_CSHIFT;cs++) {
+    for (int sf=0;sf<SRSLTE_NSUBFRAMES_X_FRAME;sf++) {
+      for (int n=0;n<=SRSLTE_MAX_PRB;n++) {
+        if (dmrs[cs][sf][n]) {
+          free(dmrs[cs][sf][n]);
+        }
+      }
+    }
+  }
+  for (int sf=0;sf<SRSLTE_NSUBFRAMES_X_FRAME;sf++) {
+    if (srs[sf]) {
+      free(srs[sf]);
+    }
+  }
+  if (initiated) {
+    srslte_refsignal_ul_free(&signals);
+  }
+}
+
+/* Generates the whole table. Called once, before the table is shared with the workers */
+bool ul_rs_table::init(srslte_cell_t cell_, 
+                       srslte_refsignal_dmrs_pusch_cfg_t *dmrs_cfg_, 
+                       srslte_pucch_cfg_t *pucch_cfg_, 
+                       srslte_refsignal_srs_cfg_t *srs_cfg_)
+{
+  if (srslte_refsignal_ul_init(&signals, cell_)) {
+    return false; 
+  }
+  initiated = true; 
+  memcpy(&cell,      &cell_,     sizeof(srslte_cell_t));
+  memcpy(&dmrs_cfg,  dmrs_cfg_,  sizeof(srslte_refsignal_dmrs_pusch_cfg_t));
+  memcpy(&pucch_cfg, pucch_cfg_, sizeof(srslte_pucch_cfg_t));
+  memcpy(&srs_cfg,   srs_cfg_,   sizeof(srslte_refsignal_srs_cfg_t));
+  srslte_refsignal_ul_set_cfg(&signals, &dmrs_cfg, &pucch_cfg, &srs_cfg);
+  return gen_dmrs() && gen_srs(); 
+}
+
+/* DMRS for every cyclic shift, subframe and valid PUSCH allocation size of the cell */
+bool ul_rs_table::gen_dmrs()
+{
+  for (uint32_t cs=0;cs<SRSLTE_NOF_CSHIFT;cs++) {
+    for (uint32_t sf=0;sf<SRSLTE_NSUBFRAMES_X_FRAME;sf++) {
+      for (uint32_t n=1;n<=cell.nof_prb;n++) {
+        if (srslte_dft_precoding_valid_prb(n)) {
+          dmrs[cs][sf][n] = (cf_t*) srslte_vec_malloc(2*SRSLTE_NRE*n*sizeof(cf_t));
+          if (!dmrs[cs][sf][n]) {
+            return false; 
+          }
+          if (srslte_refsignal_dmrs_pusch_gen(&signals, n, sf, cs, dmrs[cs][sf][n])) {
+            return false; 
+          }
+        }
+      }
+    }
+  }
+  return true; 
+}
+
+/* SRS for the subframes of the cell-specific SRS configuration */
+bool ul_rs_table::gen_srs()
+{
+  if (!srs_cfg.configured) {
+    return true; 
+  }
+  uint32_t M_sc = srslte_refsignal_srs_M_sc(&signals);
+  for (uint32_t sf=0;sf<SRSLTE_NSUBFRAMES_X_FRAME;sf++) {
+    if (srslte_refsignal_srs_send_cs(srs_cfg.subframe_config, sf) == 1) {
+      srs[sf] = (cf_t*) srslte_vec_malloc(2*M_sc*sizeof(cf_t));
+      if (!srs[sf]) {
+        return false; 
+      }
+      if (srslte_refsignal_srs_gen(&signals, sf, srs[sf])) {
+        return false; 
+      }
+    }
+  }
+  return true; 
+}
+
+bool ul_rs_table::is_cfg(srslte_cell_t cell_, 
+                         srslte_refsignal_dmrs_pusch_cfg_t *dmrs_cfg_, 
+                         srslte_pucch_cfg_t *pucch_cfg_, 
+                         srslte_refsignal_srs_cfg_t *srs_cfg_)
+{
+  return initiated                                                                  && 
+         !memcmp(&cell,      &cell_,     sizeof(srslte_cell_t))                     && 
+         !memcmp(&dmrs_cfg,  dmrs_cfg_,  sizeof(srslte_refsignal_dmrs_pusch_cfg_t)) && 
+         !memcmp(&pucch_cfg, pucch_cfg_, sizeof(srslte_pucch_cfg_t))                && 
+         !memcmp(&srs_cfg,   srs_cfg_,   sizeof(srslte_refsignal_srs_cfg_t)); 
+}
+
+cf_t* ul_rs_table::get_dmrs(uint32_t n_prb, uint32_t ncs, uint32_t sf_idx)
+{
+  if (n_prb > SRSLTE_MAX_PRB || ncs >= SRSLTE_NOF_CSHIFT || sf_idx >= SRSLTE_NSUBFRAMES_X_FRAME) {
+    return NULL; 
+  }
+  return dmrs[ncs][sf_idx][n_prb]; 
+}
+
+cf_t* ul_rs_table::get_srs(uint32_t sf_idx)
+{
+  if (sf_idx >= SRSLTE_NSUBFRAMES_X_FRAME) {
+    return NULL; 
+  }
+  return srs[sf_idx]; 
+}
+
+bool ul_rs_table::set_ue_ul(srslte_ue_ul_t *ue_ul, uint32_t n_prb, uint32_t ncs, uint32_t sf_idx)
+{
+  cf_t *r_dmrs = get_dmrs(n_prb, ncs, sf_idx);
+  if (!r_dmrs || !ue_ul->pregen_drms.r[ncs][sf_idx]) {
+    return false; 
+  }
+  if (srs_cfg.configured && srslte_refsignal_srs_send_cs(srs_cfg.subframe_config, sf_idx) == 1) {
+    cf_t *r_srs = get_srs(sf_idx);
+    if (!r_srs) {
+      return false; 
+    }
+    ue_ul->pregen_srs.r[sf_idx] = r_srs; 
+  }
+  ue_ul->pregen_drms.r[ncs][sf_idx][n_prb] = r_dmrs; 
+  ue_ul->signals_pregenerated = true; 
+  return true; 
+}
+
+bool ul_rs_table::alloc_ue_ul(srslte_ue_ul_t *ue_ul)
+{
+  for (int cs=0;cs<SRSLTE_NOF_CSHIFT;cs++) {
+    for (int sf=0;sf<SRSLTE_NSUBFRAMES_X_FRAME;sf++) {
+      ue_ul->pregen_drms.r[cs][sf] = (cf_t**) calloc(SRSLTE_MAX_PRB+1, sizeof(cf_t*));
+      if (!ue_ul->pregen_drms.r[cs][sf]) {
+        return false; 
+      }
+    }
+  }
+  bzero(ue_ul->pregen_srs.r, sizeof(ue_ul->pregen_srs.r));
+  return true; 
+}
+
+/* Only the pointer arrays are freed, the signals they point to belong to the tables */
+void ul_rs_table::free_ue_ul(srslte_ue_ul_t *ue_ul)
+{
+  for (int cs=0;cs<SRSLTE_NOF_CSHIFT;cs++) {
+    for (int sf=0;sf<SRSLTE_NSUBFRAMES_X_FRAME;sf++) {
+      if (ue_ul->pregen_drms.r[cs][sf]) {
+        free(ue_ul->pregen_drms.r[cs][sf]);
+        ue_ul->pregen_drms.r[cs][sf] = NULL; 
+      }
+    }
+  }
+  bzero(ue_ul->pregen_srs.r, sizeof(ue_ul->pregen_srs.r));
+}
+
+} // namespace srsue
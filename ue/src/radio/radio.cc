@@ -35,7 +35,13 @@ namespace srslte {
 
 bool radio::init(char *args, char *devname)
 {
-  if (srslte_rf_open_devname(&rf_device, devname, args)) {
+  is_file = devname && !strcmp(devname, "file");
+  if (is_file) {
+    if (!file.init(args)) {
+      fprintf(stderr, "Error opening file RF device\n");
+      return false; 
+    }
+  } else if (srslte_rf_open_devname(&rf_device, devname, args)) {
     fprintf(stderr, "Error opening RF device\n");
     return false;
   }
@@ -51,7 +57,9 @@ bool radio::init(char *args, char *devname)
   tx_adv_auto = true; 
   // Set default preamble length each known device
   // We distinguish by device family, maybe we should calibrate per device
-  if (strstr(srslte_rf_name(&rf_device), "uhd")) {
+  if (is_file) {
+    burst_preamble_sec = 0; 
+  } else if (strstr(srslte_rf_name(&rf_device), "uhd")) {
     burst_preamble_sec = uhd_default_burst_preamble_sec;
   } else if (strstr(srslte_rf_name(&rf_device), "bladerf")) {
     burst_preamble_sec = blade_default_burst_preamble_sec;
@@ -64,6 +72,9 @@ bool radio::init(char *args, char *devname)
 
 void radio::set_manual_calibration(rf_cal_t* calibration)
 {
+  if (is_file) {
+    return; 
+  }
   srslte_rf_cal_t tx_cal; 
   tx_cal.dc_gain  = calibration->tx_corr_dc_gain;
   tx_cal.dc_phase = calibration->tx_corr_dc_phase;
@@ -73,7 +84,9 @@ void radio::set_manual_calibration(rf_cal_t* calibration)
 }
 
 void radio::set_tx_rx_gain_offset(float offset) {
-  srslte_rf_set_tx_rx_gain_offset(&rf_device, offset);  
+  if (!is_file) {
+    srslte_rf_set_tx_rx_gain_offset(&rf_device, offset);  
+  }
 }
 
 void radio::set_burst_preamble(double preamble_us)
@@ -102,6 +115,9 @@ void radio::tx_offset(int offset_)
 
 bool radio::start_agc(bool tx_gain_same_rx)
 {
+  if (is_file) {
+    return true; 
+  }
   if (srslte_rf_start_gain_thread(&rf_device, tx_gain_same_rx)) {
     fprintf(stderr, "Error opening RF device\n");
     return false;
@@ -119,8 +135,12 @@ bool radio::rx_at(void* buffer, uint32_t nof_samples, srslte_timestamp_t rx_time
 
 bool radio::rx_now(void* buffer, uint32_t nof_samples, srslte_timestamp_t* rxd_time)
 {
+  if (is_file) {
+    return file.rx(buffer, nof_samples, rxd_time);
+  }
   if (srslte_rf_recv_with_time(&rf_device, buffer, nof_samples, true, 
     rxd_time?&rxd_time->full_secs:NULL, rxd_time?&rxd_time->frac_secs:NULL) > 0) {
+    file.record(buffer, nof_samples);
     return true; 
   } else {
     return false; 
@@ -128,7 +148,20 @@ bool radio::rx_now(void* buffer, uint32_t nof_samples, srslte_timestamp_t* rxd_t
 }
 
 void radio::get_time(srslte_timestamp_t *now) {
-  srslte_rf_get_time(&rf_device, &now->full_secs, &now->frac_secs);  
+  if (is_file) {
+    file.get_time(now);
+  } else {
+    srslte_rf_get_time(&rf_device, &now->full_secs, &now->frac_secs);  
+  }
+}
+
+bool radio::start_record(const char *filename)
+{
+  if (is_file) {
+    fprintf(stderr, "Recording is not supported with the file RF device\n");
+    return false; 
+  }
+  return file.start_record(filename);
 }
 
 // TODO: Use Calibrated values for this 
@@ -141,7 +174,9 @@ float radio::set_tx_power(float power)
     power = -50; 
   }
   float gain = power + 74;
-  srslte_rf_set_tx_gain(&rf_device, gain);
+  if (!is_file) {
+    srslte_rf_set_tx_gain(&rf_device, gain);
+  }
   return gain; 
 }
 
@@ -152,16 +187,21 @@ float radio::get_max_tx_power()
 
 float radio::get_rssi()
 {
-  return srslte_rf_get_rssi(&rf_device);  
+  return is_file?0:srslte_rf_get_rssi(&rf_device);  
 }
 
 bool radio::has_rssi()
 {
-  return srslte_rf_has_rssi(&rf_device);
+  return is_file?false:srslte_rf_has_rssi(&rf_device);
 }
 
 bool radio::tx(void* buffer, uint32_t nof_samples, srslte_timestamp_t tx_time)
 {
+  if (is_file) {
+    bool ret = file.tx(buffer, nof_samples+offset, tx_time);
+    offset = 0; 
+    return ret; 
+  }
   if (!tx_adv_negative) {
     srslte_timestamp_sub(&tx_time, 0, tx_adv_sec);
   } else {
@@ -174,7 +214,14 @@ bool radio::tx(void* buffer, uint32_t nof_samples, srslte_timestamp_t tx_time)
       srslte_timestamp_copy(&tx_time_pad, &tx_time);
       srslte_timestamp_sub(&tx_time_pad, 0, burst_preamble_time_rounded); 
       save_trace(1, &tx_time_pad);
-      srslte_rf_send_timed2(&rf_device, zeros, burst_preamble_samples, tx_time_pad.full_secs, tx_time_pad.frac_secs, true, false);
+      // Send the zero preamble in chunks, each one timed right after the previous
+      uint32_t n = 0; 
+      while (n < burst_preamble_samples) {
+        uint32_t len = SRSLTE_MIN(burst_preamble_zeros_len, burst_preamble_samples - n);
+        srslte_rf_send_timed2(&rf_device, zeros, len, tx_time_pad.full_secs, tx_time_pad.frac_secs, n == 0, false);
+        srslte_timestamp_add(&tx_time_pad, 0, (double) len/cur_tx_srate);
+        n += len; 
+      }
       is_start_of_burst = false; 
     }        
   }
@@ -206,7 +253,7 @@ void radio::set_tti_len(uint32_t sf_len_)
 
 void radio::tx_end()
 {
-  if (!is_start_of_burst) {
+  if (!is_start_of_burst && !is_file) {
     save_trace(2, &end_of_burst_time);
     srslte_rf_send_timed2(&rf_device, zeros, 0, end_of_burst_time.full_secs, end_of_burst_time.frac_secs, false, true);
     is_start_of_burst = true; 
@@ -233,7 +280,7 @@ void radio::save_trace(uint32_t is_eob, srslte_timestamp_t *tx_time) {
   if (trace_enabled) {
     tr_local_time.push_cur_time_us(tti);
     srslte_timestamp_t usrp_time; 
-    srslte_rf_get_time(&rf_device, &usrp_time.full_secs, &usrp_time.frac_secs);
+    get_time(&usrp_time);
     tr_usrp_time.push(tti, srslte_timestamp_uint32(&usrp_time));
     tr_tx_time.push(tti, srslte_timestamp_uint32(tx_time));
     tr_is_eob.push(tti, is_eob);
@@ -242,37 +289,47 @@ void radio::save_trace(uint32_t is_eob, srslte_timestamp_t *tx_time) {
 
 void radio::set_rx_freq(float freq)
 {
-  rx_freq = srslte_rf_set_rx_freq(&rf_device, freq);
+  rx_freq = is_file?freq:srslte_rf_set_rx_freq(&rf_device, freq);
 }
 
 void radio::set_rx_gain(float gain)
 {
-  srslte_rf_set_rx_gain(&rf_device, gain);
+  if (!is_file) {
+    srslte_rf_set_rx_gain(&rf_device, gain);
+  }
 }
 
 double radio::set_rx_gain_th(float gain)
 {
-  return srslte_rf_set_rx_gain_th(&rf_device, gain);
+  return is_file?gain:srslte_rf_set_rx_gain_th(&rf_device, gain);
 }
 
 void radio::set_master_clock_rate(float rate)
 {
-  srslte_rf_set_master_clock_rate(&rf_device, rate);
+  if (!is_file) {
+    srslte_rf_set_master_clock_rate(&rf_device, rate);
+  }
 }
 
 void radio::set_rx_srate(float srate)
 {
-  srslte_rf_set_rx_srate(&rf_device, srate);
+  if (is_file) {
+    file.set_rx_srate(srate);
+  } else {
+    srslte_rf_set_rx_srate(&rf_device, srate);
+  }
 }
 
 void radio::set_tx_freq(float freq)
 {
-  tx_freq = srslte_rf_set_tx_freq(&rf_device, freq);  
+  tx_freq = is_file?freq:srslte_rf_set_tx_freq(&rf_device, freq);  
 }
 
 void radio::set_tx_gain(float gain)
 {
-  srslte_rf_set_tx_gain(&rf_device, gain);
+  if (!is_file) {
+    srslte_rf_set_tx_gain(&rf_device, gain);
+  }
 }
 
 float radio::get_rx_freq()
@@ -287,16 +344,21 @@ float radio::get_tx_freq()
 
 float radio::get_tx_gain()
 {
-  return srslte_rf_get_tx_gain(&rf_device);
+  return is_file?0:srslte_rf_get_tx_gain(&rf_device);
 }
 
 float radio::get_rx_gain()
 {
-  return srslte_rf_get_rx_gain(&rf_device);
+  return is_file?0:srslte_rf_get_rx_gain(&rf_device);
 }
 
 void radio::set_tx_srate(float srate)
 {
+  if (is_file) {
+    cur_tx_srate = srate; 
+    file.set_tx_srate(srate);
+    return; 
+  }
   cur_tx_srate = srslte_rf_set_tx_srate(&rf_device, srate);
   burst_preamble_samples = (uint32_t) (cur_tx_srate * burst_preamble_sec);
   if (burst_preamble_samples > burst_preamble_max_samples) {
@@ -368,17 +430,23 @@ void radio::set_tx_srate(float srate)
 
 void radio::start_rx()
 {
-  srslte_rf_start_rx_stream(&rf_device);
+  if (!is_file) {
+    srslte_rf_start_rx_stream(&rf_device);
+  }
 }
 
 void radio::stop_rx()
 {
-  srslte_rf_stop_rx_stream(&rf_device);
+  if (!is_file) {
+    srslte_rf_stop_rx_stream(&rf_device);
+  }
 }
 
 void radio::register_error_handler(srslte_rf_error_handler_t h)
 {
-  srslte_rf_register_error_handler(&rf_device, h);
+  if (!is_file) {
+    srslte_rf_register_error_handler(&rf_device, h);
+  }
 }
 
   
@@ -0,0 +1,258 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "radio/radio_file.h"
+
+namespace srslte {
+
+radio_file::radio_file()
+{
+  initiated      = false; 
+  rx_fd          = -1; 
+  rx_map         = NULL; 
+  rx_map_len     = 0; 
+  rx_nof_samples = 0; 
+  rx_pos         = 0; 
+  tx_file        = NULL; 
+  rec_file       = NULL; 
+  rx_srate       = 1.92e6; 
+  tx_srate       = 1.92e6; 
+  paced          = false; 
+  loop           = false; 
+  pace_started   = false; 
+  bzero(rx_filename, max_path_len);
+  bzero(tx_filename, max_path_len);
+  bzero(&rx_time, sizeof(srslte_timestamp_t));
+  bzero(&pace_start, sizeof(struct timespec));
+}
+
+radio_file::~radio_file()
+{
+  stop();
+}
+
+bool radio_file::init(char *args)
+{
+  if (!args) {
+    fprintf(stderr, "File RF device requires rx_file=<path> in the device arguments\n");
+    return false; 
+  }
+  
+  // Parse comma-separated arguments 
+  char *args_cpy = strdup(args);
+  char *saveptr  = NULL; 
+  for (char *tok = strtok_r(args_cpy, ",", &saveptr); tok; tok = strtok_r(NULL, ",", &saveptr)) {
+    if (!strncmp(tok, "rx_file=", 8)) {
+      strncpy(rx_filename, &tok[8], max_path_len-1);
+    } else if (!strncmp(tok, "tx_file=", 8)) {
+      strncpy(tx_filename, &tok[8], max_path_len-1);
+    } else if (!strcmp(tok, "paced")) {
+      paced = true; 
+    } else if (!strcmp(tok, "loop")) {
+      loop = true; 
+    } else {
+      fprintf(stderr, "Warning unknown file RF device argument %s\n", tok);
+    }
+  }
+  free(args_cpy);
+  
+  if (!strlen(rx_filename)) {
+    fprintf(stderr, "File RF device requires rx_file=<path> in the device arguments\n");
+    return false; 
+  }
+  
+  rx_fd = open(rx_filename, O_RDONLY);
+  if (rx_fd < 0) {
+    fprintf(stderr, "Error opening RX file %s: %s\n", rx_filename, strerror(errno));
+    return false; 
+  }
+  struct stat st; 
+  if (fstat(rx_fd, &st) || st.st_size < (off_t) sizeof(cf_t)) {
+    fprintf(stderr, "Error RX file %s is empty\n", rx_filename);
+    stop();
+    return false; 
+  }
+  rx_map_len     = st.st_size; 
+  rx_nof_samples = rx_map_len/sizeof(cf_t);
+  rx_map = (cf_t*) mmap(NULL, rx_map_len, PROT_READ, MAP_PRIVATE, rx_fd, 0);
+  if (rx_map == MAP_FAILED) {
+    fprintf(stderr, "Error mapping RX file %s: %s\n", rx_filename, strerror(errno));
+    rx_map = NULL; 
+    stop();
+    return false; 
+  }
+  madvise(rx_map, rx_map_len, MADV_SEQUENTIAL);
+  
+  if (strlen(tx_filename)) {
+    tx_file = fopen(tx_filename, "w");
+    if (!tx_file) {
+      fprintf(stderr, "Error opening TX file %s: %s\n", tx_filename, strerror(errno));
+      stop();
+      return false; 
+    }
+  }
+  
+  rx_pos       = 0; 
+  pace_started = false; 
+  bzero(&rx_time, sizeof(srslte_timestamp_t));
+  initiated    = true; 
+  
+  printf("Opened file RF device: %s (%lu samples), TX to %s, %s%s\n", 
+         rx_filename, (unsigned long) rx_nof_samples, tx_file?tx_filename:"none", 
+         paced?"paced":"as fast as possible", loop?", loop":"");
+  return true; 
+}
+
+void radio_file::stop()
+{
+  if (rx_map) {
+    munmap(rx_map, rx_map_len);
+    rx_map = NULL; 
+  }
+  if (rx_fd >= 0) {
+    close(rx_fd);
+    rx_fd = -1; 
+  }
+  if (tx_file) {
+    fclose(tx_file);
+    tx_file = NULL; 
+  }
+  if (rec_file) {
+    fclose(rec_file);
+    rec_file = NULL; 
+  }
+  initiated = false; 
+}
+
+bool radio_file::is_init()
+{
+  return initiated; 
+}
+
+void radio_file::set_rx_srate(double srate)
+{
+  rx_srate = srate; 
+}
+
+void radio_file::set_tx_srate(double srate)
+{
+  tx_srate = srate; 
+}
+
+/* Sleeps until the wall-clock time matches the time of the next sample */
+void radio_file::pace()
+{
+  if (!pace_started) {
+    clock_gettime(CLOCK_MONOTONIC, &pace_start);
+    pace_started = true; 
+  }
+  double elapsed = srslte_timestamp_real(&rx_time); 
+  struct timespec t; 
+  t.tv_sec  = pace_start.tv_sec  + (time_t) elapsed; 
+  t.tv_nsec = pace_start.tv_nsec + (long) ((elapsed - (time_t) elapsed)*1e9);
+  if (t.tv_nsec >= 1000000000) {
+    t.tv_sec++;
+    t.tv_nsec -= 1000000000; 
+  }
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR);
+}
+
+bool radio_file::rx(void *buffer, uint32_t nof_samples, srslte_timestamp_t *rxd_time)
+{
+  if (!initiated) {
+    return false; 
+  }
+  cf_t *out = (cf_t*) buffer; 
+  uint32_t n = 0; 
+  while (n < nof_samples) {
+    if (rx_pos == rx_nof_samples) {
+      if (!loop) {
+        printf("End of RX file %s\n", rx_filename);
+        return false; 
+      }
+      rx_pos = 0; 
+    }
+    uint32_t len = (uint32_t) SRSLTE_MIN((uint64_t) (nof_samples - n), rx_nof_samples - rx_pos);
+    memcpy(&out[n], &rx_map[rx_pos], len*sizeof(cf_t));
+    rx_pos += len; 
+    n      += len; 
+  }
+  
+  if (rxd_time) {
+    srslte_timestamp_copy(rxd_time, &rx_time);
+  }
+  srslte_timestamp_add(&rx_time, 0, (double) nof_samples/rx_srate);
+  
+  // Samples are handed out once the last one would have been received
+  if (paced) {
+    pace();
+  }
+  return true; 
+}
+
+bool radio_file::tx(void *buffer, uint32_t nof_samples, srslte_timestamp_t tx_time)
+{
+  if (tx_file && nof_samples) {
+    if (fwrite(buffer, sizeof(cf_t), nof_samples, tx_file) != nof_samples) {
+      fprintf(stderr, "Error writing TX file %s\n", tx_filename);
+      return false; 
+    }
+  }
+  return true; 
+}
+
+void radio_file::get_time(srslte_timestamp_t *now)
+{
+  srslte_timestamp_copy(now, &rx_time);
+}
+
+bool radio_file::start_record(const char *filename)
+{
+  rec_file = fopen(filename, "w");
+  if (!rec_file) {
+    fprintf(stderr, "Error opening record file %s: %s\n", filename, strerror(errno));
+    return false; 
+  }
+  printf("Recording received samples to %s\n", filename);
+  return true; 
+}
+
+void radio_file::record(void *buffer, uint32_t nof_samples)
+{
+  if (rec_file) {
+    fwrite(buffer, sizeof(cf_t), nof_samples, rec_file);
+  }
+}
+
+}
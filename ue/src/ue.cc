@@ -69,6 +69,7 @@ void ue::cleanup(void)
 
 ue::ue()
     :started(false)
+    ,replaying(false)
 {
   pool = buffer_pool::get_instance();
 }
@@ -118,20 +119,65 @@ bool ue::init(all_args_t *args_)
   gw_log.set_hex_limit(args->log.gw_hex_limit);
   usim_log.set_hex_limit(args->log.usim_hex_limit);
 
-  // Set up pcap and trace
+  // Set up pcap
   if(args->pcap.enable)
   {
     mac_pcap.open(args->pcap.filename.c_str());
     mac.start_pcap(&mac_pcap);
   }
-  if(args->trace.enable)
-  {
-    phy.start_trace();
-    radio.start_trace();
-  }
   
   // Init layers
   
+  /* The PHY calls the MAC and RRC through the recorder, and the MAC calls the PHY through it, 
+   * when the PHY-MAC interface is recorded. A replay replaces the radio and the PHY */
+  phy_interface_mac *phy_mac = &phy; 
+  phy_interface_rrc *phy_rrc = &phy; 
+  mac_interface_phy *mac_phy = &mac; 
+  rrc_interface_phy *rrc_phy = &rrc; 
+  
+  replaying = args->trace.mac_replay_filename.length() > 0; 
+  if (replaying) {
+    if (!mac_replay.init(args->trace.mac_replay_filename, args->trace.mac_replay_realtime, &mac, &rrc, &phy_log)) {
+      return false; 
+    }
+    phy_mac = &mac_replay; 
+    phy_rrc = &mac_replay; 
+  } else {
+    if (args->trace.mac_record_filename.length() > 0) {
+      if (!mac_recorder.init(args->trace.mac_record_filename, &mac, &rrc, &phy, &phy_log)) {
+        return false; 
+      }
+      phy_mac = &mac_recorder; 
+      mac_phy = &mac_recorder; 
+      rrc_phy = &mac_recorder; 
+    }
+    if(args->trace.enable)
+    {
+      phy.start_trace();
+      radio.start_trace();
+    }
+    if (!init_radio_phy(mac_phy, rrc_phy)) {
+      return false; 
+    }
+  }
+
+  mac.init(phy_mac, &rlc, &rrc, &mac_log);
+  rlc.init(&pdcp, &rrc, this, &rlc_log, &mac, &mac);
+  pdcp.init(&rlc, &rrc, &gw, &pdcp_log);
+  rrc.init(phy_rrc, &mac, &rlc, &pdcp, &nas, &usim, &mac, &rrc_log);
+  if (args->expert.phy.cell_cache_filename.length() > 0) {
+    rrc.set_si_cache(args->expert.phy.cell_cache_filename + ".si");
+  }
+  nas.init(&usim, &rrc, &gw, &nas_log);
+  gw.init(&pdcp, &rrc, this, &gw_log);
+  usim.init(&args->usim, &usim_log);
+
+  started = true;
+  return true;
+}
+
+bool ue::init_radio_phy(mac_interface_phy *mac_phy, rrc_interface_phy *rrc_phy)
+{
   /* Start Radio */
   char *dev_name = NULL;
   if (args->rf.device_name.compare("auto")) {
@@ -159,13 +205,19 @@ bool ue::init(all_args_t *args_)
   }
   
   radio.set_manual_calibration(&args->rf_cal);
+  
+  if (args->rf.record_filename.length() > 0) {
+    if (!radio.start_record(args->rf.record_filename.c_str())) {
+      return false; 
+    }
+  }
 
   if (args->rf.tx_gain > 0) {
     args->expert.phy.ul_pwr_ctrl_en = false; 
   } else {
     args->expert.phy.ul_pwr_ctrl_en = true; 
   }
-  phy.init(&radio, &mac, &rrc, &phy_log, &args->expert.phy);
+  phy.init(&radio, mac_phy, rrc_phy, &phy_log, &args->expert.phy);
   
   if (args->rf.rx_gain < 0) {
     radio.start_agc(false);    
@@ -189,22 +241,19 @@ bool ue::init(all_args_t *args_)
   radio.set_tx_freq(args->rf.ul_freq);
 
   phy_log.console("Setting frequency: DL=%.1f Mhz, UL=%.1f MHz\n", args->rf.dl_freq/1e6, args->rf.ul_freq/1e6);
-
-  mac.init(&phy, &rlc, &rrc, &mac_log);
-  rlc.init(&pdcp, &rrc, this, &rlc_log, &mac);
-  pdcp.init(&rlc, &rrc, &gw, &pdcp_log);
-  rrc.init(&phy, &mac, &rlc, &pdcp, &nas, &usim, &mac, &rrc_log);
-  nas.init(&usim, &rrc, &gw, &nas_log);
-  gw.init(&pdcp, &rrc, this, &gw_log);
-  usim.init(&args->usim, &usim_log);
-
-  started = true;
   return true;
 }
 
 void ue::pregenerate_signals(bool enable)
 {
-  phy.enable_pregen_signals(enable);
+  if (!replaying) {
+    phy.enable_pregen_signals(enable);
+  }
+}
+
+bool ue::replay_finished()
+{
+  return replaying && mac_replay.is_finished();
 }
 
 void ue::test_con_restablishment() {
@@ -222,14 +271,19 @@ void ue::stop()
     pdcp.stop();
     rlc.stop();
     mac.stop();
-    phy.stop();
+    if (replaying) {
+      mac_replay.stop();
+    } else {
+      phy.stop();
+      mac_recorder.stop();
+    }
  
     usleep(1e5);
     if(args->pcap.enable)
     {
        mac_pcap.close();
     }
-    if(args->trace.enable)
+    if(args->trace.enable && !replaying)
     {
       phy.write_trace(args->trace.phy_filename);
       radio.write_trace(args->trace.radio_filename);
@@ -244,7 +298,9 @@ bool ue::is_attached()
 }
 
 void ue::start_plot() {
-  phy.start_plot();
+  if (!replaying) {
+    phy.start_plot();
+  }
 }
 
 bool ue::get_metrics(ue_metrics_t &m)
@@ -255,7 +311,11 @@ bool ue::get_metrics(ue_metrics_t &m)
 
   if(EMM_STATE_REGISTERED == nas.get_state()) {
     if(RRC_STATE_RRC_CONNECTED == rrc.get_state()) {
-      phy.get_metrics(m.phy);
+      if (replaying) {
+        bzero(&m.phy, sizeof(phy_metrics_t));
+      } else {
+        phy.get_metrics(m.phy);
+      }
       mac.get_metrics(m.mac);
       rlc.get_metrics(m.rlc);
       gw.get_metrics(m.gw);
@@ -37,19 +37,26 @@ namespace srsue{
 rlc::rlc()
 {
   pool = buffer_pool::get_instance();
+  mac  = NULL;
+  for(uint32_t i=0; i<SRSUE_N_RADIO_BEARERS; i++) {
+    __atomic_store_n(&buffer_state[i], 0, __ATOMIC_RELEASE);
+    has_buffer_state_timer[i] = false;
+  }
 }
 
 void rlc::init(pdcp_interface_rlc *pdcp_,
                rrc_interface_rlc  *rrc_,
                ue_interface       *ue_,
                srslte::log        *rlc_log_, 
-               mac_interface_timers *mac_timers_)
+               mac_interface_timers *mac_timers_,
+               mac_interface_rlc  *mac_)
 {
   pdcp    = pdcp_;
   rrc     = rrc_;
   ue      = ue_;
   rlc_log = rlc_log_;
   mac_timers = mac_timers_;
+  mac     = mac_;
 
   metrics_time = bpt::microsec_clock::local_time();
   reset_metrics(); 
@@ -96,6 +103,9 @@ void rlc::reset()
   for(uint32_t i=0; i<SRSUE_N_RADIO_BEARERS; i++) {
     if(rlc_array[i].active())
       rlc_array[i].reset();
+    if(has_buffer_state_timer[i])
+      mac_timers->get(buffer_state_timer_id[i])->stop();
+    __atomic_store_n(&buffer_state[i], 0, __ATOMIC_RELEASE);
   }
 
   rlc_array[0].init(RLC_MODE_TM, rlc_log, RB_ID_SRB0, pdcp, rrc, mac_timers); // SRB0
@@ -108,6 +118,7 @@ void rlc::write_sdu(uint32_t lcid, byte_buffer_t *sdu)
 {
   if(valid_lcid(lcid)) {
     rlc_array[lcid].write_sdu(sdu);
+    update_buffer_state(lcid);
   }
 }
 
@@ -116,8 +127,8 @@ void rlc::write_sdu(uint32_t lcid, byte_buffer_t *sdu)
 *******************************************************************************/
 uint32_t rlc::get_buffer_state(uint32_t lcid)
 {
-  if(valid_lcid(lcid)) {
-    return rlc_array[lcid].get_buffer_state();
+  if(lcid < SRSUE_N_RADIO_BEARERS) {
+    return __atomic_load_n(&buffer_state[lcid], __ATOMIC_ACQUIRE);
   } else {
     return 0;
   }
@@ -136,7 +147,11 @@ int rlc::read_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes)
 {
   if(valid_lcid(lcid)) {
     ul_tput_bytes[lcid] += nof_bytes;
-    return rlc_array[lcid].read_pdu(payload, nof_bytes);
+    int n = rlc_array[lcid].read_pdu(payload, nof_bytes);
+    if(n > 0) {
+      update_buffer_state(lcid);
+    }
+    return n;
   }
   return 0;
 }
@@ -146,6 +161,22 @@ void rlc::write_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes)
   if(valid_lcid(lcid)) {
     dl_tput_bytes[lcid] += nof_bytes;
     rlc_array[lcid].write_pdu(payload, nof_bytes);
+    if(RLC_MODE_AM == rlc_array[lcid].get_mode()) {
+      update_buffer_state(lcid); // STATUS reports and retransmissions
+    }
+  }
+}
+
+void rlc::write_pdus(uint32_t lcid, pdu_iov_t *pdus, uint32_t nof_pdus)
+{
+  if(valid_lcid(lcid)) {
+    for (uint32_t i=0;i<nof_pdus;i++) {
+      dl_tput_bytes[lcid] += pdus[i].nof_bytes;
+    }
+    rlc_array[lcid].write_pdus(pdus, nof_pdus);
+    if(RLC_MODE_AM == rlc_array[lcid].get_mode()) {
+      update_buffer_state(lcid); // STATUS reports and retransmissions
+    }
   }
 }
 
@@ -224,6 +255,10 @@ void rlc::add_bearer(uint32_t lcid, LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
     {
     case LIBLTE_RRC_RLC_MODE_AM:
       rlc_array[lcid].init(RLC_MODE_AM, rlc_log, lcid, pdcp, rrc, mac_timers);
+      if(!has_buffer_state_timer[lcid]) {
+        buffer_state_timer_id[lcid]  = mac_timers->get_unique_id();
+        has_buffer_state_timer[lcid] = true;
+      }
       break;
     case LIBLTE_RRC_RLC_MODE_UM_BI:
       rlc_array[lcid].init(RLC_MODE_UM, rlc_log, lcid, pdcp, rrc, mac_timers);
@@ -242,12 +277,50 @@ void rlc::add_bearer(uint32_t lcid, LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
     rlc_log->warning("Bearer %s already created.\n", rb_id_text[lcid]);
   }
   rlc_array[lcid].configure(cnfg);    
+  update_buffer_state(lcid);
+}
 
+/*******************************************************************************
+  Timer callback
+*******************************************************************************/
+void rlc::timer_expired(uint32_t timer_id)
+{
+  for(uint32_t i=0; i<SRSUE_N_RADIO_BEARERS; i++) {
+    if(has_buffer_state_timer[i] && buffer_state_timer_id[i] == timer_id) {
+      update_buffer_state(i);
+    }
+  }
 }
 
 /*******************************************************************************
   Helpers
 *******************************************************************************/
+
+/* Reading the entity and storing the result is serialized per bearer, so a writer 
+ * never overwrites the snapshot with a value older than the one of another writer. 
+ * MAC is told right away about new data so that it triggers the Regular BSR without waiting for its TTI. 
+ * The wake-up timer is re-armed under the same lock, so an expiry racing with it is followed by 
+ * another update that arms it again */
+void rlc::update_buffer_state(uint32_t lcid)
+{
+  boost::lock_guard<boost::mutex> lock(buffer_state_mutex[lcid]);
+  uint32_t prev = __atomic_load_n(&buffer_state[lcid], __ATOMIC_ACQUIRE);
+  uint32_t cur  = rlc_array[lcid].get_buffer_state();
+  __atomic_store_n(&buffer_state[lcid], cur, __ATOMIC_RELEASE);
+  if(has_buffer_state_timer[lcid]) {
+    srslte::timers::timer *t = mac_timers->get(buffer_state_timer_id[lcid]);
+    int32_t msec = rlc_array[lcid].msec_to_timer_expiry();
+    if(msec >= 0) {
+      t->set(this, msec+1);
+      t->run();
+    } else {
+      t->stop();
+    }
+  }
+  if(cur > prev && mac) {
+    mac->notify_ul_data(lcid);
+  }
+}
 bool rlc::valid_lcid(uint32_t lcid)
 {
   if(lcid < 0 || lcid >= SRSUE_N_RADIO_BEARERS) {
@@ -57,6 +57,15 @@ rlc_am::rlc_am() : tx_sdu_queue(16)
 
   poll_received = false;
   do_status     = false;
+  rx_pending    = false;
+
+  status_nack_bits = 0;
+
+  retx_head = retx_none;
+  retx_tail = retx_none;
+
+  status_len    = 0;
+  nof_rx_status = 0;
 }
 
 void rlc_am::init(srslte::log          *log_,
@@ -69,6 +78,10 @@ void rlc_am::init(srslte::log          *log_,
   lcid = lcid_;
   pdcp = pdcp_;
   rrc  = rrc_;
+
+  tx_window.init();
+  rx_window.init();
+  rx_segments.init();
 }
 
 void rlc_am::configure(LIBLTE_RRC_RLC_CONFIG_STRUCT *cnfg)
@@ -101,6 +114,7 @@ void rlc_am::empty_queue() {
 void rlc_am::reset()
 {
   reordering_timeout.reset();
+  poll_retx_timeout.reset();
   if(tx_sdu)
     tx_sdu->reset();
   if(rx_sdu)
@@ -122,37 +136,36 @@ void rlc_am::reset()
 
   poll_received = false;
   do_status     = false;
+  rx_pending    = false;
+
+  status_nack_bits = 0;
 
   empty_queue();
 
-  // Drop all messages in RX segments
-  std::map<uint32_t, rlc_amd_rx_pdu_segments_t>::iterator rxsegsit;
-  std::list<rlc_amd_rx_pdu_t>::iterator                   segit;
-  for(rxsegsit = rx_segments.begin(); rxsegsit != rx_segments.end(); rxsegsit++) {
-    std::list<rlc_amd_rx_pdu_t> l = rxsegsit->second.segments;
-    for(segit = l.begin(); segit != l.end(); segit++) {
-      pool->deallocate(segit->buf);
-    }
-    l.clear();
+  // Drop all messages in RX segments, RX window and TX window
+  for(uint32_t sn=0; sn<MOD; sn++) {
+    if(rx_segments.has(sn))
+      pool->deallocate(rx_segments[sn].buf);
+    if(rx_window.has(sn))
+      pool->deallocate(rx_window[sn].buf);
+    if(tx_window.has(sn))
+      pool->deallocate(tx_window[sn].buf);
   }
   rx_segments.clear();
-  
-  // Drop all messages in RX window
-  std::map<uint32_t, rlc_amd_rx_pdu_t>::iterator rxit;
-  for(rxit = rx_window.begin(); rxit != rx_window.end(); rxit++) {
-    pool->deallocate(rxit->second.buf);
-  }
   rx_window.clear();
-
-  // Drop all messages in TX window
-  std::map<uint32_t, rlc_amd_tx_pdu_t>::iterator txit;
-  for(txit = tx_window.begin(); txit != tx_window.end(); txit++) {
-    pool->deallocate(txit->second.buf);
-  }
   tx_window.clear();
 
   // Drop all messages in RETX queue
-  retx_queue.clear();
+  retx_head = retx_none;
+  retx_tail = retx_none;
+
+  // Drop the status handoff
+  boost::lock_guard<boost::mutex> lock(status_mutex);
+  for(uint32_t i=0; i<nof_rx_status; i++)
+    pool->deallocate(rx_status[i]);
+  nof_rx_status = 0;
+  status_len    = 0;
+  status_prohibit_timeout.reset();
 }
 
 rlc_mode_t rlc_am::get_mode()
@@ -181,25 +194,31 @@ void rlc_am::write_sdu(byte_buffer_t *sdu)
 
 uint32_t rlc_am::get_total_buffer_state()
 {
-  boost::lock_guard<boost::mutex> lock(mutex);
   uint32_t n_bytes = 0;
   uint32_t n_sdus  = 0;
 
+  // The RX side checks its timers unless it is busy with PDUs from the MAC
+  {
+    boost::unique_lock<boost::mutex> rx_lock(rx_mutex, boost::try_to_lock);
+    if(rx_lock.owns_lock())
+      check_reordering_timeout();
+  }
+
   // Bytes needed for status report
-  check_reordering_timeout();
-  if(do_status && !status_prohibited()) {
-    n_bytes += prepare_status();
+  n_bytes += status_due();
+  if(n_bytes > 0)
     log->debug("Buffer state - status report: %d bytes\n", n_bytes);
-  }
+
+  boost::lock_guard<boost::mutex> lock(tx_mutex);
+  handle_rx_status();
+  check_poll_retx();
 
   // Bytes needed for retx
-  if(retx_queue.size() > 0) {
-    rlc_amd_retx_t retx = retx_queue.front();
+  if(!retx_empty()) {
+    rlc_amd_retx_t retx = retx_front();
     log->debug("Buffer state - retx - SN: %d, Segment: %s, %d:%d\n", retx.sn, retx.is_segment ? "true" : "false", retx.so_start, retx.so_end);
-    if(tx_window.end() != tx_window.find(retx.sn)) {
-        n_bytes += required_buffer_size(retx);
-        log->debug("Buffer state - retx: %d bytes\n", n_bytes);
-    }
+    n_bytes += required_buffer_size(retx);
+    log->debug("Buffer state - retx: %d bytes\n", n_bytes);
   }
 
   // Bytes needed for tx SDUs
@@ -226,27 +245,34 @@ uint32_t rlc_am::get_total_buffer_state()
 
 uint32_t rlc_am::get_buffer_state()
 {
-  boost::lock_guard<boost::mutex> lock(mutex);
   uint32_t n_bytes = 0;
   uint32_t n_sdus  = 0;
 
+  // The RX side checks its timers unless it is busy with PDUs from the MAC
+  {
+    boost::unique_lock<boost::mutex> rx_lock(rx_mutex, boost::try_to_lock);
+    if(rx_lock.owns_lock())
+      check_reordering_timeout();
+  }
+
   // Bytes needed for status report
-  check_reordering_timeout();
-  if(do_status && !status_prohibited()) {
-    n_bytes = prepare_status();
+  n_bytes = status_due();
+  if(n_bytes > 0) {
     log->debug("Buffer state - status report: %d bytes\n", n_bytes);
     return n_bytes;
   }
 
+  boost::lock_guard<boost::mutex> lock(tx_mutex);
+  handle_rx_status();
+  check_poll_retx();
+
   // Bytes needed for retx
-  if(retx_queue.size() > 0) {
-    rlc_amd_retx_t retx = retx_queue.front();
+  if(!retx_empty()) {
+    rlc_amd_retx_t retx = retx_front();
     log->debug("Buffer state - retx - SN: %d, Segment: %s, %d:%d\n", retx.sn, retx.is_segment ? "true" : "false", retx.so_start, retx.so_end);
-    if(tx_window.end() != tx_window.find(retx.sn)) {
-        n_bytes = required_buffer_size(retx);
-        log->debug("Buffer state - retx: %d bytes\n", n_bytes);
-        return n_bytes;
-    }
+    n_bytes = required_buffer_size(retx);
+    log->debug("Buffer state - retx: %d bytes\n", n_bytes);
+    return n_bytes;
   }
 
   // Bytes needed for tx SDUs
@@ -273,33 +299,73 @@ uint32_t rlc_am::get_buffer_state()
 
 int rlc_am::read_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
-  boost::lock_guard<boost::mutex> lock(mutex);
-
   log->debug("MAC opportunity - %d bytes\n", nof_bytes);
 
   // Tx STATUS if requested
-  if(do_status && !status_prohibited())
-    return build_status_pdu(payload, nof_bytes);
+  int len = read_status_pdu(payload, nof_bytes);
+  if(len > 0)
+    return len;
+
+  boost::lock_guard<boost::mutex> lock(tx_mutex);
+  handle_rx_status();
+  return build_pdu(payload, nof_bytes);
+}
+
+// Status PDUs from the peer are handed to the TX side, data PDUs are handled by the RX side
+void rlc_am::write_pdu(uint8_t *payload, uint32_t nof_bytes)
+{
+  if(nof_bytes < 1)
+    return;
+  if(rlc_am_is_control_pdu(payload)) {
+    queue_rx_status(payload, nof_bytes);
+    return;
+  }
+  boost::lock_guard<boost::mutex> lock(rx_mutex);
+  handle_pdu(payload, nof_bytes);
+  update_rx_window();
+  check_reordering_timeout();
+  update_status_handoff();
+}
+
+// All PDUs of the burst go into the windows before SDUs are reassembled and timers updated
+void rlc_am::write_pdus(rlc_interface_mac::pdu_iov_t *pdus, uint32_t nof_pdus)
+{
+  boost::lock_guard<boost::mutex> lock(rx_mutex);
+  for(uint32_t i=0;i<nof_pdus;i++) {
+    if(pdus[i].nof_bytes > 0)
+      handle_pdu(pdus[i].payload, pdus[i].nof_bytes);
+  }
+  update_rx_window();
+  check_reordering_timeout();
+  update_status_handoff();
+}
+
+/****************************************************************************
+ * Tx/Rx PDU handling, called with the tx_mutex or rx_mutex locked
+ ***************************************************************************/
+
+int rlc_am::build_pdu(uint8_t *payload, uint32_t nof_bytes)
+{
+  check_poll_retx();
 
   // RETX if required
-  if(retx_queue.size() > 0)
+  if(!retx_empty())
     return build_retx_pdu(payload, nof_bytes);
 
   // Build a PDU from SDUs
   return build_data_pdu(payload, nof_bytes);
 }
 
-void rlc_am::write_pdu(uint8_t *payload, uint32_t nof_bytes)
+void rlc_am::handle_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
-  if(nof_bytes < 1)
-    return;
-  boost::lock_guard<boost::mutex> lock(mutex);
-
   if(rlc_am_is_control_pdu(payload)) {
-    handle_control_pdu(payload, nof_bytes);
+    queue_rx_status(payload, nof_bytes);
   } else {
-    rlc_amd_pdu_header_t header;
+    rlc_amd_pdu_header_t &header = rx_header;
     rlc_am_read_data_pdu_header(&payload, &nof_bytes, &header);
+    // PDUs of this burst not yet reassembled hold the low edge of the rx window back
+    if(rx_pending && !inside_rx_window(header.sn))
+      update_rx_window();
     if(header.rf) {
       handle_data_pdu_segment(payload, nof_bytes, header);
     }else{
@@ -308,6 +374,76 @@ void rlc_am::write_pdu(uint8_t *payload, uint32_t nof_bytes)
   }
 }
 
+/****************************************************************************
+ * Status handoff between the RX and TX sides
+ ***************************************************************************/
+
+// Called with the rx_mutex locked after the RX state changes
+void rlc_am::update_status_handoff()
+{
+  uint32_t len = do_status ? status_length() : 0;
+  boost::lock_guard<boost::mutex> lock(status_mutex);
+  status_len = len;
+}
+
+// Size of the status report the RX side has pending, 0 if none or if prohibited
+uint32_t rlc_am::status_due()
+{
+  boost::lock_guard<boost::mutex> lock(status_mutex);
+  if(status_len > 0 && !status_prohibited())
+    return status_len;
+  return 0;
+}
+
+// Builds the pending status PDU, unless the RX side is busy with PDUs from the MAC. In that
+// case the opportunity goes to the TX side and the status waits for the next one
+int rlc_am::read_status_pdu(uint8_t *payload, uint32_t nof_bytes)
+{
+  if(status_due() == 0)
+    return 0;
+  boost::unique_lock<boost::mutex> rx_lock(rx_mutex, boost::try_to_lock);
+  if(!rx_lock.owns_lock() || !do_status)
+    return 0;
+  return build_status_pdu(payload, nof_bytes);
+}
+
+void rlc_am::queue_rx_status(uint8_t *payload, uint32_t nof_bytes)
+{
+  byte_buffer_t *buf = pool->allocate();
+  if (!buf) {
+    log->console("Fatal Error: Could not allocate PDU in queue_rx_status()\n");
+    exit(-1);
+  }
+  rlc_memcpy(buf->msg, payload, nof_bytes);
+  buf->N_bytes = nof_bytes;
+
+  boost::lock_guard<boost::mutex> lock(status_mutex);
+  if(nof_rx_status == RLC_AM_MAX_RX_STATUS) {
+    // The oldest report is covered by the newer ones
+    pool->deallocate(rx_status[0]);
+    memmove(&rx_status[0], &rx_status[1], (RLC_AM_MAX_RX_STATUS-1)*sizeof(byte_buffer_t*));
+    nof_rx_status--;
+  }
+  rx_status[nof_rx_status++] = buf;
+}
+
+// Called with the tx_mutex locked before the TX side reports its state or builds a PDU
+void rlc_am::handle_rx_status()
+{
+  byte_buffer_t *pdus[RLC_AM_MAX_RX_STATUS];
+  uint32_t       nof_pdus;
+  {
+    boost::lock_guard<boost::mutex> lock(status_mutex);
+    nof_pdus = nof_rx_status;
+    memcpy(pdus, rx_status, nof_pdus*sizeof(byte_buffer_t*));
+    nof_rx_status = 0;
+  }
+  for(uint32_t i=0; i<nof_pdus; i++) {
+    handle_control_pdu(pdus[i]->msg, pdus[i]->N_bytes);
+    pool->deallocate(pdus[i]);
+  }
+}
+
 /****************************************************************************
  * Timer checks
  ***************************************************************************/
@@ -322,6 +458,57 @@ bool rlc_am::poll_retx()
   return (poll_retx_timeout.is_running() && poll_retx_timeout.expired());
 }
 
+static int32_t first_expiry(int32_t a, int32_t b)
+{
+  return (a < 0 || (b >= 0 && b < a)) ? b : a;
+}
+
+// Each timer is read with the lock of the side that runs it. A busy TX or RX side refreshes
+// the buffer state itself once done, so it is not waited for
+int32_t rlc_am::msec_to_timer_expiry()
+{
+  int32_t msec = -1;
+  {
+    boost::lock_guard<boost::mutex> lock(status_mutex);
+    if(status_len > 0)
+      msec = status_prohibit_timeout.msec_to_expire();
+  }
+  {
+    boost::unique_lock<boost::mutex> rx_lock(rx_mutex, boost::try_to_lock);
+    if(rx_lock.owns_lock())
+      msec = first_expiry(msec, reordering_timeout.msec_to_expire());
+  }
+  boost::unique_lock<boost::mutex> tx_lock(tx_mutex, boost::try_to_lock);
+  if(tx_lock.owns_lock())
+    msec = first_expiry(msec, poll_retx_timeout.msec_to_expire());
+  return msec;
+}
+
+void rlc_am::check_poll_retx()
+{
+  if(!poll_retx() || !retx_empty() || tx_window.size() == 0)
+    return;
+
+  // 36.322 v10 Section 5.2.2.3 - with no new data to carry the poll, retransmit a PDU
+  bool window_stalled = TX_MOD_BASE(vt_s) >= RLC_AM_WINDOW_SIZE;
+  if((tx_sdu || tx_sdu_queue.size() > 0) && !window_stalled)
+    return;
+
+  uint32_t sn = (vt_s + MOD - 1)%MOD;
+  if(!tx_window.has(sn) || tx_window[sn].is_acked)
+    sn = vt_a;
+  if(!tx_window.has(sn))
+    return;
+
+  log->info("%s Poll retx timeout - SN: %d scheduled for retx\n", rb_id_text[lcid], sn);
+  rlc_amd_retx_t retx;
+  retx.sn         = sn;
+  retx.is_segment = false;
+  retx.so_start   = 0;
+  retx.so_end     = tx_window[sn].buf->N_bytes;
+  retx_push_back(retx);
+}
+
 void rlc_am::check_reordering_timeout()
 {
   if(reordering_timeout.is_running() && reordering_timeout.expired())
@@ -330,13 +517,16 @@ void rlc_am::check_reordering_timeout()
     log->debug("%s reordering timeout expiry - updating vr_ms\n", rb_id_text[lcid]);
 
     // 36.322 v10 Section 5.1.3.2.4
+    uint32_t old_vr_ms = vr_ms;
     vr_ms = vr_x;
-    std::map<uint32_t, rlc_amd_rx_pdu_t>::iterator it = rx_window.find(vr_ms);
-    while(rx_window.end() != it)
-    {
+    while(rx_window.has(vr_ms))
       vr_ms = (vr_ms + 1)%MOD;
-      it = rx_window.find(vr_ms);
-    }
+
+    // Add or drop the NACKs of the SNs vr_ms moved over
+    if(RX_MOD_BASE(vr_ms) > RX_MOD_BASE(old_vr_ms))
+      status_nack_bits += nack_bits(old_vr_ms, vr_ms);
+    else
+      status_nack_bits -= nack_bits(vr_ms, old_vr_ms);
     if(poll_received)
       do_status = true;
 
@@ -346,6 +536,7 @@ void rlc_am::check_reordering_timeout()
       vr_x = vr_h;
     }
 
+    update_status_handoff();
     debug_state();
   }
 }
@@ -362,58 +553,158 @@ bool rlc_am::poll_required()
     return true;
   if(poll_retx())
     return true;
+
+  // 36.322 v10 Section 5.2.2.1 - poll when the buffers empty or the tx window stalls
+  if(!tx_sdu && tx_sdu_queue.size() == 0 && retx_empty())
+    return true;
+  if(TX_MOD_BASE(vt_s) >= RLC_AM_WINDOW_SIZE - 1)
+    return true;
   return false;
 }
 
-int rlc_am::prepare_status()
+// Bits taken by the NACKs of an SN in the status PDU
+uint32_t rlc_am::nack_bits(uint32_t sn)
 {
-  status.N_nack = 0;
-  status.ack_sn = vr_ms;
+  if(rx_window.has(sn))
+    return 0;
+  if(!rx_segments.has(sn))
+    return 12;                  // 10 bits SN, 2 bits ext
+
+  // One NACK with SO range for each byte range not yet received
+  rlc_amd_rx_pdu_segments_t &pdu = rx_segments[sn];
+  uint32_t nof_gaps = pdu.nof_intervals - 1;
+  if(pdu.intervals[0].so_start > 0)
+    nof_gaps++;
+  if(pdu.len == 0 || pdu.intervals[pdu.nof_intervals-1].so_end < pdu.len)
+    nof_gaps++;
+  return nof_gaps*42;           // 10 bits SN, 2 bits ext, 15 bits so_start, 15 bits so_end
+}
 
-  // We don't use segment NACKs - just NACK the full PDU
+uint32_t rlc_am::nack_bits(uint32_t sn_start, uint32_t sn_end)
+{
+  uint32_t bits = 0;
+  for(uint32_t sn = sn_start; sn != sn_end; sn = (sn + 1)%MOD)
+    bits += nack_bits(sn);
+  return bits;
+}
 
-  uint32_t i = vr_r;
-  while(RX_MOD_BASE(i) < RX_MOD_BASE(vr_ms))
-  {
-    if(rx_window.find(i) == rx_window.end())
-      status.nacks[status.N_nack++].nack_sn = i;
-    i = (i + 1)%MOD;
+int rlc_am::status_length()
+{
+  return (15 + status_nack_bits + 7)/8;   // Fixed part is 15 bits
+}
+
+// Writes the nbits LSBs of value at bit offset *pos of a zeroed buffer
+static void rlc_am_write_bits(uint8_t *payload, uint32_t *pos, uint32_t value, uint32_t nbits)
+{
+  for(int i=nbits-1; i>=0; i--) {
+    if((value >> i) & 1)
+      payload[*pos/8] |= 0x80 >> (*pos%8);
+    (*pos)++;
   }
+}
 
-  return rlc_am_packed_length(&status);
+// Appends a NACK to the status PDU, setting the E1 bit of the previous NACK or of the fixed part
+static void rlc_am_write_nack(uint8_t *payload, uint32_t *pos, uint32_t *e1_pos,
+                              uint32_t sn, bool has_so, uint32_t so_start, uint32_t so_end)
+{
+  rlc_am_write_bits(payload, e1_pos, 1, 1);
+  rlc_am_write_bits(payload, pos, sn, 10);  // 10 bit NACK_SN
+  *e1_pos = *pos;
+  (*pos)++;                                 // E1, set by the next NACK
+  rlc_am_write_bits(payload, pos, has_so ? 1 : 0, 1);  // E2
+  if(has_so) {
+    rlc_am_write_bits(payload, pos, so_start, 15);
+    rlc_am_write_bits(payload, pos, so_end,   15);
+  }
 }
 
+// Builds the status PDU from the rx window, straight into the MAC buffer. If the grant is too
+// small for all the NACKs, ACK_SN is set to the first SN left out (36.322 v10 Section 5.2.3)
 int  rlc_am::build_status_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
-  int pdu_len = rlc_am_packed_length(&status);
-  if(nof_bytes >= pdu_len)
+  if(nof_bytes < 2)
   {
-    log->info("%s Tx status PDU - %s\n",
-              rb_id_text[lcid], rlc_am_to_string(&status).c_str());
+    log->warning("%s Cannot tx status PDU - %d bytes available, %d bytes required\n",
+                 rb_id_text[lcid], nof_bytes, status_length());
+    return 0;
+  }
+  // At most RLC_AM_WINDOW_SIZE NACKs, all with SO ranges
+  uint32_t max_len  = SRSLTE_MIN(nof_bytes, (15 + RLC_AM_WINDOW_SIZE*42 + 7)/8);
+  uint32_t max_bits = max_len*8;
+  memset(payload, 0, max_len);
+
+  uint32_t pos      = 15;   // D/C, CPT, ACK_SN and E1 are written at the end
+  uint32_t e1_pos   = 14;
+  uint32_t ack_sn   = vr_ms;
+  uint32_t N_nack   = 0;
+  bool     full     = false;
+
+  for(uint32_t sn = vr_r; RX_MOD_BASE(sn) < RX_MOD_BASE(vr_ms); sn = (sn + 1)%MOD)
+  {
+    if(rx_window.has(sn))
+      continue;
+
+    if(!rx_segments.has(sn)) {
+      if(pos + 12 > max_bits || N_nack == RLC_AM_WINDOW_SIZE) {
+        full = true;
+        ack_sn = sn;
+        break;
+      }
+      rlc_am_write_nack(payload, &pos, &e1_pos, sn, false, 0, 0);
+      N_nack++;
+      continue;
+    }
+
+    // NACK the byte ranges of the PDU not yet received. Either all of them fit or the SN is left out
+    uint32_t bits = nack_bits(sn);
+    if(pos + bits > max_bits || N_nack + bits/42 > RLC_AM_WINDOW_SIZE) {
+      full = true;
+      ack_sn = sn;
+      break;
+    }
+    rlc_amd_rx_pdu_segments_t &pdu = rx_segments[sn];
+    uint32_t so = 0;
+    for(uint32_t i=0; i<=pdu.nof_intervals; i++) {
+      bool     last   = (i == pdu.nof_intervals);
+      uint32_t so_end = last ? pdu.len : pdu.intervals[i].so_start;
+      if(so < so_end || (last && pdu.len == 0)) {
+        rlc_am_write_nack(payload, &pos, &e1_pos, sn, true, so, last ? 0x7FFF : so_end - 1);
+        N_nack++;
+      }
+      if(!last)
+        so = pdu.intervals[i].so_end;
+    }
+  }
 
-    do_status     = false;
-    poll_received = false;
+  // Fixed part
+  uint32_t fixed_pos = 0;
+  rlc_am_write_bits(payload, &fixed_pos, RLC_DC_FIELD_CONTROL_PDU, 1);  // D/C
+  rlc_am_write_bits(payload, &fixed_pos, 0, 3);                         // CPT (0 == STATUS)
+  rlc_am_write_bits(payload, &fixed_pos, ack_sn, 10);                   // 10 bit ACK_SN
+
+  log->info("%s Tx status PDU - ACK_SN = %d, N_nack = %d%s\n",
+            rb_id_text[lcid], ack_sn, N_nack, full ? " (truncated)" : "");
+  if(!full && (pos + 7)/8 != status_length())
+    log->error("%s Status PDU length %d differs from the %d bytes reported in the buffer state\n",
+               rb_id_text[lcid], (pos + 7)/8, status_length());
 
+  do_status     = false;
+  poll_received = false;
+
+  {
+    boost::lock_guard<boost::mutex> lock(status_mutex);
+    status_len = 0;
     if(t_status_prohibit > 0)
       status_prohibit_timeout.start(t_status_prohibit);
-    debug_state();
-    return rlc_am_write_status_pdu(&status, payload);
-  }else{
-    log->warning("%s Cannot tx status PDU - %d bytes available, %d bytes required\n",
-                 rb_id_text[lcid], nof_bytes, pdu_len);
-    return 0;
   }
+  debug_state();
+  return (pos + 7)/8;
 }
 
 int  rlc_am::build_retx_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
-  rlc_amd_retx_t retx = retx_queue.front();
-
-  // Sanity check - drop any retx SNs not present in tx_window
-  while(tx_window.end() == tx_window.find(retx.sn)) {
-    retx_queue.pop_front();
-    retx = retx_queue.front();
-  }
+  rlc_amd_retx_t    retx = retx_front();
+  rlc_amd_tx_pdu_t &pdu  = tx_window[retx.sn];
 
   // Is resegmentation needed?
   if(retx.is_segment || required_buffer_size(retx) > nof_bytes) {
@@ -421,13 +712,16 @@ int  rlc_am::build_retx_pdu(uint8_t *payload, uint32_t nof_bytes)
     return build_segment(payload, nof_bytes, retx);
   }
 
+  retx_pop_front();
+
   // Update & write header
-  rlc_amd_pdu_header_t new_header = tx_window[retx.sn].header;
+  rlc_amd_pdu_header_t &new_header = tx_header;
+  new_header   = pdu.header;
   new_header.p = 0;
   if(poll_required())
   {
     new_header.p      = 1;
-    poll_sn           = vt_s;
+    poll_sn           = (vt_s + MOD - 1)%MOD;
     pdu_without_poll  = 0;
     byte_without_poll = 0;
     poll_retx_timeout.start(t_poll_retx);
@@ -435,110 +729,58 @@ int  rlc_am::build_retx_pdu(uint8_t *payload, uint32_t nof_bytes)
 
   uint8_t *ptr = payload;
   rlc_am_write_data_pdu_header(&new_header, &ptr);
-  memcpy(ptr, tx_window[retx.sn].buf->msg, tx_window[retx.sn].buf->N_bytes);
+  rlc_memcpy(ptr, pdu.buf->msg, pdu.buf->N_bytes);
 
-  retx_queue.pop_front();
-  tx_window[retx.sn].retx_count++;
-  if(tx_window[retx.sn].retx_count >= max_retx_thresh)
+  pdu.retx_count++;
+  if(pdu.retx_count >= max_retx_thresh)
     rrc->max_retx_attempted();
   log->info("%s Retx PDU scheduled for tx. SN: %d, retx count: %d\n",
-            rb_id_text[lcid], retx.sn, tx_window[retx.sn].retx_count);
+            rb_id_text[lcid], retx.sn, pdu.retx_count);
 
   debug_state();
-  return (ptr-payload) + tx_window[retx.sn].buf->N_bytes;
+  return (ptr-payload) + pdu.buf->N_bytes;
 }
 
 int rlc_am::build_segment(uint8_t *payload, uint32_t nof_bytes, rlc_amd_retx_t retx)
 {
+  rlc_amd_tx_pdu_t *pdu = &tx_window[retx.sn];
   if(!retx.is_segment){
     retx.so_start = 0;
-    retx.so_end   = tx_window[retx.sn].buf->N_bytes;
+    retx.so_end   = pdu->buf->N_bytes;
   }
 
   // Construct new header
-  rlc_amd_pdu_header_t new_header;
-  rlc_amd_pdu_header_t old_header = tx_window[retx.sn].header;
-
-  new_header.dc   = RLC_DC_FIELD_DATA_PDU;
-  new_header.rf   = 1;
-  new_header.p    = 0;
-  new_header.fi   = RLC_FI_FIELD_NOT_START_OR_END_ALIGNED;
-  new_header.sn   = old_header.sn;
-  new_header.lsf  = 0;
-  new_header.so   = retx.so_start;
-  new_header.N_li = 0;
-
-  uint32_t head_len  = 0;
-  uint32_t pdu_space = 0;
-
-  head_len = rlc_am_packed_length(&new_header);
-  if(nof_bytes <= head_len)
+  rlc_amd_pdu_header_t &new_header = tx_header;
+  uint32_t len = build_segment_header(pdu, retx.so_start, retx.so_end, nof_bytes, &new_header);
+  if(len == 0)
   {
     log->warning("%s Cannot build a PDU segment - %d bytes available, %d bytes required for header\n",
-                 rb_id_text[lcid], nof_bytes, head_len);
+                 rb_id_text[lcid], nof_bytes, rlc_am_packed_length(&new_header));
     return 0;
   }
-  pdu_space = nof_bytes-head_len;
-  if(pdu_space < (retx.so_end-retx.so_start))
-    retx.so_end = retx.so_start+pdu_space;
-
-  // Need to rebuild the li table & update fi based on so_start and so_end
-  if(retx.so_start == 0 && rlc_am_start_aligned(old_header.fi))
-    new_header.fi &= RLC_FI_FIELD_NOT_END_ALIGNED;   // segment is start aligned
-
-  uint32_t lower     = 0;
-  uint32_t upper     = 0;
-  uint32_t li        = 0;
-
-  for(int i=0; i<old_header.N_li; i++) {
-    if(lower >= retx.so_end)
-      break;
-
-    upper += old_header.li[i];
-
-    head_len    = rlc_am_packed_length(&new_header);
-    pdu_space   = nof_bytes-head_len;
-    if(pdu_space < (retx.so_end-retx.so_start))
-      retx.so_end = retx.so_start+pdu_space;
-
-    if(upper > retx.so_start && lower < retx.so_end) {  // Current SDU is needed
-      li = upper - lower;
-      if(upper > retx.so_end)
-        li -= upper - retx.so_end;
-      if(lower < retx.so_start)
-        li -= retx.so_start - lower;
-      if(lower > 0 && lower == retx.so_start)
-        new_header.fi &= RLC_FI_FIELD_NOT_END_ALIGNED;   // segment start is aligned with this SDU
-      if(upper == retx.so_end) {
-        new_header.fi &= RLC_FI_FIELD_NOT_START_ALIGNED; // segment end is aligned with this SDU
-      }
-      new_header.li[new_header.N_li++] = li;
-    }
-
-    lower += old_header.li[i];
-  }
 
   // Update retx_queue
-  if(tx_window[retx.sn].buf->N_bytes == retx.so_end) {
-    retx_queue.pop_front();
-    new_header.lsf = 1;
-    if(rlc_am_end_aligned(old_header.fi))
-      new_header.fi &= RLC_FI_FIELD_NOT_START_ALIGNED;   // segment is end aligned
-  } else if(retx_queue.front().so_end == retx.so_end) {
-    retx_queue.pop_front();
+  if(retx.so_start + len == retx.so_end) {
+    retx_pop_front();
   } else {
-    retx_queue.front().is_segment = true;
-    retx_queue.front().so_start = retx.so_end;
-    if(new_header.N_li > 0)
-      new_header.N_li--;
+    retx_front().is_segment = true;
+    retx_front().so_start   = retx.so_start + len;
+    retx_front().so_end     = retx.so_end;
+  }
+
+  if(poll_required())
+  {
+    new_header.p      = 1;
+    poll_sn           = (vt_s + MOD - 1)%MOD;
+    pdu_without_poll  = 0;
+    byte_without_poll = 0;
+    poll_retx_timeout.start(t_poll_retx);
   }
 
   // Write header and pdu
   uint8_t *ptr = payload;
   rlc_am_write_data_pdu_header(&new_header, &ptr);
-  uint8_t* data = &tx_window[retx.sn].buf->msg[retx.so_start];
-  uint32_t len  = retx.so_end - retx.so_start;
-  memcpy(ptr, data, len);
+  rlc_memcpy(ptr, &pdu->buf->msg[retx.so_start], len);
 
   log->info("%s Retx PDU segment scheduled for tx. SN: %d, SO: %d\n",
             rb_id_text[lcid], retx.sn, retx.so_start);
@@ -563,12 +805,19 @@ int  rlc_am::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
     return 0;
   }
 
+  // 36.322 v10 Section 5.1.3.1.1 - no new PDUs beyond the high edge of the tx window
+  if(TX_MOD_BASE(vt_s) >= RLC_AM_WINDOW_SIZE)
+  {
+    log->debug("%s Tx window full - vt_a = %d, vt_s = %d\n", rb_id_text[lcid], vt_a, vt_s);
+    return 0;
+  }
+
   byte_buffer_t *pdu = pool->allocate();
   if (!pdu) {
     log->console("Fatal Error: Could not allocate PDU in build_data_pdu()\n");
     exit(-1);
   }
-  rlc_amd_pdu_header_t header;
+  rlc_amd_pdu_header_t &header = tx_header;
   header.dc   = RLC_DC_FIELD_DATA_PDU;
   header.rf   = 0;
   header.p    = 0;
@@ -588,6 +837,7 @@ int  rlc_am::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   {
     log->warning("%s Cannot build a PDU - %d bytes available, %d bytes required for header\n",
                  rb_id_text[lcid], nof_bytes, head_len);
+    pool->deallocate(pdu);
     return 0;
   }
 
@@ -598,7 +848,7 @@ int  rlc_am::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   if(tx_sdu)
   {
     to_move = ((pdu_space-head_len) >= tx_sdu->N_bytes) ? tx_sdu->N_bytes : pdu_space-head_len;
-    memcpy(pdu_ptr, tx_sdu->msg, to_move);
+    rlc_memcpy(pdu_ptr, tx_sdu->msg, to_move);
     last_li          = to_move;
     pdu_ptr         += to_move;
     pdu->N_bytes    += to_move;
@@ -625,7 +875,7 @@ int  rlc_am::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   while(pdu_space > head_len && tx_sdu_queue.size() > 0)
   {
     if(last_li > 0)
-      header.li[header.N_li++] = last_li;
+      header.add_li(last_li);
     head_len = rlc_am_packed_length(&header);
     if(head_len >= pdu_space) {
       header.N_li--;
@@ -633,7 +883,7 @@ int  rlc_am::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
     }
     tx_sdu_queue.read(&tx_sdu);
     to_move = ((pdu_space-head_len) >= tx_sdu->N_bytes) ? tx_sdu->N_bytes : pdu_space-head_len;
-    memcpy(pdu_ptr, tx_sdu->msg, to_move);
+    rlc_memcpy(pdu_ptr, tx_sdu->msg, to_move);
     last_li          = to_move;
     pdu_ptr         += to_move;
     pdu->N_bytes    += to_move;
@@ -676,23 +926,23 @@ int  rlc_am::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   log->info("%s PDU scheduled for tx. SN: %d\n", rb_id_text[lcid], header.sn);
 
   // Place PDU in tx_window, write header and TX
-  tx_window[header.sn].buf        = pdu;
-  tx_window[header.sn].header     = header;
-  tx_window[header.sn].is_acked   = false;
-  tx_window[header.sn].retx_count = 0;
+  rlc_amd_tx_pdu_t &tx_pdu = tx_window.add(header.sn);
+  tx_pdu.buf           = pdu;
+  tx_pdu.header        = header;
+  tx_pdu.is_acked      = false;
+  tx_pdu.retx_count    = 0;
+  tx_pdu.in_retx_queue = false;
 
   uint8_t *ptr = payload;
   rlc_am_write_data_pdu_header(&header, &ptr);
-  memcpy(ptr, pdu->msg, pdu->N_bytes);
+  rlc_memcpy(ptr, pdu->msg, pdu->N_bytes);
 
   debug_state();
   return (ptr-payload) + pdu->N_bytes;
 }
 
-void rlc_am::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_header_t header)
+void rlc_am::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_header_t &header)
 {
-  std::map<uint32_t, rlc_amd_rx_pdu_t>::iterator it;
-
   log->info_hex(payload, nof_bytes, "%s Rx data PDU SN: %d",
                 rb_id_text[lcid], header.sn);
 
@@ -706,8 +956,7 @@ void rlc_am::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_h
     return;
   }
 
-  it = rx_window.find(header.sn);
-  if(rx_window.end() != it) {
+  if(rx_window.has(header.sn)) {
     if(header.p) {
       log->info("%s Status packet requested through polling bit\n", rb_id_text[lcid]);
       do_status = true;
@@ -718,30 +967,41 @@ void rlc_am::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_h
   }
 
   // Write to rx window
-  rlc_amd_rx_pdu_t pdu;
-  pdu.buf = pool->allocate();
-  if (!pdu.buf) {
+  byte_buffer_t *buf = pool->allocate();
+  if (!buf) {
     log->console("Fatal Error: Could not allocate PDU in handle_data_pdu()\n");
     exit(-1);
   }
+  rlc_memcpy(buf->msg, payload, nof_bytes);
+  buf->N_bytes = nof_bytes;
 
-  memcpy(pdu.buf->msg, payload, nof_bytes);
-  pdu.buf->N_bytes  = nof_bytes;
-  pdu.header        = header;
+  // The SN's NACKs leave the status PDU
+  if(RX_MOD_BASE(header.sn) < RX_MOD_BASE(vr_ms))
+    status_nack_bits -= nack_bits(header.sn);
 
-  rx_window[header.sn] = pdu;
+  // Segments received before the full PDU are not needed anymore
+  if(rx_segments.has(header.sn)) {
+    pool->deallocate(rx_segments[header.sn].buf);
+    rx_segments.remove(header.sn);
+  }
+
+  add_rx_pdu(buf, header);
+}
+
+// Places a complete PDU in the rx window and updates the rx state variables
+void rlc_am::add_rx_pdu(byte_buffer_t *buf, rlc_amd_pdu_header_t &header)
+{
+  rlc_amd_rx_pdu_t &pdu = rx_window.add(header.sn);
+  pdu.buf    = buf;
+  pdu.header = header;
 
   // Update vr_h
   if(RX_MOD_BASE(header.sn) >= RX_MOD_BASE(vr_h))
     vr_h  = (header.sn + 1)%MOD;
 
   // Update vr_ms
-  it = rx_window.find(vr_ms);
-  while(rx_window.end() != it)
-  {
+  while(rx_window.has(vr_ms))
     vr_ms = (vr_ms + 1)%MOD;
-    it = rx_window.find(vr_ms);
-  }
 
   // Check poll bit
   if(header.p)
@@ -758,6 +1018,18 @@ void rlc_am::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_h
     // else delay for reordering timer
   }
 
+  // SDUs are reassembled once all PDUs of the burst are in the rx window
+  rx_pending = true;
+
+  debug_state();
+}
+
+void rlc_am::update_rx_window()
+{
+  if(!rx_pending)
+    return;
+  rx_pending = false;
+
   // Reassemble and deliver SDUs
   reassemble_rx_sdus();
 
@@ -786,10 +1058,8 @@ void rlc_am::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_h
   debug_state();
 }
 
-void rlc_am::handle_data_pdu_segment(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_header_t header)
+void rlc_am::handle_data_pdu_segment(uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_header_t &header)
 {
-  std::map<uint32_t, rlc_amd_rx_pdu_segments_t>::iterator it;
-
   log->info_hex(payload, nof_bytes, "%s Rx data PDU segment. SN: %d, SO: %d",
                 rb_id_text[lcid], header.sn, header.so);
 
@@ -804,39 +1074,55 @@ void rlc_am::handle_data_pdu_segment(uint8_t *payload, uint32_t nof_bytes, rlc_a
     return;
   }
 
-  rlc_amd_rx_pdu_t segment;
-  segment.buf = pool->allocate();
-  memcpy(segment.buf->msg, payload, nof_bytes);
-  segment.buf->N_bytes = nof_bytes;
-  segment.header       = header;
+  // Check we don't already have the full PDU
+  if(rx_window.has(header.sn)) {
+    if(header.p) {
+      log->info("%s Status packet requested through polling bit\n", rb_id_text[lcid]);
+      do_status = true;
+    }
+    log->info("%s Discarding duplicate segment SN: %d, SO: %d\n",
+              rb_id_text[lcid], header.sn, header.so);
+    return;
+  }
+
+  if(header.so + nof_bytes > SRSUE_MAX_BUFFER_SIZE_BYTES - SRSUE_BUFFER_HEADER_OFFSET) {
+    log->warning("%s Discarding segment SN: %d - SO: %d, length: %d exceed the buffer size\n",
+                 rb_id_text[lcid], header.sn, header.so, nof_bytes);
+    return;
+  }
+
+  // The SN's NACKs in the status PDU are updated with the segment
+  bool in_status = RX_MOD_BASE(header.sn) < RX_MOD_BASE(vr_ms);
+  if(in_status)
+    status_nack_bits -= nack_bits(header.sn);
 
   // Check if we already have a segment from the same PDU
-  it = rx_segments.find(header.sn);
-  if(rx_segments.end() != it) {
+  if(rx_segments.has(header.sn)) {
 
     if(header.p) {
       log->info("%s Status packet requested through polling bit\n", rb_id_text[lcid]);
       do_status = true;
     }
 
-    // Add segment to PDU list and check for complete
-    if(add_segment_and_check(&it->second, &segment)) {
-      std::list<rlc_amd_rx_pdu_t>::iterator segit;
-      std::list<rlc_amd_rx_pdu_t>           seglist = it->second.segments;
-      for(segit = seglist.begin(); segit != seglist.end(); segit++) {
-        pool->deallocate(segit->buf);
-      }
-      seglist.clear();
-      rx_segments.erase(it);
-    }
-
   } else {
 
-    // Create new PDU segment list and write to rx_segments
-    rlc_amd_rx_pdu_segments_t pdu;
-    pdu.segments.push_back(segment);
-    rx_segments[header.sn] = pdu;
-
+    // Start a new PDU in rx_segments
+    rlc_amd_rx_pdu_segments_t &pdu = rx_segments.add(header.sn);
+    pdu.buf = pool->allocate();
+    if (!pdu.buf) {
+      log->console("Fatal Error: Could not allocate PDU in handle_data_pdu_segment()\n");
+      exit(-1);
+    }
+    pdu.header.dc     = RLC_DC_FIELD_DATA_PDU;
+    pdu.header.rf     = 0;
+    pdu.header.p      = 0;
+    pdu.header.fi     = RLC_FI_FIELD_START_AND_END_ALIGNED;
+    pdu.header.sn     = header.sn;
+    pdu.header.lsf    = 0;
+    pdu.header.so     = 0;
+    pdu.header.N_li   = 0;
+    pdu.len           = 0;
+    pdu.nof_intervals = 0;
 
     // Update vr_h
     if(RX_MOD_BASE(header.sn) >= RX_MOD_BASE(vr_h))
@@ -858,6 +1144,16 @@ void rlc_am::handle_data_pdu_segment(uint8_t *payload, uint32_t nof_bytes, rlc_a
     }
   }
 
+  // Add segment to the PDU and check for complete
+  rlc_amd_rx_pdu_segments_t &pdu = rx_segments[header.sn];
+  if(add_segment_and_check(&pdu, payload, nof_bytes, &header)) {
+    rx_segments.remove(header.sn);
+    add_rx_pdu(pdu.buf, pdu.header);
+  }
+
+  if(in_status)
+    status_nack_bits += nack_bits(header.sn);
+
   debug_state();
 }
 
@@ -870,54 +1166,67 @@ void rlc_am::handle_control_pdu(uint8_t *payload, uint32_t nof_bytes)
 
   log->info("%s Rx Status PDU: %s\n", rb_id_text[lcid], rlc_am_to_string(&status).c_str());
 
-  poll_retx_timeout.reset();
+  // 36.322 v10 Section 5.2.2.2 - stop t_poll_retx once the poll SN is ACKed or NACKed
+  bool poll_sn_reported = TX_MOD_BASE(poll_sn) < TX_MOD_BASE(status.ack_sn);
+  for(int j=0;j<status.N_nack;j++) {
+    if(status.nacks[j].nack_sn == poll_sn)
+      poll_sn_reported = true;
+  }
+  if(poll_sn_reported)
+    poll_retx_timeout.reset();
 
-  // Handle ACKs and NACKs
-  bool update_vt_a = true;
+  // Handle ACKs and NACKs. NACKs are listed in SN order, an SN may have several with SO ranges
+  bool     update_vt_a = true;
+  uint32_t j           = 0;
   uint32_t i = vt_a;
   while(TX_MOD_BASE(i) < TX_MOD_BASE(status.ack_sn) &&
         TX_MOD_BASE(i) < TX_MOD_BASE(vt_s))
   {
-    std::map<uint32_t, rlc_amd_tx_pdu_t>::iterator it;
-
     bool nack = false;
-    for(int j=0;j<status.N_nack;j++) {
-      if(status.nacks[j].nack_sn == i) {
-        nack = true;
-        update_vt_a = false;
-        if(tx_window.end() != tx_window.find(i))
-        {
-          if(!retx_queue_has_sn(i)) {
-            rlc_amd_retx_t retx;
-            retx.is_segment = status.nacks[j].has_so;
-            if(retx.is_segment) {
-              retx.so_start = status.nacks[j].so_start;
-              if(status.nacks[j].so_end == 0x7FFF) {
-                retx.so_end = tx_window.find(i)->second.buf->N_bytes;
-              }else{
-                retx.so_end   = status.nacks[j].so_end + 1;
-              }
-            } else {
-              retx.so_start = 0;
-              retx.so_end   = tx_window.find(i)->second.buf->N_bytes;
-            }
-            retx.sn         = i;
-            retx_queue.push_back(retx);
-          }
+    while(j < status.N_nack && TX_MOD_BASE(status.nacks[j].nack_sn) < TX_MOD_BASE(i))
+      j++;
+    for(; j<status.N_nack && status.nacks[j].nack_sn == i; j++) {
+      nack = true;
+      update_vt_a = false;
+      if(!tx_window.has(i))
+        continue;
+
+      rlc_amd_retx_t retx;
+      retx.sn         = i;
+      retx.is_segment = status.nacks[j].has_so;
+      retx.so_start   = 0;
+      retx.so_end     = tx_window[i].buf->N_bytes;
+      if(retx.is_segment) {
+        retx.so_start = status.nacks[j].so_start;
+        if(status.nacks[j].so_end != 0x7FFF)
+          retx.so_end = status.nacks[j].so_end + 1;
+      }
+
+      if(!tx_window[i].in_retx_queue) {
+        retx_push_back(retx);
+      } else {
+        // Extend the pending retx to cover the NACKed range
+        rlc_amd_retx_t &pending = tx_window[i].retx;
+        if(!retx.is_segment) {
+          pending = retx;
+        } else if(pending.is_segment) {
+          pending.so_start = SRSLTE_MIN(pending.so_start, retx.so_start);
+          pending.so_end   = SRSLTE_MAX(pending.so_end,   retx.so_end);
         }
       }
     }
 
     if(!nack) {
       //ACKed SNs get marked and removed from tx_window if possible
-      it = tx_window.find(i);
-      if(tx_window.end() != it)
+      if(tx_window.has(i))
       {
         tx_window[i].is_acked = true;
+        if(tx_window[i].in_retx_queue)
+          retx_remove(i);
         if(update_vt_a)
         {
           pool->deallocate(tx_window[i].buf);
-          tx_window.erase(i);
+          tx_window.remove(i);
           vt_a = (vt_a + 1)%MOD;
           vt_ms = (vt_ms + 1)%MOD;
         }
@@ -939,16 +1248,18 @@ void rlc_am::reassemble_rx_sdus()
     }
   }
   // Iterate through rx_window, assembling and delivering SDUs
-  while(rx_window.end() != rx_window.find(vr_r))
+  while(rx_window.has(vr_r))
   {
+    rlc_amd_rx_pdu_t &pdu = rx_window[vr_r];
+
     // Handle any SDU segments
-    for(int i=0; i<rx_window[vr_r].header.N_li; i++)
+    for(int i=0; i<pdu.header.N_li; i++)
     {
-      int len = rx_window[vr_r].header.li[i];
-      memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_r].buf->msg, len);
+      int len = pdu.header.li[i];
+      rlc_memcpy(&rx_sdu->msg[rx_sdu->N_bytes], pdu.buf->msg, len);
       rx_sdu->N_bytes += len;
-      rx_window[vr_r].buf->msg += len;
-      rx_window[vr_r].buf->N_bytes -= len;
+      pdu.buf->msg += len;
+      pdu.buf->N_bytes -= len;
       log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
       rx_sdu->timestamp = bpt::microsec_clock::local_time();
       pdcp->write_pdu(lcid, rx_sdu);
@@ -961,19 +1272,23 @@ void rlc_am::reassemble_rx_sdus()
     }
 
     // Handle last segment
-    memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_r].buf->msg, rx_window[vr_r].buf->N_bytes);
-    rx_sdu->N_bytes += rx_window[vr_r].buf->N_bytes;
-    if(rlc_am_end_aligned(rx_window[vr_r].header.fi))
+    rlc_memcpy(&rx_sdu->msg[rx_sdu->N_bytes], pdu.buf->msg, pdu.buf->N_bytes);
+    rx_sdu->N_bytes += pdu.buf->N_bytes;
+    if(rlc_am_end_aligned(pdu.header.fi))
     {
       log->info_hex(rx_sdu->msg, rx_sdu->N_bytes, "%s Rx SDU", rb_id_text[lcid]);
       rx_sdu->timestamp = bpt::microsec_clock::local_time();
       pdcp->write_pdu(lcid, rx_sdu);
       rx_sdu = pool->allocate();
+      if (!rx_sdu) {
+        log->console("Fatal Error: Could not allocate PDU in reassemble_rx_sdus() (3)\n");
+        exit(-1);
+      }
     }
 
     // Move the rx_window
-    pool->deallocate(rx_window[vr_r].buf);
-    rx_window.erase(vr_r);
+    pool->deallocate(pdu.buf);
+    rx_window.remove(vr_r);
     vr_r = (vr_r + 1)%MOD;
     vr_mr = (vr_mr + 1)%MOD;
   }
@@ -1010,142 +1325,208 @@ void rlc_am::debug_state()
 
 }
 
-bool rlc_am::add_segment_and_check(rlc_amd_rx_pdu_segments_t *pdu, rlc_amd_rx_pdu_t *segment)
+// Inserts an SDU boundary in the sorted list of offsets kept in header->li
+static void rlc_am_add_sdu_boundary(rlc_amd_pdu_header_t *header, uint32_t pos)
+{
+  uint32_t i = header->N_li;
+  while(i > 0 && header->li[i-1] > pos)
+    i--;
+  if(i > 0 && header->li[i-1] == pos)
+    return;
+  header->add_li(0);
+  memmove(&header->li[i+1], &header->li[i], (header->N_li-1-i)*sizeof(uint16_t));
+  header->li[i] = pos;
+}
+
+// Writes the segment into the PDU and returns true once all segments are received,
+// with the full PDU in pdu->buf and its header in pdu->header
+bool rlc_am::add_segment_and_check(rlc_amd_rx_pdu_segments_t *pdu, uint8_t *payload, uint32_t nof_bytes, rlc_amd_pdu_header_t *header)
 {
-  // Ordered insert
-  std::list<rlc_amd_rx_pdu_t>::iterator tmpit;
-  std::list<rlc_amd_rx_pdu_t>::iterator it = pdu->segments.begin();
-  while(it != pdu->segments.end() && it->header.so < segment->header.so)
-    it++;
-  pdu->segments.insert(it, *segment);
+  uint32_t so_start = header->so;
+  uint32_t so_end   = header->so + nof_bytes;
 
-  // Check for complete
-  uint32_t so = 0;
-  for(it = pdu->segments.begin(); it != pdu->segments.end(); it++) {
-    if(so != it->header.so)
+  // Merge the SO range with the received ones
+  uint32_t i = 0;
+  while(i < pdu->nof_intervals && pdu->intervals[i].so_end < so_start)
+    i++;
+  uint32_t j = i;
+  while(j < pdu->nof_intervals && pdu->intervals[j].so_start <= so_end) {
+    so_start = SRSLTE_MIN(so_start, pdu->intervals[j].so_start);
+    so_end   = SRSLTE_MAX(so_end,   pdu->intervals[j].so_end);
+    j++;
+  }
+  if(i == j) {
+    if(pdu->nof_intervals == RLC_AM_MAX_RX_INTERVALS) {
+      log->warning("%s Discarding segment SN: %d, SO: %d - too many SO ranges pending\n",
+                   rb_id_text[lcid], header->sn, header->so);
       return false;
-    so += it->buf->N_bytes;
+    }
+    memmove(&pdu->intervals[i+1], &pdu->intervals[i], (pdu->nof_intervals-i)*sizeof(rlc_amd_so_interval_t));
+    pdu->nof_intervals++;
+  } else if(j > i+1) {
+    memmove(&pdu->intervals[i+1], &pdu->intervals[j], (pdu->nof_intervals-j)*sizeof(rlc_amd_so_interval_t));
+    pdu->nof_intervals -= j-i-1;
+  }
+  pdu->intervals[i].so_start = so_start;
+  pdu->intervals[i].so_end   = so_end;
+
+  rlc_memcpy(&pdu->buf->msg[header->so], payload, nof_bytes);
+
+  // Collect the SDU boundaries and framing info
+  uint32_t pos = header->so;
+  for(i=0; i<header->N_li; i++) {
+    pos += header->li[i];
+    rlc_am_add_sdu_boundary(&pdu->header, pos);
   }
-  if(!pdu->segments.back().header.lsf)
+  if(header->so > 0 && rlc_am_start_aligned(header->fi))
+    rlc_am_add_sdu_boundary(&pdu->header, header->so);
+  if(header->so == 0)
+    pdu->header.fi |= (header->fi & RLC_FI_FIELD_NOT_START_ALIGNED);
+  if(header->lsf) {
+    pdu->header.fi |= (header->fi & RLC_FI_FIELD_NOT_END_ALIGNED);
+    pdu->len        = header->so + nof_bytes;
+  } else if(rlc_am_end_aligned(header->fi)) {
+    rlc_am_add_sdu_boundary(&pdu->header, header->so + nof_bytes);
+  }
+
+  // Check for complete
+  if(pdu->len == 0 || pdu->nof_intervals != 1 ||
+     pdu->intervals[0].so_start != 0 || pdu->intervals[0].so_end != pdu->len)
     return false;
 
-  // We have all segments of the PDU - reconstruct and handle
-  rlc_amd_pdu_header_t header;
-  header.dc   = RLC_DC_FIELD_DATA_PDU;
-  header.rf   = 0;
-  header.p    = 0;
-  header.fi   = RLC_FI_FIELD_START_AND_END_ALIGNED;
-  header.sn   = pdu->segments.front().header.sn;
-  header.lsf  = 0;
-  header.so   = 0;
-  header.N_li = 0;
+  // We have all segments of the PDU - convert the boundaries to LIs
+  uint32_t lower = 0;
+  uint32_t N_li  = 0;
+  for(i=0; i<pdu->header.N_li && pdu->header.li[i] < pdu->len; i++) {
+    uint32_t upper = pdu->header.li[i];
+    pdu->header.li[N_li++] = upper - lower;
+    lower = upper;
+  }
+  pdu->header.N_li = N_li;
+  pdu->buf->N_bytes = pdu->len;
+  return true;
+}
 
-  // Reconstruct fi field
-  header.fi |= (pdu->segments.front().header.fi & RLC_FI_FIELD_NOT_START_ALIGNED);
-  header.fi |= (pdu->segments.back().header.fi  & RLC_FI_FIELD_NOT_END_ALIGNED);
-
-  // Reconstruct li fields
-  uint16_t count     = 0;
-  uint16_t carryover = 0;
-  for(it = pdu->segments.begin(); it != pdu->segments.end(); it++) {
-    if(it->header.N_li > 0) {
-      header.li[header.N_li++] = it->header.li[0] + carryover;
-      count += it->header.li[0];
-      for(int i=1; i<it->header.N_li; i++) {
-        header.li[header.N_li++] = it->header.li[i];
-        count += it->header.li[i];
-      }
+// Builds the header of a segment of the PDU starting at so_start, limited to so_end and to
+// nof_bytes in total. Returns the number of PDU bytes the segment carries
+uint32_t rlc_am::build_segment_header(rlc_amd_tx_pdu_t *pdu, uint32_t so_start, uint32_t so_end, uint32_t nof_bytes, rlc_amd_pdu_header_t *header)
+{
+  rlc_amd_pdu_header_t *old_header = &pdu->header;
+
+  header->dc   = RLC_DC_FIELD_DATA_PDU;
+  header->rf   = 1;
+  header->p    = 0;
+  header->fi   = RLC_FI_FIELD_START_AND_END_ALIGNED;
+  header->sn   = old_header->sn;
+  header->lsf  = 0;
+  header->so   = so_start;
+  header->N_li = 0;
+
+  uint32_t head_len = rlc_am_packed_length(header);
+  if(nof_bytes <= head_len)
+    return 0;
+  uint32_t end = so_start + SRSLTE_MIN(so_end - so_start, nof_bytes - head_len);
+
+  // SDU boundaries inside the segment become LIs, as long as data after them still fits
+  bool     start_aligned = false;
+  bool     end_aligned   = false;
+  uint32_t lower         = so_start;
+  uint32_t upper         = 0;
+  for(uint32_t i=0; i<old_header->N_li; i++) {
+    upper += old_header->li[i];
+    if(upper < so_start)
+      continue;
+    if(upper == so_start) {
+      start_aligned = true;
+      continue;
+    }
+    if(upper >= end) {
+      end_aligned = (upper == end);
+      break;
     }
-    carryover = it->buf->N_bytes - count;
-    tmpit = it;
-    if(rlc_am_end_aligned(it->header.fi) && ++tmpit != pdu->segments.end()) {
-      header.li[header.N_li++] = carryover;
-      carryover = 0;
+    header->add_li(upper - lower);
+    head_len = rlc_am_packed_length(header);
+    if(nof_bytes <= head_len || nof_bytes - head_len <= upper - so_start) {
+      header->N_li--;     // End the segment with this SDU instead
+      end         = upper;
+      end_aligned = true;
+      break;
     }
-    count = 0;
+    end   = so_start + SRSLTE_MIN(so_end - so_start, nof_bytes - head_len);
+    lower = upper;
   }
 
-  // Copy data
-  byte_buffer_t *full_pdu = pool->allocate();
-  for(it = pdu->segments.begin(); it != pdu->segments.end(); it++) {
-    memcpy(&full_pdu->msg[full_pdu->N_bytes], it->buf->msg, it->buf->N_bytes);
-    full_pdu->N_bytes += it->buf->N_bytes;
+  if(so_start == 0)
+    start_aligned = rlc_am_start_aligned(old_header->fi);
+  if(end == pdu->buf->N_bytes) {
+    end_aligned = rlc_am_end_aligned(old_header->fi);
+    header->lsf = 1;
   }
+  if(!start_aligned)
+    header->fi |= RLC_FI_FIELD_NOT_START_ALIGNED;
+  if(!end_aligned)
+    header->fi |= RLC_FI_FIELD_NOT_END_ALIGNED;
 
-  handle_data_pdu(full_pdu->msg, full_pdu->N_bytes, header);
-  return true;
+  return end - so_start;
 }
 
 int rlc_am::required_buffer_size(rlc_amd_retx_t retx)
 {
+  rlc_amd_tx_pdu_t *pdu = &tx_window[retx.sn];
   if(!retx.is_segment){
-    return rlc_am_packed_length(&tx_window[retx.sn].header) + tx_window[retx.sn].buf->N_bytes;
+    return rlc_am_packed_length(&pdu->header) + pdu->buf->N_bytes;
   }
 
-  // Construct new header
-  rlc_amd_pdu_header_t new_header;
-  rlc_amd_pdu_header_t old_header = tx_window[retx.sn].header;
-
-  new_header.dc   = RLC_DC_FIELD_DATA_PDU;
-  new_header.rf   = 1;
-  new_header.p    = 0;
-  new_header.fi   = RLC_FI_FIELD_NOT_START_OR_END_ALIGNED;
-  new_header.sn   = old_header.sn;
-  new_header.lsf  = 0;
-  new_header.so   = retx.so_start;
-  new_header.N_li = 0;
-
-  uint32_t head_len  = 0;
-
-  // Need to rebuild the li table & update fi based on so_start and so_end
-  if(retx.so_start != 0 && rlc_am_start_aligned(old_header.fi))
-    new_header.fi &= RLC_FI_FIELD_NOT_END_ALIGNED;   // segment is start aligned
-
-  uint32_t lower     = 0;
-  uint32_t upper     = 0;
-  uint32_t li        = 0;
-
-  for(int i=0; i<old_header.N_li; i++) {
-    if(lower >= retx.so_end)
-      break;
-
-    upper += old_header.li[i];
+  rlc_amd_pdu_header_t &new_header = tx_header;
+  uint32_t len = build_segment_header(pdu, retx.so_start, retx.so_end, 0xFFFFFFFF, &new_header);
+  return rlc_am_packed_length(&new_header) + len;
+}
 
-    head_len    = rlc_am_packed_length(&new_header);
+/****************************************************************************
+ * Retx queue, linked through the tx_window slots
+ ***************************************************************************/
 
-    if(upper > retx.so_start && lower < retx.so_end) {  // Current SDU is needed
-      li = upper - lower;
-      if(upper > retx.so_end)
-        li -= upper - retx.so_end;
-      if(lower < retx.so_start)
-        li -= retx.so_start - lower;
-      if(lower > 0 && lower == retx.so_start)
-        new_header.fi &= RLC_FI_FIELD_NOT_END_ALIGNED;   // segment start is aligned with this SDU
-      if(upper == retx.so_end) {
-        new_header.fi &= RLC_FI_FIELD_NOT_START_ALIGNED; // segment end is aligned with this SDU
-      }
-      new_header.li[new_header.N_li++] = li;
-    }
+bool rlc_am::retx_empty()
+{
+  return retx_head == retx_none;
+}
 
-    lower += old_header.li[i];
-  }
+rlc_amd_retx_t& rlc_am::retx_front()
+{
+  return tx_window[retx_head].retx;
+}
 
-//  if(tx_window[retx.sn].buf->N_bytes != retx.so_end) {
-//    if(new_header.N_li > 0)
-//      new_header.N_li--; // No li for last segment
-//  }
+void rlc_am::retx_push_back(rlc_amd_retx_t retx)
+{
+  rlc_amd_tx_pdu_t &pdu = tx_window[retx.sn];
+  pdu.retx          = retx;
+  pdu.in_retx_queue = true;
+  pdu.retx_prev     = retx_tail;
+  pdu.retx_next     = retx_none;
+  if(retx_tail == retx_none)
+    retx_head = retx.sn;
+  else
+    tx_window[retx_tail].retx_next = retx.sn;
+  retx_tail = retx.sn;
+}
 
-  return rlc_am_packed_length(&new_header) + (retx.so_end-retx.so_start);
+void rlc_am::retx_pop_front()
+{
+  retx_remove(retx_head);
 }
 
-bool rlc_am::retx_queue_has_sn(uint32_t sn)
+void rlc_am::retx_remove(uint32_t sn)
 {
-  std::deque<rlc_amd_retx_t>::iterator q_it;
-  for(q_it = retx_queue.begin(); q_it != retx_queue.end(); q_it++) {
-    if(q_it->sn == sn)
-      return true;
-  }
-  return false;
+  rlc_amd_tx_pdu_t &pdu = tx_window[sn];
+  if(pdu.retx_prev == retx_none)
+    retx_head = pdu.retx_next;
+  else
+    tx_window[pdu.retx_prev].retx_next = pdu.retx_next;
+  if(pdu.retx_next == retx_none)
+    retx_tail = pdu.retx_prev;
+  else
+    tx_window[pdu.retx_next].retx_prev = pdu.retx_prev;
+  pdu.in_retx_queue = false;
 }
 
 /****************************************************************************
@@ -1189,28 +1570,33 @@ void rlc_am_read_data_pdu_header(uint8_t **payload, uint32_t *nof_bytes, rlc_amd
       header->so |= (*ptr & 0xFF);      // 8 bits of SO
       ptr++;
     }
+    else
+    {
+      header->lsf = 0;
+      header->so  = 0;
+    }
 
     // Extension part
     header->N_li = 0;
     while(ext)
     {
+      uint16_t li;
       if(header->N_li%2 == 0)
       {
         ext = ((*ptr >> 7) & 0x01);
-        header->li[header->N_li]  = (*ptr & 0x7F) << 4; // 7 bits of LI
+        li  = (*ptr & 0x7F) << 4; // 7 bits of LI
         ptr++;
-        header->li[header->N_li] |= (*ptr & 0xF0) >> 4; // 4 bits of LI
-        header->N_li++;
+        li |= (*ptr & 0xF0) >> 4; // 4 bits of LI
       }
       else
       {
         ext = (*ptr >> 3) & 0x01;
-        header->li[header->N_li] = (*ptr & 0x07) << 8; // 3 bits of LI
+        li  = (*ptr & 0x07) << 8; // 3 bits of LI
         ptr++;
-        header->li[header->N_li] |= (*ptr & 0xFF);     // 8 bits of LI
-        header->N_li++;
+        li |= (*ptr & 0xFF);      // 8 bits of LI
         ptr++;
       }
+      header->add_li(li);
     }
 
     // Account for padding if N_li is odd
@@ -1313,7 +1699,7 @@ void rlc_am_read_status_pdu(uint8_t *payload, uint32_t nof_bytes, rlc_status_pdu
       status->ack_sn  = srslte_bit_pack(&ptr, 10); // 10 bits ACK_SN
       ext1            = srslte_bit_pack(&ptr, 1);  // 1 bits E1
       status->N_nack  = 0;
-      while(ext1)
+      while(ext1 && status->N_nack < RLC_AM_WINDOW_SIZE)
       {
         status->nacks[status->N_nack].nack_sn = srslte_bit_pack(&ptr, 10);
         ext1 = srslte_bit_pack(&ptr, 1);  // 1 bits E1
@@ -121,6 +121,14 @@ uint32_t rlc_entity::get_total_buffer_state()
     return 0;
 }
 
+int32_t rlc_entity::msec_to_timer_expiry()
+{
+  if(rlc)
+    return rlc->msec_to_timer_expiry();
+  else
+    return -1;
+}
+
 int rlc_entity::read_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
   if(rlc)
@@ -134,4 +142,10 @@ void rlc_entity::write_pdu(uint8_t *payload, uint32_t nof_bytes)
     rlc->write_pdu(payload, nof_bytes);
 }
 
+void rlc_entity::write_pdus(rlc_interface_mac::pdu_iov_t *pdus, uint32_t nof_pdus)
+{
+  if(rlc)
+    rlc->write_pdus(pdus, nof_pdus);
+}
+
 } // namespace srsue
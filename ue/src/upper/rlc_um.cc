@@ -45,6 +45,7 @@ rlc_um::rlc_um() : tx_sdu_queue(16)
   vr_uh    = 0;
   
   vr_ur_in_rx_sdu = 0; 
+  rx_pending      = false; 
   
   mac_timers = NULL; 
 
@@ -122,6 +123,7 @@ void rlc_um::reset()
   vr_ux    = 0;
   vr_uh    = 0;
   pdu_lost = false;
+  rx_pending = false;
   if(rx_sdu)
     rx_sdu->reset();
   if(tx_sdu)
@@ -165,6 +167,8 @@ void rlc_um::write_sdu(byte_buffer_t *sdu)
 
 uint32_t rlc_um::get_buffer_state()
 {
+  boost::lock_guard<boost::mutex> lock(tx_mutex);
+
   // Bytes needed for tx SDUs
   uint32_t n_sdus  = tx_sdu_queue.size();
   uint32_t n_bytes = tx_sdu_queue.size_bytes();
@@ -193,13 +197,25 @@ uint32_t rlc_um::get_total_buffer_state()
 int rlc_um::read_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
   log->debug("MAC opportunity - %d bytes\n", nof_bytes);
+  boost::lock_guard<boost::mutex> lock(tx_mutex);
   return build_data_pdu(payload, nof_bytes);
 }
 
 void rlc_um::write_pdu(uint8_t *payload, uint32_t nof_bytes)
 {
-  boost::lock_guard<boost::mutex> lock(mutex);
+  boost::lock_guard<boost::mutex> lock(rx_mutex);
   handle_data_pdu(payload, nof_bytes);
+  update_rx_window();
+}
+
+// All PDUs of the burst go into the rx window before SDUs are reassembled and timers updated
+void rlc_um::write_pdus(rlc_interface_mac::pdu_iov_t *pdus, uint32_t nof_pdus)
+{
+  boost::lock_guard<boost::mutex> lock(rx_mutex);
+  for(uint32_t i=0;i<nof_pdus;i++) {
+    handle_data_pdu(pdus[i].payload, pdus[i].nof_bytes);
+  }
+  update_rx_window();
 }
 
 /****************************************************************************
@@ -210,7 +226,7 @@ void rlc_um::timer_expired(uint32_t timeout_id)
 {
   if(reordering_timeout_id == timeout_id)
   {
-    boost::lock_guard<boost::mutex> lock(mutex);
+    boost::lock_guard<boost::mutex> lock(rx_mutex);
 
     // 36.322 v10 Section 5.1.2.2.4
     log->info("%s reordering timeout expiry - updating vr_ur and reassembling\n",
@@ -287,7 +303,7 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
     to_move = ((pdu_space-head_len) >= tx_sdu->N_bytes) ? tx_sdu->N_bytes : pdu_space-head_len;
     log->debug("%s adding remainder of SDU segment - %d bytes of %d remaining\n",
                rb_id_text[lcid], to_move, tx_sdu->N_bytes);
-    memcpy(pdu_ptr, tx_sdu->msg, to_move);
+    rlc_memcpy(pdu_ptr, tx_sdu->msg, to_move);
     last_li          = to_move;
     pdu_ptr         += to_move;
     pdu->N_bytes    += to_move;
@@ -315,7 +331,7 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
     to_move = ((pdu_space-head_len) >= tx_sdu->N_bytes) ? tx_sdu->N_bytes : pdu_space-head_len;
     log->debug("%s adding new SDU segment - %d bytes of %d remaining\n",
                rb_id_text[lcid], to_move, tx_sdu->N_bytes);
-    memcpy(pdu_ptr, tx_sdu->msg, to_move);
+    rlc_memcpy(pdu_ptr, tx_sdu->msg, to_move);
     last_li          = to_move;
     pdu_ptr         += to_move;
     pdu->N_bytes    += to_move;
@@ -341,7 +357,7 @@ int  rlc_um::build_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   // Add header and TX
   log->debug("%s packing PDU with length %d\n", rb_id_text[lcid], pdu->N_bytes);
   rlc_um_write_data_pdu_header(&header, pdu);
-  memcpy(payload, pdu->msg, pdu->N_bytes);
+  rlc_memcpy(payload, pdu->msg, pdu->N_bytes);
   uint32_t ret = pdu->N_bytes;
   log->debug("%sreturning length %d\n", rb_id_text[lcid], pdu->N_bytes);
   pool->deallocate(pdu);
@@ -359,6 +375,10 @@ void rlc_um::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   log->info_hex(payload, nof_bytes, "RX %s Rx data PDU SN: %d",
                 rb_id_text[lcid], header.sn);
 
+  // After a SN wrap-around, an earlier PDU of this burst may still be waiting for reassembly
+  if(rx_pending && rx_window.end() != rx_window.find(header.sn))
+    update_rx_window();
+
   if(RX_MOD_BASE(header.sn) >= RX_MOD_BASE(vr_uh-rx_window_size) &&
      RX_MOD_BASE(header.sn) <  RX_MOD_BASE(vr_ur))
   {
@@ -381,7 +401,7 @@ void rlc_um::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes)
     log->error("Discarting packet: no space in buffer pool\n");
     return;
   }
-  memcpy(pdu.buf->msg, payload, nof_bytes);
+  rlc_memcpy(pdu.buf->msg, payload, nof_bytes);
   pdu.buf->N_bytes = nof_bytes;
   //Strip header from PDU
   int header_len = rlc_um_packed_length(&header);
@@ -394,6 +414,16 @@ void rlc_um::handle_data_pdu(uint8_t *payload, uint32_t nof_bytes)
   if(!inside_reordering_window(header.sn))
     vr_uh  = (header.sn + 1)%rx_mod;
 
+  // SDUs are reassembled once all PDUs of the burst are in the rx window
+  rx_pending = true;
+}
+
+void rlc_um::update_rx_window()
+{
+  if(!rx_pending)
+    return;
+  rx_pending = false;
+
   // Reassemble and deliver SDUs, while updating vr_ur
   log->debug("Entering Reassemble from received PDU\n");
   reassemble_rx_sdus();
@@ -437,7 +467,7 @@ void rlc_um::reassemble_rx_sdus()
       for(int i=0; i<rx_window[vr_ur].header.N_li; i++)
       {
         int len = rx_window[vr_ur].header.li[i];
-        memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, len);
+        rlc_memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, len);
         rx_sdu->N_bytes += len;
         rx_window[vr_ur].buf->msg += len;
         rx_window[vr_ur].buf->N_bytes -= len;
@@ -454,7 +484,7 @@ void rlc_um::reassemble_rx_sdus()
       }
 
       // Handle last segment
-      memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, rx_window[vr_ur].buf->N_bytes);
+      rlc_memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, rx_window[vr_ur].buf->N_bytes);
       rx_sdu->N_bytes += rx_window[vr_ur].buf->N_bytes;
       log->debug("Writting last segment in SDU buffer. Lower edge vr_ur=%d, Buffer size=%d, segment size=%d\n", 
                vr_ur, rx_sdu->N_bytes, rx_window[vr_ur].buf->N_bytes);
@@ -489,7 +519,7 @@ void rlc_um::reassemble_rx_sdus()
     for(int i=0; i<rx_window[vr_ur].header.N_li; i++)
     {
       int len = rx_window[vr_ur].header.li[i];
-      memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, len);
+      rlc_memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, len);
       log->debug("Concatenating %d bytes in to current length %d. rx_window remaining bytes=%d, vr_ur_in_rx_sdu=%d, vr_ur=%d, rx_mod=%d, last_mod=%d\n",
         len, rx_sdu->N_bytes, rx_window[vr_ur].buf->N_bytes, vr_ur_in_rx_sdu, vr_ur, rx_mod, (vr_ur_in_rx_sdu+1)%rx_mod);
       rx_sdu->N_bytes += len;      
@@ -508,7 +538,7 @@ void rlc_um::reassemble_rx_sdus()
     }
     
     // Handle last segment
-    memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, rx_window[vr_ur].buf->N_bytes);
+    rlc_memcpy(&rx_sdu->msg[rx_sdu->N_bytes], rx_window[vr_ur].buf->msg, rx_window[vr_ur].buf->N_bytes);
     rx_sdu->N_bytes += rx_window[vr_ur].buf->N_bytes;
     log->debug("Writting last segment in SDU buffer. Updating vr_ur=%d, Buffer size=%d, segment size=%d\n", 
                vr_ur, rx_sdu->N_bytes, rx_window[vr_ur].buf->N_bytes);
@@ -26,6 +26,7 @@
 
 
 #include <unistd.h>
+#include <stdio.h>
 #include <sstream>
 
 #include "upper/rrc.h"
@@ -41,6 +42,9 @@ namespace srsue{
 rrc::rrc()
   :state(RRC_STATE_IDLE)
   ,drb_up(false)
+  ,si_cache_valid(false)
+  ,si_pending(0)
+  ,sib2_received(false)
 {}
 
 static void liblte_rrc_handler(void *ctx, char *str) {
@@ -244,9 +248,9 @@ void rrc::write_pdu_bcch_bch(byte_buffer_t *pdu)
   rrc_log->info("MIB received BW=%s MHz\n", liblte_rrc_dl_bandwidth_text[mib.dl_bw]);
   rrc_log->console("MIB received BW=%s MHz\n", liblte_rrc_dl_bandwidth_text[mib.dl_bw]);
 
-  // Start the SIB search state machine
+  // Start SIB1 acquisition, scheduled by the MAC on its TTI clock
   state = RRC_STATE_SIB1_SEARCH;
-  pthread_create(&sib_search_thread, NULL, &rrc::start_sib_thread, this);
+  sib1_acquire();
 }
 
 void rrc::write_pdu_bcch_dlsch(byte_buffer_t *pdu)
@@ -256,6 +260,14 @@ void rrc::write_pdu_bcch_dlsch(byte_buffer_t *pdu)
   LIBLTE_RRC_BCCH_DLSCH_MSG_STRUCT dlsch_msg;
   srslte_bit_unpack_vector(pdu->msg, bit_buf.msg, pdu->N_bytes*8);
   bit_buf.N_bits = pdu->N_bytes*8;
+  
+  // Keep the packed message in case it is a SIB2 to be cached
+  uint8_t  packed[sizeof(si_cache.sib2_pdu)];
+  uint32_t packed_len = pdu->N_bytes; 
+  if (packed_len <= sizeof(si_cache.sib2_pdu)) {
+    memcpy(packed, pdu->msg, packed_len);
+  }
+  
   pool->deallocate(pdu);
   liblte_rrc_unpack_bcch_dlsch_msg((LIBLTE_BIT_MSG_STRUCT*)&bit_buf, &dlsch_msg);
 
@@ -282,22 +294,176 @@ void rrc::write_pdu_bcch_dlsch(byte_buffer_t *pdu)
                        ss.str().c_str());
       
       state = RRC_STATE_SIB2_SEARCH;
-      mac->bcch_stop_rx();
       //TODO: Use all SIB1 info
+      
+      boost::mutex::scoped_lock lock(si_mutex);
+      si_pending    = 0; 
+      sib2_received = false; 
+      
+      // Skip SIB2 acquisition if the cached one is still valid 
+      if (si_cache_load()                          && 
+          si_cache.cell_id   == sib1.cell_id       && 
+          si_cache.value_tag == sib1.system_info_value_tag) 
+      {
+        LIBLTE_RRC_BCCH_DLSCH_MSG_STRUCT cached_msg;
+        srslte_bit_unpack_vector(si_cache.sib2_pdu, bit_buf.msg, si_cache.sib2_len*8);
+        bit_buf.N_bits = si_cache.sib2_len*8;
+        liblte_rrc_unpack_bcch_dlsch_msg((LIBLTE_BIT_MSG_STRUCT*)&bit_buf, &cached_msg);
+        if (cached_msg.N_sibs > 0 && LIBLTE_RRC_SYS_INFO_BLOCK_TYPE_2 == cached_msg.sibs[0].sib_type) {
+          rrc_log->console("Using cached SIB2, systemInfoValueTag=%d\n", sib1.system_info_value_tag);
+          rrc_log->info("Using cached SIB2, systemInfoValueTag=%d\n", sib1.system_info_value_tag);
+          handle_sib2(&cached_msg.sibs[0].sib.sib2);
+        }
+      }
+      
+      // Schedule all SI messages in SIB1. SIB2 is always mapped to the first one 
+      uint32_t si_win_len = liblte_rrc_si_window_length_num[sib1.si_window_length];
+      for (uint32_t n=0;n<sib1.N_sched_info && n<LIBLTE_RRC_MAX_SI_MESSAGE;n++) {
+        if (n == 0 && sib2_received) {
+          continue; 
+        }
+        mac->si_acquire(n+1, 
+                        liblte_rrc_si_periodicity_num[sib1.sched_info[n].si_periodicity], 
+                        n*si_win_len, si_win_len, SI_MAX_WINDOWS);
+        si_pending |= ((uint64_t) 1)<<(n+1);
+      }
+      // Connect now if SIB2 was cached. The other SI messages are acquired in the background 
+      if (sib2_received || !(si_pending & SIB2_SI_MASK)) {
+        sib2_complete();
+      }
 
-    } else if (LIBLTE_RRC_SYS_INFO_BLOCK_TYPE_2 == dlsch_msg.sibs[0].sib_type && RRC_STATE_SIB2_SEARCH == state) {
-      // Handle SIB2
-      memcpy(&sib2, &dlsch_msg.sibs[0].sib.sib2, sizeof(LIBLTE_RRC_SYS_INFO_BLOCK_TYPE_2_STRUCT));
-      rrc_log->console("SIB2 received\n");
-      rrc_log->info("SIB2 received\n");
-      state = RRC_STATE_WAIT_FOR_CON_SETUP;
-      mac->bcch_stop_rx();
-      apply_sib2_configs();
-      send_con_request();
+    } else if (RRC_STATE_SIB2_SEARCH == state || si_pending) {
+      boost::mutex::scoped_lock lock(si_mutex);
+      for (uint32_t i=0;i<dlsch_msg.N_sibs;i++) {
+        if (LIBLTE_RRC_SYS_INFO_BLOCK_TYPE_2 == dlsch_msg.sibs[i].sib_type && 
+            RRC_STATE_SIB2_SEARCH == state && !sib2_received) 
+        {
+          // Handle SIB2
+          rrc_log->console("SIB2 received\n");
+          rrc_log->info("SIB2 received\n");
+          if (i == 0) {
+            if (packed_len <= sizeof(si_cache.sib2_pdu)) {
+              si_cache_save(packed, packed_len);
+            } else {
+              rrc_log->warning("SIB2 message of %d bytes does not fit in the SI cache, not caching it\n", packed_len);
+            }
+          }
+          handle_sib2(&dlsch_msg.sibs[i].sib.sib2);
+          sib2_complete();
+        } else {
+          rrc_log->info("SIB%d received\n", liblte_rrc_sys_info_block_type_num[dlsch_msg.sibs[i].sib_type]);
+        }
+      }
     }
   }
 }
 
+void rrc::handle_sib2(LIBLTE_RRC_SYS_INFO_BLOCK_TYPE_2_STRUCT *sib2_)
+{
+  memcpy(&sib2, sib2_, sizeof(LIBLTE_RRC_SYS_INFO_BLOCK_TYPE_2_STRUCT));
+  sib2_received = true; 
+}
+
+void rrc::sib1_acquire()
+{
+  // SIB1 is transmitted in subframe 5 of radio frames with SFN mod 2 = 0
+  mac->si_acquire(0, 2, 5, 1, SIB1_MAX_WINDOWS);
+  rrc_log->debug("Instructed MAC to search for SIB1\n");
+}
+
+void rrc::si_acquired(uint32_t si_id, bool success)
+{
+  boost::mutex::scoped_lock lock(si_mutex);
+  if (si_id == 0) {
+    if (!success && RRC_STATE_SIB1_SEARCH == state) {
+      rrc_log->info("Timeout while searching for SIB1. Resynchronizing SFN...\n");
+      rrc_log->console("Timeout while searching for SIB1. Resynchronizing SFN...\n");
+      phy->resync_sfn();
+      sib1_acquire();
+    }
+    return; 
+  }
+  if (!(si_pending & (((uint64_t) 1)<<si_id))) {
+    return; 
+  }
+  si_pending &= ~(((uint64_t) 1)<<si_id);
+  if (!success) {
+    rrc_log->warning("SI message %d not received after %d windows\n", si_id, SI_MAX_WINDOWS);
+    // The SI message carrying SIB2 was given up, no need to wait for the others 
+    if (SIB2_SI_MASK == (((uint64_t) 1)<<si_id) && RRC_STATE_SIB2_SEARCH == state && !sib2_received) {
+      sib2_complete();
+    }
+  }
+}
+
+/* Called with si_mutex locked once SIB2 has been received or given up. The connection request 
+ * does not wait for the remaining SI messages, which are still acquired by the MAC */
+void rrc::sib2_complete()
+{
+  if (sib2_received) {
+    state = RRC_STATE_WAIT_FOR_CON_SETUP;
+    apply_sib2_configs();
+    send_con_request();
+  } else {
+    rrc_log->info("SIB2 not received. Restarting SI acquisition...\n");
+    rrc_log->console("SIB2 not received. Restarting SI acquisition...\n");
+    mac->si_acquire_stop();
+    si_pending = 0; 
+    state = RRC_STATE_SIB1_SEARCH;
+    sib1_acquire();
+  }
+}
+
+void rrc::set_si_cache(std::string filename)
+{
+  si_cache_file  = filename; 
+  si_cache_valid = false; 
+}
+
+bool rrc::si_cache_load()
+{
+  if (si_cache_valid) {
+    return true; 
+  }
+  if (!si_cache_file.length()) {
+    return false; 
+  }
+  FILE *f = fopen(si_cache_file.c_str(), "r");
+  if (!f) {
+    return false; 
+  }
+  si_cache_valid = fread(&si_cache, sizeof(si_cache_t), 1, f) == 1 && 
+                   si_cache.magic    == SI_CACHE_MAGIC && 
+                   si_cache.sib2_len <= sizeof(si_cache.sib2_pdu); 
+  fclose(f);
+  if (!si_cache_valid) {
+    rrc_log->warning("Invalid SI cache file %s\n", si_cache_file.c_str());
+  }
+  return si_cache_valid; 
+}
+
+void rrc::si_cache_save(uint8_t *sib2_pdu, uint32_t len)
+{
+  if (!si_cache_file.length()) {
+    return; 
+  }
+  bzero(&si_cache, sizeof(si_cache_t));
+  si_cache.magic     = SI_CACHE_MAGIC; 
+  si_cache.cell_id   = sib1.cell_id; 
+  si_cache.value_tag = sib1.system_info_value_tag; 
+  si_cache.sib2_len  = len; 
+  memcpy(si_cache.sib2_pdu, sib2_pdu, len);
+  si_cache_valid = true; 
+  
+  FILE *f = fopen(si_cache_file.c_str(), "w");
+  if (!f || fwrite(&si_cache, sizeof(si_cache_t), 1, f) != 1) {
+    rrc_log->warning("Error writing SI cache file %s\n", si_cache_file.c_str());
+  }
+  if (f) {
+    fclose(f);
+  }
+}
+
 void rrc::write_pdu_pcch(byte_buffer_t *pdu)
 {
   if (pdu->N_bytes > 0 && pdu->N_bytes < SRSUE_MAX_BUFFER_SIZE_BITS) {
@@ -872,6 +1038,7 @@ void rrc::radio_link_failure() {
   
   rrc_log->warning("Detected Radio-Link Failure\n");
   rrc_log->console("Warning: Detected Radio-Link Failure\n");
+  phy->iq_capture_trigger();
   if (state != RRC_STATE_RRC_CONNECTED) {
     rrc_connection_release();
   } else {    
@@ -879,69 +1046,34 @@ void rrc::radio_link_failure() {
   }
 }
 
-void* rrc::start_sib_thread(void *rrc_)
+// Determine the paging frame and paging occasion as in 36.304 Section 7 (FDD)
+void rrc::apply_paging_drx()
 {
-  rrc *r = (rrc*)rrc_;
-  r->sib_search();
-  return NULL;
-}
-
-void rrc::sib_search()
-{
-  bool      searching = true;
-  uint32_t  tti ;
-  uint32_t  si_win_start, si_win_len;
-  uint16_t  period;
-  uint32_t  nof_sib1_trials = 0; 
-  const int SIB1_SEARCH_TIMEOUT = 30; 
-
-  while(searching)
-  {
-    switch(state)
-    {
-    case RRC_STATE_SIB1_SEARCH:
-      // Instruct MAC to look for SIB1
-      while(!phy->status_is_sync()){
-        usleep(50000);
-      }
-      usleep(10000); 
-      tti          = mac->get_current_tti();
-      si_win_start = sib_start_tti(tti, 2, 5);
-      mac->bcch_start_rx(si_win_start, 1);
-      rrc_log->debug("Instructed MAC to search for SIB1, win_start=%d, win_len=%d\n",
-                     si_win_start, 1);
-      nof_sib1_trials++;
-      if (nof_sib1_trials >= SIB1_SEARCH_TIMEOUT) {
-        rrc_log->info("Timeout while searching for SIB1. Resynchronizing SFN...\n");
-        rrc_log->console("Timeout while searching for SIB1. Resynchronizing SFN...\n");
-        phy->resync_sfn();
-        nof_sib1_trials = 0; 
-      }
-      break;
-    case RRC_STATE_SIB2_SEARCH:
-      // Instruct MAC to look for SIB2
-      usleep(10000);
-      tti          = mac->get_current_tti();
-      period       = liblte_rrc_si_periodicity_num[sib1.sched_info[0].si_periodicity];
-      si_win_start = sib_start_tti(tti, period, 0);
-      si_win_len   = liblte_rrc_si_window_length_num[sib1.si_window_length];
-
-      mac->bcch_start_rx(si_win_start, si_win_len);
-      rrc_log->debug("Instructed MAC to search for SIB2, win_start=%d, win_len=%d\n",
-                     si_win_start, si_win_len);
-
-      break;
-    default:
-      searching = false;
-      break;
-    }
-    usleep(100000);
+  // No UE-specific DRX is negotiated, so T is the default paging cycle in SIB2
+  uint32_t T  = liblte_rrc_default_paging_cycle_num[sib2.rr_config_common_sib.pcch_cnfg.default_paging_cycle];
+  uint32_t nB = (uint32_t) (T*liblte_rrc_nb_num[sib2.rr_config_common_sib.pcch_cnfg.nB]);
+  uint32_t N  = SRSLTE_MAX(1, SRSLTE_MIN(T, nB));
+  uint32_t Ns = SRSLTE_MAX(1, nB/T);
+
+  // UE_ID = IMSI mod 1024
+  uint8_t  imsi[15];
+  uint32_t ue_id = 0;
+  usim->get_imsi_vec(imsi, 15);
+  for (int i=0;i<15;i++) {
+    ue_id = (ue_id*10 + imsi[i])%1024;
   }
-}
 
-// Determine SI messages scheduling as in 36.331 5.2.3 Acquisition of an SI message
-uint32_t rrc::sib_start_tti(uint32_t tti, uint32_t period, uint32_t x) {
-  return (period*10*(1+tti/(period*10))+x)%10240; // the 1 means next opportunity
+  // Subframe pattern for FDD, 36.304 Section 7.2
+  const static uint32_t po_table[3][4] = {{9, 9, 9, 9},
+                                          {4, 9, 4, 9},
+                                          {0, 4, 5, 9}};
+  uint32_t pf_offset = (T/N)*(ue_id%N);
+  uint32_t i_s       = (ue_id/N)%Ns;
+  uint32_t po_sf     = po_table[Ns==4?2:(Ns==2?1:0)][i_s];
+
+  rrc_log->info("Set paging DRX: T=%d, nB=%d, UE_ID=%d, PF=SFN mod %d = %d, PO=%d\n",
+                T, nB, ue_id, T, pf_offset, po_sf);
+  phy->set_paging_occasion(T, pf_offset, po_sf);
 }
 
 void rrc::apply_sib2_configs()
@@ -1006,6 +1138,8 @@ void rrc::apply_sib2_configs()
                  liblte_rrc_srs_subfr_config_num[sib2.rr_config_common_sib.srs_ul_cnfg.subfr_cnfg],
                  sib2.rr_config_common_sib.srs_ul_cnfg.ack_nack_simul_tx?"yes":"no");
 
+  apply_paging_drx();
+
   mac_timers->get(t301)->set(this, liblte_rrc_t301_num[sib2.ue_timers_and_constants.t301]);
   mac_timers->get(t310)->set(this, liblte_rrc_t310_num[sib2.ue_timers_and_constants.t310]);
   mac_timers->get(t311)->set(this, liblte_rrc_t311_num[sib2.ue_timers_and_constants.t311]);
@@ -1200,6 +1334,25 @@ void rrc::apply_mac_config_dedicated(LIBLTE_RRC_MAC_MAIN_CONFIG_STRUCT *mac_cnfg
   }
 }
 
+void rrc::apply_sps_config(LIBLTE_RRC_SPS_CONFIG_STRUCT *sps_cnfg)
+{
+  if (sps_cnfg->sps_cnfg_dl_present) {
+    // n1PUCCH-AN-Persistent resources are used by the PHY for PDSCH without PDCCH 
+    phy->set_config_sps_dl(&sps_cnfg->sps_cnfg_dl);
+    if (sps_cnfg->sps_cnfg_dl.setup_present) {
+      rrc_log->info("Set SPS DL config: interval=%s, nof_processes=%d\n", 
+                    liblte_rrc_sps_interval_dl_text[sps_cnfg->sps_cnfg_dl.sps_interval_dl], 
+                    sps_cnfg->sps_cnfg_dl.N_sps_processes);
+    }
+  }
+  if (sps_cnfg->sps_cnfg_ul_present && sps_cnfg->sps_cnfg_ul.setup_present) {
+    rrc_log->info("Set SPS UL config: interval=%s, implicitReleaseAfter=%s\n", 
+                  liblte_rrc_sps_interval_ul_text[sps_cnfg->sps_cnfg_ul.sps_interval_ul], 
+                  liblte_rrc_implicit_release_after_text[sps_cnfg->sps_cnfg_ul.implicit_release_after]);
+  }
+  mac->set_config_sps(sps_cnfg);
+}
+
 void rrc::apply_rr_config_dedicated(LIBLTE_RRC_RR_CONFIG_DEDICATED_STRUCT *cnfg) {   
   if(cnfg->phy_cnfg_ded_present) {
    apply_phy_config_dedicated(&cnfg->phy_cnfg_ded, false);
@@ -1214,7 +1367,7 @@ void rrc::apply_rr_config_dedicated(LIBLTE_RRC_RR_CONFIG_DEDICATED_STRUCT *cnfg)
   }
   
   if(cnfg->sps_cnfg_present) {
-    //TODO
+    apply_sps_config(&cnfg->sps_cnfg);
   }
   if(cnfg->rlf_timers_and_constants_present) {
     //TODO
@@ -0,0 +1,123 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "common/pdu.h"
+
+using namespace srslte;
+
+#define NOF_SDUS 30
+#define SDU_LEN  2
+#define LCID     3
+
+/* More subheaders than the initial subheader table */
+void many_subheaders_test()
+{
+  uint8_t  buffer[256];
+  uint32_t n = 0;
+
+  // All but the last SDU subheader carry the 7-bit length field
+  for(uint32_t i=0;i<NOF_SDUS-1;i++) {
+    buffer[n++] = 0x20 | LCID;
+    buffer[n++] = SDU_LEN;
+  }
+  buffer[n++] = LCID;
+  for(uint32_t i=0;i<NOF_SDUS;i++) {
+    buffer[n++] = i;
+    buffer[n++] = i;
+  }
+
+  sch_pdu pdu(10);
+  pdu.init_rx(n);
+  assert(pdu.parse_packet(buffer));
+  assert(NOF_SDUS == pdu.nof_subh());
+
+  uint32_t i = 0;
+  while(pdu.next()) {
+    assert(pdu.get()->is_sdu());
+    assert(LCID == pdu.get()->get_sdu_lcid());
+    assert(SDU_LEN == pdu.get()->get_payload_size());
+    assert(i == pdu.get()->get_sdu_ptr()[0]);
+    i++;
+  }
+  assert(NOF_SDUS == i);
+}
+
+/* The subheaders run up to the end of the PDU without a last subheader */
+void truncated_header_test()
+{
+  uint8_t buffer[16];
+  memset(buffer, 0x20 | LCID, sizeof(buffer));
+
+  sch_pdu pdu(10);
+  pdu.init_rx(sizeof(buffer));
+  assert(!pdu.parse_packet(buffer));
+  assert(0 == pdu.nof_subh());
+  assert(!pdu.next());
+}
+
+/* An SDU length field that points past the end of the PDU */
+void malformed_length_test()
+{
+  uint8_t buffer[8];
+  bzero(buffer, sizeof(buffer));
+  buffer[0] = 0x20 | LCID;
+  buffer[1] = 0x7f;
+  buffer[2] = LCID;
+
+  sch_pdu pdu(10);
+  pdu.init_rx(sizeof(buffer));
+  assert(!pdu.parse_packet(buffer));
+  assert(0 == pdu.nof_subh());
+  assert(!pdu.next());
+}
+
+/* The last subheader has the F bit set but the PDU ends before its second L byte */
+void truncated_length_test()
+{
+  uint8_t *buffer = (uint8_t*) malloc(2);
+  buffer[0] = 0x20 | LCID;
+  buffer[1] = 0x80;
+
+  sch_pdu pdu(10);
+  pdu.init_rx(2);
+  assert(!pdu.parse_packet(buffer));
+  assert(0 == pdu.nof_subh());
+  free(buffer);
+}
+
+int main(int argc, char **argv) {
+  many_subheaders_test();
+  truncated_header_test();
+  malformed_length_test();
+  truncated_length_test();
+  printf("Passed\n");
+  exit(0);
+}
@@ -0,0 +1,912 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/* Full-stack L2 loopback benchmark.
+ *
+ * The UE MAC, RLC and PDCP run unmodified against an emulated PHY that loops them back to
+ * an in-process eNB peer made of a second RLC and PDCP and a minimal MAC scheduler. The
+ * emulated PHY grants a fixed TB size every TTI in each direction, draws HARQ failures from
+ * a BLER and paces the TTIs at a configurable period, 0 running them as fast as possible.
+ * Traffic is generated and terminated at the PDCP SAP of both sides, so no TUN device is
+ * needed. Results are printed to stdout as JSON.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <vector>
+#include <algorithm>
+
+#include "liblte/hdr/liblte_rrc.h"
+#include "common/common.h"
+#include "common/buffer_pool.h"
+#include "common/logger.h"
+#include "common/log_filter.h"
+#include "common/threads.h"
+#include "common/timers.h"
+#include "common/pdu.h"
+#include "common/mac_interface.h"
+#include "common/phy_interface.h"
+#include "common/interfaces.h"
+#include "mac/mac.h"
+#include "upper/rlc.h"
+#include "upper/pdcp.h"
+
+using namespace srsue;
+
+#define LCID srslte::RB_ID_DRB1
+#define RNTI 0x46
+
+/**********************************************************************
+ *  Program arguments processing
+ ***********************************************************************/
+typedef struct {
+  uint32_t duration_ms;
+  uint32_t dl_grant_bytes;
+  uint32_t ul_grant_bytes;
+  float    dl_bler;
+  float    ul_bler;
+  uint32_t harq_rtt;
+  uint32_t tti_period_us;
+  float    dl_rate_mbps;
+  float    ul_rate_mbps;
+  uint32_t sdu_len;
+  bool     rlc_um;
+  int      verbose;
+}prog_args_t;
+
+prog_args_t prog_args;
+
+void args_default(prog_args_t *args) {
+  args->duration_ms    = 10000;
+  args->dl_grant_bytes = 6000;
+  args->ul_grant_bytes = 2000;
+  args->dl_bler        = 0.1;
+  args->ul_bler        = 0.1;
+  args->harq_rtt       = 8;
+  args->tti_period_us  = 1000;
+  args->dl_rate_mbps   = 0;
+  args->ul_rate_mbps   = 0;
+  args->sdu_len        = 1400;
+  args->rlc_um         = false;
+  args->verbose        = 0;
+}
+
+void usage(prog_args_t *args, char *prog) {
+  printf("Usage: %s [dDUbBrtlLsuv]\n", prog);
+  printf("\t-d Duration in TTIs [Default %d]\n", args->duration_ms);
+  printf("\t-D DL TB size in bytes per TTI, 0 disables DL [Default %d]\n", args->dl_grant_bytes);
+  printf("\t-U UL TB size in bytes per TTI, 0 disables UL [Default %d]\n", args->ul_grant_bytes);
+  printf("\t-b DL BLER [Default %.2f]\n", args->dl_bler);
+  printf("\t-B UL BLER [Default %.2f]\n", args->ul_bler);
+  printf("\t-r DL HARQ RTT in TTIs, UL is synchronous [Default %d]\n", args->harq_rtt);
+  printf("\t-t TTI period in us, 0 runs as fast as possible [Default %d]\n", args->tti_period_us);
+  printf("\t-l DL offered load in Mbps, 0 saturates [Default %.1f]\n", args->dl_rate_mbps);
+  printf("\t-L UL offered load in Mbps, 0 saturates [Default %.1f]\n", args->ul_rate_mbps);
+  printf("\t-s SDU size in bytes [Default %d]\n", args->sdu_len);
+  printf("\t-u Use RLC UM instead of AM\n");
+  printf("\t-v [increase verbosity, logs to /tmp/l2_loopback_bench.log]\n");
+}
+
+void parse_args(prog_args_t *args, int argc, char **argv) {
+  int opt;
+  args_default(args);
+  while ((opt = getopt(argc, argv, "dDUbBrtlLsuv")) != -1) {
+    switch (opt) {
+    case 'd':
+      args->duration_ms = atoi(argv[optind]);
+      break;
+    case 'D':
+      args->dl_grant_bytes = atoi(argv[optind]);
+      break;
+    case 'U':
+      args->ul_grant_bytes = atoi(argv[optind]);
+      break;
+    case 'b':
+      args->dl_bler = atof(argv[optind]);
+      break;
+    case 'B':
+      args->ul_bler = atof(argv[optind]);
+      break;
+    case 'r':
+      args->harq_rtt = atoi(argv[optind]);
+      break;
+    case 't':
+      args->tti_period_us = atoi(argv[optind]);
+      break;
+    case 'l':
+      args->dl_rate_mbps = atof(argv[optind]);
+      break;
+    case 'L':
+      args->ul_rate_mbps = atof(argv[optind]);
+      break;
+    case 's':
+      args->sdu_len = atoi(argv[optind]);
+      break;
+    case 'u':
+      args->rlc_um = true;
+      break;
+    case 'v':
+      args->verbose++;
+      break;
+    default:
+      usage(args, argv[0]);
+      exit(-1);
+    }
+  }
+  // HARQ feedback is received 4 TTI after the transmission
+  if (args->harq_rtt < 4 || args->sdu_len < 16 || args->sdu_len > 8000) {
+    usage(args, argv[0]);
+    exit(-1);
+  }
+}
+
+uint64_t now_us()
+{
+  struct timeval t;
+  gettimeofday(&t, NULL);
+  return (uint64_t) t.tv_sec*1000000 + t.tv_usec;
+}
+
+/**********************************************************************
+ *  Traffic source and sink at the PDCP SAP, like iperf over the GW
+ ***********************************************************************/
+class traffic_endpoint : public gw_interface_pdcp
+{
+public:
+
+  // Sequence number and transmission time at the start of every SDU
+  const static uint32_t HDR_LEN         = 12;
+  // SDUs are not generated while the RLC holds more than this, as the GW would block
+  const static uint32_t MAX_QUEUE_BYTES = 128*1024;
+
+  traffic_endpoint() {
+    pthread_mutex_init(&mutex, NULL);
+  }
+
+  void init(pdcp_interface_gw *pdcp_, rlc *rlc_, uint32_t sdu_len_, float rate_mbps_)
+  {
+    pdcp      = pdcp_;
+    rlc_h     = rlc_;
+    sdu_len   = sdu_len_;
+    rate_mbps = rate_mbps_;
+    pool      = srslte::buffer_pool::get_instance();
+    credit    = 0;
+    tx_seq    = 0;
+    tx_bytes  = 0;
+    rx_seq    = 0;
+    rx_sdus   = 0;
+    rx_bytes  = 0;
+    nof_lost  = 0;
+    nof_reordered = 0;
+    latency_us.reserve(1<<20);
+  }
+
+  // Generates the SDUs offered during one TTI of 1 ms
+  void tti_tx()
+  {
+    if (rate_mbps > 0) {
+      credit += rate_mbps*1e6/8/1000;
+      if (credit > MAX_QUEUE_BYTES) {
+        credit = MAX_QUEUE_BYTES;
+      }
+    } else {
+      credit = MAX_QUEUE_BYTES;
+    }
+    uint32_t queued = rlc_h->get_total_buffer_state(LCID);
+    while (credit >= sdu_len && queued < MAX_QUEUE_BYTES) {
+      srslte::byte_buffer_t *sdu = pool->allocate();
+      if (!sdu) {
+        break;
+      }
+      uint64_t t = now_us();
+      memcpy(&sdu->msg[0], &tx_seq, sizeof(uint32_t));
+      memcpy(&sdu->msg[4], &t, sizeof(uint64_t));
+      sdu->N_bytes = sdu_len;
+      pdcp->write_sdu(LCID, sdu);
+      tx_seq++;
+      tx_bytes += sdu_len;
+      queued   += sdu_len;
+      credit   -= sdu_len;
+    }
+  }
+
+  void write_pdu(uint32_t lcid, srslte::byte_buffer_t *pdu)
+  {
+    if (pdu->N_bytes >= HDR_LEN) {
+      uint32_t seq;
+      uint64_t t;
+      memcpy(&seq, &pdu->msg[0], sizeof(uint32_t));
+      memcpy(&t,   &pdu->msg[4], sizeof(uint64_t));
+      uint64_t now = now_us();
+
+      pthread_mutex_lock(&mutex);
+      if (seq >= rx_seq) {
+        nof_lost += seq - rx_seq;
+        rx_seq    = seq + 1;
+      } else {
+        // Counted as lost when the gap was seen
+        nof_reordered++;
+        if (nof_lost > 0) {
+          nof_lost--;
+        }
+      }
+      rx_sdus++;
+      rx_bytes += pdu->N_bytes;
+      latency_us.push_back(now > t ? (uint32_t) (now - t) : 0);
+      pthread_mutex_unlock(&mutex);
+    }
+    pool->deallocate(pdu);
+  }
+
+  float percentile(float p)
+  {
+    if (latency_us.size() == 0) {
+      return 0;
+    }
+    return latency_us[(uint32_t) (p*(latency_us.size()-1))];
+  }
+
+  // Prints the direction this endpoint receives, once traffic has stopped
+  void print_rx_json(traffic_endpoint *src, uint32_t nof_ttis, float wall_secs)
+  {
+    std::sort(latency_us.begin(), latency_us.end());
+    float secs = (float) nof_ttis/1000;
+    printf("    \"offered_mbps\": %.3f,\n",       secs>0?src->tx_bytes*8/secs/1e6:0);
+    printf("    \"goodput_mbps\": %.3f,\n",       secs>0?rx_bytes*8/secs/1e6:0);
+    printf("    \"goodput_wall_mbps\": %.3f,\n",  wall_secs>0?rx_bytes*8/wall_secs/1e6:0);
+    printf("    \"tx_sdus\": %u,\n",              src->tx_seq);
+    printf("    \"rx_sdus\": %lu,\n",             (unsigned long) rx_sdus);
+    printf("    \"lost_sdus\": %lu,\n",           (unsigned long) nof_lost);
+    printf("    \"reordered_sdus\": %lu,\n",      (unsigned long) nof_reordered);
+    printf("    \"latency_us\": {\"p50\": %.0f, \"p90\": %.0f, \"p99\": %.0f, \"p999\": %.0f, \"max\": %.0f},\n",
+           percentile(0.5), percentile(0.9), percentile(0.99), percentile(0.999), percentile(1.0));
+  }
+
+  uint64_t get_rx_bytes() {
+    return rx_bytes;
+  }
+
+private:
+  pdcp_interface_gw   *pdcp;
+  rlc                 *rlc_h;
+  srslte::buffer_pool *pool;
+  uint32_t             sdu_len;
+  float                rate_mbps;
+  float                credit;
+
+  uint32_t             tx_seq;
+  uint64_t             tx_bytes;
+
+  pthread_mutex_t      mutex;
+  uint32_t             rx_seq;
+  uint64_t             rx_sdus;
+  uint64_t             rx_bytes;
+  uint64_t             nof_lost;
+  uint64_t             nof_reordered;
+  std::vector<uint32_t> latency_us;
+};
+
+/**********************************************************************
+ *  RRC and UE stubs. Bearers are configured by main()
+ ***********************************************************************/
+class rrc_dummy : public rrc_interface_mac
+                , public rrc_interface_pdcp
+                , public rrc_interface_rlc
+                , public ue_interface
+{
+public:
+  rrc_dummy() {
+    nof_max_retx = 0;
+  }
+  void release_pucch_srs() {}
+  void ra_problem() {}
+  void si_acquired(uint32_t si_id, bool success) {}
+  void write_pdu(uint32_t lcid, srslte::byte_buffer_t *pdu) {
+    srslte::buffer_pool::get_instance()->deallocate(pdu);
+  }
+  void write_pdu_bcch_bch(srslte::byte_buffer_t *pdu) {}
+  void write_pdu_bcch_dlsch(srslte::byte_buffer_t *pdu) {}
+  void write_pdu_pcch(srslte::byte_buffer_t *pdu) {}
+  void max_retx_attempted() {
+    nof_max_retx++;
+  }
+  uint32_t nof_max_retx;
+};
+
+/**********************************************************************
+ *  eNB peer: RLC and PDCP entities of the UE code plus MAC multiplexing
+ ***********************************************************************/
+class enb_peer : public mac_interface_rlc
+               , public srslte::mac_interface_timers
+{
+public:
+
+  const static uint32_t NOF_TIMERS = 20;
+
+  enb_peer() : timers_db(NOF_TIMERS), dl_pdu(20), ul_pdu(20) {}
+
+  void init(LIBLTE_RRC_RLC_CONFIG_STRUCT *rlc_cnfg, uint32_t sdu_len, float rate_mbps, srslte::log *log_h_)
+  {
+    log_h = log_h_;
+    rlc_h.init(&pdcp_h, &rrc, &rrc, log_h, this, this);
+    pdcp_h.init(&rlc_h, &rrc, &traffic, log_h);
+    pdcp_h.add_bearer(LCID);
+    rlc_h.add_bearer(LCID, rlc_cnfg);
+    traffic.init(&pdcp_h, &rlc_h, sdu_len, rate_mbps);
+    ta_sent       = false;
+    sr_pending    = false;
+    ul_buffer     = 0;
+  }
+
+  void stop()
+  {
+    rlc_h.stop();
+  }
+
+  void tti_clock()
+  {
+    timers_db.step_all();
+    traffic.tti_tx();
+  }
+
+  /* Builds a DL-SCH PDU of nof_bytes in buffer, which must hold twice as much. Returns NULL if
+   * there is nothing to transmit. The first PDU carries a TA command to start the UE
+   * timeAlignmentTimer, without which the UE does not send HARQ ACKs */
+  uint8_t* build_dl_pdu(uint8_t *buffer, uint32_t nof_bytes)
+  {
+    bool has_data = false;
+    dl_pdu.init_tx(buffer, nof_bytes, false);
+    if (!ta_sent) {
+      if (dl_pdu.new_subh()) {
+        dl_pdu.get()->set_ta_cmd(31);
+        ta_sent  = true;
+        has_data = true;
+      }
+    }
+    while (rlc_h.get_buffer_state(LCID) > 0 && dl_pdu.get_sdu_space() > 0) {
+      uint32_t sdu_len = SRSLTE_MIN(rlc_h.get_buffer_state(LCID), (uint32_t) dl_pdu.get_sdu_space());
+      if (!dl_pdu.new_subh()) {
+        break;
+      }
+      if (dl_pdu.get()->set_sdu(LCID, sdu_len, &rlc_h) <= 0) {
+        dl_pdu.del_subh();
+        break;
+      }
+      has_data = true;
+    }
+    return has_data?dl_pdu.write_packet(log_h):NULL;
+  }
+
+  void process_ul_pdu(uint8_t *pdu, uint32_t nof_bytes)
+  {
+    ul_pdu.init_rx(nof_bytes, true);
+    ul_pdu.parse_packet(pdu);
+    while (ul_pdu.next()) {
+      srslte::sch_subh *subh = ul_pdu.get();
+      if (subh->is_sdu()) {
+        rlc_h.write_pdu(subh->get_sdu_lcid(), subh->get_sdu_ptr(), subh->get_payload_size());
+        ul_buffer -= SRSLTE_MIN(ul_buffer, subh->get_payload_size());
+      } else if (subh->ce_type() == srslte::sch_subh::SHORT_BSR ||
+                 subh->ce_type() == srslte::sch_subh::TRUNC_BSR ||
+                 subh->ce_type() == srslte::sch_subh::LONG_BSR)
+      {
+        uint32_t buff_size[4];
+        bzero(buff_size, sizeof(buff_size));
+        if (subh->get_bsr(buff_size) >= 0) {
+          ul_buffer = buff_size[0] + buff_size[1] + buff_size[2] + buff_size[3];
+        }
+      }
+    }
+  }
+
+  /* UL scheduling follows the SR and the last reported buffer status */
+  void sr_received() {
+    sr_pending = true;
+  }
+  bool need_ul_grant() {
+    bool ret   = sr_pending || ul_buffer > 0;
+    sr_pending = false;
+    return ret;
+  }
+
+  /* MAC interface for RLC. The scheduler polls the buffer state every TTI */
+  void notify_ul_data(uint32_t lcid) {}
+
+  /* Timer services for RLC, stepped every TTI */
+  srslte::timers::timer* get(uint32_t timer_id) {
+    return timers_db.get(timer_id);
+  }
+  uint32_t get_unique_id() {
+    return timers_db.get_unique_id();
+  }
+
+  traffic_endpoint traffic;
+  rrc_dummy        rrc;
+
+private:
+  srslte::log    *log_h;
+  rlc             rlc_h;
+  pdcp            pdcp_h;
+  srslte::timers  timers_db;
+  srslte::sch_pdu dl_pdu;
+  srslte::sch_pdu ul_pdu;
+  bool            ta_sent;
+  bool            sr_pending;
+  uint32_t        ul_buffer;
+};
+
+/**********************************************************************
+ *  Emulated PHY: grants, HARQ and BLER between the UE MAC and the eNB peer
+ ***********************************************************************/
+class emulated_phy : public phy_interface_mac
+                   , public thread
+{
+public:
+
+  const static uint32_t NOF_HARQ_PROC = 8;
+
+  void init(prog_args_t *args_, mac_interface_phy *mac_, traffic_endpoint *ue_traffic_, enb_peer *enb_,
+            uint32_t max_harq_tx_, srslte::log *log_h_)
+  {
+    args        = args_;
+    mac         = mac_;
+    ue_traffic  = ue_traffic_;
+    enb         = enb_;
+    max_harq_tx = max_harq_tx_;
+    log_h       = log_h_;
+    seed        = 1;
+    tti         = 0;
+    nof_ttis    = 0;
+    sr_req      = false;
+    sr_tti      = -1;
+    finished    = false;
+    bzero(&dl_stats, sizeof(harq_stats_t));
+    bzero(&ul_stats, sizeof(harq_stats_t));
+    for (uint32_t i=0;i<NOF_HARQ_PROC;i++) {
+      bzero(&dl_proc[i], sizeof(dl_proc_t));
+      bzero(&ul_proc[i], sizeof(ul_proc_t));
+      dl_proc[i].buffer = (uint8_t*) calloc(1, 2*SRSLTE_MAX(args->dl_grant_bytes, 1));
+      ul_proc[i].buffer = (uint8_t*) calloc(1, SRSLTE_MAX(args->ul_grant_bytes, 1));
+    }
+    running = true;
+    start();
+  }
+
+  void stop()
+  {
+    running = false;
+    wait_thread_finish();
+    for (uint32_t i=0;i<NOF_HARQ_PROC;i++) {
+      free(dl_proc[i].buffer);
+      free(ul_proc[i].buffer);
+    }
+  }
+
+  bool is_finished() {
+    return finished;
+  }
+
+  uint32_t get_nof_ttis() {
+    return nof_ttis;
+  }
+
+  float get_wall_secs() {
+    return (float) (end_us - start_us)/1e6;
+  }
+
+  void print_harq_json(bool is_dl)
+  {
+    harq_stats_t *s = is_dl?&dl_stats:&ul_stats;
+    printf("    \"harq\": {\"tx\": %u, \"retx\": %u, \"failed\": %u}\n", s->nof_tx, s->nof_retx, s->nof_failed);
+  }
+
+  /* PHY interface for MAC */
+  void configure_prach_params() {}
+  void sync_start() {}
+  void sync_stop() {}
+  void prach_send(uint32_t preamble_idx, int allowed_subframe, float target_power_dbm) {}
+  int  prach_tx_tti() {
+    return -1;
+  }
+  void sr_send() {
+    sr_req = true;
+  }
+  int  sr_last_tx_tti() {
+    return sr_tti;
+  }
+  void set_timeadv_rar(uint32_t ta_cmd) {}
+  void set_timeadv(uint32_t ta_cmd) {}
+  void set_rar_grant(uint32_t tti, uint8_t grant_payload[SRSLTE_RAR_GRANT_LEN]) {}
+  void pdcch_ul_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start = -1, int tti_end = -1) {}
+  void pdcch_dl_search(srslte_rnti_type_t rnti_type, uint16_t rnti, int tti_start = -1, int tti_end = -1) {}
+  void pdcch_ul_search_reset() {}
+  void pdcch_dl_search_reset() {}
+  void set_sps_rnti(uint16_t rnti) {}
+  void set_crnti(uint16_t rnti) {}
+  uint32_t get_current_tti() {
+    return tti;
+  }
+  float get_phr() {
+    return 0;
+  }
+  float get_pathloss_db() {
+    return 0;
+  }
+
+private:
+
+  typedef struct {
+    bool     active;      // TB waiting for its ACK or a retransmission
+    bool     ack;
+    bool     ndi;
+    uint32_t nof_tx;
+    uint32_t tx_tti;
+    uint8_t *pdu;
+    uint8_t *buffer;
+  } dl_proc_t;
+
+  typedef struct {
+    bool     rx_pending;  // Transmitted at tx_tti, decoded by the eNB in that TTI
+    bool     phich_pending;
+    bool     ack;
+    bool     ndi;
+    uint32_t tx_tti;
+    uint32_t len;
+    uint8_t *buffer;
+  } ul_proc_t;
+
+  typedef struct {
+    uint32_t nof_tx;
+    uint32_t nof_retx;
+    uint32_t nof_failed;
+  } harq_stats_t;
+
+  static const int rv_of_tx[4];
+
+  bool tb_error(float bler) {
+    return (float) rand_r(&seed)/RAND_MAX < bler;
+  }
+
+  void run_thread()
+  {
+    uint64_t tti_start = now_us();
+    start_us = tti_start;
+    while (running && nof_ttis < args->duration_ms) {
+      tti = (tti+1)%10240;
+      nof_ttis++;
+
+      // SR requested by the MAC is transmitted in the next TTI
+      if (sr_req) {
+        sr_req = false;
+        sr_tti = tti;
+        enb->sr_received();
+      }
+
+      mac->tti_clock(tti);
+      enb->tti_clock();
+      ue_traffic->tti_tx();
+
+      if (args->ul_grant_bytes > 0) {
+        run_ul();
+      }
+      if (args->dl_grant_bytes > 0) {
+        run_dl();
+      }
+
+      if (args->tti_period_us > 0) {
+        tti_start += args->tti_period_us;
+        uint64_t now = now_us();
+        if (tti_start > now) {
+          usleep(tti_start - now);
+        }
+      }
+    }
+    end_us   = now_us();
+    finished = true;
+  }
+
+  /* DL HARQ is asynchronous: a process is reused once its RTT has elapsed, retransmissions first */
+  void run_dl()
+  {
+    dl_proc_t *p   = NULL;
+    uint32_t   pid = 0;
+    for (uint32_t i=0;i<NOF_HARQ_PROC && !p;i++) {
+      if (dl_proc[i].active && !dl_proc[i].ack && srslte_tti_interval(tti, dl_proc[i].tx_tti) >= args->harq_rtt) {
+        if (dl_proc[i].nof_tx < max_harq_tx) {
+          p   = &dl_proc[i];
+          pid = i;
+          dl_stats.nof_retx++;
+        } else {
+          dl_proc[i].active = false;
+          dl_stats.nof_failed++;
+        }
+      }
+    }
+    for (uint32_t i=0;i<NOF_HARQ_PROC && !p;i++) {
+      if (!dl_proc[i].active || (dl_proc[i].ack && srslte_tti_interval(tti, dl_proc[i].tx_tti) >= args->harq_rtt)) {
+        dl_proc[i].active = false;
+        dl_proc[i].pdu    = enb->build_dl_pdu(dl_proc[i].buffer, args->dl_grant_bytes);
+        if (dl_proc[i].pdu) {
+          p         = &dl_proc[i];
+          pid       = i;
+          p->active = true;
+          p->ack    = false;
+          p->ndi    = !p->ndi;
+          p->nof_tx = 0;
+        }
+        break;
+      }
+    }
+    if (!p) {
+      return;
+    }
+
+    mac_interface_phy::mac_grant_t    grant;
+    mac_interface_phy::tb_action_dl_t action;
+    bzero(&grant,  sizeof(mac_interface_phy::mac_grant_t));
+    bzero(&action, sizeof(mac_interface_phy::tb_action_dl_t));
+    grant.pid       = pid;
+    grant.tti       = tti;
+    grant.ndi       = p->ndi;
+    grant.n_bytes   = args->dl_grant_bytes;
+    grant.rv        = rv_of_tx[p->nof_tx%4];
+    grant.rnti      = RNTI;
+    grant.rnti_type = SRSLTE_RNTI_USER;
+    mac->new_grant_dl(grant, &action);
+
+    p->tx_tti = tti;
+    p->nof_tx++;
+    dl_stats.nof_tx++;
+
+    bool ack = action.default_ack;
+    if (action.decode_enabled) {
+      ack = !tb_error(args->dl_bler);
+      if (ack) {
+        memcpy(action.payload_ptr, p->pdu, args->dl_grant_bytes);
+      }
+      mac->tb_decoded(ack, SRSLTE_RNTI_USER, pid);
+    }
+    // No ACK is a DTX for the eNB
+    p->ack = action.generate_ack && ack;
+  }
+
+  /* UL HARQ is synchronous: the PDU granted in TTI n is sent in n+4 and acknowledged in n+8 */
+  void run_ul()
+  {
+    // Decode the transmission of this TTI
+    ul_proc_t *rx = &ul_proc[tti%NOF_HARQ_PROC];
+    if (rx->rx_pending && rx->tx_tti == tti) {
+      rx->rx_pending    = false;
+      rx->phich_pending = true;
+      rx->ack           = !tb_error(args->ul_bler);
+      if (rx->ack) {
+        enb->process_ul_pdu(rx->buffer, rx->len);
+      }
+    }
+
+    // PHICH for the transmission 4 TTI ago and grant for the one in 4 TTI use the same process
+    uint32_t   pid   = (tti+4)%NOF_HARQ_PROC;
+    ul_proc_t *p     = &ul_proc[pid];
+    bool       phich = p->phich_pending;
+    p->phich_pending = false;
+
+    mac_interface_phy::mac_grant_t   grant;
+    mac_interface_phy::tb_action_ul_t action;
+    bzero(&grant,  sizeof(mac_interface_phy::mac_grant_t));
+    bzero(&action, sizeof(mac_interface_phy::tb_action_ul_t));
+
+    if (phich && !p->ack) {
+      // Non-adaptive retransmission
+      mac->harq_recv(tti, false, &action);
+      ul_stats.nof_retx++;
+    } else if (enb->need_ul_grant()) {
+      p->ndi          = !p->ndi;
+      p->len          = args->ul_grant_bytes;
+      grant.pid       = pid;
+      grant.tti       = tti;
+      grant.ndi       = p->ndi;
+      grant.n_bytes   = args->ul_grant_bytes;
+      grant.rnti      = RNTI;
+      grant.rnti_type = SRSLTE_RNTI_USER;
+      if (phich) {
+        mac->new_grant_ul_ack(grant, true, &action);
+      } else {
+        mac->new_grant_ul(grant, &action);
+      }
+    } else if (phich) {
+      mac->harq_recv(tti, true, &action);
+    }
+
+    if (action.tx_enabled) {
+      memcpy(p->buffer, action.payload_ptr, p->len);
+      p->rx_pending = true;
+      p->tx_tti     = (tti+4)%10240;
+      ul_stats.nof_tx++;
+    } else if (phich && !p->ack) {
+      // The UE reached maxHARQ-Tx
+      ul_stats.nof_failed++;
+    }
+  }
+
+  prog_args_t       *args;
+  mac_interface_phy *mac;
+  traffic_endpoint  *ue_traffic;
+  enb_peer          *enb;
+  srslte::log       *log_h;
+  uint32_t           max_harq_tx;
+  unsigned int       seed;
+
+  bool               running;
+  volatile bool      finished;
+  volatile uint32_t  tti;
+  uint32_t           nof_ttis;
+  uint64_t           start_us;
+  uint64_t           end_us;
+  volatile bool      sr_req;
+  volatile int       sr_tti;
+
+  dl_proc_t          dl_proc[NOF_HARQ_PROC];
+  ul_proc_t          ul_proc[NOF_HARQ_PROC];
+  harq_stats_t       dl_stats;
+  harq_stats_t       ul_stats;
+};
+
+const int emulated_phy::rv_of_tx[4] = {0, 2, 3, 1};
+
+
+// Create classes
+srslte::logger     logger;
+srslte::log_filter log_phy;
+srslte::log_filter log_mac;
+srslte::log_filter log_rlc;
+srslte::log_filter log_enb;
+srsue::mac         my_mac;
+srsue::rlc         my_rlc;
+srsue::pdcp        my_pdcp;
+rrc_dummy          my_rrc;
+traffic_endpoint   ue_traffic;
+enb_peer           enb;
+emulated_phy       my_phy;
+
+float cpu_secs()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (float) (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec)/1e6;
+}
+
+int main(int argc, char *argv[])
+{
+  parse_args(&prog_args, argc, argv);
+
+  logger.init("/tmp/l2_loopback_bench.log");
+  log_phy.init("PHY ", &logger, true);
+  log_mac.init("MAC ", &logger, true);
+  log_rlc.init("RLC ", &logger);
+  log_enb.init("ENB ", &logger);
+
+  srslte::LOG_LEVEL_ENUM level = srslte::LOG_LEVEL_ERROR;
+  if (prog_args.verbose == 1) {
+    level = srslte::LOG_LEVEL_INFO;
+  } else if (prog_args.verbose > 1) {
+    level = srslte::LOG_LEVEL_DEBUG;
+  }
+  log_phy.set_level(level);
+  log_mac.set_level(level);
+  log_rlc.set_level(level);
+  log_enb.set_level(level);
+
+  // Same bearer configuration in both peers
+  LIBLTE_RRC_RLC_CONFIG_STRUCT rlc_cnfg;
+  bzero(&rlc_cnfg, sizeof(LIBLTE_RRC_RLC_CONFIG_STRUCT));
+  if (prog_args.rlc_um) {
+    rlc_cnfg.rlc_mode                      = LIBLTE_RRC_RLC_MODE_UM_BI;
+    rlc_cnfg.ul_um_bi_rlc.sn_field_len     = LIBLTE_RRC_SN_FIELD_LENGTH_SIZE10;
+    rlc_cnfg.dl_um_bi_rlc.sn_field_len     = LIBLTE_RRC_SN_FIELD_LENGTH_SIZE10;
+    rlc_cnfg.dl_um_bi_rlc.t_reordering     = LIBLTE_RRC_T_REORDERING_MS35;
+  } else {
+    rlc_cnfg.rlc_mode                      = LIBLTE_RRC_RLC_MODE_AM;
+    rlc_cnfg.ul_am_rlc.t_poll_retx         = LIBLTE_RRC_T_POLL_RETRANSMIT_MS45;
+    rlc_cnfg.ul_am_rlc.poll_pdu            = LIBLTE_RRC_POLL_PDU_P32;
+    rlc_cnfg.ul_am_rlc.poll_byte           = LIBLTE_RRC_POLL_BYTE_KB25;
+    rlc_cnfg.ul_am_rlc.max_retx_thresh     = LIBLTE_RRC_MAX_RETX_THRESHOLD_T32;
+    rlc_cnfg.dl_am_rlc.t_reordering        = LIBLTE_RRC_T_REORDERING_MS35;
+    rlc_cnfg.dl_am_rlc.t_status_prohibit   = LIBLTE_RRC_T_STATUS_PROHIBIT_MS10;
+  }
+
+  // UE stack. The MAC waits for the emulated PHY to start the TTIs
+  my_rlc.init(&my_pdcp, &my_rrc, &my_rrc, &log_rlc, &my_mac, &my_mac);
+  my_pdcp.init(&my_rlc, &my_rrc, &ue_traffic, &log_rlc);
+  my_mac.init(&my_phy, &my_rlc, &my_rrc, &log_mac);
+
+  LIBLTE_RRC_MAC_MAIN_CONFIG_STRUCT mac_cfg;
+  bzero(&mac_cfg, sizeof(LIBLTE_RRC_MAC_MAIN_CONFIG_STRUCT));
+  mac_cfg.ulsch_cnfg.max_harq_tx        = LIBLTE_RRC_MAX_HARQ_TX_N5;
+  mac_cfg.ulsch_cnfg.periodic_bsr_timer = LIBLTE_RRC_PERIODIC_BSR_TIMER_SF5;
+  mac_cfg.ulsch_cnfg.retx_bsr_timer     = LIBLTE_RRC_RETRANSMISSION_BSR_TIMER_SF320;
+  mac_cfg.ulsch_cnfg.tti_bundling       = false;
+  mac_cfg.drx_cnfg.setup_present        = false;
+  mac_cfg.phr_cnfg.setup_present        = false;
+  mac_cfg.time_alignment_timer          = LIBLTE_RRC_TIME_ALIGNMENT_TIMER_INFINITY;
+  my_mac.set_config_main(&mac_cfg);
+
+  // SR on PUCCH, so that UL data never triggers random access
+  LIBLTE_RRC_SCHEDULING_REQUEST_CONFIG_STRUCT sr_cfg;
+  bzero(&sr_cfg, sizeof(LIBLTE_RRC_SCHEDULING_REQUEST_CONFIG_STRUCT));
+  sr_cfg.setup_present = true;
+  sr_cfg.dsr_trans_max = LIBLTE_RRC_DSR_TRANS_MAX_N64;
+  my_mac.set_config_sr(&sr_cfg);
+
+  my_pdcp.add_bearer(LCID);
+  my_rlc.add_bearer(LCID, &rlc_cnfg);
+  my_mac.setup_lcid(LCID, 0, 1, -1, -1);
+  ue_traffic.init(&my_pdcp, &my_rlc, prog_args.sdu_len, prog_args.ul_rate_mbps);
+
+  enb.init(&rlc_cnfg, prog_args.sdu_len, prog_args.dl_rate_mbps, &log_enb);
+
+  float cpu_start = cpu_secs();
+  my_phy.init(&prog_args, &my_mac, &ue_traffic, &enb,
+              liblte_rrc_max_harq_tx_num[mac_cfg.ulsch_cnfg.max_harq_tx], &log_phy);
+  while (!my_phy.is_finished()) {
+    usleep(100000);
+  }
+  my_phy.stop();
+  float cpu_used = cpu_secs() - cpu_start;
+
+  my_mac.stop();
+  my_rlc.stop();
+  enb.stop();
+
+  float    wall_secs = my_phy.get_wall_secs();
+  uint32_t nof_ttis  = my_phy.get_nof_ttis();
+  float    mbits     = (ue_traffic.get_rx_bytes() + enb.traffic.get_rx_bytes())*8/1e6;
+
+  printf("{\n");
+  printf("  \"config\": {\"ttis\": %u, \"dl_tb_bytes\": %u, \"ul_tb_bytes\": %u, \"dl_bler\": %.3f, \"ul_bler\": %.3f, "
+         "\"dl_harq_rtt\": %u, \"tti_period_us\": %u, \"sdu_bytes\": %u, \"rlc_mode\": \"%s\"},\n",
+         nof_ttis, prog_args.dl_grant_bytes, prog_args.ul_grant_bytes, prog_args.dl_bler, prog_args.ul_bler,
+         prog_args.harq_rtt, prog_args.tti_period_us, prog_args.sdu_len, prog_args.rlc_um?"um":"am");
+  printf("  \"dl\": {\n");
+  ue_traffic.print_rx_json(&enb.traffic, nof_ttis, wall_secs);
+  my_phy.print_harq_json(true);
+  printf("  },\n");
+  printf("  \"ul\": {\n");
+  enb.traffic.print_rx_json(&ue_traffic, nof_ttis, wall_secs);
+  my_phy.print_harq_json(false);
+  printf("  },\n");
+  printf("  \"wall_secs\": %.3f,\n", wall_secs);
+  printf("  \"cpu_secs\": %.3f,\n",  cpu_used);
+  printf("  \"cpu_us_per_mbit\": %.3f,\n", mbits>0?cpu_used*1e6/mbits:0);
+  printf("  \"rlc_max_retx\": %u\n", my_rrc.nof_max_retx + enb.rrc.nof_max_retx);
+  printf("}\n");
+
+  exit(0);
+}
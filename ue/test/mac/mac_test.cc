@@ -300,6 +300,13 @@ public:
     return 0; 
   }
   
+  void write_pdus(uint32_t lcid, pdu_iov_t *pdus, uint32_t nof_pdus) 
+  {
+    for (uint32_t i=0;i<nof_pdus;i++) {
+      write_pdu(lcid, pdus[i].payload, pdus[i].nof_bytes);
+    }
+  }
+  
   int read_pdu(uint32_t lcid, uint8_t *payload, uint32_t nof_bytes) 
   {
     if (lcid == 0) {
@@ -0,0 +1,139 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include "mac/dl_sps.h"
+#include "mac/ul_sps.h"
+
+using namespace srsue;
+
+#define INTERVAL 10
+
+/* Configured assignments recur every interval from the activation TTI, also across the SFN wrap, 
+ * with the HARQ process of Section 5.10.1 */
+void dl_sps_test()
+{
+  LIBLTE_RRC_SPS_CONFIG_DL_STRUCT cfg;
+  bzero(&cfg, sizeof(cfg));
+  cfg.setup_present   = true;
+  cfg.sps_interval_dl = LIBLTE_RRC_SPS_INTERVAL_DL_SF10;
+  cfg.N_sps_processes = 2;
+
+  mac_interface_phy::mac_grant_t grant;
+  bzero(&grant, sizeof(grant));
+  grant.n_bytes = 100;
+  grant.pid     = 0;
+  grant.sps_n_pucch_idx = 2;
+
+  dl_sps sps;
+  sps.set_config(&cfg);
+  assert(sps.is_enabled());
+
+  uint32_t start_tti = 10240 - 25;
+  sps.reset(start_tti, &grant);
+
+  uint32_t nof_grants = 0;
+  for (uint32_t i=0;i<100;i++) {
+    uint32_t tti = (start_tti+i)%10240;
+    mac_interface_phy::mac_grant_t pending;
+    bool ret = sps.get_pending_grant(tti, &pending);
+    assert(ret == (i%INTERVAL == 0));
+    if (ret) {
+      assert(tti == pending.tti);
+      assert(pending.is_sps_configured);
+      assert(100 == pending.n_bytes);
+      assert(2 == pending.sps_n_pucch_idx);
+      assert(((tti/INTERVAL)%2) == pending.pid);
+      assert(sps.get_harq_pid(tti) == pending.pid);
+      nof_grants++;
+    }
+  }
+  assert(10 == nof_grants);
+
+  // Released by PDCCH 
+  sps.clear();
+  mac_interface_phy::mac_grant_t pending;
+  assert(!sps.get_pending_grant(start_tti, &pending));
+
+  // Disabled by RRC 
+  sps.reset(start_tti, &grant);
+  sps.set_config(NULL);
+  assert(!sps.is_enabled());
+  assert(!sps.get_pending_grant(start_tti, &pending));
+}
+
+/* Configured grants recur every interval until implicitReleaseAfter consecutive PDUs without SDUs */
+void ul_sps_test()
+{
+  LIBLTE_RRC_SPS_CONFIG_UL_STRUCT cfg;
+  bzero(&cfg, sizeof(cfg));
+  cfg.setup_present          = true;
+  cfg.sps_interval_ul        = LIBLTE_RRC_SPS_INTERVAL_UL_SF10;
+  cfg.implicit_release_after = LIBLTE_RRC_IMPLICIT_RELEASE_AFTER_E2;
+
+  mac_interface_phy::mac_grant_t grant;
+  bzero(&grant, sizeof(grant));
+  grant.n_bytes = 50;
+
+  ul_sps sps;
+  sps.set_config(&cfg);
+  assert(sps.is_enabled());
+
+  uint32_t start_tti = 1000;
+  sps.reset(start_tti, &grant);
+
+  mac_interface_phy::mac_grant_t pending;
+  for (uint32_t i=0;i<3*INTERVAL;i++) {
+    assert(sps.get_pending_grant(start_tti+i, &pending) == (i%INTERVAL == 0));
+  }
+  assert(start_tti+2*INTERVAL == pending.tti);
+  assert(pending.is_sps_configured);
+
+  // A PDU with SDUs restarts the count of empty PDUs 
+  assert(!sps.new_pdu(0));
+  assert(!sps.new_pdu(1));
+  assert(!sps.new_pdu(0));
+  assert(sps.get_pending_grant(start_tti+3*INTERVAL, &pending));
+
+  // Second consecutive empty PDU releases the grant 
+  assert(sps.new_pdu(0));
+  assert(!sps.get_pending_grant(start_tti+4*INTERVAL, &pending));
+  assert(!sps.new_pdu(0));
+
+  // A new activation configures it again 
+  sps.reset(start_tti+5*INTERVAL, &grant);
+  assert(sps.get_pending_grant(start_tti+6*INTERVAL, &pending));
+}
+
+int main(int argc, char **argv) {
+  dl_sps_test();
+  ul_sps_test();
+  printf("Passed\n");
+  exit(0);
+}
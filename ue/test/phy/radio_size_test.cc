@@ -0,0 +1,47 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "radio/radio.h"
+
+/* Memory regression test: the radio object used to embed a 245 MB buffer of zeros */
+
+#define MAX_RADIO_SIZE (1024*1024)
+
+int main(int argc, char **argv) {
+  printf("sizeof(srslte::radio)=%lu bytes\n", (unsigned long) sizeof(srslte::radio));
+  if (sizeof(srslte::radio) > MAX_RADIO_SIZE) {
+    printf("Radio object exceeds %d bytes\n", MAX_RADIO_SIZE);
+    exit(-1);
+  }
+  
+  srslte::radio *r = new srslte::radio();
+  delete r;
+  
+  printf("Ok\n");
+  exit(0);
+}
@@ -211,8 +211,14 @@ public:
   bool rar_rnti_set;
 
   void pch_decoded_ok(uint32_t len) {} 
+  bool get_sps_grant_dl(uint32_t tti, mac_grant_t *grant) { return false; }
+  bool get_sps_grant_ul(uint32_t tti, mac_grant_t *grant) { return false; }
 
   
+  void wait_tti_processed() {
+    
+  }
+  
   void tti_clock(uint32_t tti) {
     if (!rar_rnti_set) {
       int prach_tti = my_phy.prach_tx_tti();
@@ -311,6 +317,8 @@ public:
     }
   }
 
+  void set_cell(srslte_cell_t cell) {}
+  
   void bch_decoded_ok(uint8_t *payload, uint32_t len) {
     printf("BCH decoded\n");
     bch_decoded = true; 
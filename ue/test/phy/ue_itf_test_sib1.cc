@@ -131,7 +131,11 @@ public:
   }
   
   void pch_decoded_ok(uint32_t len) {}
+  bool get_sps_grant_dl(uint32_t tti, mac_grant_t *grant) { return false; }
+  bool get_sps_grant_ul(uint32_t tti, mac_grant_t *grant) { return false; }
 
+  void set_cell(srslte_cell_t cell) {}
+  
   void bch_decoded_ok(uint8_t *payload, uint32_t len) {
     printf("BCH decoded\n");
     bch_decoded = true; 
@@ -141,6 +145,9 @@ public:
   }
   void tti_clock(uint32_t tti) {
     
+  }
+  void wait_tti_processed() {
+    
   }
 };
 
@@ -201,6 +201,7 @@ public:
 
   void release_pucch_srs() {}
   void ra_problem() {}
+  void si_acquired(uint32_t si_id, bool success) {}
   void write_pdu_bcch_bch(srslte::byte_buffer_t *pdu) {}
   void write_pdu_bcch_dlsch(srslte::byte_buffer_t *pdu) 
   {
@@ -539,7 +540,7 @@ int main(int argc, char *argv[])
     
   my_phy.init(&my_radio, &my_mac, &my_tester, &log_phy, NULL);
   my_mac.init(&my_phy, &rlc, &my_tester, &log_mac);
-  rlc.init(&my_tester, &my_tester, &my_tester, &log_rlc, &my_mac);  
+  rlc.init(&my_tester, &my_tester, &my_tester, &log_rlc, &my_mac, &my_mac);  
   my_tester.init(&my_phy, &my_mac, &rlc, &log_tester, prog_args.ip_address);
 
   
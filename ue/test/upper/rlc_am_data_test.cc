@@ -63,7 +63,7 @@ int main(int argc, char **argv) {
 
   b1.reset();
   b2.reset();
-  memset(&h, 0, sizeof(rlc_amd_pdu_header_t));
+  h = rlc_amd_pdu_header_t();
 
   memcpy(b1.msg, &pdu2[0], PDU2_LEN);
   b1.N_bytes = PDU2_LEN;
@@ -85,7 +85,7 @@ int main(int argc, char **argv) {
 
   b1.reset();
   b2.reset();
-  memset(&h, 0, sizeof(rlc_amd_pdu_header_t));
+  h = rlc_amd_pdu_header_t();
 
   memcpy(b1.msg, &pdu3[0], PDU3_LEN);
   b1.N_bytes = PDU3_LEN;
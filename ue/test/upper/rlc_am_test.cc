@@ -71,6 +71,44 @@ public:
   int n_sdus;
 };
 
+// Writes bytes [so_start, so_end) of the PDU with SN sn, holding data with SDU boundaries at the
+// offsets in bounds, as a PDU segment into buf
+void write_segment(byte_buffer_t *buf, uint32_t sn, uint8_t *data, uint32_t pdu_len,
+                   uint32_t *bounds, uint32_t nof_bounds, uint32_t so_start, uint32_t so_end)
+{
+  rlc_amd_pdu_header_t h;
+  h.dc  = RLC_DC_FIELD_DATA_PDU;
+  h.rf  = 1;
+  h.p   = 0;
+  h.sn  = sn;
+  h.so  = so_start;
+  h.lsf = (so_end == pdu_len);
+
+  bool start_aligned = (so_start == 0);
+  bool end_aligned   = (so_end == pdu_len);
+  uint32_t lower = so_start;
+  for(uint32_t i=0;i<nof_bounds;i++) {
+    if(bounds[i] == so_start)
+      start_aligned = true;
+    if(bounds[i] == so_end)
+      end_aligned = true;
+    if(bounds[i] > so_start && bounds[i] < so_end) {
+      h.add_li(bounds[i] - lower);
+      lower = bounds[i];
+    }
+  }
+  h.fi = RLC_FI_FIELD_START_AND_END_ALIGNED;
+  if(!start_aligned)
+    h.fi |= RLC_FI_FIELD_NOT_START_ALIGNED;
+  if(!end_aligned)
+    h.fi |= RLC_FI_FIELD_NOT_END_ALIGNED;
+
+  uint8_t *ptr = buf->msg;
+  rlc_am_write_data_pdu_header(&h, &ptr);
+  memcpy(ptr, &data[so_start], so_end - so_start);
+  buf->N_bytes = (ptr - buf->msg) + so_end - so_start;
+}
+
 void basic_test()
 {
   srslte::log_stdout log1("RLC_AM_1");
@@ -150,6 +188,70 @@ void basic_test()
   }
 }
 
+void burst_test()
+{
+  srslte::log_stdout log1("RLC_AM_1");
+  srslte::log_stdout log2("RLC_AM_2");
+  log1.set_level(srslte::LOG_LEVEL_DEBUG);
+  log2.set_level(srslte::LOG_LEVEL_DEBUG);
+  log1.set_hex_limit(-1);
+  log2.set_hex_limit(-1);
+  rlc_am_tester     tester;
+  mac_dummy_timers  timers;
+
+  rlc_am rlc1;
+  rlc_am rlc2;
+
+  rlc1.init(&log1, 1, &tester, &tester, &timers);
+  rlc2.init(&log2, 1, &tester, &tester, &timers);
+
+  LIBLTE_RRC_RLC_CONFIG_STRUCT cnfg;
+  cnfg.rlc_mode = LIBLTE_RRC_RLC_MODE_AM;
+  cnfg.dl_am_rlc.t_reordering = LIBLTE_RRC_T_REORDERING_MS5;
+  cnfg.dl_am_rlc.t_status_prohibit = LIBLTE_RRC_T_STATUS_PROHIBIT_MS5;
+  cnfg.ul_am_rlc.max_retx_thresh = LIBLTE_RRC_MAX_RETX_THRESHOLD_T4;
+  cnfg.ul_am_rlc.poll_byte = LIBLTE_RRC_POLL_BYTE_KB25;
+  cnfg.ul_am_rlc.poll_pdu = LIBLTE_RRC_POLL_PDU_P4;
+
+  rlc1.configure(&cnfg);
+  rlc2.configure(&cnfg);
+
+  // Push 5 SDUs into RLC1
+  byte_buffer_t sdu_bufs[NBUFS];
+  for(int i=0;i<NBUFS;i++)
+  {
+    *sdu_bufs[i].msg    = i; // Write the index into the buffer
+    sdu_bufs[i].N_bytes = 1; // Give each buffer a size of 1 byte
+    rlc1.write_sdu(&sdu_bufs[i]);
+  }
+
+  // Read 5 PDUs from RLC1 (1 byte each)
+  byte_buffer_t pdu_bufs[NBUFS];
+  rlc_interface_mac::pdu_iov_t iov[NBUFS];
+  for(int i=0;i<NBUFS;i++)
+  {
+    iov[i].payload   = pdu_bufs[i].msg;
+    iov[i].nof_bytes = rlc1.read_pdu(pdu_bufs[i].msg, 3); // 3 bytes for header + payload
+    assert(3 == iov[i].nof_bytes);
+  }
+  assert(0 == rlc1.get_buffer_state());
+
+  // Write the 5 PDUs into RLC2 in reverse order, as a single burst
+  rlc_interface_mac::pdu_iov_t rev_iov[NBUFS];
+  for(int i=0;i<NBUFS;i++)
+  {
+    rev_iov[i] = iov[NBUFS-1-i];
+  }
+  rlc2.write_pdus(rev_iov, NBUFS);
+
+  assert(NBUFS == tester.n_sdus);
+  for(int i=0; i<tester.n_sdus; i++)
+  {
+    assert(tester.sdus[i]->N_bytes == 1);
+    assert(*(tester.sdus[i]->msg)  == i);
+  }
+}
+
 void concat_test()
 {
   srslte::log_stdout log1("RLC_AM_1");
@@ -1032,9 +1134,556 @@ void resegment_test_6()
   }
 }
 
+void segment_li_test()
+{
+  // SDUs:                |  30  |   40   |    50    |
+  // PDU segments:        |    50    |       70      |
+
+  srslte::log_stdout log1("RLC_AM_1");
+  log1.set_level(srslte::LOG_LEVEL_DEBUG);
+  log1.set_hex_limit(-1);
+  rlc_am_tester     tester;
+  mac_dummy_timers  timers;
+
+  rlc_am rlc1;
+  rlc1.init(&log1, 1, &tester, &tester, &timers);
+
+  LIBLTE_RRC_RLC_CONFIG_STRUCT cnfg;
+  bzero(&cnfg, sizeof(LIBLTE_RRC_RLC_CONFIG_STRUCT));
+  cnfg.rlc_mode = LIBLTE_RRC_RLC_MODE_AM;
+  cnfg.dl_am_rlc.t_reordering = LIBLTE_RRC_T_REORDERING_MS5;
+  cnfg.dl_am_rlc.t_status_prohibit = LIBLTE_RRC_T_STATUS_PROHIBIT_MS5;
+  rlc1.configure(&cnfg);
+
+  uint8_t  data[120];
+  uint32_t bounds[2] = {30, 70};
+  for(int i=0;i<120;i++)
+    data[i] = i;
+
+  // The first segment ends inside the second SDU, past its only LI
+  byte_buffer_t seg;
+  write_segment(&seg, 0, data, 120, bounds, 2, 0, 50);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  assert(tester.n_sdus == 0);
+
+  write_segment(&seg, 0, data, 120, bounds, 2, 50, 120);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+
+  assert(tester.n_sdus == 3);
+  uint32_t lower = 0;
+  for(int i=0;i<3;i++)
+  {
+    uint32_t upper = (i < 2) ? bounds[i] : 120;
+    assert(tester.sdus[i]->N_bytes == upper - lower);
+    assert(memcmp(tester.sdus[i]->msg, &data[lower], upper - lower) == 0);
+    lower = upper;
+  }
+}
+
+void segment_reorder_test()
+{
+  // SDUs:                |  30  |   40   |    50    |
+  // PDU segments:                         |    60    | (first)
+  //                          |     60     |            (twice, overlapping)
+  //                      |  30  |                      (last)
+
+  srslte::log_stdout log1("RLC_AM_1");
+  log1.set_level(srslte::LOG_LEVEL_DEBUG);
+  log1.set_hex_limit(-1);
+  rlc_am_tester     tester;
+  mac_dummy_timers  timers;
+
+  rlc_am rlc1;
+  rlc1.init(&log1, 1, &tester, &tester, &timers);
+
+  LIBLTE_RRC_RLC_CONFIG_STRUCT cnfg;
+  bzero(&cnfg, sizeof(LIBLTE_RRC_RLC_CONFIG_STRUCT));
+  cnfg.rlc_mode = LIBLTE_RRC_RLC_MODE_AM;
+  cnfg.dl_am_rlc.t_reordering = LIBLTE_RRC_T_REORDERING_MS5;
+  cnfg.dl_am_rlc.t_status_prohibit = LIBLTE_RRC_T_STATUS_PROHIBIT_MS5;
+  rlc1.configure(&cnfg);
+
+  uint8_t  data[120];
+  uint32_t bounds[2] = {30, 70};
+  for(int i=0;i<120;i++)
+    data[i] = i;
+
+  byte_buffer_t seg;
+  write_segment(&seg, 0, data, 120, bounds, 2, 60, 120);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  write_segment(&seg, 0, data, 120, bounds, 2, 20, 80);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  assert(tester.n_sdus == 0);
+
+  write_segment(&seg, 0, data, 120, bounds, 2, 0, 30);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  assert(tester.n_sdus == 3);
+
+  // A duplicate of a segment of the reassembled PDU is dropped
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  assert(tester.n_sdus == 3);
+
+  uint32_t lower = 0;
+  for(int i=0;i<3;i++)
+  {
+    uint32_t upper = (i < 2) ? bounds[i] : 120;
+    assert(tester.sdus[i]->N_bytes == upper - lower);
+    assert(memcmp(tester.sdus[i]->msg, &data[lower], upper - lower) == 0);
+    lower = upper;
+  }
+}
+
+void segment_intervals_test()
+{
+  // One SDU of 100 bytes, received in 1 byte segments at even SOs. The segment that would
+  // open more than RLC_AM_MAX_RX_INTERVALS SO ranges is dropped until the gaps are filled
+
+  srslte::log_stdout log1("RLC_AM_1");
+  log1.set_level(srslte::LOG_LEVEL_DEBUG);
+  log1.set_hex_limit(-1);
+  rlc_am_tester     tester;
+  mac_dummy_timers  timers;
+
+  rlc_am rlc1;
+  rlc1.init(&log1, 1, &tester, &tester, &timers);
+
+  LIBLTE_RRC_RLC_CONFIG_STRUCT cnfg;
+  bzero(&cnfg, sizeof(LIBLTE_RRC_RLC_CONFIG_STRUCT));
+  cnfg.rlc_mode = LIBLTE_RRC_RLC_MODE_AM;
+  cnfg.dl_am_rlc.t_reordering = LIBLTE_RRC_T_REORDERING_MS5;
+  cnfg.dl_am_rlc.t_status_prohibit = LIBLTE_RRC_T_STATUS_PROHIBIT_MS5;
+  rlc1.configure(&cnfg);
+
+  uint8_t data[100];
+  for(int i=0;i<100;i++)
+    data[i] = i;
+
+  byte_buffer_t seg;
+  uint32_t last = 2*RLC_AM_MAX_RX_INTERVALS;
+  for(uint32_t so=0;so<=last;so+=2)
+  {
+    write_segment(&seg, 0, data, 100, NULL, 0, so, so+1);
+    rlc1.write_pdu(seg.msg, seg.N_bytes);
+  }
+  for(uint32_t so=1;so<last;so+=2)
+  {
+    write_segment(&seg, 0, data, 100, NULL, 0, so, so+1);
+    rlc1.write_pdu(seg.msg, seg.N_bytes);
+  }
+  write_segment(&seg, 0, data, 100, NULL, 0, last+1, 100);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  assert(tester.n_sdus == 0);
+
+  write_segment(&seg, 0, data, 100, NULL, 0, last, last+1);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+
+  assert(tester.n_sdus == 1);
+  assert(tester.sdus[0]->N_bytes == 100);
+  assert(memcmp(tester.sdus[0]->msg, data, 100) == 0);
+}
+
+void window_stall_test()
+{
+  srslte::log_stdout log1("RLC_AM_1");
+  log1.set_level(srslte::LOG_LEVEL_ERROR);
+  rlc_am_tester     tester;
+  mac_dummy_timers  timers;
+
+  rlc_am rlc1;
+  rlc1.init(&log1, 1, &tester, &tester, &timers);
+
+  LIBLTE_RRC_RLC_CONFIG_STRUCT cnfg;
+  bzero(&cnfg, sizeof(LIBLTE_RRC_RLC_CONFIG_STRUCT));
+  cnfg.rlc_mode = LIBLTE_RRC_RLC_MODE_AM;
+  cnfg.ul_am_rlc.t_poll_retx = LIBLTE_RRC_T_POLL_RETRANSMIT_MS500;
+  cnfg.ul_am_rlc.max_retx_thresh = LIBLTE_RRC_MAX_RETX_THRESHOLD_T4;
+  cnfg.ul_am_rlc.poll_byte = LIBLTE_RRC_POLL_BYTE_KB25;
+  cnfg.ul_am_rlc.poll_pdu = LIBLTE_RRC_POLL_PDU_P4;
+  rlc1.configure(&cnfg);
+
+  // Fill the tx window with 1 byte PDUs. No new PDUs once vt_s reaches vt_a + 512, the last one polls
+  int nof_sdus = RLC_AM_WINDOW_SIZE + 10;
+  byte_buffer_t pdu;
+  rlc_amd_pdu_header_t h;
+  for(int i=0;i<nof_sdus;i++)
+  {
+    byte_buffer_t *sdu = buffer_pool::get_instance()->allocate();
+    *sdu->msg    = i;
+    sdu->N_bytes = 1;
+    rlc1.write_sdu(sdu);
+    if(i < RLC_AM_WINDOW_SIZE) {
+      rlc1.get_buffer_state();
+      pdu.N_bytes = rlc1.read_pdu(pdu.msg, 3);
+      assert(pdu.N_bytes == 3);
+    }
+  }
+  rlc_am_read_data_pdu_header(&pdu, &h);
+  assert(h.sn == RLC_AM_WINDOW_SIZE-1);
+  assert(h.p == 1);
+  rlc1.get_buffer_state();
+  assert(0 == rlc1.read_pdu(pdu.msg, 3));
+
+  // ACK the first SN only, the window moves by one
+  rlc_status_pdu_t status;
+  byte_buffer_t    status_buf;
+  status.ack_sn = 1;
+  rlc_am_write_status_pdu(&status, &status_buf);
+  rlc1.write_pdu(status_buf.msg, status_buf.N_bytes);
+  rlc1.get_buffer_state();
+  pdu.N_bytes = rlc1.read_pdu(pdu.msg, 3);
+  assert(pdu.N_bytes == 3);
+  rlc_am_read_data_pdu_header(&pdu, &h);
+  assert(h.sn == RLC_AM_WINDOW_SIZE);
+  assert(pdu.msg[2] == (RLC_AM_WINDOW_SIZE & 0xFF));
+  rlc1.get_buffer_state();
+  assert(0 == rlc1.read_pdu(pdu.msg, 3));
+
+  // ACK all of them, the remaining SDUs go out
+  status.ack_sn = RLC_AM_WINDOW_SIZE + 1;
+  rlc_am_write_status_pdu(&status, &status_buf);
+  rlc1.write_pdu(status_buf.msg, status_buf.N_bytes);
+  for(int i=RLC_AM_WINDOW_SIZE+1;i<nof_sdus;i++)
+  {
+    rlc1.get_buffer_state();
+    pdu.N_bytes = rlc1.read_pdu(pdu.msg, 3);
+    assert(pdu.N_bytes == 3);
+    rlc_am_read_data_pdu_header(&pdu, &h);
+    assert(h.sn == i);
+    assert(pdu.msg[2] == (i & 0xFF));
+  }
+  assert(0 == rlc1.get_buffer_state());
+}
+
+void poll_retx_test()
+{
+  srslte::log_stdout log1("RLC_AM_1");
+  srslte::log_stdout log2("RLC_AM_2");
+  log1.set_level(srslte::LOG_LEVEL_DEBUG);
+  log2.set_level(srslte::LOG_LEVEL_DEBUG);
+  log1.set_hex_limit(-1);
+  log2.set_hex_limit(-1);
+  rlc_am_tester     tester;
+  mac_dummy_timers  timers;
+
+  rlc_am rlc1;
+  rlc_am rlc2;
+  rlc1.init(&log1, 1, &tester, &tester, &timers);
+  rlc2.init(&log2, 1, &tester, &tester, &timers);
+
+  LIBLTE_RRC_RLC_CONFIG_STRUCT cnfg;
+  bzero(&cnfg, sizeof(LIBLTE_RRC_RLC_CONFIG_STRUCT));
+  cnfg.rlc_mode = LIBLTE_RRC_RLC_MODE_AM;
+  cnfg.dl_am_rlc.t_reordering = LIBLTE_RRC_T_REORDERING_MS5;
+  cnfg.dl_am_rlc.t_status_prohibit = LIBLTE_RRC_T_STATUS_PROHIBIT_MS5;
+  cnfg.ul_am_rlc.t_poll_retx = LIBLTE_RRC_T_POLL_RETRANSMIT_MS5;
+  cnfg.ul_am_rlc.max_retx_thresh = LIBLTE_RRC_MAX_RETX_THRESHOLD_T4;
+  cnfg.ul_am_rlc.poll_byte = LIBLTE_RRC_POLL_BYTE_KB25;
+  cnfg.ul_am_rlc.poll_pdu = LIBLTE_RRC_POLL_PDU_P4;
+  rlc1.configure(&cnfg);
+  rlc2.configure(&cnfg);
+
+  byte_buffer_t sdu;
+  *sdu.msg    = 7;
+  sdu.N_bytes = 1;
+  rlc1.write_sdu(&sdu);
+
+  // The only PDU polls and is lost
+  byte_buffer_t pdu;
+  pdu.N_bytes = rlc1.read_pdu(pdu.msg, 3);
+  rlc_amd_pdu_header_t h;
+  rlc_am_read_data_pdu_header(&pdu, &h);
+  assert(h.p == 1);
+  assert(0 == rlc1.get_buffer_state());
+
+  // Sleep to let the poll retx timeout expire. With the SDU buffer empty, the PDU is retransmitted
+  usleep(10000);
+
+  assert(3 == rlc1.get_buffer_state());
+  byte_buffer_t retx;
+  retx.N_bytes = rlc1.read_pdu(retx.msg, 3);
+  assert(retx.N_bytes == 3);
+  rlc_am_read_data_pdu_header(&retx, &h);
+  assert(h.sn == 0);
+  assert(h.p == 1);
+  assert(0 == rlc1.get_buffer_state());
+
+  rlc2.write_pdu(retx.msg, retx.N_bytes);
+  assert(tester.n_sdus == 1);
+  assert(*(tester.sdus[0]->msg) == 7);
+
+  // The status stops the poll retx timer
+  byte_buffer_t status_buf;
+  assert(2 == rlc2.get_buffer_state());
+  status_buf.N_bytes = rlc2.read_pdu(status_buf.msg, 2);
+  rlc1.write_pdu(status_buf.msg, status_buf.N_bytes);
+  usleep(10000);
+  assert(0 == rlc1.get_buffer_state());
+}
+
+void status_nack_so_test()
+{
+  // Rx PDUs:             |  0  |  1: |30|  |30|  |  2: lost  |  3:   |80|  |  4  |
+  // NACKs:                        |30|  |30|      |    2     | |40|
+
+  srslte::log_stdout log1("RLC_AM_1");
+  log1.set_level(srslte::LOG_LEVEL_DEBUG);
+  log1.set_hex_limit(-1);
+  rlc_am_tester     tester;
+  mac_dummy_timers  timers;
+
+  rlc_am rlc1;
+  rlc1.init(&log1, 1, &tester, &tester, &timers);
+
+  LIBLTE_RRC_RLC_CONFIG_STRUCT cnfg;
+  bzero(&cnfg, sizeof(LIBLTE_RRC_RLC_CONFIG_STRUCT));
+  cnfg.rlc_mode = LIBLTE_RRC_RLC_MODE_AM;
+  cnfg.dl_am_rlc.t_reordering = LIBLTE_RRC_T_REORDERING_MS5;
+  cnfg.dl_am_rlc.t_status_prohibit = LIBLTE_RRC_T_STATUS_PROHIBIT_MS5;
+  rlc1.configure(&cnfg);
+
+  uint8_t data[120];
+  for(int i=0;i<120;i++)
+    data[i] = i;
+
+  byte_buffer_t seg;
+  write_segment(&seg, 0, data, 120, NULL, 0, 0, 120);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  write_segment(&seg, 1, data, 120, NULL, 0, 0, 30);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  write_segment(&seg, 1, data, 120, NULL, 0, 60, 90);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  write_segment(&seg, 3, data, 120, NULL, 0, 40, 120);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  write_segment(&seg, 4, data, 120, NULL, 0, 0, 120);
+  seg.msg[0] |= 0x20; // Poll
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+
+  // Sleep to let reordering timeout expire
+  usleep(10000);
+
+  // The buffer state is the length of the status PDU
+  uint32_t      len = rlc1.get_buffer_state();
+  byte_buffer_t status_buf;
+  status_buf.N_bytes = rlc1.read_pdu(status_buf.msg, 100);
+  assert(len == 20); // 15 bits fixed part, 3 NACKs with SO range of 42 bits, 1 NACK of 12 bits
+  assert(status_buf.N_bytes == len);
+
+  rlc_status_pdu_t status;
+  rlc_am_read_status_pdu(&status_buf, &status);
+  assert(status.ack_sn == 5);
+  assert(status.N_nack == 4);
+  assert(status.nacks[0].nack_sn == 1 && status.nacks[0].has_so);
+  assert(status.nacks[0].so_start == 30 && status.nacks[0].so_end == 59);
+  assert(status.nacks[1].nack_sn == 1 && status.nacks[1].has_so);
+  assert(status.nacks[1].so_start == 90 && status.nacks[1].so_end == 0x7FFF);
+  assert(status.nacks[2].nack_sn == 2 && !status.nacks[2].has_so);
+  assert(status.nacks[3].nack_sn == 3 && status.nacks[3].has_so);
+  assert(status.nacks[3].so_start == 0 && status.nacks[3].so_end == 39);
+
+  // Fill the first gap of SN 1 and receive SN 2, polling again
+  write_segment(&seg, 1, data, 120, NULL, 0, 30, 60);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  write_segment(&seg, 2, data, 120, NULL, 0, 0, 120);
+  seg.msg[0] |= 0x20; // Poll
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+
+  // Sleep to let the status prohibit timeout expire
+  usleep(10000);
+
+  len = rlc1.get_buffer_state();
+  status_buf.N_bytes = rlc1.read_pdu(status_buf.msg, 100);
+  assert(len == 13); // 15 bits fixed part, 2 NACKs with SO range of 42 bits
+  assert(status_buf.N_bytes == len);
+
+  rlc_am_read_status_pdu(&status_buf, &status);
+  assert(status.ack_sn == 5);
+  assert(status.N_nack == 2);
+  assert(status.nacks[0].nack_sn == 1);
+  assert(status.nacks[0].so_start == 90 && status.nacks[0].so_end == 0x7FFF);
+  assert(status.nacks[1].nack_sn == 3);
+  assert(status.nacks[1].so_start == 0 && status.nacks[1].so_end == 39);
+}
+
+void status_truncated_test()
+{
+  // Rx PDUs:             |  0  |  1: lost  |  2: |30|  |30|  |  3: lost  |  4  |
+  // NACKs:                     |    1     |      |30|  |30|  |    3     |
+
+  srslte::log_stdout log1("RLC_AM_1");
+  log1.set_level(srslte::LOG_LEVEL_DEBUG);
+  log1.set_hex_limit(-1);
+  rlc_am_tester     tester;
+  mac_dummy_timers  timers;
+
+  rlc_am rlc1;
+  rlc1.init(&log1, 1, &tester, &tester, &timers);
+
+  LIBLTE_RRC_RLC_CONFIG_STRUCT cnfg;
+  bzero(&cnfg, sizeof(LIBLTE_RRC_RLC_CONFIG_STRUCT));
+  cnfg.rlc_mode = LIBLTE_RRC_RLC_MODE_AM;
+  cnfg.dl_am_rlc.t_reordering = LIBLTE_RRC_T_REORDERING_MS5;
+  cnfg.dl_am_rlc.t_status_prohibit = LIBLTE_RRC_T_STATUS_PROHIBIT_MS5;
+  rlc1.configure(&cnfg);
+
+  uint8_t data[120];
+  for(int i=0;i<120;i++)
+    data[i] = i;
+
+  byte_buffer_t seg;
+  write_segment(&seg, 0, data, 120, NULL, 0, 0, 120);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  write_segment(&seg, 2, data, 120, NULL, 0, 0, 30);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  write_segment(&seg, 2, data, 120, NULL, 0, 60, 90);
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  write_segment(&seg, 4, data, 120, NULL, 0, 0, 120);
+  seg.msg[0] |= 0x20; // Poll
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+
+  // Sleep to let reordering timeout expire
+  usleep(10000);
+
+  // 15 bits fixed part, NACKs of 12, 2x42 and 12 bits
+  assert(rlc1.get_buffer_state() == 16);
+
+  // 9 bytes hold the NACK of SN 1 and only one of the NACKs of SN 2. SN 2 is left out and
+  // ACK_SN is SN 2
+  byte_buffer_t status_buf;
+  status_buf.N_bytes = rlc1.read_pdu(status_buf.msg, 9);
+  assert(status_buf.N_bytes == 4);
+
+  rlc_status_pdu_t status;
+  rlc_am_read_status_pdu(&status_buf, &status);
+  assert(status.ack_sn == 2);
+  assert(status.N_nack == 1);
+  assert(status.nacks[0].nack_sn == 1 && !status.nacks[0].has_so);
+
+  // With room for the NACKs of SN 2, ACK_SN is SN 3
+  write_segment(&seg, 4, data, 120, NULL, 0, 0, 120);
+  seg.msg[0] |= 0x20; // Poll
+  rlc1.write_pdu(seg.msg, seg.N_bytes);
+  usleep(10000);
+  status_buf.N_bytes = rlc1.read_pdu(status_buf.msg, 14);
+  assert(status_buf.N_bytes == 14);
+
+  rlc_am_read_status_pdu(&status_buf, &status);
+  assert(status.ack_sn == 3);
+  assert(status.N_nack == 3);
+  assert(status.nacks[0].nack_sn == 1);
+  assert(status.nacks[1].nack_sn == 2 && status.nacks[1].so_start == 30 && status.nacks[1].so_end == 59);
+  assert(status.nacks[2].nack_sn == 2 && status.nacks[2].so_start == 90 && status.nacks[2].so_end == 0x7FFF);
+}
+
+void status_nack_merge_test()
+{
+  // PDUs:                |        100       | 1 |
+  // NACKs of SN 0:          |10|    |10|  |20|       (first status)
+  //                      |10|        SN 0            (second status)
+
+  srslte::log_stdout log1("RLC_AM_1");
+  srslte::log_stdout log2("RLC_AM_2");
+  log1.set_level(srslte::LOG_LEVEL_DEBUG);
+  log2.set_level(srslte::LOG_LEVEL_DEBUG);
+  log1.set_hex_limit(-1);
+  log2.set_hex_limit(-1);
+  rlc_am_tester     tester;
+  mac_dummy_timers  timers;
+
+  rlc_am rlc1;
+  rlc_am rlc2;
+  rlc1.init(&log1, 1, &tester, &tester, &timers);
+  rlc2.init(&log2, 1, &tester, &tester, &timers);
+
+  LIBLTE_RRC_RLC_CONFIG_STRUCT cnfg;
+  bzero(&cnfg, sizeof(LIBLTE_RRC_RLC_CONFIG_STRUCT));
+  cnfg.rlc_mode = LIBLTE_RRC_RLC_MODE_AM;
+  cnfg.dl_am_rlc.t_reordering = LIBLTE_RRC_T_REORDERING_MS5;
+  cnfg.dl_am_rlc.t_status_prohibit = LIBLTE_RRC_T_STATUS_PROHIBIT_MS5;
+  cnfg.ul_am_rlc.t_poll_retx = LIBLTE_RRC_T_POLL_RETRANSMIT_MS500;
+  cnfg.ul_am_rlc.max_retx_thresh = LIBLTE_RRC_MAX_RETX_THRESHOLD_T4;
+  cnfg.ul_am_rlc.poll_byte = LIBLTE_RRC_POLL_BYTE_KB25;
+  cnfg.ul_am_rlc.poll_pdu = LIBLTE_RRC_POLL_PDU_P4;
+  rlc1.configure(&cnfg);
+  rlc2.configure(&cnfg);
+
+  byte_buffer_t sdu_bufs[2];
+  for(int j=0;j<100;j++)
+    sdu_bufs[0].msg[j] = j;
+  sdu_bufs[0].N_bytes = 100;
+  *sdu_bufs[1].msg    = 100;
+  sdu_bufs[1].N_bytes = 1;
+  rlc1.write_sdu(&sdu_bufs[0]);
+  rlc1.write_sdu(&sdu_bufs[1]);
+
+  byte_buffer_t pdu_bufs[2];
+  pdu_bufs[0].N_bytes = rlc1.read_pdu(pdu_bufs[0].msg, 102);
+  pdu_bufs[1].N_bytes = rlc1.read_pdu(pdu_bufs[1].msg, 3);
+  assert(0 == rlc1.get_buffer_state());
+
+  // SN 0 is lost
+  rlc2.write_pdu(pdu_bufs[1].msg, pdu_bufs[1].N_bytes);
+
+  // The NACKs of SN 0 are merged into one retx from SO 10 to the end of the PDU
+  rlc_status_pdu_t status;
+  byte_buffer_t    status_buf;
+  status.ack_sn = 2;
+  status.N_nack = 3;
+  status.nacks[0].nack_sn  = 0;
+  status.nacks[0].has_so   = true;
+  status.nacks[0].so_start = 10;
+  status.nacks[0].so_end   = 19;
+  status.nacks[1].nack_sn  = 0;
+  status.nacks[1].has_so   = true;
+  status.nacks[1].so_start = 50;
+  status.nacks[1].so_end   = 59;
+  status.nacks[2].nack_sn  = 0;
+  status.nacks[2].has_so   = true;
+  status.nacks[2].so_start = 80;
+  status.nacks[2].so_end   = 0x7FFF;
+  rlc_am_write_status_pdu(&status, &status_buf);
+  rlc1.write_pdu(status_buf.msg, status_buf.N_bytes);
+
+  assert(94 == rlc1.get_buffer_state()); // 4 byte segment header + 90 bytes
+  byte_buffer_t retx1;
+  retx1.N_bytes = rlc1.read_pdu(retx1.msg, 94);
+  assert(retx1.N_bytes == 94);
+  rlc_amd_pdu_header_t h;
+  rlc_am_read_data_pdu_header(&retx1, &h);
+  assert(h.sn == 0 && h.rf == 1 && h.so == 10 && h.lsf == 1);
+  assert(0 == rlc1.get_buffer_state());
+
+  // A NACK without SO range makes the whole PDU pending again
+  status.N_nack = 2;
+  status.nacks[0].so_start = 0;
+  status.nacks[0].so_end   = 9;
+  status.nacks[1].has_so   = false;
+  rlc_am_write_status_pdu(&status, &status_buf);
+  rlc1.write_pdu(status_buf.msg, status_buf.N_bytes);
+
+  assert(102 == rlc1.get_buffer_state());
+  byte_buffer_t retx2;
+  retx2.N_bytes = rlc1.read_pdu(retx2.msg, 102);
+  assert(retx2.N_bytes == 102);
+  rlc_am_read_data_pdu_header(&retx2, &h);
+  assert(h.sn == 0 && h.rf == 0);
+
+  rlc2.write_pdu(retx1.msg, retx1.N_bytes);
+  rlc2.write_pdu(retx2.msg, retx2.N_bytes);
+
+  assert(tester.n_sdus == 2);
+  assert(tester.sdus[0]->N_bytes == 100);
+  for(int j=0;j<100;j++)
+    assert(tester.sdus[0]->msg[j] == j);
+  assert(tester.sdus[1]->N_bytes == 1);
+  assert(*(tester.sdus[1]->msg) == 100);
+}
+
 int main(int argc, char **argv) {
   basic_test();
   buffer_pool::get_instance()->cleanup();
+  burst_test();
+  buffer_pool::get_instance()->cleanup();
   concat_test();
   buffer_pool::get_instance()->cleanup();
   segment_test();
@@ -1052,4 +1701,20 @@ int main(int argc, char **argv) {
   resegment_test_5();
   buffer_pool::get_instance()->cleanup();
   resegment_test_6();
+  buffer_pool::get_instance()->cleanup();
+  segment_li_test();
+  buffer_pool::get_instance()->cleanup();
+  segment_reorder_test();
+  buffer_pool::get_instance()->cleanup();
+  segment_intervals_test();
+  buffer_pool::get_instance()->cleanup();
+  window_stall_test();
+  buffer_pool::get_instance()->cleanup();
+  poll_retx_test();
+  buffer_pool::get_instance()->cleanup();
+  status_nack_so_test();
+  buffer_pool::get_instance()->cleanup();
+  status_truncated_test();
+  buffer_pool::get_instance()->cleanup();
+  status_nack_merge_test();
 }
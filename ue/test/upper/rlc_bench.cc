@@ -0,0 +1,798 @@
+/**
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2013-2015 Software Radio Systems Limited
+ *
+ * \section LICENSE
+ *
+ * This file is part of the srsUE library.
+ *
+ * srsUE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsUE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/* RLC AM and UM microbenchmarks.
+ *
+ * A TX and an RX entity exchange PDUs over a channel model that drops, holds back and
+ * duplicates PDUs with configurable probabilities. SDU and grant sizes are drawn uniformly
+ * from configurable ranges. Every step writes SDUs to the TX entity while it holds less
+ * than a few grants of data, reads one data PDU from it and one status PDU from the RX
+ * entity, and steps the MAC timers once. Each call to the entities is timed, so the per
+ * call cost of the window operations is reported apart from the channel model, and the
+ * entities are built with RLC_COUNT_COPIES to count the bytes they copy.
+ *
+ * The AM entities run their t_reordering, t_status_prohibit and t_poll_retx on the wall
+ * clock, so the rates computed over the time spent in the entities are the ones to compare
+ * between builds. The AM transmitter does not stop at a full window, so SDUs are held back,
+ * as the PDCP would, while the PDUs seen on the channel leave half the window unacknowledged
+ * or the SDU queue of the entity is full. The predefined scenarios run in order unless one is chosen with -f or a
+ * custom one is given. Results are printed to stdout as JSON.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <vector>
+#include <deque>
+
+#include "liblte/hdr/liblte_rrc.h"
+#include "common/common.h"
+#include "common/buffer_pool.h"
+#include "common/log_stdout.h"
+#include "common/timers.h"
+#include "common/interfaces.h"
+#include "upper/rlc_am.h"
+#include "upper/rlc_um.h"
+
+using namespace srsue;
+
+#define LCID 3
+
+namespace srsue {
+uint64_t rlc_copied_bytes = 0;
+}
+
+/**********************************************************************
+ *  Scenarios
+ ***********************************************************************/
+typedef struct {
+  const char *name;
+  bool        um;
+  uint32_t    sdu_min;
+  uint32_t    sdu_max;
+  uint32_t    pdu_min;
+  uint32_t    pdu_max;
+  float       loss;
+  float       reorder;
+  uint32_t    reorder_depth;
+  float       dup;
+}scenario_t;
+
+static const scenario_t scenarios[] = {
+  // name              um     SDU bytes     grant bytes   loss  reorder depth dup
+  {"am_clean",         false, 1400, 1400,   1500, 1500,   0,    0,      0,    0},
+  {"am_concat",        false, 40,   200,    3000, 3000,   0,    0,      0,    0},
+  {"am_segment",       false, 1400, 1400,   100,  300,    0,    0,      0,    0},
+  {"am_mixed",         false, 40,   1500,   200,  4000,   0,    0,      0,    0},
+  {"am_loss1",         false, 1400, 1400,   500,  2000,   0.01, 0,      0,    0},
+  {"am_loss10",        false, 1400, 1400,   500,  2000,   0.1,  0,      0,    0},
+  {"am_reorder",       false, 1400, 1400,   500,  2000,   0,    0.1,    8,    0},
+  {"am_dup",           false, 1400, 1400,   500,  2000,   0,    0,      0,    0.05},
+  {"am_mixed_impair",  false, 40,   1500,   100,  4000,   0.05, 0.05,   16,   0.02},
+  {"um_clean",         true,  1400, 1400,   1500, 1500,   0,    0,      0,    0},
+  {"um_concat",        true,  40,   200,    3000, 3000,   0,    0,      0,    0},
+  {"um_segment",       true,  1400, 1400,   100,  300,    0,    0,      0,    0},
+  {"um_loss1",         true,  1400, 1400,   500,  2000,   0.01, 0,      0,    0},
+  {"um_reorder",       true,  1400, 1400,   500,  2000,   0,    0.1,    8,    0},
+};
+static const uint32_t nof_scenarios = sizeof(scenarios)/sizeof(scenario_t);
+
+/**********************************************************************
+ *  Program arguments processing
+ ***********************************************************************/
+typedef struct {
+  uint32_t    nof_sdus;
+  char       *filter;
+  bool        custom;
+  scenario_t  custom_scenario;
+  uint32_t    seed;
+  int         verbose;
+}prog_args_t;
+
+prog_args_t prog_args;
+
+void args_default(prog_args_t *args) {
+  args->nof_sdus = 100000;
+  args->filter   = NULL;
+  args->custom   = false;
+  args->seed     = 1;
+  args->verbose  = 0;
+  args->custom_scenario = scenarios[0];
+  args->custom_scenario.name = "custom";
+}
+
+void usage(prog_args_t *args, char *prog) {
+  printf("Usage: %s [nfulrRdsSpPxv]\n", prog);
+  printf("\t-n SDUs per scenario [Default %d]\n", args->nof_sdus);
+  printf("\t-f Run only the predefined scenario with this name\n");
+  printf("\tAny of the following runs a single custom scenario:\n");
+  printf("\t-u Use RLC UM instead of AM\n");
+  printf("\t-l PDU loss probability [Default %.2f]\n", args->custom_scenario.loss);
+  printf("\t-r PDU reordering probability [Default %.2f]\n", args->custom_scenario.reorder);
+  printf("\t-R PDUs overtaking a reordered PDU [Default %d]\n", args->custom_scenario.reorder_depth);
+  printf("\t-d PDU duplication probability [Default %.2f]\n", args->custom_scenario.dup);
+  printf("\t-s Minimum SDU size in bytes [Default %d]\n", args->custom_scenario.sdu_min);
+  printf("\t-S Maximum SDU size in bytes [Default %d]\n", args->custom_scenario.sdu_max);
+  printf("\t-p Minimum grant size in bytes [Default %d]\n", args->custom_scenario.pdu_min);
+  printf("\t-P Maximum grant size in bytes [Default %d]\n", args->custom_scenario.pdu_max);
+  printf("\t-x Random seed [Default %d]\n", args->seed);
+  printf("\t-v [increase verbosity, logs the entities to stdout]\n");
+}
+
+void parse_args(prog_args_t *args, int argc, char **argv) {
+  int opt;
+  args_default(args);
+  scenario_t *c = &args->custom_scenario;
+  while ((opt = getopt(argc, argv, "nfulrRdsSpPxv")) != -1) {
+    switch (opt) {
+    case 'n':
+      args->nof_sdus = atoi(argv[optind]);
+      break;
+    case 'f':
+      args->filter = argv[optind];
+      break;
+    case 'u':
+      c->um = true;
+      args->custom = true;
+      break;
+    case 'l':
+      c->loss = atof(argv[optind]);
+      args->custom = true;
+      break;
+    case 'r':
+      c->reorder = atof(argv[optind]);
+      args->custom = true;
+      break;
+    case 'R':
+      c->reorder_depth = atoi(argv[optind]);
+      args->custom = true;
+      break;
+    case 'd':
+      c->dup = atof(argv[optind]);
+      args->custom = true;
+      break;
+    case 's':
+      c->sdu_min = atoi(argv[optind]);
+      args->custom = true;
+      break;
+    case 'S':
+      c->sdu_max = atoi(argv[optind]);
+      args->custom = true;
+      break;
+    case 'p':
+      c->pdu_min = atoi(argv[optind]);
+      args->custom = true;
+      break;
+    case 'P':
+      c->pdu_max = atoi(argv[optind]);
+      args->custom = true;
+      break;
+    case 'x':
+      args->seed = atoi(argv[optind]);
+      break;
+    case 'v':
+      args->verbose++;
+      break;
+    default:
+      usage(args, argv[0]);
+      exit(-1);
+    }
+  }
+  if (c->reorder > 0 && c->reorder_depth == 0) {
+    c->reorder_depth = 8;
+  }
+  if (c->sdu_min < 8 || c->sdu_max < c->sdu_min || c->sdu_max > 8000 ||
+      c->pdu_min < 16 || c->pdu_max < c->pdu_min || c->pdu_max > 8000)
+  {
+    usage(args, argv[0]);
+    exit(-1);
+  }
+}
+
+uint64_t now_ns()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec*1000000000 + t.tv_nsec;
+}
+
+float draw(uint32_t *seed)
+{
+  return (float) rand_r(seed)/((float) RAND_MAX + 1);
+}
+
+uint32_t draw_range(uint32_t *seed, uint32_t min, uint32_t max)
+{
+  return min + (uint32_t) (draw(seed)*(max - min + 1));
+}
+
+/**********************************************************************
+ *  Channel model
+ ***********************************************************************/
+class channel
+{
+public:
+
+  void init(const scenario_t *s, uint32_t seed_)
+  {
+    loss          = s->loss;
+    reorder       = s->reorder;
+    reorder_depth = s->reorder_depth;
+    dup           = s->dup;
+    seed          = seed_;
+    ready.clear();
+    held.clear();
+    nof_pdus      = 0;
+    nof_bytes     = 0;
+    nof_lost      = 0;
+    nof_reordered = 0;
+    nof_dup       = 0;
+  }
+
+  // A held PDU is delivered after reorder_depth PDUs sent after it
+  void send(uint8_t *payload, uint32_t nof_bytes_)
+  {
+    nof_pdus++;
+    nof_bytes += nof_bytes_;
+    if (draw(&seed) < loss) {
+      nof_lost++;
+      return;
+    }
+    std::vector<uint8_t> pdu(payload, payload + nof_bytes_);
+    bool duplicate = draw(&seed) < dup;
+    if (draw(&seed) < reorder) {
+      held_pdu_t h;
+      h.pdu       = pdu;
+      h.countdown = reorder_depth;
+      held.push_back(h);
+      nof_reordered++;
+    } else {
+      ready.push_back(pdu);
+      release();
+    }
+    if (duplicate) {
+      ready.push_back(pdu);
+      nof_dup++;
+    }
+  }
+
+  // Delivers the held PDUs when nothing else is sent
+  void flush()
+  {
+    for (uint32_t i=0;i<held.size();i++) {
+      ready.push_back(held[i].pdu);
+    }
+    held.clear();
+  }
+
+  bool empty()
+  {
+    return ready.empty() && held.empty();
+  }
+
+  std::deque<std::vector<uint8_t> > ready;
+
+  uint64_t nof_pdus;
+  uint64_t nof_bytes;
+  uint64_t nof_lost;
+  uint64_t nof_reordered;
+  uint64_t nof_dup;
+
+private:
+
+  void release()
+  {
+    std::deque<held_pdu_t>::iterator it = held.begin();
+    while (it != held.end()) {
+      if (--it->countdown == 0) {
+        ready.push_back(it->pdu);
+        it = held.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  typedef struct {
+    std::vector<uint8_t> pdu;
+    uint32_t             countdown;
+  } held_pdu_t;
+
+  std::deque<held_pdu_t> held;
+
+  float    loss;
+  float    reorder;
+  uint32_t reorder_depth;
+  float    dup;
+  uint32_t seed;
+};
+
+/**********************************************************************
+ *  MAC timers stepped once per step, and SDU sink
+ ***********************************************************************/
+class bench_timers
+    :public srslte::mac_interface_timers
+{
+public:
+  bench_timers() : timers(32) {}
+  srslte::timers::timer* get(uint32_t timer_id)
+  {
+    return timers.get(timer_id);
+  }
+  uint32_t get_unique_id()
+  {
+    return timers.get_unique_id();
+  }
+  void step()
+  {
+    timers.step_all();
+  }
+  void reset()
+  {
+    timers.stop_all();
+  }
+private:
+  srslte::timers timers;
+};
+
+class sdu_sink
+    :public pdcp_interface_rlc
+    ,public rrc_interface_rlc
+{
+public:
+
+  void reset()
+  {
+    pool          = srslte::buffer_pool::get_instance();
+    next_seq      = 0;
+    nof_sdus      = 0;
+    nof_bytes     = 0;
+    nof_gaps      = 0;
+    nof_out_of_order = 0;
+    nof_corrupted = 0;
+    nof_max_retx  = 0;
+  }
+
+  // Every SDU starts with its sequence number and is filled with its lowest byte
+  void write_pdu(uint32_t lcid, srslte::byte_buffer_t *sdu)
+  {
+    uint32_t seq = 0;
+    if (sdu->N_bytes >= 8) {
+      memcpy(&seq, sdu->msg, sizeof(uint32_t));
+      if (sdu->msg[4] != (uint8_t) seq || sdu->msg[sdu->N_bytes-1] != (uint8_t) seq) {
+        nof_corrupted++;
+      }
+    } else {
+      nof_corrupted++;
+    }
+    if (seq > next_seq) {
+      nof_gaps++;
+    } else if (seq < next_seq) {
+      nof_out_of_order++;
+    }
+    if (seq >= next_seq) {
+      next_seq = seq + 1;
+    }
+    nof_sdus++;
+    nof_bytes += sdu->N_bytes;
+    pool->deallocate(sdu);
+  }
+  void write_pdu_bcch_bch(srslte::byte_buffer_t *sdu) {}
+  void write_pdu_bcch_dlsch(srslte::byte_buffer_t *sdu) {}
+  void write_pdu_pcch(srslte::byte_buffer_t *sdu) {}
+
+  // RRC interface
+  void max_retx_attempted()
+  {
+    nof_max_retx++;
+  }
+
+  uint64_t nof_sdus;
+  uint64_t nof_bytes;
+  uint64_t nof_gaps;
+  uint64_t nof_out_of_order;
+  uint64_t nof_corrupted;
+  uint32_t nof_max_retx;
+
+private:
+  srslte::buffer_pool *pool;
+  uint32_t             next_seq;
+};
+
+/**********************************************************************
+ *  Timed calls to the entities
+ ***********************************************************************/
+typedef enum {
+  OP_WRITE_SDU = 0,
+  OP_READ_DATA,
+  OP_WRITE_DATA,
+  OP_READ_STATUS,
+  OP_WRITE_STATUS,
+  OP_BUFFER_STATE,
+  OP_N_ITEMS,
+} op_t;
+static const char op_text[OP_N_ITEMS][16] = {"write_sdu", "read_data", "write_data",
+                                             "read_status", "write_status", "buffer_state"};
+
+typedef struct {
+  uint64_t nof_calls;
+  uint64_t ns;
+} op_stats_t;
+
+class bench
+{
+public:
+
+  // Data kept queued in the TX entity, in grants of the largest size
+  const static uint32_t QUEUED_GRANTS  = 2;
+  // A run is abandoned when nothing is delivered for this long
+  const static uint64_t MAX_IDLE_NS    = 2000000000;
+  // Capacity of the SDU queue of the entities, write_sdu() blocks when it is full
+  const static uint32_t TX_QUEUE_SDUS  = 16;
+  // Unacknowledged AM SNs above which no SDUs are written
+  const static uint32_t MAX_INFLIGHT   = RLC_AM_WINDOW_SIZE/2;
+  const static uint32_t SN_MOD         = 1024;
+
+  void run(const scenario_t *s_, uint32_t nof_sdus_, uint32_t seed_, srslte::log *log_tx, srslte::log *log_rx)
+  {
+    s        = s_;
+    nof_sdus = nof_sdus_;
+    seed     = seed_;
+    pool     = srslte::buffer_pool::get_instance();
+
+    rlc_common *tx;
+    rlc_common *rx;
+    if (s->um) {
+      tx = &um_tx;
+      rx = &um_rx;
+    } else {
+      tx = &am_tx;
+      rx = &am_rx;
+    }
+
+    LIBLTE_RRC_RLC_CONFIG_STRUCT cnfg;
+    bzero(&cnfg, sizeof(LIBLTE_RRC_RLC_CONFIG_STRUCT));
+    if (s->um) {
+      cnfg.rlc_mode                    = LIBLTE_RRC_RLC_MODE_UM_BI;
+      cnfg.ul_um_bi_rlc.sn_field_len   = LIBLTE_RRC_SN_FIELD_LENGTH_SIZE10;
+      cnfg.dl_um_bi_rlc.sn_field_len   = LIBLTE_RRC_SN_FIELD_LENGTH_SIZE10;
+      cnfg.dl_um_bi_rlc.t_reordering   = LIBLTE_RRC_T_REORDERING_MS35;
+    } else {
+      cnfg.rlc_mode                    = LIBLTE_RRC_RLC_MODE_AM;
+      cnfg.ul_am_rlc.t_poll_retx       = LIBLTE_RRC_T_POLL_RETRANSMIT_MS45;
+      cnfg.ul_am_rlc.poll_pdu          = LIBLTE_RRC_POLL_PDU_P32;
+      cnfg.ul_am_rlc.poll_byte         = LIBLTE_RRC_POLL_BYTE_KB25;
+      cnfg.ul_am_rlc.max_retx_thresh   = LIBLTE_RRC_MAX_RETX_THRESHOLD_T32;
+      cnfg.dl_am_rlc.t_reordering      = LIBLTE_RRC_T_REORDERING_MS35;
+      cnfg.dl_am_rlc.t_status_prohibit = LIBLTE_RRC_T_STATUS_PROHIBIT_MS0;
+    }
+    timers.reset();
+    sink.reset();
+    tx->init(log_tx, LCID, &sink, &sink, &timers);
+    rx->init(log_rx, LCID, &sink, &sink, &timers);
+    tx->configure(&cnfg);
+    rx->configure(&cnfg);
+
+    ul.init(s, seed*2);
+    dl.init(s, seed*2 + 1);
+    bzero(ops, sizeof(ops));
+    tx_seq         = 0;
+    tx_next_sn     = 0;
+    tx_ack_sn      = 0;
+    nof_started    = 0;
+    nof_steps      = 0;
+    nof_status     = 0;
+    status_bytes   = 0;
+    data_bytes     = 0;
+    stalled        = false;
+    rlc_copied_bytes = 0;
+
+    uint64_t start = now_ns();
+    uint64_t last_rx_time  = start;
+    uint64_t last_rx_sdus  = 0;
+    uint32_t queue_limit   = QUEUED_GRANTS*s->pdu_max;
+
+    while (!finished()) {
+      bool active = false;
+
+      // SDUs from the PDCP
+      uint32_t queued = timed_buffer_state(tx);
+      while (tx_seq < nof_sdus && queued < queue_limit && !queue_full()) {
+        srslte::byte_buffer_t *sdu = pool->allocate();
+        if (!sdu) {
+          break;
+        }
+        uint32_t len = draw_range(&seed, s->sdu_min, s->sdu_max);
+        memcpy(sdu->msg, &tx_seq, sizeof(uint32_t));
+        memset(&sdu->msg[4], (uint8_t) tx_seq, len - 4);
+        sdu->N_bytes = len;
+        uint64_t t = now_ns();
+        tx->write_sdu(sdu);
+        add_op(OP_WRITE_SDU, t);
+        tx_seq++;
+        queued += len;
+      }
+
+      // One data PDU from TX to RX
+      if (queued > 0) {
+        uint32_t grant = draw_range(&seed, s->pdu_min, s->pdu_max);
+        uint64_t t = now_ns();
+        int len = tx->read_pdu(buffer, grant);
+        add_op(OP_READ_DATA, t);
+        if (len > 0) {
+          data_bytes += len;
+          track_data_pdu(buffer, len);
+          ul.send(buffer, len);
+          active = true;
+        }
+      }
+      if (!active) {
+        ul.flush();
+      }
+      deliver(&ul, rx, false);
+
+      // One status PDU from RX to TX
+      if (timed_buffer_state(rx) > 0) {
+        uint32_t grant = draw_range(&seed, s->pdu_min, s->pdu_max);
+        uint64_t t = now_ns();
+        int len = rx->read_pdu(buffer, grant);
+        add_op(OP_READ_STATUS, t);
+        if (len > 0) {
+          nof_status++;
+          status_bytes += len;
+          dl.send(buffer, len);
+          active = true;
+        }
+      }
+      dl.flush();
+      deliver(&dl, tx, true);
+
+      timers.step();
+      nof_steps++;
+
+      // Waits for the wall clock timers of AM when there is nothing to send
+      uint64_t now = now_ns();
+      if (sink.nof_sdus != last_rx_sdus) {
+        last_rx_sdus = sink.nof_sdus;
+        last_rx_time = now;
+      } else if (now - last_rx_time > MAX_IDLE_NS) {
+        stalled = true;
+        break;
+      }
+      if (!active) {
+        usleep(100);
+      }
+    }
+    wall_ns = now_ns() - start;
+
+    tx->reset();
+    rx->reset();
+  }
+
+  void print_json(bool last)
+  {
+    uint64_t rlc_ns = 0;
+    for (uint32_t i=0;i<OP_N_ITEMS;i++) {
+      rlc_ns += ops[i].ns;
+    }
+    float rlc_secs  = (float) rlc_ns/1e9;
+    float wall_secs = (float) wall_ns/1e9;
+
+    printf("  {\n");
+    printf("    \"scenario\": \"%s\",\n", s->name);
+    printf("    \"config\": {\"rlc_mode\": \"%s\", \"sdu_bytes\": [%u, %u], \"grant_bytes\": [%u, %u], "
+           "\"loss\": %.3f, \"reorder\": %.3f, \"reorder_depth\": %u, \"dup\": %.3f},\n",
+           s->um?"um":"am", s->sdu_min, s->sdu_max, s->pdu_min, s->pdu_max,
+           s->loss, s->reorder, s->reorder_depth, s->dup);
+    printf("    \"tx_sdus\": %u,\n",                  tx_seq);
+    printf("    \"rx_sdus\": %lu,\n",                 (unsigned long) sink.nof_sdus);
+    printf("    \"rx_bytes\": %lu,\n",                (unsigned long) sink.nof_bytes);
+    printf("    \"gaps\": %lu,\n",                    (unsigned long) sink.nof_gaps);
+    printf("    \"out_of_order\": %lu,\n",            (unsigned long) sink.nof_out_of_order);
+    printf("    \"corrupted\": %lu,\n",               (unsigned long) sink.nof_corrupted);
+    printf("    \"max_retx\": %u,\n",                 sink.nof_max_retx);
+    printf("    \"stalled\": %s,\n",                  stalled?"true":"false");
+    printf("    \"steps\": %lu,\n",                   (unsigned long) nof_steps);
+    printf("    \"rlc_secs\": %.6f,\n",               rlc_secs);
+    printf("    \"wall_secs\": %.3f,\n",              wall_secs);
+    printf("    \"sdus_per_sec\": %.0f,\n",           rlc_secs>0?sink.nof_sdus/rlc_secs:0);
+    printf("    \"sdus_per_wall_sec\": %.0f,\n",      wall_secs>0?sink.nof_sdus/wall_secs:0);
+    printf("    \"mbps\": %.1f,\n",                   rlc_secs>0?sink.nof_bytes*8/rlc_secs/1e6:0);
+    printf("    \"copied_per_delivered_byte\": %.3f,\n",
+           sink.nof_bytes>0?(float) rlc_copied_bytes/sink.nof_bytes:0);
+    printf("    \"data_pdu_bytes_per_delivered_byte\": %.3f,\n",
+           sink.nof_bytes>0?(float) data_bytes/sink.nof_bytes:0);
+    printf("    \"status\": {\"pdus\": %lu, \"bytes\": %lu, \"overhead\": %.5f},\n",
+           (unsigned long) nof_status, (unsigned long) status_bytes,
+           data_bytes>0?(float) status_bytes/data_bytes:0);
+    printf("    \"channel\": {\"pdus\": %lu, \"lost\": %lu, \"reordered\": %lu, \"duplicated\": %lu},\n",
+           (unsigned long) (ul.nof_pdus + dl.nof_pdus), (unsigned long) (ul.nof_lost + dl.nof_lost),
+           (unsigned long) (ul.nof_reordered + dl.nof_reordered), (unsigned long) (ul.nof_dup + dl.nof_dup));
+    printf("    \"ns_per_call\": {");
+    for (uint32_t i=0;i<OP_N_ITEMS;i++) {
+      printf("\"%s\": %.0f%s", op_text[i],
+             ops[i].nof_calls>0?(float) ops[i].ns/ops[i].nof_calls:0, i<OP_N_ITEMS-1?", ":"");
+    }
+    printf("}\n");
+    printf("  }%s\n", last?"":",");
+  }
+
+private:
+
+  bool finished()
+  {
+    if (tx_seq < nof_sdus) {
+      return false;
+    }
+    if (sink.nof_sdus >= nof_sdus) {
+      return true;
+    }
+    // UM does not recover losses, it is done once everything sent has been delivered
+    return s->um && ul.empty() && um_tx.get_buffer_state() == 0 && !um_rx.reordering_timeout_running();
+  }
+
+  void deliver(channel *ch, rlc_common *dst, bool status)
+  {
+    while (!ch->ready.empty()) {
+      std::vector<uint8_t> &pdu = ch->ready.front();
+      if (status) {
+        track_status_pdu(&pdu[0], pdu.size());
+      }
+      uint64_t t = now_ns();
+      dst->write_pdu(&pdu[0], pdu.size());
+      add_op(status?OP_WRITE_STATUS:OP_WRITE_DATA, t);
+      ch->ready.pop_front();
+    }
+  }
+
+  // Follows the SDU queue and the AM transmit window from the PDUs exchanged by the entities
+  void track_data_pdu(uint8_t *payload, uint32_t nof_bytes)
+  {
+    if (s->um) {
+      rlc_umd_pdu_header_t header;
+      rlc_um_read_data_pdu_header(payload, nof_bytes, RLC_UMD_SN_SIZE_10_BITS, &header);
+      nof_started += header.N_li + (rlc_um_start_aligned(header.fi)?1:0);
+      return;
+    }
+    if (rlc_am_is_control_pdu(payload)) {
+      return;
+    }
+    rlc_amd_pdu_header_t header;
+    rlc_am_read_data_pdu_header(&payload, &nof_bytes, &header);
+    uint32_t inflight = (tx_next_sn - tx_ack_sn) % SN_MOD;
+    if ((header.sn - tx_ack_sn) % SN_MOD >= inflight) {
+      tx_next_sn = (header.sn + 1) % SN_MOD;
+      nof_started += header.N_li + (rlc_am_start_aligned(header.fi)?1:0);
+    }
+  }
+
+  void track_status_pdu(uint8_t *payload, uint32_t nof_bytes)
+  {
+    if (s->um || !rlc_am_is_control_pdu(payload)) {
+      return;
+    }
+    rlc_status_pdu_t status;
+    rlc_am_read_status_pdu(payload, nof_bytes, &status);
+    uint32_t sn = status.N_nack > 0 ? status.nacks[0].nack_sn : status.ack_sn;
+    if ((sn - tx_ack_sn) % SN_MOD <= (tx_next_sn - tx_ack_sn) % SN_MOD) {
+      tx_ack_sn = sn;
+    }
+  }
+
+  bool queue_full()
+  {
+    return tx_seq - nof_started >= TX_QUEUE_SDUS ||
+           (!s->um && (tx_next_sn - tx_ack_sn) % SN_MOD >= MAX_INFLIGHT);
+  }
+
+  uint32_t timed_buffer_state(rlc_common *rlc)
+  {
+    uint64_t t = now_ns();
+    uint32_t n = rlc->get_buffer_state();
+    add_op(OP_BUFFER_STATE, t);
+    return n;
+  }
+
+  void add_op(op_t op, uint64_t start)
+  {
+    ops[op].nof_calls++;
+    ops[op].ns += now_ns() - start;
+  }
+
+  const scenario_t *s;
+  uint32_t          nof_sdus;
+  uint32_t          seed;
+  srslte::buffer_pool *pool;
+
+  rlc_am       am_tx;
+  rlc_am       am_rx;
+  rlc_um       um_tx;
+  rlc_um       um_rx;
+  bench_timers timers;
+  sdu_sink     sink;
+  channel      ul;
+  channel      dl;
+
+  uint8_t      buffer[8192];
+  op_stats_t   ops[OP_N_ITEMS];
+  uint32_t     tx_seq;
+  uint32_t     tx_next_sn;
+  uint32_t     tx_ack_sn;
+  uint32_t     nof_started;
+  uint64_t     nof_steps;
+  uint64_t     nof_status;
+  uint64_t     status_bytes;
+  uint64_t     data_bytes;
+  uint64_t     wall_ns;
+  bool         stalled;
+};
+
+int main(int argc, char *argv[])
+{
+  parse_args(&prog_args, argc, argv);
+
+  srslte::log_stdout log_tx("RLC_TX");
+  srslte::log_stdout log_rx("RLC_RX");
+  srslte::LOG_LEVEL_ENUM level = srslte::LOG_LEVEL_NONE;
+  if (prog_args.verbose == 1) {
+    level = srslte::LOG_LEVEL_INFO;
+  } else if (prog_args.verbose > 1) {
+    level = srslte::LOG_LEVEL_DEBUG;
+  }
+  log_tx.set_level(level);
+  log_rx.set_level(level);
+
+  std::vector<const scenario_t*> run;
+  if (prog_args.custom) {
+    run.push_back(&prog_args.custom_scenario);
+  } else {
+    for (uint32_t i=0;i<nof_scenarios;i++) {
+      if (!prog_args.filter || !strcmp(prog_args.filter, scenarios[i].name)) {
+        run.push_back(&scenarios[i]);
+      }
+    }
+  }
+  if (run.empty()) {
+    printf("Unknown scenario %s\n", prog_args.filter);
+    exit(-1);
+  }
+
+  // The entities are large, keep them off the stack
+  bench *b = new bench;
+  printf("[\n");
+  for (uint32_t i=0;i<run.size();i++) {
+    b->run(run[i], prog_args.nof_sdus, prog_args.seed, &log_tx, &log_rx);
+    b->print_json(i == run.size() - 1);
+    fflush(stdout);
+  }
+  printf("]\n");
+  delete b;
+
+  srslte::buffer_pool::cleanup();
+  exit(0);
+}